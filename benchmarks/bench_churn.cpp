@@ -0,0 +1,119 @@
+// Object churn benchmark: N threads repeatedly create and destroy objects,
+// comparing the pointer API (create/destroy(T*)) with handles
+// (create_handle/destroy(Handle&)).
+//
+// Usage: bench_churn [ops_per_thread] [max_threads]
+
+#include <memglass/memglass.hpp>
+#include <memglass/registry.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memglass;
+
+namespace {
+
+struct Order {
+    uint64_t id;
+    int64_t price;
+    uint32_t quantity;
+    uint32_t side;
+};
+
+constexpr size_t LIVE_PER_THREAD = 8;
+
+void register_order() {
+    TypeDescriptor desc;
+    desc.name = "Order";
+    desc.size = sizeof(Order);
+    desc.alignment = alignof(Order);
+    desc.fields = {
+        {"id", offsetof(Order, id), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::None, false},
+        {"price", offsetof(Order, price), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+        {"quantity", offsetof(Order, quantity), sizeof(uint32_t), PrimitiveType::UInt32, 0, 0, Atomicity::None, false},
+        {"side", offsetof(Order, side), sizeof(uint32_t), PrimitiveType::UInt32, 0, 0, Atomicity::None, false},
+    };
+    registry::register_type_for<Order>(desc);
+}
+
+void churn_pointers(size_t ops, const std::string& label) {
+    std::vector<Order*> live;
+    live.reserve(LIVE_PER_THREAD + 1);
+    for (size_t i = 0; i < ops; ++i) {
+        Order* order = memglass::create<Order>(label);
+        if (!order) std::abort();
+        order->id = i;
+        live.push_back(order);
+        if (live.size() > LIVE_PER_THREAD) {
+            memglass::destroy(live.front());
+            live.erase(live.begin());
+        }
+    }
+    for (Order* order : live) memglass::destroy(order);
+}
+
+void churn_handles(size_t ops, const std::string& label) {
+    std::vector<Handle<Order>> live;
+    live.reserve(LIVE_PER_THREAD + 1);
+    for (size_t i = 0; i < ops; ++i) {
+        auto order = memglass::create_handle<Order>(label);
+        if (!order) std::abort();
+        order->id = i;
+        live.push_back(order);
+        if (live.size() > LIVE_PER_THREAD) {
+            memglass::destroy(live.front());
+            live.erase(live.begin());
+        }
+    }
+    for (auto& order : live) memglass::destroy(order);
+}
+
+// Returns create+destroy pairs per second across all threads
+template<typename Fn>
+double run(Fn fn, size_t threads, size_t ops) {
+    // Fresh session per run so region growth is comparable
+    Config config;
+    config.max_objects = 65536;
+    if (!memglass::init("bench_churn", config)) {
+        std::fprintf(stderr, "Failed to create session\n");
+        std::exit(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([fn, ops, t] { fn(ops, "order_" + std::to_string(t)); });
+    }
+    for (auto& w : workers) w.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    memglass::shutdown();
+    return static_cast<double>(threads * ops) / elapsed.count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                  : std::thread::hardware_concurrency();
+    if (ops == 0 || max_threads == 0) {
+        std::fprintf(stderr, "Usage: %s [ops_per_thread] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    register_order();
+
+    std::printf("%-8s %16s %16s %8s\n", "threads", "pointer ops/s", "handle ops/s", "speedup");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        double pointers = run(churn_pointers, threads, ops);
+        double handles = run(churn_handles, threads, ops);
+        std::printf("%-8zu %16.0f %16.0f %7.2fx\n", threads, pointers, handles, handles / pointers);
+    }
+    return 0;
+}
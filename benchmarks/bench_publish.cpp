@@ -0,0 +1,90 @@
+// Publishing cost benchmark: a typical instrumented hot loop (a Guarded
+// quote, an atomic counter, a rolling statistic and a cycle_end() per
+// iteration) with publishing live and paused. Built twice: bench_publish,
+// and bench_publish_disabled with MEMGLASS_DISABLE (compiled out).
+//
+// Usage: bench_publish [iterations]
+
+#include <memglass/memglass.hpp>
+#include <memglass/registry.hpp>
+#include <memglass/stats.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace memglass;
+
+namespace {
+
+struct Quote {
+    double bid;
+    double ask;
+};
+
+struct Engine {
+    std::atomic<uint64_t> ticks;
+    Guarded<Quote> quote;
+    Ewma spread;
+};
+
+void register_engine() {
+    TypeDescriptor desc;
+    desc.name = "Engine";
+    desc.size = sizeof(Engine);
+    desc.alignment = alignof(Engine);
+    desc.fields = {
+        {"ticks", offsetof(Engine, ticks), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::Atomic, true},
+    };
+    Ewma::describe(desc, "spread", offsetof(Engine, spread));
+    registry::register_type_for<Engine>(desc);
+}
+
+// Returns ns per iteration
+double run(Engine* engine, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        double bid = 100.0 + static_cast<double>(i & 7);
+        Quote q{bid, bid + 0.25};
+        engine->quote.write(q);
+        engine->ticks.fetch_add(1, std::memory_order_relaxed);
+        engine->spread.update(q.ask - q.bid);
+        memglass::cycle_end();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / static_cast<double>(iterations);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    if (iterations == 0) {
+        std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    register_engine();
+    if (!memglass::init("bench_publish")) {
+        std::fprintf(stderr, "Failed to create session\n");
+        return 1;
+    }
+    Engine* engine = memglass::create<Engine>("engine");
+    if (!engine) return 1;
+
+    run(engine, iterations / 10);  // warm up
+
+#ifdef MEMGLASS_DISABLE
+    std::printf("%-10s %8.2f ns/iter\n", "disabled", run(engine, iterations));
+#else
+    std::printf("%-10s %8.2f ns/iter\n", "live", run(engine, iterations));
+    memglass::set_paused(true);
+    std::printf("%-10s %8.2f ns/iter\n", "paused", run(engine, iterations));
+    memglass::set_paused(false);
+#endif
+
+    memglass::destroy(engine);
+    memglass::shutdown();
+    return 0;
+}
@@ -0,0 +1,403 @@
+"""
+mgdf - numpy columns from memglass recordings
+
+Reads MGDF files written by memglass-diff or a Recorder straight into
+numpy arrays, without going through `memglass-diff --decode` text. The file
+is memory-mapped and decoded by libmemglass_c: the block index prunes by
+time, blocks that never mention a wanted object or field are skipped, and
+the rest are decoded on all cores.
+
+Example usage:
+    from mgdf import Recording
+
+    with Recording("quotes.mgdf") as rec:
+        ts, bid = rec.field("AAPL", "quote.bid_price")
+
+        # Several fields of one object, second by second
+        cols = rec.query(labels=["AAPL"], fields=["quote.bid_price", "quote.ask_price"],
+                         start="14:30", end="21:00", interval="1s", agg="last")
+        for (label, field), s in cols.items():
+            print(label, field, len(s), s.values.mean())
+
+Requires numpy and libmemglass_c (built with memglass). Set MEMGLASS_C_LIB
+to the library's path if it is not on the loader's search path.
+"""
+
+import ctypes
+import ctypes.util
+import datetime
+import os
+import re
+from dataclasses import dataclass
+from typing import Dict, Iterator, List, Optional, Sequence, Tuple, Union
+
+import numpy as np
+
+TimeLike = Union[int, str, np.datetime64, datetime.datetime, None]
+DurationLike = Union[int, str, np.timedelta64, datetime.timedelta, None]
+
+ABI_VERSION = 3  # first libmemglass_c with recordings
+
+# MEMGLASS_TYPE_* -> numpy dtype of the field's values
+_DTYPES = {
+    1: np.bool_,
+    2: np.int8,
+    3: np.uint8,
+    4: np.int16,
+    5: np.uint16,
+    6: np.int32,
+    7: np.uint32,
+    8: np.int64,
+    9: np.uint64,
+    10: np.float32,
+    11: np.float64,
+    12: np.int8,  # char
+}
+
+_TYPE_NAMES = {
+    1: "bool", 2: "int8", 3: "uint8", 4: "int16", 5: "uint16", 6: "int32",
+    7: "uint32", 8: "int64", 9: "uint64", 10: "float32", 11: "float64", 12: "char",
+}
+
+_AGGREGATIONS = {"last": 0, "first": 1, "min": 2, "max": 3, "mean": 4, "avg": 4, "sum": 5, "count": 6}
+
+_UNITS = {"ns": 1, "us": 1_000, "ms": 1_000_000, "s": 1_000_000_000,
+          "m": 60_000_000_000, "h": 3_600_000_000_000}
+
+
+class MgdfError(Exception):
+    """Cannot load the library, open the file or run a query."""
+    pass
+
+
+class _RecordingInfo(ctypes.Structure):
+    _fields_ = [
+        ("version", ctypes.c_uint32),
+        ("flags", ctypes.c_uint32),
+        ("block_count", ctypes.c_uint32),
+        ("has_index", ctypes.c_uint32),
+        ("first_ts", ctypes.c_uint64),
+        ("last_ts", ctypes.c_uint64),
+    ]
+
+
+class _Query(ctypes.Structure):
+    _fields_ = [
+        ("labels", ctypes.POINTER(ctypes.c_char_p)),
+        ("label_count", ctypes.c_uint32),
+        ("fields", ctypes.POINTER(ctypes.c_char_p)),
+        ("field_count", ctypes.c_uint32),
+        ("start_ns", ctypes.c_uint64),
+        ("end_ns", ctypes.c_uint64),
+        ("interval_ns", ctypes.c_uint64),
+        ("aggregation", ctypes.c_uint32),
+        ("fill", ctypes.c_uint32),
+        ("threads", ctypes.c_uint32),
+        ("reserved", ctypes.c_uint32),
+    ]
+
+
+class _Series(ctypes.Structure):
+    _fields_ = [
+        ("label", ctypes.c_char_p),
+        ("field", ctypes.c_char_p),
+        ("type_id", ctypes.c_uint32),
+        ("integer", ctypes.c_uint32),
+        ("count", ctypes.c_uint64),
+        ("timestamps", ctypes.POINTER(ctypes.c_uint64)),
+        ("ints", ctypes.POINTER(ctypes.c_int64)),
+        ("doubles", ctypes.POINTER(ctypes.c_double)),
+    ]
+
+
+class _QueryStats(ctypes.Structure):
+    _fields_ = [
+        ("blocks_total", ctypes.c_uint64),
+        ("blocks_in_range", ctypes.c_uint64),
+        ("blocks_decoded", ctypes.c_uint64),
+        ("records", ctypes.c_uint64),
+        ("points", ctypes.c_uint64),
+    ]
+
+
+_lib = None
+
+
+def _load_library() -> ctypes.CDLL:
+    global _lib
+    if _lib is not None:
+        return _lib
+
+    candidates = []
+    if os.environ.get("MEMGLASS_C_LIB"):
+        candidates.append(os.environ["MEMGLASS_C_LIB"])
+    found = ctypes.util.find_library("memglass_c")
+    if found:
+        candidates.append(found)
+    candidates += ["libmemglass_c.so.1", "libmemglass_c.so"]
+
+    lib = None
+    for name in candidates:
+        try:
+            lib = ctypes.CDLL(name)
+            break
+        except OSError:
+            continue
+    if lib is None:
+        raise MgdfError("libmemglass_c not found; set MEMGLASS_C_LIB to its path")
+
+    lib.memglass_abi_version.restype = ctypes.c_uint32
+    if lib.memglass_abi_version() < ABI_VERSION:
+        raise MgdfError(f"libmemglass_c ABI {lib.memglass_abi_version()} has no recordings; "
+                        f"need {ABI_VERSION} or newer")
+
+    lib.memglass_recording_open.argtypes = [ctypes.c_char_p]
+    lib.memglass_recording_open.restype = ctypes.c_void_p
+    lib.memglass_recording_close.argtypes = [ctypes.c_void_p]
+    lib.memglass_recording_close.restype = None
+    lib.memglass_recording_describe.argtypes = [ctypes.c_void_p, ctypes.POINTER(_RecordingInfo)]
+    lib.memglass_recording_query.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Query),
+                                             ctypes.POINTER(_QueryStats)]
+    lib.memglass_series_count.argtypes = [ctypes.c_void_p]
+    lib.memglass_series_count.restype = ctypes.c_uint32
+    lib.memglass_series_at.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.POINTER(_Series)]
+    lib.memglass_recording_error.argtypes = [ctypes.c_void_p]
+    lib.memglass_recording_error.restype = ctypes.c_char_p
+    _lib = lib
+    return lib
+
+
+def parse_duration(value: DurationLike) -> int:
+    """Nanoseconds from an int, a timedelta or "100ms", "1s", "5m", "1h", "250us"."""
+    if value is None:
+        return 0
+    if isinstance(value, datetime.timedelta):
+        return (value.days * 86_400 + value.seconds) * 1_000_000_000 + value.microseconds * 1_000
+    if isinstance(value, np.timedelta64):
+        return int(value.astype("timedelta64[ns]").astype(np.int64))
+    if isinstance(value, str):
+        m = re.fullmatch(r"\s*(\d+(?:\.\d*)?)\s*(ns|us|ms|s|m|h)?\s*", value)
+        if not m:
+            raise ValueError(f"invalid duration '{value}'")
+        return int(float(m.group(1)) * _UNITS[m.group(2) or "ns"])
+    return int(value)
+
+
+def parse_time(value: TimeLike, reference_ns: int = 0) -> int:
+    """Nanoseconds since the epoch from an int, a datetime (naive = UTC),
+    a datetime64, "YYYY-MM-DDTHH:MM[:SS[.frac]]" (UTC) or a time of day
+    "HH:MM[:SS[.frac]]" on the UTC date of reference_ns."""
+    if value is None:
+        return 0
+    if isinstance(value, datetime.datetime):
+        if value.tzinfo is None:
+            value = value.replace(tzinfo=datetime.timezone.utc)
+        delta = value - datetime.datetime(1970, 1, 1, tzinfo=datetime.timezone.utc)
+        return parse_duration(delta)
+    if isinstance(value, np.datetime64):
+        return int(value.astype("datetime64[ns]").astype(np.int64))
+    if isinstance(value, str):
+        if "T" not in value:
+            day = np.datetime64(reference_ns, "ns").astype("datetime64[D]")
+            value = f"{day}T{value}"
+        try:
+            return int(np.datetime64(value, "ns").astype(np.int64))
+        except ValueError:
+            raise ValueError(f"invalid time '{value}'") from None
+    return int(value)
+
+
+@dataclass
+class Series:
+    """One object field as parallel columns."""
+    label: str
+    field: str
+    type: str                # field type, e.g. "int64" or "float64"
+    timestamps: np.ndarray   # uint64 ns since the epoch (bucket starts when resampled)
+    values: np.ndarray
+
+    def __len__(self) -> int:
+        return len(self.timestamps)
+
+    def __iter__(self) -> Iterator[np.ndarray]:
+        """Unpack as `ts, values = series`."""
+        return iter((self.timestamps, self.values))
+
+    @property
+    def times(self) -> np.ndarray:
+        """Timestamps as datetime64[ns] (a view, no copy)."""
+        return self.timestamps.view("datetime64[ns]")
+
+
+@dataclass
+class QueryStats:
+    blocks_total: int
+    blocks_in_range: int   # overlapping the time range
+    blocks_decoded: int    # also mentioning a wanted label/field
+    records: int
+    points: int
+
+
+class Recording:
+    """
+    A memory-mapped MGDF recording (version 2, as written by current
+    memglass-diff). Columns are copied out of the library, so results
+    outlive later queries and close().
+    """
+
+    def __init__(self, path: str):
+        self._handle = None
+        self._lib = _load_library()
+        self.path = path
+        self._handle = self._lib.memglass_recording_open(os.fsencode(path))
+        if not self._handle:
+            raise MgdfError(f"cannot open '{path}' as an MGDF file")
+
+        info = _RecordingInfo()
+        self._lib.memglass_recording_describe(self._handle, ctypes.byref(info))
+        self.version = info.version
+        self.is_rollup = bool(info.flags & 1)
+        self.block_count = info.block_count
+        self.has_index = bool(info.has_index)
+        self.first_ts = info.first_ts
+        self.last_ts = info.last_ts
+        self.last_stats: Optional[QueryStats] = None
+
+    def close(self):
+        if self._handle:
+            self._lib.memglass_recording_close(self._handle)
+            self._handle = None
+
+    def __enter__(self) -> "Recording":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def query(self, labels: Optional[Sequence[str]] = None, fields: Optional[Sequence[str]] = None,
+              start: TimeLike = None, end: TimeLike = None, interval: DurationLike = None,
+              agg: str = "last", fill: bool = False,
+              threads: int = 0) -> Dict[Tuple[str, str], Series]:
+        """
+        Columns of every (label, field) matching the query, keyed in label,
+        then field order.
+
+        Args:
+            labels: Exact object labels; None for all.
+            fields: Exact field names; None for all.
+            start: Inclusive start time (see parse_time()); times of day
+                are on the recording's first day.
+            end: Exclusive end time.
+            interval: Resample into buckets of this width (see
+                parse_duration()); None for every change.
+            agg: last, first, min, max, mean, sum or count per bucket.
+            fill: With last, repeat values into empty buckets.
+            threads: Decoder threads; 0 for one per core.
+
+        Raises:
+            MgdfError: If the file has no blocks (version 1) or is corrupt.
+        """
+        if not self._handle:
+            raise MgdfError("recording is closed")
+        if agg not in _AGGREGATIONS:
+            raise ValueError(f"invalid aggregation '{agg}'")
+
+        label_list = [s.encode() for s in labels] if labels else []
+        field_list = [s.encode() for s in fields] if fields else []
+        label_array = (ctypes.c_char_p * max(1, len(label_list)))(*label_list)
+        field_array = (ctypes.c_char_p * max(1, len(field_list)))(*field_list)
+
+        q = _Query()
+        q.labels = ctypes.cast(label_array, ctypes.POINTER(ctypes.c_char_p))
+        q.label_count = len(label_list)
+        q.fields = ctypes.cast(field_array, ctypes.POINTER(ctypes.c_char_p))
+        q.field_count = len(field_list)
+        q.start_ns = parse_time(start, self.first_ts)
+        q.end_ns = parse_time(end, self.first_ts)
+        q.interval_ns = parse_duration(interval)
+        q.aggregation = _AGGREGATIONS[agg]
+        q.fill = 1 if fill else 0
+        q.threads = threads
+
+        stats = _QueryStats()
+        if self._lib.memglass_recording_query(self._handle, ctypes.byref(q), ctypes.byref(stats)) != 0:
+            error = self._lib.memglass_recording_error(self._handle).decode()
+            raise MgdfError(error or "query failed")
+        self.last_stats = QueryStats(stats.blocks_total, stats.blocks_in_range, stats.blocks_decoded,
+                                     stats.records, stats.points)
+
+        # Values keep the field's dtype unless the aggregation changes it
+        resampled = q.interval_ns != 0 or self.is_rollup
+        native = not resampled or agg not in ("mean", "avg", "sum", "count")
+        result: Dict[Tuple[str, str], Series] = {}
+        s = _Series()
+        for i in range(self._lib.memglass_series_count(self._handle)):
+            self._lib.memglass_series_at(self._handle, i, ctypes.byref(s))
+            n = s.count
+            timestamps = np.ctypeslib.as_array(s.timestamps, (n,)).copy() if n else np.empty(0, np.uint64)
+            if s.integer:
+                values = np.ctypeslib.as_array(s.ints, (n,)).copy() if n else np.empty(0, np.int64)
+            else:
+                values = np.ctypeslib.as_array(s.doubles, (n,)).copy() if n else np.empty(0, np.float64)
+
+            dtype = _DTYPES.get(s.type_id)
+            if native and dtype is not None and values.dtype != dtype:
+                values = values.view(np.uint64) if dtype is np.uint64 else values.astype(dtype)
+
+            label, field = s.label.decode(), s.field.decode()
+            result[(label, field)] = Series(label, field, _TYPE_NAMES.get(s.type_id, "unknown"),
+                                            timestamps, values)
+        return result
+
+    def field(self, label: str, field: str, start: TimeLike = None, end: TimeLike = None,
+              interval: DurationLike = None, agg: str = "last") -> Series:
+        """
+        Columns of one object field; empty if the recording never changes
+        it in the range. Unpacks as `ts, values = rec.field(...)`.
+        """
+        series = self.query([label], [field], start, end, interval, agg)
+        found = series.get((label, field))
+        if found is None:
+            return Series(label, field, "unknown", np.empty(0, np.uint64), np.empty(0, np.float64))
+        return found
+
+    def __repr__(self) -> str:
+        kind = "rollup" if self.is_rollup else "changes"
+        return f"Recording({self.path!r}, {kind}, {self.block_count} blocks)"
+
+
+if __name__ == "__main__":
+    import argparse
+    import sys
+    import time
+
+    parser = argparse.ArgumentParser(description="Load MGDF recording columns into numpy")
+    parser.add_argument("path", help="MGDF recording")
+    parser.add_argument("-l", "--label", action="append", help="Object label (repeatable)")
+    parser.add_argument("-f", "--field", action="append", help="Field name (repeatable)")
+    parser.add_argument("--start", help="Start time (YYYY-MM-DDTHH:MM[:SS] or HH:MM[:SS], UTC)")
+    parser.add_argument("--end", help="End time (exclusive)")
+    parser.add_argument("-i", "--interval", help="Resample interval, e.g. 1s")
+    parser.add_argument("-a", "--agg", default="last", help="Aggregation (default: last)")
+
+    args = parser.parse_args()
+
+    try:
+        with Recording(args.path) as rec:
+            began = time.perf_counter()
+            cols = rec.query(args.label, args.field, args.start, args.end, args.interval, args.agg)
+            elapsed = time.perf_counter() - began
+
+            st = rec.last_stats
+            print(f"{rec}: {st.blocks_decoded}/{st.blocks_total} blocks decoded, "
+                  f"{st.points} points in {elapsed * 1e3:.1f}ms")
+            for (label, field), s in cols.items():
+                if len(s):
+                    print(f"  {label}.{field:30} {s.type:8} {len(s):>10}  "
+                          f"first {s.values[0]}  last {s.values[-1]}")
+    except (MgdfError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
@@ -113,6 +113,9 @@ int main() {
             }
         }
 
+        // All quotes are consistent here; observers may capture now
+        memglass::cycle_end();
+
         // Print status every second
         if (tick % 100 == 0) {
             std::cout << "\rTick " << tick << ": ";
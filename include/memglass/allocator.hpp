@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include "detail/shm.hpp"
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string_view>
@@ -22,8 +23,10 @@ public:
     // Initialize with first region
     bool init(std::string_view session_name, size_t initial_size);
 
-    // Allocate memory from regions
-    void* allocate(size_t size, size_t alignment);
+    // Allocate memory from regions. Lock-free unless a new region is needed;
+    // optionally returns the location, saving a get_location() call.
+    void* allocate(size_t size, size_t alignment,
+                   uint64_t* region_id = nullptr, uint64_t* offset = nullptr);
 
     // Get region by ID
     void* get_region_data(uint64_t region_id);
@@ -41,12 +44,15 @@ private:
     Context& ctx_;
     std::string session_name_;
     std::vector<std::unique_ptr<Region>> regions_;
+    std::atomic<Region*> current_{nullptr};  // bump-allocated without the mutex
     std::mutex mutex_;
     uint64_t next_region_id_ = 1;
     size_t current_region_size_;
 
     Region* create_region(size_t size);
     Region* current_region();
+    static void* try_allocate(Region* region, size_t size, size_t alignment,
+                              uint64_t* region_id, uint64_t* offset);
 };
 
 // Metadata manager - handles overflow regions for types, fields, and objects
@@ -58,7 +64,10 @@ public:
     // Initialize (called after header is set up)
     bool init(std::string_view session_name);
 
-    // Allocate entries (from header first, then overflow regions)
+    // Allocate entries (from header first, then overflow regions).
+    // Lock-free except when a new overflow region is needed. The caller
+    // publishes each entry once written: ObjectEntry::status for objects,
+    // TypeEntry::type_id (stored last, release) for a type and its fields.
     ObjectEntry* allocate_object_entry();
     TypeEntry* allocate_type_entry();
     FieldEntry* allocate_field_entries(uint32_t count);
@@ -78,11 +87,30 @@ private:
     Context& ctx_;
     std::string session_name_;
     std::vector<std::unique_ptr<OverflowRegion>> overflow_regions_;
-    std::mutex mutex_;
+    std::atomic<OverflowRegion*> current_overflow_{nullptr};
+    mutable std::mutex mutex_;  // guards overflow_regions_; not taken by allocations
+                                // unless a new region is needed
     uint64_t next_overflow_id_ = 1;
 
     OverflowRegion* create_overflow_region();
-    OverflowRegion* current_overflow_region();
+
+    template<typename Entry>
+    Entry* reserve_entries(uint32_t n, std::atomic<uint32_t>& header_count,
+                           uint32_t header_capacity, uint64_t header_offset,
+                           std::atomic<uint32_t> MetadataOverflowDescriptor::*overflow_count,
+                           uint32_t MetadataOverflowDescriptor::*overflow_capacity,
+                           uint32_t MetadataOverflowDescriptor::*overflow_offset);
+};
+
+// Directory slot of a live object, as returned by create_handle().
+// Destroying through a handle is a compare-and-swap on the slot's status
+// word (generation and state), with no lookup or lock, so a handle to a
+// slot that was destroyed and reused meanwhile cannot destroy the new object.
+struct ObjectHandle {
+    ObjectEntry* entry = nullptr;
+    uint64_t generation = 0;
+
+    explicit operator bool() const { return entry != nullptr; }
 };
 
 // Object manager - tracks object lifecycle
@@ -90,12 +118,21 @@ class ObjectManager {
 public:
     explicit ObjectManager(Context& ctx);
 
-    // Register an object in the directory
+    // Register an object in the directory, remembering ptr for
+    // destroy_object(ptr)
     ObjectEntry* register_object(void* ptr, uint32_t type_id, std::string_view label);
 
+    // Register without pointer tracking; only the label index update
+    // takes a lock
+    ObjectHandle register_object(uint64_t region_id, uint64_t offset, uint32_t type_id,
+                                 std::string_view label);
+
     // Mark object as destroyed
     void destroy_object(void* ptr);
 
+    // Lock-free; false if the handle is empty, already destroyed or stale
+    bool destroy_object(const ObjectHandle& handle);
+
     // Find object by label
     ObjectEntry* find_object(std::string_view label);
 
@@ -103,9 +140,31 @@ public:
     std::vector<ObjectEntry*> get_all_objects();
 
 private:
+    static constexpr uint32_t NO_SLOT = ~0u;
+
+    ObjectEntry* acquire_entry();
+    void release_entry(ObjectEntry* entry);
+    void index_label(ObjectEntry* entry);
+    void unindex_label(ObjectEntry* entry);
+
     Context& ctx_;
-    std::unordered_map<void*, ObjectEntry*> ptr_to_entry_;
+
+    // Pointer API only
+    std::unordered_map<void*, ObjectHandle> ptr_to_entry_;
     std::mutex mutex_;
+
+    // Destroyed header directory slots, reused before reserving new ones.
+    // Treiber stack of slot indices; the head carries an ABA tag in the
+    // upper 32 bits.
+    ObjectEntry* header_entries_ = nullptr;
+    uint32_t header_capacity_ = 0;
+    std::unique_ptr<std::atomic<uint32_t>[]> free_next_;
+    std::atomic<uint64_t> free_head_{NO_SLOT};
+
+    // Label index in the header segment; its writers take label_mutex_
+    std::atomic<uint64_t>* label_index_ = nullptr;
+    uint32_t label_index_capacity_ = 0;
+    std::mutex label_mutex_;
 };
 
 } // namespace memglass
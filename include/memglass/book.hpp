@@ -0,0 +1,201 @@
+#pragma once
+
+#include "registry.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace memglass {
+
+// Price-level order book kept sorted in place (bids best-first descending,
+// asks best-first ascending) so observers can follow deep books without
+// copying them under a lock.
+//
+// Each level carries its own version stamp, odd while the level is being
+// written, and the book carries an epoch, odd while levels shift (insert
+// and remove). A quantity update only touches one level's version, so a
+// reader racing it re-reads that level instead of the whole book; only
+// shifts restart a read. See BookReader in ladder.hpp.
+//
+// Single writer. Register with describe(), which registers Book<Levels>
+// and BookLevel once and appends a nested field of the book to the
+// enclosing type's descriptor. Observers see it as "<name>.epoch",
+// "<name>.bids[0].price", ..., however deep the book.
+//
+//     struct Instrument {
+//         memglass::Book<10> book;
+//     };
+//     memglass::Book<10>::describe(desc, "book", offsetof(Instrument, book));
+//
+// memglass-gen emits this call for fields of type Book<Levels>.
+
+enum class BookSide : uint8_t {
+    Bid = 0,
+    Ask = 1
+};
+
+struct BookLevel {
+    uint64_t version = 0;  // odd while this level is written
+    double price = 0;
+    double qty = 0;
+    uint64_t orders = 0;
+};
+
+template<uint32_t Levels>
+struct Book {
+    static_assert(Levels >= 1, "Book needs at least one level");
+
+    uint64_t epoch = 0;  // odd while levels shift
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    BookLevel bids[Levels]{};
+    BookLevel asks[Levels]{};
+
+    static constexpr uint32_t depth() { return Levels; }
+
+    // Add a new level. False if the price already has a level or falls
+    // behind a full side; otherwise the worst level of a full side drops.
+    bool insert(BookSide side, double price, double qty, uint64_t orders = 0) {
+        BookLevel* lv = levels(side);
+        uint32_t n = count(side);
+        uint32_t pos = lower_bound(side, price);
+        if (pos < n && lv[pos].price == price) return false;
+        if (pos >= Levels) return false;
+
+        begin_shift();
+        for (uint32_t i = (n < Levels ? n : Levels - 1); i > pos; --i) {
+            write_level(lv[i], lv[i - 1].price, lv[i - 1].qty, lv[i - 1].orders);
+        }
+        write_level(lv[pos], price, qty, orders);
+        if (n < Levels) store_count(side, n + 1);
+        end_shift();
+        return true;
+    }
+
+    // Change an existing level in place. False if the price has no level.
+    bool update(BookSide side, double price, double qty, uint64_t orders = 0) {
+        uint32_t pos = find(side, price);
+        if (pos == Levels) return false;
+        write_level(levels(side)[pos], price, qty, orders);
+        return true;
+    }
+
+    // Delete a level. False if the price has no level.
+    bool remove(BookSide side, double price) {
+        uint32_t pos = find(side, price);
+        if (pos == Levels) return false;
+
+        BookLevel* lv = levels(side);
+        uint32_t n = count(side);
+        begin_shift();
+        for (uint32_t i = pos; i + 1 < n; ++i) {
+            write_level(lv[i], lv[i + 1].price, lv[i + 1].qty, lv[i + 1].orders);
+        }
+        write_level(lv[n - 1], 0, 0, 0);
+        store_count(side, n - 1);
+        end_shift();
+        return true;
+    }
+
+    // Insert, update or (qty 0) remove, as a feed's level message implies
+    bool set(BookSide side, double price, double qty, uint64_t orders = 0) {
+        if (qty == 0) return remove(side, price);
+        return update(side, price, qty, orders) || insert(side, price, qty, orders);
+    }
+
+    void clear() {
+        begin_shift();
+        for (BookSide side : {BookSide::Bid, BookSide::Ask}) {
+            for (uint32_t i = 0; i < count(side); ++i) {
+                write_level(levels(side)[i], 0, 0, 0);
+            }
+            store_count(side, 0);
+        }
+        end_shift();
+    }
+
+    // Index of the level at price, or Levels if there is none
+    uint32_t find(BookSide side, double price) const {
+        uint32_t pos = lower_bound(side, price);
+        return pos < count(side) && levels(side)[pos].price == price ? pos : Levels;
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        auto add = [](TypeDescriptor& type, std::string_view field, size_t at, uint32_t size,
+                      PrimitiveType primitive, uint32_t nested = 0, uint32_t count = 0) {
+            type.fields.push_back({field, static_cast<uint32_t>(at), size, primitive, nested, count,
+                                   nested ? Atomicity::None : Atomicity::Atomic, true});
+        };
+        TypeDescriptor level{"memglass::BookLevel", sizeof(BookLevel), alignof(BookLevel), {}};
+        add(level, "price", offsetof(BookLevel, price), 8, PrimitiveType::Float64);
+        add(level, "qty", offsetof(BookLevel, qty), 8, PrimitiveType::Float64);
+        add(level, "orders", offsetof(BookLevel, orders), 8, PrimitiveType::UInt64);
+        add(level, "version", offsetof(BookLevel, version), 8, PrimitiveType::UInt64);
+        uint32_t level_id = registry::register_type(level);
+
+        TypeDescriptor book{registry::intern("memglass::Book<" + std::to_string(Levels) + ">"),
+                            sizeof(Book), alignof(Book), {}};
+        add(book, "epoch", offsetof(Book, epoch), 8, PrimitiveType::UInt64);
+        add(book, "bid_count", offsetof(Book, bid_count), 4, PrimitiveType::UInt32);
+        add(book, "ask_count", offsetof(Book, ask_count), 4, PrimitiveType::UInt32);
+        add(book, "bids", offsetof(Book, bids), sizeof(BookLevel) * Levels, PrimitiveType::Unknown,
+            level_id, Levels);
+        add(book, "asks", offsetof(Book, asks), sizeof(BookLevel) * Levels, PrimitiveType::Unknown,
+            level_id, Levels);
+        add(desc, registry::intern(name), offset, sizeof(Book), PrimitiveType::Unknown,
+            registry::register_type(book));
+    }
+
+private:
+    BookLevel* levels(BookSide side) { return side == BookSide::Bid ? bids : asks; }
+    const BookLevel* levels(BookSide side) const { return side == BookSide::Bid ? bids : asks; }
+    uint32_t count(BookSide side) const { return side == BookSide::Bid ? bid_count : ask_count; }
+
+    void store_count(BookSide side, uint32_t n) {
+        std::atomic_ref<uint32_t>(side == BookSide::Bid ? bid_count : ask_count)
+            .store(n, std::memory_order_release);
+    }
+
+    // First level not strictly better than price
+    uint32_t lower_bound(BookSide side, double price) const {
+        const BookLevel* lv = levels(side);
+        uint32_t lo = 0;
+        uint32_t hi = count(side);
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            bool better = side == BookSide::Bid ? lv[mid].price > price : lv[mid].price < price;
+            if (better) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static void write_level(BookLevel& level, double price, double qty, uint64_t orders) {
+        std::atomic_ref<uint64_t> version(level.version);
+        uint64_t v = level.version;
+        version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::atomic_ref<double>(level.price).store(price, std::memory_order_relaxed);
+        std::atomic_ref<double>(level.qty).store(qty, std::memory_order_relaxed);
+        std::atomic_ref<uint64_t>(level.orders).store(orders, std::memory_order_relaxed);
+        version.store(v + 2, std::memory_order_release);
+    }
+
+    void begin_shift() {
+        std::atomic_ref<uint64_t>(epoch).store(epoch + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_shift() {
+        std::atomic_ref<uint64_t>(epoch).store(epoch + 1, std::memory_order_release);
+    }
+};
+
+} // namespace memglass
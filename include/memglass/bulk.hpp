@@ -0,0 +1,83 @@
+#pragma once
+
+#include "observer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace memglass {
+
+struct BulkOptions {
+    // Objects of a region closer than this are copied as one span. SIZE_MAX
+    // copies each region's used range from the first to the last object.
+    size_t merge_gap = 256;
+};
+
+// Copies a set of objects out of producer memory in one short burst, so
+// decoding (formatting, map inserts) runs against a private arena instead
+// of holding the producer's cache lines.
+//
+// Objects are grouped into 16-byte aligned spans per region and read with
+// aligned 16-byte loads. Each copy is then validated: the directory entry
+// must still be alive with the same generation, and Guarded<T> fields and
+// the sequence Locked<T> bumps under its lock must be even and must not
+// have moved across the burst. Failing fields are re-read individually
+// from shared memory; objects destroyed or reused meanwhile are dropped.
+class BulkCopy {
+public:
+    explicit BulkCopy(Observer& obs, const BulkOptions& options = {});
+
+    // Copy these objects; returns how many were copied (not dropped)
+    size_t copy(const std::vector<ObservedObject>& objects);
+
+    // Private copy of objects[index] from the last copy(); nullptr if the
+    // object was dropped or its type is unknown
+    const void* data(size_t index) const;
+
+    // Stats from the last copy()
+    size_t spans() const { return spans_.size(); }
+    size_t bytes_copied() const { return bytes_copied_; }
+    size_t retried_fields() const { return retried_fields_; }
+    size_t dropped_objects() const { return dropped_objects_; }
+    uint64_t burst_ns() const { return burst_ns_; }  // time spent in the copy itself
+
+private:
+    static constexpr size_t NO_COPY = ~size_t{0};
+
+    struct alignas(16) Block {
+        unsigned char bytes[16];
+    };
+
+    struct Span {
+        const unsigned char* src;
+        size_t arena_offset;  // bytes
+        size_t size;          // bytes, multiple of 16
+    };
+
+    // Guarded<T> or Locked<T> sequence sampled before the burst
+    struct Guard {
+        size_t object;        // index into the copy() argument
+        FieldRef field;
+        size_t before;
+    };
+
+    void plan(const std::vector<ObservedObject>& objects);
+    void validate(const std::vector<ObservedObject>& objects);
+    void reread_field(size_t object, const FieldRef& field, const unsigned char* src);
+
+    Observer& obs_;
+    BulkOptions options_;
+    std::vector<Block> arena_;
+    std::vector<Span> spans_;
+    std::vector<size_t> offsets_;       // per object: arena offset or NO_COPY
+    std::vector<const unsigned char*> sources_;  // per object: shared memory
+    std::vector<const ObservedType*> types_;
+    std::vector<Guard> guards_;
+    size_t bytes_copied_ = 0;
+    size_t retried_fields_ = 0;
+    size_t dropped_objects_ = 0;
+    uint64_t burst_ns_ = 0;
+};
+
+} // namespace memglass
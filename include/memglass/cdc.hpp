@@ -0,0 +1,187 @@
+#pragma once
+
+#include "diff.hpp"
+#include "pause.hpp"
+#include "tsc.hpp"
+#include "types.hpp"
+#include "detail/shm.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace memglass {
+
+class Observer;
+
+// Change-data capture. Sampling misses values that come and go between
+// two samples; stores made through memglass::store() or Tracked<T> are
+// also logged as (address, value, TSC) records to a per-thread ring in the
+// session's CDC segment, and CdcReader turns them back into every change
+// of every tracked field, in order.
+//
+// Opt in per session with Config::cdc_ring_capacity, then per field: wrap
+// it in Tracked<T>, or write it with store(). Other fields are untouched
+// and cost nothing. A thread claims a ring on its first tracked store and
+// frees it when it exits; Config::cdc_rings bounds the threads logging at
+// once. Full rings drop records and count them, so a reader knows exactly
+// how much it missed.
+//
+//     struct Position {
+//         memglass::Tracked<int64_t> quantity;
+//         double pnl;
+//     };
+//     pos->quantity = 100;               // logged
+//     memglass::store(pos->pnl, 12.5);   // logged
+//     pos->pnl = 13.0;                   // not logged
+//
+// Logging is skipped while publishing is paused (pause.hpp), and compiled
+// out with MEMGLASS_DISABLE.
+
+template<typename T>
+concept Trackable = std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint64_t);
+
+namespace detail {
+
+// Append a record to the calling thread's ring; no-op without CDC
+void cdc_append(const void* address, uint64_t value, uint32_t size);
+
+// Called by Context when a session with a CDC segment starts and stops
+void cdc_attach(CdcHeader* header);
+void cdc_detach();
+
+// Publish a data region mapping for address resolution
+void cdc_add_region(CdcHeader* header, uint64_t region_id, const void* base, uint64_t size);
+
+template<Trackable T>
+uint64_t cdc_bits(const T& value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+} // namespace detail
+
+// With MEMGLASS_DISABLE, store() and Tracked<T> move to an inline
+// namespace and only store, so they never clash with the logging versions
+#ifdef MEMGLASS_DISABLE
+inline namespace disabled {
+
+template<Trackable T>
+inline void store(T& field, T value) {
+    field = value;
+}
+
+template<Trackable T>
+inline void store(std::atomic<T>& field, T value,
+                  std::memory_order order = std::memory_order_release) {
+    field.store(value, order);
+}
+#else
+// Store value into field and log the change
+template<Trackable T>
+inline void store(T& field, T value) {
+    field = value;
+    if (!paused()) detail::cdc_append(&field, detail::cdc_bits(value), sizeof(T));
+}
+
+template<Trackable T>
+inline void store(std::atomic<T>& field, T value,
+                  std::memory_order order = std::memory_order_release) {
+    field.store(value, order);
+    if (!paused()) detail::cdc_append(&field, detail::cdc_bits(value), sizeof(T));
+}
+#endif
+
+// A field whose every assignment of a T is logged. Same size and layout
+// as T, so it is registered as a plain T field (memglass-gen does this).
+// Construction and copying from another Tracked<T> are not logged.
+template<Trackable T>
+struct Tracked {
+    T value{};
+
+    Tracked() = default;
+    Tracked(T v) : value(v) {}
+
+    Tracked& operator=(T v) {
+        store(value, v);
+        return *this;
+    }
+
+    operator T() const { return value; }
+    T get() const { return value; }
+};
+
+#ifdef MEMGLASS_DISABLE
+} // namespace disabled
+#endif
+
+// Counters of a CdcReader
+struct CdcStats {
+    uint64_t records = 0;     // Records drained
+    uint64_t dropped = 0;     // Records the producer dropped (full rings, no free ring)
+    uint64_t unresolved = 0;  // Records whose address matched no live object field
+};
+
+// Drains a producer's CDC rings into diffs: one SnapshotDiff per distinct
+// timestamp, with one FieldChange per logged store. old_value is the
+// previous logged value of the field, or of Unknown type for the first.
+//
+// Rings are single-consumer: run one reader per session. Records are in
+// TSC order within one drain(); a store whose thread was preempted between
+// taking its timestamp and publishing can land in the next drain.
+class CdcReader {
+public:
+    explicit CdcReader(Observer& obs);
+
+    CdcReader(const CdcReader&) = delete;
+    CdcReader& operator=(const CdcReader&) = delete;
+
+    // Map the CDC segment; false if the producer logs no changes. Records
+    // not yet consumed by an earlier reader are returned too.
+    bool attach();
+
+    bool attached() const { return header_ != nullptr; }
+
+    // Append the changes logged since the last drain to out; returns the
+    // number of records drained
+    size_t drain(std::vector<SnapshotDiff>& out);
+
+    // Producer-side drops as of the last drain, plus this reader's counts
+    const CdcStats& stats() const { return stats_; }
+
+private:
+    struct ObjectSpan {
+        uint64_t offset;
+        uint64_t end;
+        std::string label;
+        const ObservedType* type;
+    };
+
+    struct Resolved {
+        const std::string* label = nullptr;
+        std::string field;
+        PrimitiveType type = PrimitiveType::Unknown;
+    };
+
+    CdcRing* ring(uint32_t i) const;
+    void rebuild_index();
+    bool resolve(uint64_t address, Resolved& out) const;
+
+    Observer& obs_;
+    detail::SharedMemory shm_;
+    CdcHeader* header_ = nullptr;
+    TscClock clock_;
+    uint64_t calibrated_at_ = 0;
+    uint64_t indexed_sequence_ = ~0ull;
+    std::unordered_map<uint64_t, std::vector<ObjectSpan>> spans_;  // by region id
+    std::unordered_map<uint64_t, FieldValue> last_;                // by address
+    std::vector<CdcRecord> records_;
+    CdcStats stats_;
+};
+
+} // namespace memglass
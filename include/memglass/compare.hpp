@@ -0,0 +1,135 @@
+#pragma once
+
+#include "diff.hpp"
+#include "observer.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memglass {
+
+// Absolute tolerances for SessionComparator. Keys are "label.field" or a
+// bare field name; the more specific key wins. An infinite tolerance drops
+// the field from the comparison.
+struct CompareOptions {
+    double tolerance = 0;  // fields without an entry
+    std::unordered_map<std::string, double> tolerances;
+
+    double tolerance_for(std::string_view label, std::string_view field) const;
+};
+
+// Parse "[<label.field|field>=]<tolerance>" or "<name>=ignore" into options
+bool parse_tolerance(std::string_view spec, CompareOptions& options);
+
+// A field out of tolerance between the two sessions. Names point into the
+// comparator's plan and stay valid until it is rebuilt.
+struct Divergence {
+    std::string_view label;
+    std::string_view field;
+    FieldValue a;
+    FieldValue b;
+    uint64_t since_ns = 0;  // compare() that first saw it out of tolerance
+};
+
+struct CompareResult {
+    uint64_t timestamp_ns = 0;
+    std::vector<Divergence> diverged;   // out of tolerance now
+    std::vector<Divergence> converged;  // back within tolerance since the last compare()
+};
+
+struct CompareStats {
+    size_t objects = 0;           // labels present in both sessions
+    size_t fields = 0;            // fields compared per pass
+    size_t spans = 0;             // memcmp ranges they were merged into
+    size_t slow_fields = 0;       // fields whose layouts differ, always decoded
+    uint64_t compares = 0;
+    uint64_t rebuilds = 0;
+    uint64_t spans_mismatched = 0;  // memcmp found a difference, fields decoded
+};
+
+// Compares the objects of two sessions, e.g. production and a shadow build
+// of the same strategy. Objects are paired by label and fields by name, so
+// the sessions may publish different schemas.
+//
+// The pairing is compiled into a plan once per structural change: fields
+// with the same primitive type whose values sit back to back in both
+// objects are merged into spans, and a pass is one memcmp per span. Only
+// spans that differ are decoded field by field (through the Guarded<T> /
+// Locked<T> protocols) and checked against their tolerance.
+class SessionComparator {
+public:
+    SessionComparator(Observer& a, Observer& b, CompareOptions options = {});
+
+    // Compare all paired fields; rebuilds the plan first when either
+    // session created or destroyed objects
+    const CompareResult& compare();
+
+    // Re-pair objects and fields now
+    void rebuild();
+
+    // Labels present in one session only, as of the last rebuild
+    const std::vector<std::string>& only_in_a() const { return only_in_a_; }
+    const std::vector<std::string>& only_in_b() const { return only_in_b_; }
+
+    // "label.field" of paired objects whose field exists on one side only
+    const std::vector<std::string>& unmatched_fields() const { return unmatched_fields_; }
+
+    const CompareStats& stats() const { return stats_; }
+    const CompareOptions& options() const { return options_; }
+
+private:
+    struct ObjectPlan {
+        std::string label;
+        ObjectView a;
+        ObjectView b;
+    };
+
+    struct FieldPlan {
+        uint32_t object;
+        std::string name;  // path, e.g. "quote.bid"
+        FieldRef a;
+        FieldRef b;
+        double tolerance;
+        bool diverged = false;
+        uint64_t since_ns = 0;
+    };
+
+    // Fields [first, last) whose values are compared as one byte range;
+    // size 0 means the layouts differ and the field is always decoded
+    struct Span {
+        const char* a;
+        const char* b;
+        uint32_t size;
+        uint32_t first;
+        uint32_t last;
+        uint32_t diverged = 0;  // fields of the span currently out of tolerance
+    };
+
+    void check_fields(Span& span);
+    FieldValue read(ObjectView& view, const FieldRef& field);
+
+    Observer& a_;
+    Observer& b_;
+    CompareOptions options_;
+    uint64_t sequence_a_ = ~0ull;
+    uint64_t sequence_b_ = ~0ull;
+    std::shared_ptr<const Schema> schema_a_;
+    std::shared_ptr<const Schema> schema_b_;
+
+    std::vector<ObjectPlan> objects_;
+    std::vector<FieldPlan> fields_;
+    std::vector<Span> spans_;
+
+    std::vector<std::string> only_in_a_;
+    std::vector<std::string> only_in_b_;
+    std::vector<std::string> unmatched_fields_;
+
+    CompareResult result_;
+    CompareStats stats_;
+};
+
+} // namespace memglass
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace memglass::detail {
+
+// Cross-process futex on a word in shared memory (not FUTEX_PRIVATE).
+// Elsewhere waits degrade to a short sleep and wakes are no-ops, so
+// callers must re-check their condition after every wait.
+
+// Sleep while *word == expected, up to timeout; spurious returns allowed
+inline void futex_wait(const std::atomic<uint32_t>* word, uint32_t expected,
+                       std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, const_cast<std::atomic<uint32_t>*>(word), FUTEX_WAIT, expected, &ts,
+            nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) != expected) return;
+    std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+#endif
+}
+
+inline void futex_wake_all(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+} // namespace memglass::detail
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace memglass::detail {
+
+// Open-addressed hash table from label to header object directory slot,
+// stored in the header segment after the object directory. Lets readers
+// find one object by label without scanning the directory.
+//
+// Each slot packs (label hash << 32) | (directory index + 1); 0 is empty.
+// Linear probing with backward-shift deletion, so erased slots never
+// linger and a probe ends at the first empty slot. Writers are serialized
+// by the caller. An erase moves entries towards their home slot while
+// `seq` is odd, so a reader that misses must retry if `seq` moved (see
+// label_index_lookup). The producer inserts after publishing an entry and
+// erases before releasing it, so readers must still check the entry's
+// state and label.
+
+inline uint32_t label_hash(std::string_view label) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (char c : label) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+inline uint64_t label_slot(uint32_t hash, uint32_t index) {
+    return (static_cast<uint64_t>(hash) << 32) | (static_cast<uint64_t>(index) + 1);
+}
+
+// Capacity is a power of two; false if no free slot was found
+inline bool label_index_insert(std::atomic<uint64_t>* table, uint32_t capacity,
+                               uint32_t hash, uint32_t index) {
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        auto& slot = table[(hash + i) & mask];
+        if (slot.load(std::memory_order_relaxed) == 0) {
+            slot.store(label_slot(hash, index), std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void label_index_erase(std::atomic<uint64_t>* table, uint32_t capacity,
+                              std::atomic<uint32_t>& seq, uint32_t hash, uint32_t index) {
+    uint64_t value = label_slot(hash, index);
+    uint32_t mask = capacity - 1;
+    uint32_t hole = capacity;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        uint32_t pos = (hash + i) & mask;
+        uint64_t current = table[pos].load(std::memory_order_relaxed);
+        if (current == 0) return;
+        if (current == value) {
+            hole = pos;
+            break;
+        }
+    }
+    if (hole == capacity) return;
+
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Pull back each later entry of the run whose home slot is not in
+    // (hole, pos], so every entry stays reachable from its home
+    for (uint32_t pos = (hole + 1) & mask; pos != hole; pos = (pos + 1) & mask) {
+        uint64_t current = table[pos].load(std::memory_order_relaxed);
+        if (current == 0) break;
+        uint32_t home = static_cast<uint32_t>(current >> 32) & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            table[hole].store(current, std::memory_order_relaxed);
+            hole = pos;
+        }
+    }
+    table[hole].store(0, std::memory_order_relaxed);
+
+    seq.store(s + 2, std::memory_order_release);
+}
+
+// Call fn(index) for each directory slot whose label hash matches, until
+// fn returns true; returns whether it did
+template<typename Fn>
+bool label_index_find(const std::atomic<uint64_t>* table, uint32_t capacity,
+                      uint32_t hash, Fn&& fn) {
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        uint64_t current = table[(hash + i) & mask].load(std::memory_order_acquire);
+        if (current == 0) return false;
+        if (static_cast<uint32_t>(current >> 32) != hash) continue;
+        if (fn(static_cast<uint32_t>(current) - 1)) return true;
+    }
+    return false;
+}
+
+enum class LabelLookup { Found, Missing, Unsure };
+
+// label_index_find() that tells a real miss from one that raced an erase
+// moving entries; Unsure after a few tries, so callers fall back to a scan
+template<typename Fn>
+LabelLookup label_index_lookup(const std::atomic<uint64_t>* table, uint32_t capacity,
+                               const std::atomic<uint32_t>& seq, uint32_t hash, Fn&& fn) {
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        uint32_t s1 = seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        if (label_index_find(table, capacity, hash, fn)) return LabelLookup::Found;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == s1) return LabelLookup::Missing;
+    }
+    return LabelLookup::Unsure;
+}
+
+} // namespace memglass::detail
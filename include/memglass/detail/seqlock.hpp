@@ -1,6 +1,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <optional>
 #include <type_traits>
@@ -21,6 +23,9 @@ namespace memglass {
 // Key insight: atomic_signal_fence prevents compiler reordering, while the
 // release/acquire on seq_ provides the necessary CPU memory ordering.
 // Direct assignment (not memcpy) allows the compiler to optimize the copy.
+//
+// Both wrappers are the same in every build, MEMGLASS_DISABLE included, so
+// a disabled producer and the observer library agree on them.
 template <typename T>
 struct Guarded {
     static_assert(std::is_nothrow_copy_assignable_v<T>,
@@ -77,7 +82,10 @@ private:
     std::atomic<std::size_t> seq_;
 };
 
-// Spinlock-protected value for exclusive access
+// Spinlock-protected value for exclusive access. Writers also bump a
+// sequence inside the critical section, odd while the value changes, so
+// observers that cannot take the lock (read-only mappings) validate their
+// copy the way Guarded<T> readers do.
 template <typename T>
 struct Locked {
     static_assert(std::is_trivially_copyable_v<T>,
@@ -85,17 +93,16 @@ struct Locked {
 
     mutable std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
     T value{};
+    std::atomic<uint32_t> seq_{0};
 
     Locked() = default;
     explicit Locked(const T &v) : value(v) {
     }
 
     void write(const T &v) {
-        while (lock_.test_and_set(std::memory_order_acquire)) {
-            MEMGLASS_PAUSE();
-        }
+        lock();
         std::memcpy(&value, &v, sizeof(T));
-        lock_.clear(std::memory_order_release);
+        unlock();
     }
 
     T read() const {
@@ -108,15 +115,71 @@ struct Locked {
         return result;
     }
 
+    // Read without taking the lock, for observers with read-only mappings:
+    // retries until the sequence is even and unchanged across the copy
+    T read_unlocked() const {
+        T result;
+        while (true) {
+            uint32_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                MEMGLASS_PAUSE();
+                continue;
+            }
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            std::memcpy(&result, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s1) {
+                return result;
+            }
+        }
+    }
+
     // Read-modify-write operation
     template <typename F>
     void update(F &&func) {
+        lock();
+        func(value);
+        unlock();
+    }
+
+private:
+    // Take the lock and mark the value as changing
+    void lock() {
         while (lock_.test_and_set(std::memory_order_acquire)) {
             MEMGLASS_PAUSE();
         }
-        func(value);
+        seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void unlock() {
+        seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
         lock_.clear(std::memory_order_release);
     }
 };
 
+namespace detail {
+
+// Where Locked<T> keeps the value and the sequence for a primitive T of
+// value_size bytes, for observers that only know the field's primitive type
+constexpr std::size_t locked_value_offset(std::size_t value_size) {
+    return value_size;
+}
+
+constexpr std::size_t locked_seq_offset(std::size_t value_size) {
+    constexpr std::size_t align = alignof(std::atomic<uint32_t>);
+    return (2 * value_size + align - 1) / align * align;
+}
+
+static_assert(offsetof(Locked<int8_t>, seq_) == locked_seq_offset(1));
+static_assert(offsetof(Locked<int16_t>, seq_) == locked_seq_offset(2));
+static_assert(offsetof(Locked<int32_t>, seq_) == locked_seq_offset(4));
+static_assert(offsetof(Locked<int64_t>, seq_) == locked_seq_offset(8));
+static_assert(offsetof(Locked<int8_t>, value) == locked_value_offset(1));
+static_assert(offsetof(Locked<int16_t>, value) == locked_value_offset(2));
+static_assert(offsetof(Locked<int32_t>, value) == locked_value_offset(4));
+static_assert(offsetof(Locked<double>, value) == locked_value_offset(sizeof(double)));
+
+}  // namespace detail
+
 }  // namespace memglass
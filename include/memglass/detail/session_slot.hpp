@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace memglass::detail {
+
+// Per-thread slots in a segment of the attached session (heartbeat slots,
+// CDC rings). The generation changes on every attach and detach, so a
+// thread's claim on a segment that is gone goes stale instead of dangling.
+
+// The segment threads claim slots in; generation 0 is never current
+template<typename Header>
+class SessionSegment {
+public:
+    void attach(Header* header) { publish(header); }
+    void detach() { publish(nullptr); }
+
+    uint64_t generation(std::memory_order order = std::memory_order_acquire) const {
+        return generation_.load(order);
+    }
+    Header* header() const { return header_.load(std::memory_order_acquire); }
+
+private:
+    void publish(Header* header) {
+        header_.store(header, std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    std::atomic<Header*> header_{nullptr};
+    std::atomic<uint64_t> generation_{1};
+};
+
+// The calling thread's claim on one slot. Free marks the slot free again;
+// it only runs while the claim's session is still attached, so a detached
+// segment is never written.
+template<typename Header, typename Slot, void (*Free)(Slot*)>
+class SlotClaim {
+public:
+    explicit SlotClaim(const SessionSegment<Header>& segment) : segment_(segment) {}
+    ~SlotClaim() { release(); }
+
+    SlotClaim(const SlotClaim&) = delete;
+    SlotClaim& operator=(const SlotClaim&) = delete;
+
+    // Relaxed check for hot paths: attached or detached since the last claim
+    bool stale() const { return generation_ != segment_.generation(std::memory_order_relaxed); }
+
+    // Slot taken by the last claim, nullptr if none
+    Slot* slot() const { return slot_; }
+
+    // The slot, if its session is still the attached one
+    Slot* current() const { return slot_ && generation_ == segment_.generation() ? slot_ : nullptr; }
+
+    void release() {
+        if (current()) Free(slot_);
+        slot_ = nullptr;
+    }
+
+    // Release and forget the session, so the next stale() check is true
+    void reset() {
+        release();
+        generation_ = 0;
+    }
+
+    // Release, move to the current session and keep the slot find(header)
+    // takes; nullptr when detached or find finds no free slot
+    template<typename Find>
+    Slot* claim(Find&& find) {
+        release();
+        generation_ = segment_.generation();
+        Header* header = segment_.header();
+        slot_ = header ? find(header) : nullptr;
+        return slot_;
+    }
+
+private:
+    const SessionSegment<Header>& segment_;
+    uint64_t generation_ = 0;
+    Slot* slot_ = nullptr;
+};
+
+} // namespace memglass::detail
@@ -7,6 +7,12 @@
 
 namespace memglass::detail {
 
+// How open() maps an existing segment
+struct MapOptions {
+    bool writable = true;   // PROT_WRITE; read-only mappings fault on stores
+    bool populate = false;  // prefault all pages at map time (MAP_POPULATE)
+};
+
 // Platform-agnostic shared memory handle
 class SharedMemory {
 public:
@@ -23,7 +29,7 @@ public:
     bool create(std::string_view name, size_t size);
 
     // Open existing shared memory region (observer)
-    bool open(std::string_view name);
+    bool open(std::string_view name, const MapOptions& options = {});
 
     // Unlink shared memory (removes from filesystem, keeps mapped)
     void unlink();
@@ -54,5 +60,9 @@ private:
 std::string make_header_shm_name(std::string_view session_name);
 std::string make_region_shm_name(std::string_view session_name, uint64_t region_id);
 std::string make_overflow_shm_name(std::string_view session_name, uint64_t overflow_id);
+std::string make_events_shm_name(std::string_view session_name);
+std::string make_cdc_shm_name(std::string_view session_name);
+std::string make_stamps_shm_name(std::string_view session_name);
+std::string make_heartbeats_shm_name(std::string_view session_name);
 
 } // namespace memglass::detail
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "observer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memglass {
+
+class BulkCopy;
+class DirtyTracker;
+
+// Union-like storage for a primitive field value
+struct FieldValue {
+    PrimitiveType type = PrimitiveType::Unknown;
+    Atomicity atomicity = Atomicity::None;
+
+    union {
+        bool b;
+        int8_t i8;
+        uint8_t u8;
+        int16_t i16;
+        uint16_t u16;
+        int32_t i32;
+        uint32_t u32;
+        int64_t i64;
+        uint64_t u64;
+        float f32;
+        double f64;
+        char c;
+    } data;
+
+    bool operator==(const FieldValue& other) const;
+    bool operator!=(const FieldValue& other) const { return !(*this == other); }
+
+    // Integer view (used for delta encoding); 0 for floats
+    int64_t as_int64() const;
+
+    // Numeric view for any primitive type
+    double as_double() const;
+
+    // Store an integer into the union member selected by `type`
+    void set_int64(int64_t v);
+
+    bool is_integer() const;
+    bool is_float() const { return type == PrimitiveType::Float32 || type == PrimitiveType::Float64; }
+
+    std::string to_string() const;
+    std::string to_json() const;
+};
+
+// Read a primitive field through its proxy, respecting atomicity
+FieldValue read_field_value(const FieldProxy& field);
+
+// Decode a primitive field from a private copy of its object, following
+// the Guarded<T>/Locked<T> layouts. No synchronization: the copy must
+// already be consistent (see BulkCopy).
+FieldValue decode_field_value(const FieldEntry& field, const void* object);
+
+// Snapshot storage
+
+struct ObjectSnapshot {
+    std::string label;
+    std::string type_name;
+    uint64_t region_id = 0;
+    uint64_t offset = 0;
+    std::map<std::string, FieldValue> fields;  // field_name -> value
+};
+
+struct Snapshot {
+    uint64_t timestamp_ns = 0;  // nanoseconds since epoch
+    uint64_t sequence = 0;
+    uint64_t pid = 0;
+    std::map<std::string, ObjectSnapshot> objects;  // label -> snapshot
+};
+
+// Read every field of every live object
+Snapshot take_snapshot(Observer& obs);
+
+// Same, but copy all objects into bulk's arena first and decode from there
+Snapshot take_snapshot(Observer& obs, BulkCopy& bulk);
+
+
+// Diff computation
+
+struct FieldChange {
+    std::string object_label;
+    std::string field_name;
+    FieldValue old_value;
+    FieldValue new_value;
+};
+
+struct SnapshotDiff {
+    uint64_t timestamp_ns = 0;
+    uint64_t old_sequence = 0;
+    uint64_t new_sequence = 0;
+    std::vector<std::string> added_objects;
+    std::vector<std::string> removed_objects;
+    std::vector<FieldChange> field_changes;
+
+    bool empty() const {
+        return added_objects.empty() && removed_objects.empty() && field_changes.empty();
+    }
+};
+
+SnapshotDiff compute_diff(const Snapshot& old_snap, const Snapshot& new_snap);
+
+// Bring snap up to date in place and return what changed. Only objects on
+// pages the tracker saw written are re-read; call dirty.collect() first.
+SnapshotDiff update_snapshot(Observer& obs, Snapshot& snap, const DirtyTracker& dirty);
+
+// Same, bulk-copying the objects to re-read before decoding them
+SnapshotDiff update_snapshot(Observer& obs, Snapshot& snap, const DirtyTracker& dirty,
+                             BulkCopy& bulk);
+
+// Readable name for a primitive type ("int64", "float64", ...)
+std::string_view primitive_type_name(PrimitiveType type);
+
+// Size of a primitive type in bytes; 0 for user types
+size_t primitive_size(PrimitiveType type);
+
+// Wall-clock time in nanoseconds since the Unix epoch
+uint64_t wall_clock_ns();
+
+} // namespace memglass
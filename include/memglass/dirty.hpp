@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace memglass {
+
+class Observer;
+
+// Finds the region pages a producer wrote since the last collect() using
+// Linux soft-dirty tracking (/proc/<pid>/clear_refs and /proc/<pid>/pagemap).
+//
+// When soft-dirty is unavailable (kernel without CONFIG_MEM_SOFT_DIRTY, no
+// permission on the producer's /proc entries) attach() returns false and
+// every range reports dirty, so callers degrade to a full scan.
+//
+// Reading the bits and clearing them are two steps, so a store to a clean
+// page between them is wiped without being seen. collect() therefore also
+// reports the pages dirty in the round before, which covers pages written
+// steadily, and every full_scan_interval() rounds reports every page dirty,
+// which bounds how late any other such store shows up.
+//
+// Clearing soft-dirty bits affects the whole producer process; do not run
+// two trackers (or CRIU) against the same producer at once.
+class DirtyTracker {
+public:
+    explicit DirtyTracker(Observer& obs);
+    ~DirtyTracker();
+
+    DirtyTracker(const DirtyTracker&) = delete;
+    DirtyTracker& operator=(const DirtyTracker&) = delete;
+
+    // Open the producer's pagemap and clear its soft-dirty bits
+    bool attach();
+
+    bool supported() const { return pagemap_fd_ != -1; }
+
+    // Snapshot the soft-dirty bits of all region pages and clear them
+    bool collect();
+
+    // True if any page backing [offset, offset + size) of the region was
+    // written before the last collect() (or in the round before it); always
+    // true when unsupported or on a full-scan round
+    bool is_dirty(uint64_t region_id, uint64_t offset, uint64_t size) const;
+
+    // Every n-th collect() reports every page dirty; 0 never does
+    void set_full_scan_interval(uint32_t collects) { full_scan_interval_ = collects; }
+    uint32_t full_scan_interval() const { return full_scan_interval_; }
+
+    // The last collect() was a full-scan round
+    bool full_scan() const { return full_scan_; }
+
+    // Page counts from the last collect()
+    size_t dirty_pages() const { return dirty_pages_; }
+    size_t tracked_pages() const { return tracked_pages_; }
+
+private:
+    struct Mapping {
+        uint64_t start;        // producer virtual address
+        uint64_t end;
+        uint64_t file_offset;
+    };
+
+    struct RegionPages {
+        std::vector<Mapping> mappings;
+        std::vector<uint64_t> dirty;     // one bit per page of the segment
+        std::vector<uint64_t> previous;  // the bits read the round before
+        bool known = false;           // collected at least once
+    };
+
+    bool clear_refs();
+    bool load_mappings();
+    void read_dirty_bits(RegionPages& region);
+
+    Observer& obs_;
+    uint64_t pid_ = 0;
+    int pagemap_fd_ = -1;
+    size_t page_size_ = 4096;
+    uint64_t mappings_sequence_ = ~0ull;
+    std::unordered_map<uint64_t, RegionPages> regions_;
+    std::vector<uint64_t> entries_;  // pagemap read buffer
+    size_t dirty_pages_ = 0;
+    size_t tracked_pages_ = 0;
+    uint32_t full_scan_interval_ = 16;
+    uint64_t collects_ = 0;
+    bool full_scan_ = false;
+};
+
+} // namespace memglass
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.hpp"
+#include "detail/shm.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace memglass {
+
+class Observer;
+
+namespace detail {
+
+// Producer side of mark()/cycle_end(): append to the ring and wake waiters.
+// Safe from several threads as long as no writer is lapped by the whole
+// ring mid-write; readers detect torn entries either way.
+void publish_event(EventRingHeader* ring, EventKind kind, std::string_view name);
+
+} // namespace detail
+
+// An event as read from the producer's ring
+struct Event {
+    uint64_t index = 0;          // Position in the producer's event stream
+    uint64_t epoch = 0;          // Completed cycles when published
+    uint64_t timestamp_ns = 0;   // Producer steady_clock
+    EventKind kind = EventKind::CycleEnd;
+    std::string name;            // Mark name, empty for CycleEnd
+};
+
+// Follows the producer's events segment, blocking on a futex between
+// events, so samplers can capture at cycle boundaries or named marks
+// instead of on a timer.
+//
+// The ring keeps Config::event_ring_capacity events; a listener that falls
+// further behind skips ahead and counts the lost events in missed().
+class EventListener {
+public:
+    explicit EventListener(Observer& obs);
+
+    EventListener(const EventListener&) = delete;
+    EventListener& operator=(const EventListener&) = delete;
+
+    // Map the events segment; false if the producer publishes none.
+    // Only events published after attach() are returned.
+    bool attach();
+
+    bool attached() const { return ring_ != nullptr; }
+
+    // Next event after the last one returned; false on timeout
+    bool next(Event& out, std::chrono::nanoseconds timeout);
+
+    // Next CycleEnd, or next Mark with this name; false on timeout
+    bool wait_for(EventKind kind, std::string_view name, Event& out,
+                  std::chrono::nanoseconds timeout);
+
+    // Drop everything published so far, e.g. events raised while the
+    // caller was busy capturing
+    void skip_to_head();
+
+    // Events overwritten before this listener read them
+    uint64_t missed() const { return missed_; }
+
+    // Completed cycles as of now
+    uint64_t epoch() const;
+
+private:
+    Observer& obs_;
+    detail::SharedMemory shm_;
+    EventRingHeader* ring_ = nullptr;
+    const EventEntry* entries_ = nullptr;
+    uint64_t cursor_ = 0;
+    uint64_t missed_ = 0;
+};
+
+} // namespace memglass
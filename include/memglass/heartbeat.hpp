@@ -0,0 +1,105 @@
+#pragma once
+
+#include "tsc.hpp"
+#include "types.hpp"
+#include "detail/shm.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace memglass {
+
+class Observer;
+
+// Stall detection for producer threads. Each thread calls
+// memglass::heartbeat() once per event-loop iteration, which bumps a loop
+// counter and the last-beat TSC in the thread's slot of the
+// memglass_<session>_heartbeats segment. A StallDetector reads the slots
+// and flags threads that have not beaten for longer than a threshold:
+// stuck in a syscall, waiting on a lock, spinning in a loop that never
+// returns to the event loop.
+
+namespace detail {
+
+// Publish the session's heartbeat segment to producer threads; claimed
+// slots of an earlier session are forgotten
+void heartbeat_attach(HeartbeatHeader* header);
+void heartbeat_detach();
+
+} // namespace detail
+
+// One producer thread as last seen by a StallDetector
+struct ThreadHeartbeat {
+    uint32_t slot = 0;
+    uint32_t tid = 0;
+    std::string name;
+    uint64_t count = 0;          // Loop iterations so far
+    uint64_t silent_ns = 0;      // Since the last beat
+    uint64_t threshold_ns = 0;   // Silence that counts as a stall
+    double rate = 0;             // Iterations per second since the previous check
+    bool stalled = false;
+};
+
+struct StallOptions {
+    // Silence after which a thread is stalled, unless the thread set its
+    // own with register_heartbeat()
+    std::chrono::nanoseconds threshold = std::chrono::milliseconds(10);
+};
+
+// Watches the producer's heartbeat slots. check() as often as the
+// smallest threshold calls for; stalls shorter than the interval between
+// checks are still caught if they are in progress at a check.
+class StallDetector {
+public:
+    using Callback = std::function<void(const ThreadHeartbeat&)>;
+
+    explicit StallDetector(Observer& obs, const StallOptions& options = {});
+
+    StallDetector(const StallDetector&) = delete;
+    StallDetector& operator=(const StallDetector&) = delete;
+
+    // Map the heartbeats segment; false if the producer has none
+    bool attach();
+
+    bool attached() const { return header_ != nullptr; }
+
+    // Re-read every slot. Calls on_stall for threads that stalled since
+    // the previous check and on_recover for those that beat again.
+    const std::vector<ThreadHeartbeat>& check();
+
+    // Threads with a slot, as of the last check(), in slot order
+    const std::vector<ThreadHeartbeat>& threads() const { return threads_; }
+
+    // Stalled threads as of the last check()
+    size_t stalled() const;
+
+    void on_stall(Callback cb) { on_stall_ = std::move(cb); }
+    void on_recover(Callback cb) { on_recover_ = std::move(cb); }
+
+private:
+    struct Previous {
+        uint32_t tid = 0;
+        uint64_t count = 0;
+        uint64_t checked_ns = 0;
+        bool active = false;
+        bool stalled = false;
+    };
+
+    Observer& obs_;
+    StallOptions options_;
+    detail::SharedMemory shm_;
+    const HeartbeatHeader* header_ = nullptr;
+    const HeartbeatSlot* slots_ = nullptr;
+    TscClock clock_;
+    uint64_t calibrated_at_ = 0;
+    std::vector<Previous> previous_;
+    std::vector<ThreadHeartbeat> threads_;
+    Callback on_stall_;
+    Callback on_recover_;
+};
+
+} // namespace memglass
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "book.hpp"
+#include "diff.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memglass {
+
+// Observer side of Book<Levels> (book.hpp): consistent ladder reads and
+// level-by-level diffs keyed on price.
+
+struct LadderLevel {
+    double price = 0;
+    double qty = 0;
+    uint64_t orders = 0;
+};
+
+struct Ladder {
+    uint64_t epoch = 0;
+    std::vector<LadderLevel> bids;  // best first
+    std::vector<LadderLevel> asks;  // best first
+    uint32_t level_retries = 0;     // levels re-read after racing an update
+    uint32_t book_retries = 0;      // reads restarted by a shift
+};
+
+// Names of the books a type registered with Book<Levels>::describe()
+std::vector<std::string> find_books(const ObservedType& type);
+
+// Reads one book of a type out of live objects. Resolves the book's field
+// offsets once; construct per type and reuse across objects and ticks.
+class BookReader {
+public:
+    BookReader() = default;
+    BookReader(const ObservedType& type, std::string_view name);
+
+    // False if the type has no book by that name
+    explicit operator bool() const { return depth_ > 0; }
+
+    const std::string& name() const { return name_; }
+    uint32_t depth() const { return depth_; }
+
+    // Read the book in object. Each level is read under its version stamp
+    // and retried alone; the whole read restarts only if the epoch moved.
+    // False if the book was still shifting after max_attempts tries.
+    bool read(const void* object, Ladder& out, uint32_t max_attempts = 64) const;
+
+private:
+    struct Slot {
+        uint32_t version;
+        uint32_t price;
+        uint32_t qty;
+        uint32_t orders;
+    };
+
+    bool read_side(const char* base, const std::vector<Slot>& slots, uint32_t count,
+                   std::vector<LadderLevel>& out, uint32_t& retries, uint32_t max_attempts) const;
+
+    std::string name_;
+    uint32_t depth_ = 0;
+    uint32_t epoch_ = 0;
+    uint32_t bid_count_ = 0;
+    uint32_t ask_count_ = 0;
+    std::vector<Slot> bids_;
+    std::vector<Slot> asks_;
+};
+
+// Ladder of a book as captured in a snapshot. Levels are taken as read,
+// without the epoch check. False if the object has no such book.
+bool read_ladder(const ObjectSnapshot& obj, std::string_view name, Ladder& out);
+
+// A price level that appeared, changed or went away. The missing side of
+// an added or removed level has qty 0.
+struct LevelChange {
+    BookSide side = BookSide::Bid;
+    double price = 0;
+    LadderLevel old_level;
+    LadderLevel new_level;
+};
+
+// Changes from old_ladder to new_ladder, matched by price, best first
+std::vector<LevelChange> diff_ladders(const Ladder& old_ladder, const Ladder& new_ladder);
+
+} // namespace memglass
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "tsc.hpp"
+#include "types.hpp"
+#include "detail/shm.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace memglass {
+
+class Observer;
+
+// Per-message latency attribution. The producer calls stamp(id, stage) as
+// a message crosses each stage boundary (feed handler, strategy, order
+// gateway, ...); stamps go to a ring in memglass_<session>_stamps. A
+// StampJoiner (memglass-latency) joins them per message into per-stage
+// and end-to-end latency histograms and keeps the slowest messages with
+// their full breakdown.
+//
+// Sampling is by message id, so a sampled message is stamped at every
+// stage and an unsampled one costs one multiply and a branch per stage.
+
+namespace detail {
+
+// Producer side of stamp(): append to the ring if the message is sampled
+void publish_stamp(StampRingHeader* ring, uint64_t message_id, uint32_t stage);
+
+// Producer side of define_stage()
+void name_stage(StampRingHeader* ring, uint32_t stage, std::string_view name);
+
+// Same decision for a message at every stage
+inline bool stamp_sampled(uint64_t sample_mask, uint64_t message_id) {
+    return (((message_id * 0x9E3779B97F4A7C15ull) >> 32) & sample_mask) == 0;
+}
+
+} // namespace detail
+
+// Log-linear histogram of nanosecond latencies: exact below 16, then 8
+// buckets per power of two (within 12.5%). Fixed size, no allocation.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 16 + 60 * 8;
+
+    void add(uint64_t ns);
+    void merge(const LatencyHistogram& other);
+    void clear() { *this = {}; }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0; }
+
+    // Value at quantile q (0..1): the midpoint of its bucket, clamped to
+    // the observed min and max
+    uint64_t percentile(double q) const;
+
+    // Non-empty buckets as (lower bound, count), for plotting
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const;
+
+private:
+    static size_t index(uint64_t ns);
+    static uint64_t lower_bound(size_t index);
+
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = ~0ull;
+    uint64_t max_ = 0;
+};
+
+// One joined message
+struct MessageTrace {
+    uint64_t message_id = 0;
+    uint64_t start_ns = 0;   // Wall clock at its first stamp
+    uint64_t total_ns = 0;   // First stamp to last
+    std::vector<std::pair<uint32_t, uint64_t>> stages;  // (stage, ns since first stamp), in stage order
+};
+
+struct LatencyReport {
+    std::vector<std::string> stage_names;   // By stage; "stage<N>" where unnamed
+    std::vector<LatencyHistogram> stages;   // By stage: time since the previous stamped stage
+    LatencyHistogram end_to_end;
+    std::vector<MessageTrace> worst;        // Slowest end to end, slowest first
+    uint64_t messages = 0;                  // Messages completed
+    uint64_t incomplete = 0;                // Messages dropped before their final stage
+    uint64_t missed = 0;                    // Stamps overwritten before they were read
+};
+
+struct JoinOptions {
+    // Stage that completes a message; by default the highest stage named
+    // with define_stage(). With neither, a message completes once it has
+    // had no new stamp for timeout.
+    uint32_t final_stage = ~0u;
+
+    // Slowest messages kept per report
+    size_t worst = 10;
+
+    // Messages without a new stamp for this long are dropped as
+    // incomplete (or, with no final stage, completed)
+    std::chrono::nanoseconds timeout = std::chrono::seconds(1);
+};
+
+// Reads the producer's stamps ring and joins stamps per message id. Poll
+// faster than the ring wraps; overwritten stamps are counted in missed.
+class StampJoiner {
+public:
+    explicit StampJoiner(Observer& obs, const JoinOptions& options = {});
+
+    StampJoiner(const StampJoiner&) = delete;
+    StampJoiner& operator=(const StampJoiner&) = delete;
+
+    // Map the stamps segment; false if the producer stamps nothing. Only
+    // stamps published after attach() are joined.
+    bool attach();
+
+    bool attached() const { return ring_ != nullptr; }
+
+    // Join the stamps published since the last poll; returns how many
+    // were read
+    size_t poll();
+
+    // Everything completed since attach() or the last reset()
+    const LatencyReport& report() const { return report_; }
+
+    // Start a new reporting window; messages in flight carry over
+    void reset();
+
+    // Messages with some stamps but not the final one yet
+    size_t pending() const { return pending_.size(); }
+
+private:
+    struct Pending {
+        uint64_t first_tsc = 0;
+        uint64_t last_tsc = 0;
+        std::vector<std::pair<uint32_t, uint64_t>> stamps;  // (stage, tsc)
+    };
+
+    void add(uint64_t message_id, uint32_t stage, uint64_t tsc);
+    void complete(uint64_t message_id, Pending& p);
+    void expire();
+    void refresh_stages();
+    uint64_t to_ns(uint64_t ticks) const;
+
+    Observer& obs_;
+    JoinOptions options_;
+    detail::SharedMemory shm_;
+    StampRingHeader* ring_ = nullptr;
+    const StampEntry* entries_ = nullptr;
+    uint64_t cursor_ = 0;
+    TscClock clock_;
+    uint64_t calibrated_at_ = 0;
+    uint32_t final_stage_ = ~0u;
+    std::unordered_map<uint64_t, Pending> pending_;
+    LatencyReport report_;
+};
+
+} // namespace memglass
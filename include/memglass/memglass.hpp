@@ -3,9 +3,12 @@
 #include "types.hpp"
 #include "registry.hpp"
 #include "allocator.hpp"
+#include "pause.hpp"
 #include "detail/seqlock.hpp"
 
+#include <chrono>
 #include <memory>
+#include <new>
 #include <string_view>
 #include <type_traits>
 
@@ -46,7 +49,21 @@ public:
     // Direct access to header shared memory
     detail::SharedMemory& header_shm() { return header_shm_; }
 
+    // Events segment; nullptr when Config::event_ring_capacity is 0
+    EventRingHeader* events() { return events_; }
+
+    // Change-data-capture segment; nullptr when Config::cdc_ring_capacity is 0
+    CdcHeader* cdc() { return cdc_; }
+
+    // Stamps segment; nullptr when Config::stamp_ring_capacity is 0
+    StampRingHeader* stamps() { return stamps_; }
+
+    // Heartbeats segment; nullptr when Config::heartbeat_slots is 0
+    HeartbeatHeader* heartbeats() { return heartbeats_; }
+
 private:
+    void close_cdc();
+
     bool initialized_ = false;
     std::string session_name_;
     Config config_;
@@ -54,11 +71,117 @@ private:
     detail::SharedMemory header_shm_;
     TelemetryHeader* header_ = nullptr;
 
+    detail::SharedMemory events_shm_;
+    EventRingHeader* events_ = nullptr;
+
+    detail::SharedMemory cdc_shm_;
+    CdcHeader* cdc_ = nullptr;
+
+    detail::SharedMemory stamps_shm_;
+    StampRingHeader* stamps_ = nullptr;
+
+    detail::SharedMemory heartbeats_shm_;
+    HeartbeatHeader* heartbeats_ = nullptr;
+
     std::unique_ptr<RegionManager> regions_;
     std::unique_ptr<MetadataManager> metadata_;
     std::unique_ptr<ObjectManager> objects_;
 };
 
+#ifdef MEMGLASS_DISABLE
+
+// Producer API compiled out. Nothing is mapped or published: objects are
+// plain heap allocations and statistics and tracked stores are plain
+// stores. Guarded<T> and Locked<T> are shared with the observer side and
+// stay as they are; uncontended, they cost a few extra stores. Define
+// MEMGLASS_DISABLE for every translation unit of the producer. Everything
+// that differs lives in an inline namespace, so the program can still
+// link the regular library (e.g. to observe other sessions).
+namespace detail {
+
+template<typename T>
+T* allocate_local(size_t count) {
+    return static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t{alignof(T)}, std::nothrow));
+}
+
+} // namespace detail
+
+inline namespace disabled {
+
+inline bool init(std::string_view, const Config& = {}) { return true; }
+inline void shutdown() {}
+
+inline Config& config() {
+    static Config default_config;
+    return default_config;
+}
+
+inline void mark(std::string_view) {}
+inline void cycle_end() {}
+inline void stamp(uint64_t, uint32_t) {}
+inline void define_stage(uint32_t, std::string_view) {}
+inline void heartbeat() {}
+inline bool register_heartbeat(std::string_view, std::chrono::nanoseconds = {}) { return true; }
+inline void unregister_heartbeat() {}
+
+template<typename T>
+struct Handle : ObjectHandle {
+    T* ptr = nullptr;
+
+    explicit operator bool() const { return ptr != nullptr; }
+    T* get() const { return ptr; }
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+};
+
+template<Observable T>
+T* create(std::string_view) {
+    T* ptr = detail::allocate_local<T>(1);
+    return ptr ? new (ptr) T{} : nullptr;
+}
+
+template<Observable T>
+T* create(std::string_view, const T& initial) {
+    T* ptr = detail::allocate_local<T>(1);
+    return ptr ? new (ptr) T(initial) : nullptr;
+}
+
+template<Observable T>
+T* create_array(std::string_view, size_t count) {
+    T* arr = detail::allocate_local<T>(count);
+    if (!arr) return nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        new (&arr[i]) T{};
+    }
+    return arr;
+}
+
+template<Observable T>
+void destroy(T* obj) {
+    if (!obj) return;
+    obj->~T();
+    ::operator delete(obj, std::align_val_t{alignof(T)});
+}
+
+template<Observable T>
+Handle<T> create_handle(std::string_view label) {
+    Handle<T> handle;
+    handle.ptr = create<T>(label);
+    return handle;
+}
+
+template<Observable T>
+bool destroy(Handle<T>& handle) {
+    if (!handle.ptr) return false;
+    destroy(handle.ptr);
+    handle = {};
+    return true;
+}
+
+} // namespace disabled
+
+#else
+
 // Initialize memglass (must be called before any other functions)
 bool init(std::string_view session_name, const Config& config = {});
 
@@ -68,6 +191,50 @@ void shutdown();
 // Get current configuration
 Config& config();
 
+// Publish a named event (e.g. after each market-data burst) and wake
+// observers waiting for it. Names longer than 31 bytes are truncated.
+void mark(std::string_view name);
+
+// Publish the end of one producer loop iteration and advance the epoch,
+// so observers can capture between iterations instead of mid-update
+void cycle_end();
+
+// Record that a message crossed into pipeline stage `stage` (0 for the
+// first, stages numbered in pipeline order), for per-message latency
+// attribution (memglass-latency). Only messages picked by
+// Config::stamp_sample_every are stamped, the same ones at every stage.
+void stamp(uint64_t message_id, uint32_t stage);
+
+// Name a stage for the latency tools; names longer than 31 bytes are
+// truncated. Stages from MAX_STAGES on are ignored.
+void define_stage(uint32_t stage, std::string_view name);
+
+// Mark one iteration of the calling thread's event loop, for stall
+// detection. The first call claims a heartbeat slot named after the
+// thread; after that a beat is two plain stores to a cache line only this
+// thread writes. No-op when Config::heartbeat_slots is 0 or every slot is
+// taken.
+void heartbeat();
+
+// Claim (or rename) the calling thread's heartbeat slot. A non-zero
+// max_silence replaces the observer's stall threshold for this thread.
+// Returns false if no slot is free.
+bool register_heartbeat(std::string_view name, std::chrono::nanoseconds max_silence = {});
+
+// Release the calling thread's slot, e.g. before blocking on purpose; the
+// next heartbeat() claims one again. Threads release theirs on exit.
+void unregister_heartbeat();
+
+// Object created by create_handle()
+template<typename T>
+struct Handle : ObjectHandle {
+    T* ptr = nullptr;
+
+    T* get() const { return ptr; }
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+};
+
 // Create an object in shared memory
 template<Observable T>
 T* create(std::string_view label) {
@@ -147,4 +314,44 @@ void destroy(T* obj) {
     ctx->objects().destroy_object(obj);
 }
 
+// Create an object and return a handle for destroy without a lookup.
+// Unlike create(), nothing is recorded per pointer; concurrent creates and
+// destroys only serialize on the short label index update.
+template<Observable T>
+Handle<T> create_handle(std::string_view label) {
+    auto* ctx = detail::get_context();
+    if (!ctx || !ctx->is_initialized()) return {};
+
+    uint32_t type_id = registry::get_type_id(typeid(T).name());
+    if (type_id == 0) return {};
+
+    uint64_t region_id, offset;
+    void* ptr = ctx->regions().allocate(sizeof(T), alignof(T), &region_id, &offset);
+    if (!ptr) return {};
+
+    T* obj = new (ptr) T{};
+
+    Handle<T> handle;
+    static_cast<ObjectHandle&>(handle) =
+        ctx->objects().register_object(region_id, offset, type_id, label);
+    if (handle) handle.ptr = obj;
+    return handle;
+}
+
+// Destroy an object created by create_handle() and reset the handle.
+// Returns false if it was already destroyed.
+template<Observable T>
+bool destroy(Handle<T>& handle) {
+    auto* ctx = detail::get_context();
+    if (!ctx || !ctx->is_initialized()) return false;
+
+    if (!ctx->objects().destroy_object(handle)) return false;
+
+    handle.ptr->~T();
+    handle = {};
+    return true;
+}
+
+#endif // MEMGLASS_DISABLE
+
 } // namespace memglass
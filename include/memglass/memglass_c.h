@@ -0,0 +1,311 @@
+/*
+ * memglass C API - read-only observer and recording reader for use from
+ * other languages.
+ *
+ * Built as the shared library libmemglass_c. Everything here operates on
+ * the producer's shared memory directly: object data pointers are
+ * zero-copy, and reads follow each field's atomicity (atomic loads,
+ * seqlock retry, optimistic Locked<T> reads) without writing to the
+ * producer's memory.
+ *
+ * ABI rules: functions are only ever added, structs are only extended at
+ * the end, and MEMGLASS_C_ABI_VERSION is bumped whenever either happens
+ * or existing calls report something different. Version 4 lists nested
+ * structs as one MEMGLASS_FIELD_NESTED field instead of their leaves.
+ * Strings returned by the library stay valid until the observer (or
+ * recording) is closed.
+ *
+ * Threading: an observer may be shared by readers, but refresh() and
+ * close() must not run concurrently with other calls on it.
+ */
+
+#ifndef MEMGLASS_C_H
+#define MEMGLASS_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(MEMGLASS_C_BUILD)
+#define MEMGLASS_C_API __attribute__((visibility("default")))
+#else
+#define MEMGLASS_C_API
+#endif
+
+#define MEMGLASS_C_ABI_VERSION 4
+
+/* Status codes (negative on failure) */
+enum {
+    MEMGLASS_OK = 0,
+    MEMGLASS_ERR_INVALID = -1,    /* bad argument */
+    MEMGLASS_ERR_NOT_FOUND = -2,  /* no such type, field or object */
+    MEMGLASS_ERR_STALE = -3,      /* object destroyed or slot reused */
+    MEMGLASS_ERR_BUSY = -4,       /* no consistent read within the retry budget */
+    MEMGLASS_ERR_TIMEOUT = -5,    /* wait expired without a change */
+    MEMGLASS_ERR_TYPE = -6        /* field is not a primitive of the requested kind */
+};
+
+/* Mirrors memglass::PrimitiveType */
+enum {
+    MEMGLASS_TYPE_UNKNOWN = 0,
+    MEMGLASS_TYPE_BOOL = 1,
+    MEMGLASS_TYPE_INT8 = 2,
+    MEMGLASS_TYPE_UINT8 = 3,
+    MEMGLASS_TYPE_INT16 = 4,
+    MEMGLASS_TYPE_UINT16 = 5,
+    MEMGLASS_TYPE_INT32 = 6,
+    MEMGLASS_TYPE_UINT32 = 7,
+    MEMGLASS_TYPE_INT64 = 8,
+    MEMGLASS_TYPE_UINT64 = 9,
+    MEMGLASS_TYPE_FLOAT32 = 10,
+    MEMGLASS_TYPE_FLOAT64 = 11,
+    MEMGLASS_TYPE_CHAR = 12
+};
+
+/* Mirrors memglass::Atomicity */
+enum {
+    MEMGLASS_ATOMICITY_NONE = 0,
+    MEMGLASS_ATOMICITY_ATOMIC = 1,
+    MEMGLASS_ATOMICITY_SEQLOCK = 2,
+    MEMGLASS_ATOMICITY_LOCKED = 3
+};
+
+/* Mirrors memglass::FieldFlags */
+enum {
+    MEMGLASS_FIELD_ARRAY = 1 << 0,
+    MEMGLASS_FIELD_NESTED = 1 << 1,
+    MEMGLASS_FIELD_READONLY = 1 << 2
+};
+
+/* memglass_open() flags */
+enum {
+    MEMGLASS_OPEN_POPULATE = 1 << 0,  /* prefault region pages at map time */
+    MEMGLASS_OPEN_LAZY = 1 << 1       /* map regions on first object access */
+};
+
+/* Mirrors memglass::query::Aggregation */
+enum {
+    MEMGLASS_AGG_LAST = 0,
+    MEMGLASS_AGG_FIRST = 1,
+    MEMGLASS_AGG_MIN = 2,
+    MEMGLASS_AGG_MAX = 3,
+    MEMGLASS_AGG_MEAN = 4,
+    MEMGLASS_AGG_SUM = 5,
+    MEMGLASS_AGG_COUNT = 6
+};
+
+typedef struct memglass_observer memglass_observer;
+typedef struct memglass_recording memglass_recording;
+
+typedef struct memglass_type_info {
+    const char* name;
+    uint32_t type_id;
+    uint32_t size;
+    uint32_t alignment;
+    uint32_t field_count;
+} memglass_type_info;
+
+typedef struct memglass_field_info {
+    const char* name;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t type_id;     /* MEMGLASS_TYPE_* or a user type id */
+    uint32_t flags;       /* MEMGLASS_FIELD_* */
+    uint32_t array_size;
+    uint8_t atomicity;    /* MEMGLASS_ATOMICITY_* */
+    uint8_t reserved[3];
+} memglass_field_info;
+
+/*
+ * A resolved field: compile once per (type, path), then read from any
+ * object of that type without name lookups.
+ */
+typedef struct memglass_field {
+    uint32_t owner_type_id;  /* type the path was resolved against */
+    uint32_t offset;         /* from the start of the object */
+    uint32_t size;           /* bytes memglass_read() copies */
+    uint32_t type_id;
+    uint32_t array_size;
+    uint8_t atomicity;
+    uint8_t reserved[3];
+} memglass_field;
+
+/*
+ * A live object. data points straight into shared memory; reads through
+ * memglass_read*() report MEMGLASS_ERR_STALE once the producer destroys
+ * the object or reuses its slot.
+ */
+typedef struct memglass_object {
+    const char* label;
+    const char* type_name;
+    const void* data;
+    uint32_t type_id;
+    uint32_t size;
+    uint64_t generation;
+    const void* entry;       /* directory entry; internal */
+} memglass_object;
+
+MEMGLASS_C_API uint32_t memglass_abi_version(void);
+MEMGLASS_C_API const char* memglass_strerror(int status);
+
+/* Connection; NULL if the session is missing or incompatible */
+MEMGLASS_C_API memglass_observer* memglass_open(const char* session, uint32_t flags);
+MEMGLASS_C_API void memglass_close(memglass_observer* obs);
+
+/* Pick up new types, objects and regions; returns 1 if anything changed */
+MEMGLASS_C_API int memglass_refresh(memglass_observer* obs);
+
+MEMGLASS_C_API uint64_t memglass_sequence(const memglass_observer* obs);
+MEMGLASS_C_API uint64_t memglass_producer_pid(const memglass_observer* obs);
+MEMGLASS_C_API uint64_t memglass_start_timestamp(const memglass_observer* obs);
+
+/* Schema */
+MEMGLASS_C_API uint32_t memglass_type_count(const memglass_observer* obs);
+MEMGLASS_C_API int memglass_type_at(const memglass_observer* obs, uint32_t index,
+                                    memglass_type_info* out);
+MEMGLASS_C_API int memglass_type_find(const memglass_observer* obs, const char* name,
+                                      memglass_type_info* out);
+/* Fields as published; a MEMGLASS_FIELD_NESTED field's type_id is the
+ * nested type, whose fields are listed under that id */
+MEMGLASS_C_API int memglass_field_at(const memglass_observer* obs, uint32_t type_id,
+                                     uint32_t index, memglass_field_info* out);
+
+/* Resolve "field", "nested.field" or "nested[i].field" on a type */
+MEMGLASS_C_API int memglass_field_compile(const memglass_observer* obs, uint32_t type_id,
+                                          const char* path, memglass_field* out);
+
+/* Objects, as of the last open/refresh */
+MEMGLASS_C_API uint32_t memglass_object_count(const memglass_observer* obs);
+MEMGLASS_C_API int memglass_object_at(memglass_observer* obs, uint32_t index,
+                                      memglass_object* out);
+MEMGLASS_C_API int memglass_object_find(memglass_observer* obs, const char* label,
+                                        memglass_object* out);
+
+/* MEMGLASS_OK while the object is alive with the same generation */
+MEMGLASS_C_API int memglass_object_check(const memglass_object* obj);
+
+/*
+ * Consistent copy of a field (field->size bytes) into out. Seqlock and
+ * Locked fields are retried a bounded number of times, so a producer that
+ * died mid-write yields MEMGLASS_ERR_BUSY instead of a hang.
+ */
+MEMGLASS_C_API int memglass_read(const memglass_object* obj, const memglass_field* field,
+                                 void* out, size_t out_size);
+
+/* Read a primitive field converted to int64 / double */
+MEMGLASS_C_API int memglass_read_i64(const memglass_object* obj, const memglass_field* field,
+                                     int64_t* out);
+MEMGLASS_C_API int memglass_read_f64(const memglass_object* obj, const memglass_field* field,
+                                     double* out);
+
+/* Copy of the whole object (obj->size bytes, ignoring field atomicity) */
+MEMGLASS_C_API int memglass_read_object(const memglass_object* obj, void* out, size_t out_size);
+
+/*
+ * Block until the structural sequence differs from last_sequence (new or
+ * destroyed objects, types, regions). timeout_ms < 0 waits forever.
+ */
+MEMGLASS_C_API int memglass_wait_sequence(const memglass_observer* obs, uint64_t last_sequence,
+                                          int32_t timeout_ms, uint64_t* sequence);
+
+/*
+ * Block until the field's bytes differ from previous (field->size bytes),
+ * copying the new value into previous.
+ */
+MEMGLASS_C_API int memglass_wait_field(const memglass_object* obj, const memglass_field* field,
+                                       void* previous, size_t size, int32_t timeout_ms);
+
+/*
+ * Block until the producer publishes memglass::mark(mark), or its next
+ * cycle_end() when mark is NULL, counting from this call. epoch receives
+ * the producer's completed cycle count. MEMGLASS_ERR_NOT_FOUND if the
+ * producer publishes no events. Registers as a waiter in the session's
+ * events segment, the only segment the library writes to.
+ */
+MEMGLASS_C_API int memglass_wait_event(memglass_observer* obs, const char* mark,
+                                       int32_t timeout_ms, uint64_t* epoch);
+
+/*
+ * Recordings: MGDF files written by memglass-diff or a Recorder, mapped
+ * read-only. Queries run like memglass-query: the block index prunes by
+ * time, blocks that never mention a wanted label or field are skipped,
+ * and the rest are decoded on all cores into columns.
+ */
+
+typedef struct memglass_recording_info {
+    uint32_t version;       /* MGDF version; queries need 2 */
+    uint32_t flags;         /* 1 = rollup file */
+    uint32_t block_count;
+    uint32_t has_index;     /* 0 if the writer was killed; blocks were scanned */
+    uint64_t first_ts;      /* ns since the epoch, 0 without blocks */
+    uint64_t last_ts;
+} memglass_recording_info;
+
+typedef struct memglass_query {
+    const char* const* labels;  /* exact object labels; NULL/0 = all */
+    uint32_t label_count;
+    const char* const* fields;  /* exact field names; NULL/0 = all */
+    uint32_t field_count;
+    uint64_t start_ns;          /* inclusive */
+    uint64_t end_ns;            /* exclusive; 0 = no end */
+    uint64_t interval_ns;       /* resampling buckets; 0 = every change */
+    uint32_t aggregation;       /* MEMGLASS_AGG_* */
+    uint32_t fill;              /* with LAST, repeat values into empty buckets */
+    uint32_t threads;           /* 0 = one per core */
+    uint32_t reserved;
+} memglass_query;
+
+/*
+ * One object field as parallel columns of count entries. Integer series
+ * (except MEAN and SUM) come in ints, exact; the rest in doubles. Columns
+ * stay valid until the next query on the recording or its close.
+ */
+typedef struct memglass_series {
+    const char* label;
+    const char* field;
+    uint32_t type_id;          /* MEMGLASS_TYPE_* */
+    uint32_t integer;          /* 1: values in ints, else in doubles */
+    uint64_t count;
+    const uint64_t* timestamps;
+    const int64_t* ints;
+    const double* doubles;
+} memglass_series;
+
+typedef struct memglass_query_stats {
+    uint64_t blocks_total;
+    uint64_t blocks_in_range;  /* overlapping the time range */
+    uint64_t blocks_decoded;   /* also mentioning a wanted label/field */
+    uint64_t records;
+    uint64_t points;
+} memglass_query_stats;
+
+/* NULL if the file is missing or not MGDF */
+MEMGLASS_C_API memglass_recording* memglass_recording_open(const char* path);
+MEMGLASS_C_API void memglass_recording_close(memglass_recording* rec);
+
+MEMGLASS_C_API int memglass_recording_describe(const memglass_recording* rec,
+                                              memglass_recording_info* out);
+
+/*
+ * Replace the recording's series with the result of a query (sorted by
+ * label, then field). stats may be NULL. On MEMGLASS_ERR_INVALID,
+ * memglass_recording_error() says why.
+ */
+MEMGLASS_C_API int memglass_recording_query(memglass_recording* rec, const memglass_query* query,
+                                            memglass_query_stats* stats);
+
+MEMGLASS_C_API uint32_t memglass_series_count(const memglass_recording* rec);
+MEMGLASS_C_API int memglass_series_at(const memglass_recording* rec, uint32_t index,
+                                      memglass_series* out);
+
+/* Last query error, "" if none */
+MEMGLASS_C_API const char* memglass_recording_error(const memglass_recording* rec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEMGLASS_C_H */
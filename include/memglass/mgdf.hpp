@@ -0,0 +1,344 @@
+#pragma once
+
+#include "diff.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memglass::mgdf {
+
+// MGDF ("memglass diff format") binary encoding
+//
+// Header (per file):
+//   Magic: "MGDF" (4 bytes)
+//   Version: uint8 (1 = record stream, 2 = blocks)
+//   Flags: uint8 (FLAG_ROLLUP for rollup files, other bits reserved)
+//   Reserved: 2 bytes
+//
+// Version 1 per diff record:
+//   Record type: uint8 (1 = diff, 0 = end)
+//   Timestamp delta: varint (ns since last record or file start)
+//   Sequence: varint
+//   Num added objects: varint
+//   Num removed objects: varint
+//   Num field changes: varint
+//   For each added/removed: string
+//   For each change:
+//     object label: string
+//     field name: string
+//     type: uint8 (PrimitiveType)
+//     value_delta: varint (for integers) or raw bytes (for floats)
+//
+// Version 2 groups records into self-contained blocks followed by an index,
+// so readers can seek by time and decode blocks independently:
+//
+//   Block header (32 bytes, little endian):
+//     Magic: "MGBK", payload size: u32, record count: u32, string count: u32,
+//     first timestamp: u64, last timestamp: u64
+//   Block payload:
+//     String table: string count x string (labels and field names)
+//     Records: as version 1, but timestamps are deltas from the previous
+//     record in the block, the sequence is followed by a signed varint
+//     (new - old sequence), strings are varint string-table ids, and
+//     integer values are deltas from the previous value of the same
+//     object/field in the block (the first one is absolute)
+//   Index (after the last block):
+//     Magic: "MGIX", block count: u32,
+//     per block: offset u64, first ts u64, last ts u64, records u32, size u32
+//   Footer (16 bytes): index offset u64, magic "MGFT", reserved u32
+//
+// A file without index (writer killed) is still readable by walking the
+// block headers from the start.
+//
+// Rollup files (version 2 with FLAG_ROLLUP) hold per-interval aggregates
+// instead of changes, one record per closed bucket:
+//   Record type: uint8 (2 = rollup)
+//   Bucket start delta: signed varint (like the diff timestamp delta)
+//   Interval: varint (ns)
+//   Num entries: varint
+//   For each entry:
+//     object label, field name: varint string-table ids
+//     type: uint8 (PrimitiveType)
+//     count: varint
+//     first, last, min, max: integers as signed varints, first a delta from
+//       the previous last of the same object/field in the block, the others
+//       deltas from first; floats as raw bytes
+//     sum: raw double
+
+constexpr uint8_t VERSION_1 = 1;
+constexpr uint8_t VERSION_2 = 2;
+constexpr uint8_t VERSION = VERSION_2;
+constexpr uint8_t RECORD_END = 0;
+constexpr uint8_t RECORD_DIFF = 1;
+constexpr uint8_t RECORD_ROLLUP = 2;
+
+constexpr uint8_t FLAG_ROLLUP = 0x01;
+
+constexpr size_t FILE_HEADER_SIZE = 8;
+constexpr size_t BLOCK_HEADER_SIZE = 32;
+constexpr size_t INDEX_ENTRY_SIZE = 32;
+constexpr size_t FOOTER_SIZE = 16;
+constexpr uint32_t NO_STRING = ~0u;
+
+// Version 1 stream encoder. Appends to a caller-owned buffer, so the buffer
+// can be reused across batches without reallocating.
+class Writer {
+public:
+    void write_header(std::string& out);
+    void write_diff(std::string& out, const SnapshotDiff& diff);
+    void write_end(std::string& out);
+
+private:
+    uint64_t last_timestamp_ = 0;
+};
+
+// Aggregate of one object field's changes in [start_ns, start_ns + interval_ns)
+struct Rollup {
+    uint64_t start_ns = 0;
+    uint64_t interval_ns = 0;
+    uint64_t count = 0;  // changes folded in
+    FieldValue first;
+    FieldValue last;
+    FieldValue min;
+    FieldValue max;
+    double sum = 0;      // of the numeric view, for means
+
+    void add(const FieldValue& v);
+
+    // Combine with an aggregate that follows this one in time
+    void merge(const Rollup& later);
+};
+
+// Open rollups of one bucket, keyed and written in (label, field) order
+using RollupMap = std::map<std::pair<std::string, std::string>, Rollup>;
+
+struct BlockHeader {
+    uint32_t payload_size = 0;
+    uint32_t record_count = 0;
+    uint32_t string_count = 0;
+    uint64_t first_ts = 0;
+    uint64_t last_ts = 0;
+};
+
+struct BlockInfo {
+    uint64_t offset = 0;  // file offset of the block header
+    uint64_t first_ts = 0;
+    uint64_t last_ts = 0;
+    uint32_t record_count = 0;
+    uint32_t size = 0;    // header + payload
+};
+
+// Version 2 encoder. Completed blocks are appended to the caller's buffer;
+// write_end() emits the last partial block, the index and the footer.
+class BlockWriter {
+public:
+    explicit BlockWriter(size_t block_bytes = 256 * 1024,
+                         uint64_t block_span_ns = 10'000'000'000ull);
+
+    void write_header(std::string& out, uint8_t flags = 0);
+    void write_diff(std::string& out, const SnapshotDiff& diff);
+
+    // One RECORD_ROLLUP record; only for files written with FLAG_ROLLUP
+    void write_rollups(std::string& out, uint64_t start_ns, uint64_t interval_ns,
+                       const RollupMap& rollups);
+
+    // Close the current block early (e.g. before a long idle period)
+    void finish_block(std::string& out);
+
+    void write_end(std::string& out);
+
+    const std::vector<BlockInfo>& blocks() const { return index_; }
+
+private:
+    uint32_t intern(std::string_view s);
+    void begin_record(std::string& out, uint8_t type, uint64_t timestamp_ns);
+    int64_t& last_value(uint32_t label, uint32_t field);
+
+    size_t block_bytes_;
+    uint64_t block_span_ns_;
+    uint64_t written_ = 0;  // bytes handed to callers so far
+
+    // Current block
+    std::string records_;
+    std::string strings_;
+    std::unordered_map<std::string, uint32_t> string_ids_;
+    std::unordered_map<uint64_t, int64_t> last_values_;  // (label id, field id) -> value
+    std::string key_;
+    BlockHeader header_;
+    uint64_t last_timestamp_ = 0;
+
+    std::vector<BlockInfo> index_;
+};
+
+// Writes a rollup file: changes are folded into buckets aligned to
+// multiples of interval_ns since the epoch, and a bucket is written once a
+// change past its end arrives. Late changes (clock steps) fold into the
+// open bucket. Object additions and removals are not kept.
+class RollupWriter {
+public:
+    explicit RollupWriter(uint64_t interval_ns, size_t block_bytes = 256 * 1024);
+
+    void write_header(std::string& out);
+    void write_diff(std::string& out, const SnapshotDiff& diff);
+    void write_change(std::string& out, uint64_t timestamp_ns, std::string_view label,
+                      std::string_view field, const FieldValue& value);
+
+    // Fold in a finer aggregate, e.g. when compacting 1s rollups into 1m;
+    // false unless its interval divides this writer's
+    bool write_rollup(std::string& out, std::string_view label, std::string_view field,
+                      const Rollup& rollup);
+
+    void write_end(std::string& out);
+
+    uint64_t interval_ns() const { return interval_ns_; }
+    uint64_t rollups() const { return rollups_; }  // aggregates written so far
+    const std::vector<BlockInfo>& blocks() const { return writer_.blocks(); }
+
+private:
+    Rollup& slot(std::string& out, uint64_t timestamp_ns, std::string_view label,
+                 std::string_view field);
+    void flush_bucket(std::string& out);
+
+    uint64_t interval_ns_;
+    BlockWriter writer_;
+    RollupMap open_;
+    std::pair<std::string, std::string> key_;  // reused for lookups
+    uint64_t bucket_start_ = 0;
+    bool has_bucket_ = false;
+    uint64_t rollups_ = 0;
+};
+
+// Receives the contents of one block from BlockDecoder::decode(). String
+// arguments are ids into BlockDecoder::strings().
+class BlockVisitor {
+public:
+    virtual ~BlockVisitor() = default;
+
+    virtual void on_record(uint64_t /*timestamp_ns*/, uint64_t /*old_sequence*/,
+                           uint64_t /*sequence*/) {}
+    virtual void on_object(bool /*added*/, uint32_t /*label*/) {}
+    virtual void on_change(uint32_t /*label*/, uint32_t /*field*/, const FieldValue& /*value*/) {}
+    virtual void on_rollup(uint32_t /*label*/, uint32_t /*field*/, const Rollup& /*rollup*/) {}
+};
+
+// Decodes one version 2 block held in memory
+class BlockDecoder {
+public:
+    // Parse the block header and string table; data must stay valid
+    bool open(const char* data, size_t size);
+
+    const BlockHeader& header() const { return header_; }
+    size_t total_size() const { return BLOCK_HEADER_SIZE + header_.payload_size; }
+
+    const std::vector<std::string_view>& strings() const { return strings_; }
+
+    // String-table id of s, or NO_STRING if the block never mentions it
+    uint32_t find(std::string_view s) const;
+
+    // Decode all records; integer values come out absolute
+    bool decode(BlockVisitor& visitor);
+
+private:
+    bool decode_rollups(const char*& p, uint64_t& timestamp, BlockVisitor& visitor);
+
+    const char* data_ = nullptr;
+    const char* records_ = nullptr;
+    const char* end_ = nullptr;
+    BlockHeader header_;
+    std::vector<std::string_view> strings_;
+    std::unordered_map<uint64_t, int64_t> last_values_;
+};
+
+bool parse_block_header(const char* data, size_t size, BlockHeader& header);
+
+// Read-only view of a whole MGDF file, mapped into memory
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    uint8_t version() const { return version_; }
+    uint8_t flags() const { return flags_; }
+    bool is_rollup() const { return (flags_ & FLAG_ROLLUP) != 0; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Version 2 blocks, from the index or by walking block headers
+    const std::vector<BlockInfo>& blocks() const { return blocks_; }
+    bool has_index() const { return has_index_; }
+
+    // Ask the kernel to read a block ahead, for blocks a query will decode
+    void will_need(const BlockInfo& block) const;
+
+private:
+    bool load_index();
+    void scan_blocks();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    uint8_t version_ = 0;
+    uint8_t flags_ = 0;
+    bool has_index_ = false;
+    std::vector<BlockInfo> blocks_;
+};
+
+// Sequential decoder for version 1 and 2 streams
+class Reader {
+public:
+    explicit Reader(std::istream& in) : in_(in) {}
+
+    bool read_header();
+
+    // Version 1 integer changes decode to the stored delta, not the
+    // absolute value; version 2 values are absolute. Rollup files yield
+    // no diffs.
+    std::optional<SnapshotDiff> read_diff();
+
+    uint8_t version() const { return version_; }
+    uint8_t flags() const { return flags_; }
+
+private:
+    std::istream& in_;
+    uint8_t version_ = 0;
+    uint8_t flags_ = 0;
+    uint64_t last_timestamp_ = 0;
+
+    // Version 2: diffs decoded from the current block
+    std::string block_;
+    std::deque<SnapshotDiff> pending_;
+    bool read_block();
+
+    uint8_t read_u8();
+    uint64_t read_varint();
+    int64_t read_varint_signed();
+    std::string read_string();
+    void read_raw_value(FieldValue& v);
+};
+
+// Primitive encoders shared by MGDF producers
+void put_varint(std::string& out, uint64_t v);
+void put_varint_signed(std::string& out, int64_t v);
+void put_string(std::string& out, std::string_view s);
+void put_u32(std::string& out, uint32_t v);
+void put_u64(std::string& out, uint64_t v);
+
+// Bounds-checked decoders over a byte range; return false past the end
+bool get_varint(const char*& p, const char* end, uint64_t& v);
+bool get_varint_signed(const char*& p, const char* end, int64_t& v);
+uint32_t get_u32(const char* p);
+uint64_t get_u64(const char* p);
+
+} // namespace memglass::mgdf
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types.hpp"
+#include "schema.hpp"
 #include "detail/shm.hpp"
 #include "detail/seqlock.hpp"
 
@@ -19,13 +20,22 @@ class Observer;
 class ObjectView;
 class FieldProxy;
 
-// Type information as seen by observer
-struct ObservedType {
-    uint32_t type_id;
-    std::string name;
-    uint32_t size;
-    uint32_t alignment;
-    std::vector<FieldEntry> fields;
+// When the observer maps region segments
+enum class RegionMapping {
+    Eager,     // map every region at connect/refresh
+    Populate,  // map at connect/refresh and prefault every page (hot regions)
+    Lazy       // map a region the first time one of its objects is accessed
+};
+
+struct ObserverOptions {
+    // Map segments writable so FieldProxy assignment works. Read-only
+    // observers cannot disturb the producer; Locked<T> fields are then read
+    // without taking the producer's lock and validated by its sequence.
+    bool writable = false;
+    RegionMapping regions = RegionMapping::Eager;
+    // Where parsed schemas are shared; nullptr uses SchemaCache::shared(),
+    // so observers of sessions with identical types parse them once
+    std::shared_ptr<SchemaCache> schema_cache;
 };
 
 // Object information as seen by observer
@@ -37,6 +47,7 @@ struct ObservedObject {
     uint64_t offset;
     uint64_t generation;
     ObjectState state;
+    const ObjectEntry* entry = nullptr;  // directory slot, for liveness checks
 };
 
 // Field proxy for intuitive field access
@@ -67,10 +78,10 @@ public:
         }
     }
 
-    // Assignment for writes
+    // Assignment for writes (ignored unless the observer is writable)
     template<typename T>
     FieldProxy& operator=(const T& value) {
-        if (!data_ || !field_) return *this;
+        if (!data_ || !field_ || !writable()) return *this;
 
         switch (field_->atomicity) {
             case Atomicity::Atomic:
@@ -142,9 +153,11 @@ private:
     template<typename T>
     T read_locked() const {
         auto* locked = reinterpret_cast<const Locked<T>*>(data_);
-        return locked->read();
+        return writable() ? locked->read() : locked->read_unlocked();
     }
 
+    bool writable() const;
+
     template<typename T>
     void write_direct(const T& value) {
         *reinterpret_cast<T*>(data_) = value;
@@ -192,9 +205,9 @@ public:
         return result;
     }
 
-    // Raw data access
+    // Raw data access; mutable_data() is nullptr for read-only observers
     const void* data() const { return data_; }
-    void* mutable_data() { return data_; }
+    void* mutable_data() { return writable_ ? data_ : nullptr; }
 
     // Object info
     const ObservedObject& info() const { return obj_info_; }
@@ -206,18 +219,19 @@ public:
 private:
     friend class FieldProxy;
 
-    const FieldEntry* find_field(std::string_view name) const;
+    FieldRef find_field(std::string_view name) const;
 
     Observer* observer_ = nullptr;
     ObservedObject obj_info_;
     const ObservedType* type_ = nullptr;
     void* data_ = nullptr;
+    bool writable_ = false;
 };
 
 // Observer - connects to a memglass session and reads data
 class Observer {
 public:
-    explicit Observer(std::string_view session_name);
+    explicit Observer(std::string_view session_name, const ObserverOptions& options = {});
     ~Observer();
 
     // Connect to the session
@@ -232,6 +246,11 @@ public:
     // Check if connected
     bool is_connected() const { return connected_; }
 
+    // Session this observer was created for
+    const std::string& session_name() const { return session_name_; }
+
+    const ObserverOptions& options() const { return options_; }
+
     // Producer info
     uint64_t producer_pid() const;
     uint64_t start_timestamp() const;
@@ -239,13 +258,22 @@ public:
     // Sequence number (changes on structural modifications)
     uint64_t sequence() const;
 
+    // Producer's publishing kill switch (pause.hpp). set_paused() needs a
+    // writable observer; both are false for producers without the switch.
+    bool paused() const;
+    bool set_paused(bool paused);
+
     // Get all types
-    const std::vector<ObservedType>& types() const { return types_; }
+    const std::vector<ObservedType>& types() const;
+
+    // Parsed types, possibly shared with observers of other sessions
+    const std::shared_ptr<const Schema>& schema() const { return schema_; }
 
     // Get all objects
     std::vector<ObservedObject> objects() const;
 
-    // Find object by label
+    // Find object by label; uses the producer's label index when present,
+    // touching only a few header cache lines
     ObjectView find(std::string_view label);
 
     // Get object view
@@ -254,11 +282,15 @@ public:
     // Get type by ID
     const ObservedType* get_type(uint32_t type_id) const;
 
-    // Get pointer to object data
+    // Get pointer to object data (maps the region first in Lazy mode)
     void* get_object_data(uint64_t region_id, uint64_t offset);
 
+    // Number of region segments currently mapped
+    size_t mapped_regions() const { return region_shms_.size(); }
+
 private:
     std::string session_name_;
+    ObserverOptions options_;
     bool connected_ = false;
 
     detail::SharedMemory header_shm_;
@@ -266,12 +298,16 @@ private:
 
     std::unordered_map<uint64_t, detail::SharedMemory> region_shms_;
     std::unordered_map<uint64_t, detail::SharedMemory> overflow_shms_;
-    std::vector<ObservedType> types_;
-    std::unordered_map<uint32_t, size_t> type_id_to_index_;
+    std::shared_ptr<SchemaCache> schema_cache_;
+    std::shared_ptr<const Schema> schema_;
     uint64_t last_sequence_ = 0;
 
     void load_types();
     void load_regions();
+    detail::SharedMemory* map_region(uint64_t region_id);
+    detail::MapOptions map_options(bool populate) const;
+    const std::atomic<uint64_t>* label_index() const;
+    std::atomic<uint32_t>* paused_flag() const;
     void load_overflow_regions();
 };
 
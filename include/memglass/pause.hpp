@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace memglass {
+
+// Runtime kill switch for publishing. While paused the producer skips work
+// that only serves observers: mark()/cycle_end() events and rolling
+// statistics updates. Object data is still written, so the producer's own
+// state stays correct, and observers see the objects frozen at whatever
+// they last published.
+//
+// Observers flip the switch of a live producer through the session header
+// (Observer::set_paused, `memglass pause <session>`), without a restart.
+// Hot paths can test paused() themselves to skip their own publishing.
+//
+// Building with MEMGLASS_DISABLE compiles the producer API out instead:
+// see memglass.hpp. paused() is then a constant false, so instrumentation
+// keeps running as plain in-process stores.
+
+#ifdef MEMGLASS_DISABLE
+
+inline namespace disabled {
+
+constexpr bool paused() { return false; }
+inline void set_paused(bool) {}
+
+} // namespace disabled
+
+#else
+
+namespace detail {
+
+// Switch used before init() and after shutdown(); while a session is live
+// paused_flag points at its TelemetryHeader::paused instead
+inline std::atomic<uint32_t> local_paused{0};
+inline std::atomic<uint32_t>* paused_flag = &local_paused;
+
+} // namespace detail
+
+// One relaxed load, cheap enough to test on every update
+inline bool paused() {
+    return detail::paused_flag->load(std::memory_order_relaxed) != 0;
+}
+
+// Pause or resume publishing from the producer itself
+inline void set_paused(bool paused) {
+    detail::paused_flag->store(paused ? 1 : 0, std::memory_order_relaxed);
+}
+
+#endif
+
+} // namespace memglass
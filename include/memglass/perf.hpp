@@ -0,0 +1,148 @@
+#pragma once
+
+#include "stats.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace memglass {
+
+// Wall time and hardware counters of instrumented scopes. A ScopeTimer
+// reads the calling thread's counters on entry and exit and adds the
+// difference to a ScopeStats embedded in an observed struct, which
+// publishes totals and per-call figures (IPC, misses per call) as atomic
+// fields like the rolling statistics in stats.hpp:
+//
+//     struct Worker {
+//         memglass::ScopeStats decode;
+//         memglass::ScopeStats match;
+//     };
+//     memglass::ScopeStats::describe(desc, "decode", offsetof(Worker, decode));
+//
+//     void on_packet(Worker* w, ...) {
+//         memglass::ScopeTimer t(w->decode);
+//         ...
+//     }
+//
+// Counters (cycles, instructions, LLC misses, branch misses) come from a
+// perf_event group opened per thread on its first scope and read in user
+// space with rdpmc, without syscalls. Where that is not allowed (no PMU in
+// a VM, perf_event_paranoid, not x86) scopes are timed only, and
+// ScopeStats::counters reads 0.
+//
+// A ScopeStats has a single writer: give each thread its own, e.g. one
+// observed object per worker thread. Scopes are not timed while publishing
+// is paused, and ScopeTimer compiles to nothing with MEMGLASS_DISABLE.
+
+// Counter readings of the calling thread
+struct PerfSample {
+    uint64_t ns = 0;               // steady_clock
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+    uint64_t branch_misses = 0;
+    bool counters = false;         // false: timing only
+};
+
+// Read the calling thread's counters, opening them on first use
+PerfSample perf_sample();
+
+// Whether perf_sample() reads hardware counters on this thread
+bool perf_counters_available();
+
+// Inline namespace with MEMGLASS_DISABLE, like the stats types
+#ifdef MEMGLASS_DISABLE
+inline namespace disabled {
+#endif
+
+struct ScopeStats {
+    // Totals
+    uint64_t calls = 0;
+    uint64_t total_ns = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+    uint64_t branch_misses = 0;
+
+    // Per call, and instructions per cycle; 0 without counters
+    double ns_per_call = 0;
+    double ipc = 0;
+    double llc_misses_per_call = 0;
+    double branch_misses_per_call = 0;
+
+    uint32_t counters = 0;  // 1 if the counters were read, 0 if timing only
+
+    void add(const PerfSample& begin, const PerfSample& end) {
+        if (paused()) return;
+        uint64_t n = calls + 1;
+        detail::publish(total_ns, total_ns + (end.ns - begin.ns));
+        detail::publish(ns_per_call, static_cast<double>(total_ns) / static_cast<double>(n));
+        if (begin.counters && end.counters) {
+            detail::publish(cycles, cycles + (end.cycles - begin.cycles));
+            detail::publish(instructions, instructions + (end.instructions - begin.instructions));
+            detail::publish(llc_misses, llc_misses + (end.llc_misses - begin.llc_misses));
+            detail::publish(branch_misses, branch_misses + (end.branch_misses - begin.branch_misses));
+            if (cycles) {
+                detail::publish(ipc, static_cast<double>(instructions) / static_cast<double>(cycles));
+            }
+            detail::publish(llc_misses_per_call, static_cast<double>(llc_misses) / static_cast<double>(n));
+            detail::publish(branch_misses_per_call,
+                            static_cast<double>(branch_misses) / static_cast<double>(n));
+            if (!counters) detail::publish(counters, uint32_t{1});
+        }
+        detail::publish(calls, n);
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        TypeDescriptor type{"memglass::ScopeStats", sizeof(ScopeStats), alignof(ScopeStats), {}};
+        detail::describe_stat<uint64_t>(type, "calls", offsetof(ScopeStats, calls));
+        detail::describe_stat<uint64_t>(type, "total_ns", offsetof(ScopeStats, total_ns));
+        detail::describe_stat<uint64_t>(type, "cycles", offsetof(ScopeStats, cycles));
+        detail::describe_stat<uint64_t>(type, "instructions", offsetof(ScopeStats, instructions));
+        detail::describe_stat<uint64_t>(type, "llc_misses", offsetof(ScopeStats, llc_misses));
+        detail::describe_stat<uint64_t>(type, "branch_misses", offsetof(ScopeStats, branch_misses));
+        detail::describe_stat<double>(type, "ns_per_call", offsetof(ScopeStats, ns_per_call));
+        detail::describe_stat<double>(type, "ipc", offsetof(ScopeStats, ipc));
+        detail::describe_stat<double>(type, "llc_misses_per_call",
+                                      offsetof(ScopeStats, llc_misses_per_call));
+        detail::describe_stat<double>(type, "branch_misses_per_call",
+                                      offsetof(ScopeStats, branch_misses_per_call));
+        detail::describe_stat<uint32_t>(type, "counters", offsetof(ScopeStats, counters));
+        detail::describe_nested(desc, name, offset, type);
+    }
+};
+
+// Adds the enclosing scope to a ScopeStats
+class ScopeTimer {
+public:
+#ifdef MEMGLASS_DISABLE
+    explicit ScopeTimer(ScopeStats&) {}
+#else
+    explicit ScopeTimer(ScopeStats& stats)
+        : stats_(paused() ? nullptr : &stats)
+    {
+        if (stats_) begin_ = perf_sample();
+    }
+
+    ~ScopeTimer() {
+        if (stats_) stats_->add(begin_, perf_sample());
+    }
+#endif
+
+    ScopeTimer(const ScopeTimer&) = delete;
+    ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+#ifndef MEMGLASS_DISABLE
+private:
+    ScopeStats* stats_;
+    PerfSample begin_;
+#endif
+};
+
+#ifdef MEMGLASS_DISABLE
+} // namespace disabled
+#endif
+
+} // namespace memglass
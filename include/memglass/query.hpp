@@ -0,0 +1,101 @@
+#pragma once
+
+#include "mgdf.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace memglass::query {
+
+enum class Aggregation {
+    Last,
+    First,
+    Min,
+    Max,
+    Mean,
+    Sum,
+    Count
+};
+
+// Parse "last", "first", "min", "max", "mean"/"avg", "sum", "count"
+bool parse_aggregation(std::string_view name, Aggregation& agg);
+
+struct Query {
+    std::vector<std::string> labels;  // exact object labels; empty = all
+    std::vector<std::string> fields;  // exact field names; empty = all
+    uint64_t start_ns = 0;
+    uint64_t end_ns = std::numeric_limits<uint64_t>::max();  // exclusive
+
+    // Bucket width for resampling; 0 returns every change unaggregated
+    // (rollup files: every bucket at their own resolution). Buckets are
+    // aligned to multiples of interval_ns since the epoch; on rollup files
+    // interval_ns must be a multiple of the rollup resolution.
+    uint64_t interval_ns = 0;
+    Aggregation aggregation = Aggregation::Last;
+
+    // With Last, repeat the previous value in buckets without changes
+    // (starting from the first change inside the range)
+    bool fill = false;
+
+    unsigned threads = 0;  // 0 = one per core
+};
+
+// One object field as parallel columns. Integer series (except Mean and
+// Sum) are returned exactly in ints; float series, means and sums in doubles.
+struct Series {
+    std::string label;
+    std::string field;
+    PrimitiveType type = PrimitiveType::Unknown;
+    bool integer = false;  // values are in ints, otherwise in doubles
+    std::vector<uint64_t> timestamps;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+
+    size_t size() const { return timestamps.size(); }
+    double value(size_t i) const {
+        return integer ? static_cast<double>(ints[i]) : doubles[i];
+    }
+};
+
+struct QueryStats {
+    size_t blocks_total = 0;
+    size_t blocks_in_range = 0;  // overlapping the time range
+    size_t blocks_decoded = 0;   // also mentioning a wanted label/field
+    uint64_t records = 0;        // diffs, or rollup entries
+    uint64_t points = 0;         // changes (rollup entries) matching the query
+};
+
+struct QueryResult {
+    std::vector<Series> series;  // sorted by label, then field
+    QueryStats stats;
+};
+
+// Decode the blocks of a version 2 recording that can match the query,
+// spread over threads, and build resampled columns
+bool run_query(const mgdf::MappedFile& file, const Query& query, QueryResult& result,
+               std::string* error = nullptr);
+
+struct CompactStats {
+    uint64_t records = 0;  // diffs or rollup entries read
+    uint64_t rollups = 0;  // aggregates written
+    uint64_t bytes = 0;    // output size
+};
+
+// Aggregate a version 2 recording into an interval_ns rollup file. The
+// input is a raw recording, or a rollup file whose resolution divides
+// interval_ns (e.g. 1s rollups compacted into 1m).
+bool compact(const mgdf::MappedFile& file, uint64_t interval_ns, std::ostream& out,
+             CompactStats* stats = nullptr, std::string* error = nullptr);
+
+// "100ms", "1s", "5m", "1h", "250us", "10ns" or plain nanoseconds
+bool parse_duration(std::string_view text, uint64_t& ns);
+
+// Nanoseconds since the epoch, "YYYY-MM-DDTHH:MM[:SS[.frac]]" (UTC) or a
+// time of day "HH:MM[:SS[.frac]]" on the UTC date of reference_ns
+bool parse_time(std::string_view text, uint64_t reference_ns, uint64_t& ns);
+
+} // namespace memglass::query
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "sink.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace memglass {
+
+struct RecorderOptions {
+    SinkSpec output{SinkFormat::Binary, "recording.mgd"};
+    std::chrono::milliseconds interval{100};  // Capture period
+    bool dirty_tracking = true;               // Re-read only written pages (soft-dirty)
+    bool skip_empty = true;                   // Don't write diffs without changes
+    int cpu = -1;                             // Pin the recorder thread; -1 leaves it unpinned
+    bool idle_priority = true;                // Run the recorder thread as SCHED_IDLE
+    uint64_t max_read_bytes_per_sec = 0;      // Cap on producer memory re-read; 0 = none
+    size_t queue_depth = 4096;                // Diffs queued for the writer thread
+};
+
+struct RecorderStats {
+    uint64_t captures = 0;      // Capture passes run
+    uint64_t diffs = 0;         // Diffs handed to the sink
+    uint64_t changes = 0;       // Field changes in those diffs
+    uint64_t bytes_read = 0;    // Producer memory re-read, estimated from pages
+    uint64_t throttled_ns = 0;  // Time added to intervals by the read cap
+    uint64_t dropped = 0;       // Diffs the writer queue dropped
+};
+
+// Records the producer's own session from inside the producer: the same
+// diffs memglass-diff would write, without a second process pulling every
+// object across cores. A background thread captures every interval,
+// re-reading only objects on pages written since the last pass when
+// soft-dirty tracking is available, and hands diffs to a writer thread
+// (AsyncSink) so encoding and I/O never run on the capture thread.
+//
+// The producer decides what the recording may cost: pin the thread to a
+// housekeeping core, keep it at idle priority, and cap how many bytes of
+// shared memory it re-reads per second. Passes are skipped while
+// publishing is paused.
+//
+//     memglass::init("trading");
+//     memglass::RecorderOptions opts;
+//     opts.output = {memglass::SinkFormat::Binary, "trading.mgd"};
+//     opts.cpu = 15;
+//     memglass::Recorder recorder(opts);
+//     recorder.start();
+//     ...
+//     recorder.stop();
+//     memglass::shutdown();
+//
+// Soft-dirty bits are process-wide: don't also run memglass-diff -d
+// against the same producer.
+class Recorder {
+public:
+    explicit Recorder(const RecorderOptions& options = {});
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Start recording the current session (memglass::init() first). False,
+    // with error set, if there is no session or the output can't be opened.
+    bool start(std::string* error = nullptr);
+
+    // Take a last capture, then flush and close the output. Call before
+    // memglass::shutdown().
+    void stop();
+
+    bool running() const { return thread_.joinable(); }
+
+    // Safe to call from any thread while recording
+    RecorderStats stats() const;
+
+private:
+    struct State;
+
+    void run();
+    uint64_t capture();  // returns the bytes re-read
+    bool configure_thread(std::string* error);
+
+    RecorderOptions options_;
+    std::unique_ptr<State> state_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    std::atomic<uint64_t> captures_{0};
+    std::atomic<uint64_t> diffs_{0};
+    std::atomic<uint64_t> changes_{0};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> throttled_ns_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace memglass
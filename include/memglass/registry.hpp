@@ -17,7 +17,7 @@ struct FieldDescriptor {
     uint32_t offset;
     uint32_t size;
     PrimitiveType primitive_type;
-    uint32_t user_type_id;  // For nested types
+    uint32_t user_type_id;  // Nested struct: its registered type (primitive_type Unknown)
     uint32_t array_size;    // 0 = not array
     Atomicity atomicity;
     bool readonly;
@@ -51,6 +51,10 @@ const std::vector<std::pair<uint32_t, TypeDescriptor>>& get_all_types();
 // Clear registry (for testing)
 void clear();
 
+// Copy a generated field name (e.g. "latency.mean") into storage that
+// outlives the registry, for FieldDescriptor::name
+std::string_view intern(std::string_view name);
+
 // Write types to shared memory header
 void write_to_header(TelemetryHeader* header, void* base);
 
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace memglass {
+
+// A field reached from some type by a path such as "bid", "quote.bid" or
+// "book.bids[3].qty". entry is shared with every other type embedding the
+// same nested type; base locates the instance that declares it.
+struct FieldRef {
+    const FieldEntry* entry = nullptr;  // as published by its own type
+    uint32_t base = 0;                  // offset of that type's instance in the outer type
+
+    uint32_t offset() const { return base + entry->offset; }
+    explicit operator bool() const { return entry != nullptr; }
+};
+
+// Type information as seen by observer
+struct ObservedType {
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    uint32_t type_id;
+    std::string name;
+    uint32_t size;
+    uint32_t alignment;
+
+    // Fields as published. A nested struct (FieldFlags::IsNested) is one
+    // field whose type_id is the nested type; its fields are not copied here.
+    std::vector<FieldEntry> fields;
+
+    // Per field: the nested type it embeds, shared by every parent, or
+    // nullptr for leaves and for unknown, cyclic or oversized references
+    std::vector<const ObservedType*> nested_types;
+
+    // Index into fields by name, so lookups don't scan the field list
+    std::unordered_map<std::string, size_t, NameHash, std::equal_to<>> field_index;
+
+    // Guarded<T> and primitive Locked<T> fields, nested ones included: the
+    // ones a bulk copy has to validate
+    std::vector<FieldRef> guarded_fields;
+
+    // A field by name, else a dotted path walked through nested types
+    // ("quote.bid", "levels[1].bid")
+    FieldRef find_field(std::string_view path) const;
+
+    // Calls fn(path, ref) for every leaf, descending into nested types as
+    // it goes; array elements of nested structs are visited one by one
+    template<typename Fn>
+    void for_each_leaf(Fn&& fn) const {
+        std::string path;
+        visit_leaves(path, 0, fn);
+    }
+
+private:
+    template<typename Fn>
+    void visit_leaves(std::string& path, uint32_t base, Fn& fn) const {
+        size_t prefix = path.size();
+        for (size_t j = 0; j < fields.size(); ++j) {
+            const FieldEntry& f = fields[j];
+            path.append(f.name, strnlen(f.name, sizeof(f.name)));
+            const ObservedType* nested = j < nested_types.size() ? nested_types[j] : nullptr;
+            if (!nested) {
+                fn(std::string_view(path), FieldRef{&f, base});
+            } else if (f.flags & static_cast<uint32_t>(FieldFlags::IsArray)) {
+                size_t name_end = path.size();
+                for (uint32_t e = 0; e < f.array_size; ++e) {
+                    path.append("[").append(std::to_string(e)).append("].");
+                    nested->visit_leaves(path, base + f.offset + e * nested->size, fn);
+                    path.resize(name_end);
+                }
+            } else {
+                path.append(1, '.');
+                nested->visit_leaves(path, base + f.offset, fn);
+            }
+            path.resize(prefix);
+        }
+    }
+};
+
+// Parsed type registry of a session. Immutable once built, so every
+// observer whose producer published the same types shares one instance.
+struct Schema {
+    uint64_t fingerprint = 0;
+    std::vector<ObservedType> types;
+    std::unordered_map<uint32_t, size_t> type_id_to_index;
+
+    const ObservedType* get_type(uint32_t type_id) const;
+};
+
+// Schemas keyed on a fingerprint of the published TypeEntry/FieldEntry
+// contents. Sessions of the same binary hash to the same fingerprint and
+// are parsed once; observers keep the schema alive, the cache only holds
+// weak references. Thread-safe.
+class SchemaCache {
+public:
+    // Process-wide cache used by observers that don't supply their own
+    static const std::shared_ptr<SchemaCache>& shared();
+
+    // Schema of the types currently published in this header
+    std::shared_ptr<const Schema> load(const TelemetryHeader* header);
+
+    // Schemas still referenced by some observer
+    size_t size() const;
+
+    size_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    size_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, std::weak_ptr<const Schema>> schemas_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+};
+
+} // namespace memglass
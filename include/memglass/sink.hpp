@@ -0,0 +1,234 @@
+#pragma once
+
+#include "diff.hpp"
+#include "mgdf.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace memglass {
+
+// Contents of a JSON string, without the quotes; shared by the sinks and
+// the tools so labels and field names are escaped the same way everywhere
+void append_json_escaped(std::string& out, std::string_view s);
+
+// A CSV cell, quoted only when it holds a comma, quote or line break
+void append_csv_field(std::string& out, std::string_view s);
+
+// Byte destination for a sink: stdout, a file or a local stream socket
+class SinkOutput {
+public:
+    SinkOutput() = default;
+    ~SinkOutput();
+
+    SinkOutput(const SinkOutput&) = delete;
+    SinkOutput& operator=(const SinkOutput&) = delete;
+
+    // Target syntax: "-" (stdout), "unix:<path>" (connect to a unix stream
+    // socket) or a file path (truncated)
+    bool open(std::string_view target, std::string* error = nullptr);
+
+    // Write all bytes; returns false once the destination has failed
+    bool write(std::string_view data);
+
+    void close();
+
+    bool is_open() const { return fd_ != -1; }
+    bool failed() const { return failed_; }
+    const std::string& target() const { return target_; }
+
+private:
+    int fd_ = -1;
+    bool owns_fd_ = false;
+    bool is_socket_ = false;
+    bool failed_ = false;
+    std::string target_;
+};
+
+// Receives diffs from one capture. write() encodes into an internal batch,
+// flush() hands the batch to the output, close() writes any trailer.
+class DiffSink {
+public:
+    virtual ~DiffSink() = default;
+
+    virtual void write(const SnapshotDiff& diff) = 0;
+    virtual void flush() = 0;
+    virtual void close() { flush(); }
+
+    // Shared-ownership entry point used when one diff fans out to several
+    // sinks; asynchronous sinks keep the pointer instead of copying the diff
+    virtual void submit(const std::shared_ptr<const SnapshotDiff>& diff) { write(*diff); }
+
+    // Diffs dropped because the sink could not keep up
+    virtual uint64_t dropped() const { return 0; }
+
+    virtual std::string_view name() const = 0;
+};
+
+// Base for sinks that encode into a reusable byte buffer
+class BufferedSink : public DiffSink {
+public:
+    void flush() override;
+    void close() override;
+
+protected:
+    BufferedSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes);
+
+    // Flush once the batch grows past batch_bytes
+    void maybe_flush();
+
+    std::string buffer_;
+    std::unique_ptr<SinkOutput> out_;
+
+private:
+    size_t batch_bytes_;
+};
+
+// Compact human-readable text (one block per diff)
+class TextSink : public BufferedSink {
+public:
+    explicit TextSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes = 64 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    std::string_view name() const override { return "text"; }
+};
+
+// One JSON object per diff (JSONL), optionally pretty-printed
+class JsonSink : public BufferedSink {
+public:
+    JsonSink(std::unique_ptr<SinkOutput> out, bool pretty, size_t batch_bytes = 64 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    std::string_view name() const override { return pretty_ ? "json-pretty" : "json"; }
+
+private:
+    bool pretty_;
+};
+
+// CSV with a fixed column order:
+//   timestamp_ns,sequence,event,object,field,type,old,new
+class CsvSink : public BufferedSink {
+public:
+    explicit CsvSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes = 256 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    std::string_view name() const override { return "csv"; }
+
+private:
+    bool header_written_ = false;
+};
+
+// InfluxDB line protocol; changed fields of one object share a line
+class LineProtocolSink : public BufferedSink {
+public:
+    LineProtocolSink(std::unique_ptr<SinkOutput> out, std::string_view session,
+                     size_t batch_bytes = 256 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    std::string_view name() const override { return "influx"; }
+
+private:
+    std::string session_tag_;
+};
+
+// Newline-delimited JSON with one record per change or object event
+class NdjsonSink : public BufferedSink {
+public:
+    explicit NdjsonSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes = 256 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    std::string_view name() const override { return "ndjson"; }
+};
+
+// MGDF binary stream (version 2 blocks with a trailing index)
+class MgdfSink : public BufferedSink {
+public:
+    explicit MgdfSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes = 1024 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    void close() override;
+    std::string_view name() const override { return "binary"; }
+
+private:
+    mgdf::BlockWriter writer_;
+    bool header_written_ = false;
+    bool closed_ = false;
+};
+
+// MGDF rollup file: per-interval first/last/min/max/count/sum of each
+// changed field instead of the changes themselves
+class RollupSink : public BufferedSink {
+public:
+    RollupSink(std::unique_ptr<SinkOutput> out, uint64_t interval_ns,
+               size_t batch_bytes = 256 * 1024);
+    void write(const SnapshotDiff& diff) override;
+    void close() override;
+    std::string_view name() const override { return "rollup"; }
+
+private:
+    mgdf::RollupWriter writer_;
+    bool header_written_ = false;
+    bool closed_ = false;
+};
+
+// Runs another sink on its own thread behind a bounded queue. The capture
+// thread never blocks on I/O; diffs are dropped (and counted) when full.
+class AsyncSink : public DiffSink {
+public:
+    explicit AsyncSink(std::unique_ptr<DiffSink> inner, size_t max_queue = 4096);
+    ~AsyncSink() override;
+
+    void write(const SnapshotDiff& diff) override;
+    void submit(const std::shared_ptr<const SnapshotDiff>& diff) override;
+    void flush() override;
+    void close() override;
+
+    uint64_t dropped() const override { return dropped_.load(std::memory_order_relaxed); }
+    std::string_view name() const override { return inner_->name(); }
+
+private:
+    void run();
+
+    std::unique_ptr<DiffSink> inner_;
+    size_t max_queue_;
+    std::vector<std::shared_ptr<const SnapshotDiff>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool flush_requested_ = false;
+    bool stop_ = false;
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+};
+
+// Output formats understood by make_sink
+enum class SinkFormat {
+    Text,
+    Json,
+    JsonPretty,
+    Binary,
+    Csv,
+    LineProtocol,
+    Ndjson,
+    Rollup
+};
+
+struct SinkSpec {
+    SinkFormat format = SinkFormat::Text;
+    std::string target = "-";
+    uint64_t rollup_interval_ns = 0;  // SinkFormat::Rollup bucket width
+};
+
+// Parse a format name ("text", "json", "json-pretty", "binary"/"mgdf",
+// "csv", "influx"/"line", "ndjson", or "rollup-<duration>" such as
+// "rollup-1s") into spec's format and rollup interval
+bool parse_sink_format(std::string_view name, SinkSpec& spec);
+
+// Parse "<format>[:<target>]", e.g. "binary:day.mgd", "rollup-1m:day.1m.mgd"
+// or "influx:unix:/run/telegraf.sock"
+bool parse_sink_spec(std::string_view spec, SinkSpec& out);
+
+// Create a sink writing to spec.target; returns nullptr and sets error on failure
+std::unique_ptr<DiffSink> make_sink(const SinkSpec& spec, std::string_view session,
+                                    std::string* error = nullptr);
+
+} // namespace memglass
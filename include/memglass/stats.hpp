@@ -0,0 +1,347 @@
+#pragma once
+
+#include "pause.hpp"
+#include "registry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace memglass {
+
+// Rolling statistics computed by the producer at full event resolution.
+// Embed them in an observed struct and update them on the hot path; the
+// results are published as atomic fields, so observers read exact values
+// instead of re-deriving them from whatever samples they happen to catch.
+//
+// Each type has a single writer. Results are stored one field at a time,
+// so a reader may see e.g. a mean one sample newer than the count.
+//
+// Register them with describe(), which registers the stats type once and
+// appends a nested field of it to the enclosing type's descriptor;
+// observers see the results as "<name>.mean", ...:
+//
+//     struct Engine {
+//         memglass::Ewma latency;
+//         memglass::WindowStats<10> spread;
+//     };
+//     memglass::Ewma::describe(desc, "latency", offsetof(Engine, latency));
+//     memglass::WindowStats<10>::describe(desc, "spread", offsetof(Engine, spread));
+//
+// memglass-gen emits these calls for fields of these types.
+//
+// Updates are skipped while publishing is paused (pause.hpp): results
+// freeze and samples taken meanwhile are not counted. With
+// MEMGLASS_DISABLE the types and publish() move to an inline namespace
+// and store plainly, so they never clash with the library's definitions.
+
+namespace detail {
+
+#ifdef MEMGLASS_DISABLE
+inline namespace disabled {
+
+template<typename T>
+inline void publish(T& field, T value) {
+    field = value;
+}
+
+} // namespace disabled
+#else
+// Store a result that observers read with Atomicity::Atomic
+template<typename T>
+inline void publish(T& field, T value) {
+    std::atomic_ref<T>(field).store(value, std::memory_order_release);
+}
+#endif
+
+// Add a result field to a stats type's descriptor
+template<typename T>
+inline void describe_stat(TypeDescriptor& type, std::string_view name, size_t offset,
+                          Atomicity atomicity = Atomicity::Atomic) {
+    type.fields.push_back({name, static_cast<uint32_t>(offset), static_cast<uint32_t>(sizeof(T)),
+                           primitive_type_of<T>(), 0, 0, atomicity, atomicity == Atomicity::None});
+}
+
+// Register a stats type (once; later calls find it by name) and append a
+// field of it at offset to desc
+inline void describe_nested(TypeDescriptor& desc, std::string_view name, size_t offset,
+                            const TypeDescriptor& type) {
+    uint32_t type_id = registry::register_type(type);
+    desc.fields.push_back({registry::intern(name), static_cast<uint32_t>(offset), type.size,
+                           PrimitiveType::Unknown, type_id, 0, Atomicity::None, false});
+}
+
+// "memglass::WindowStats<10>" from base and n, in storage that outlives
+// the registry
+inline std::string_view stats_type_name(std::string_view base, uint32_t n) {
+    std::string name(base);
+    name.append(1, '<').append(std::to_string(n)).append(1, '>');
+    return registry::intern(name);
+}
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double Inf = std::numeric_limits<double>::infinity();
+
+} // namespace detail
+
+#ifdef MEMGLASS_DISABLE
+inline namespace disabled {
+#endif
+
+// Exponentially weighted moving average over events: a sample's weight
+// halves every half_life updates. One multiply-add per update.
+struct Ewma {
+    double value = 0;         // result
+    uint64_t count = 0;       // samples seen
+    double half_life = 16;    // in updates
+    double alpha = 0;         // derived from half_life on first use
+
+    void set_half_life(double updates) {
+        half_life = updates;
+        alpha = 0;
+    }
+
+    void update(double x) {
+        if (paused()) return;
+        if (alpha == 0) alpha = 1 - std::exp2(-1.0 / half_life);
+        detail::publish(value, count ? value + alpha * (x - value) : x);
+        detail::publish(count, count + 1);
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        TypeDescriptor type{"memglass::Ewma", sizeof(Ewma), alignof(Ewma), {}};
+        detail::describe_stat<double>(type, "value", offsetof(Ewma, value));
+        detail::describe_stat<uint64_t>(type, "count", offsetof(Ewma, count));
+        detail::describe_stat<double>(type, "half_life", offsetof(Ewma, half_life),
+                                      Atomicity::None);
+        detail::describe_nested(desc, name, offset, type);
+    }
+};
+
+// Time-weighted moving average of a level (a price, a queue depth) sampled
+// at irregular times: each sample counts for as long as it stood, with
+// weight halving every half_life_ns. Costs an exp2() per update; tick()
+// brings the value up to date without a new sample.
+struct TimeEwma {
+    double value = 0;                      // result, as of last_ns
+    uint64_t count = 0;                    // samples seen
+    uint64_t half_life_ns = 1'000'000'000;
+    uint64_t last_ns = 0;
+    double level = 0;                      // latest sample
+
+    void update(double x, uint64_t now_ns) {
+        if (paused()) return;
+        if (count == 0) {
+            detail::publish(value, x);
+            last_ns = now_ns;
+        } else {
+            tick(now_ns);
+        }
+        level = x;
+        detail::publish(count, count + 1);
+    }
+
+    void tick(uint64_t now_ns) {
+        if (paused() || count == 0 || now_ns <= last_ns) return;
+        double w = std::exp2(-static_cast<double>(now_ns - last_ns) / static_cast<double>(half_life_ns));
+        detail::publish(value, level + w * (value - level));
+        last_ns = now_ns;
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        TypeDescriptor type{"memglass::TimeEwma", sizeof(TimeEwma), alignof(TimeEwma), {}};
+        detail::describe_stat<double>(type, "value", offsetof(TimeEwma, value));
+        detail::describe_stat<uint64_t>(type, "count", offsetof(TimeEwma, count));
+        detail::describe_stat<uint64_t>(type, "half_life_ns", offsetof(TimeEwma, half_life_ns),
+                                        Atomicity::None);
+        detail::describe_nested(desc, name, offset, type);
+    }
+};
+
+// Count, sum, mean, min and max of the samples in the last N buckets of
+// bucket_ns each, the current partial bucket included. Buckets are aligned
+// to multiples of bucket_ns since the epoch and fixed, so the oldest leaves
+// the window whole. An update is O(1); starting a bucket is O(N), once per
+// bucket_ns. Empty windows read NaN for mean, min and max.
+template<uint32_t N>
+struct WindowStats {
+    static_assert(N >= 1, "WindowStats needs at least one bucket");
+
+    struct Bucket {
+        uint64_t count = 0;
+        double sum = 0;
+        double min = detail::Inf;
+        double max = -detail::Inf;
+    };
+
+    // Results
+    uint64_t count = 0;
+    double sum = 0;
+    double mean = detail::NaN;
+    double min = detail::NaN;
+    double max = detail::NaN;
+    uint64_t window_ns = N * 100'000'000ull;
+
+    // State
+    uint64_t bucket_ns = 100'000'000;
+    uint64_t bucket_start = 0;
+    uint32_t head = 0;
+    Bucket closed{};     // buckets other than head, combined
+    Bucket buckets[N]{};
+
+    void set_bucket_ns(uint64_t ns) {
+        bucket_ns = ns;
+        window_ns = ns * N;
+    }
+
+    void update(double x, uint64_t now_ns) {
+        if (paused()) return;
+        advance(now_ns);
+        Bucket& b = buckets[head];
+        b.count++;
+        b.sum += x;
+        if (x < b.min) b.min = x;
+        if (x > b.max) b.max = x;
+        publish_results();
+    }
+
+    // Drop buckets that left the window without adding a sample
+    void tick(uint64_t now_ns) {
+        if (!paused() && now_ns >= bucket_start + bucket_ns) {
+            advance(now_ns);
+            publish_results();
+        }
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        TypeDescriptor type{detail::stats_type_name("memglass::WindowStats", N),
+                            sizeof(WindowStats), alignof(WindowStats), {}};
+        detail::describe_stat<uint64_t>(type, "count", offsetof(WindowStats, count));
+        detail::describe_stat<double>(type, "sum", offsetof(WindowStats, sum));
+        detail::describe_stat<double>(type, "mean", offsetof(WindowStats, mean));
+        detail::describe_stat<double>(type, "min", offsetof(WindowStats, min));
+        detail::describe_stat<double>(type, "max", offsetof(WindowStats, max));
+        detail::describe_stat<uint64_t>(type, "window_ns", offsetof(WindowStats, window_ns),
+                                        Atomicity::None);
+        detail::describe_nested(desc, name, offset, type);
+    }
+
+private:
+    void advance(uint64_t now_ns) {
+        if (now_ns < bucket_start + bucket_ns) return;  // also samples from the past
+
+        uint64_t steps = (now_ns - bucket_start) / bucket_ns;
+        for (uint64_t i = 0; i < std::min<uint64_t>(steps, N); ++i) {
+            head = (head + 1) % N;
+            buckets[head] = Bucket{};
+        }
+        bucket_start += steps * bucket_ns;
+
+        closed = Bucket{};
+        for (uint32_t i = 0; i < N; ++i) {
+            if (i == head) continue;
+            const Bucket& b = buckets[i];
+            closed.count += b.count;
+            closed.sum += b.sum;
+            closed.min = std::min(closed.min, b.min);
+            closed.max = std::max(closed.max, b.max);
+        }
+    }
+
+    void publish_results() {
+        const Bucket& b = buckets[head];
+        uint64_t n = closed.count + b.count;
+        double s = closed.sum + b.sum;
+        detail::publish(count, n);
+        detail::publish(sum, s);
+        detail::publish(mean, n ? s / static_cast<double>(n) : detail::NaN);
+        detail::publish(min, n ? std::min(closed.min, b.min) : detail::NaN);
+        detail::publish(max, n ? std::max(closed.max, b.max) : detail::NaN);
+    }
+};
+
+// Events (or amounts) per second over the last N buckets of bucket_ns,
+// bucketed like WindowStats. The rate divides by the time the window
+// covers, or by the time since the first add() while the meter is younger
+// than the window (at least one bucket).
+template<uint32_t N>
+struct RateMeter {
+    static_assert(N >= 1, "RateMeter needs at least one bucket");
+
+    // Results
+    double rate = 0;     // per second
+    uint64_t total = 0;  // since creation
+    uint64_t window_ns = N * 100'000'000ull;
+
+    // State
+    uint64_t bucket_ns = 100'000'000;
+    uint64_t bucket_start = 0;
+    uint64_t first_ns = 0;
+    uint32_t head = 0;
+    uint64_t closed = 0;  // buckets other than head, combined
+    uint64_t buckets[N]{};
+
+    void set_bucket_ns(uint64_t ns) {
+        bucket_ns = ns;
+        window_ns = ns * N;
+    }
+
+    void add(uint64_t n, uint64_t now_ns) {
+        if (paused()) return;
+        if (first_ns == 0) first_ns = now_ns;
+        advance(now_ns);
+        buckets[head] += n;
+        detail::publish(total, total + n);
+        publish_rate(now_ns);
+    }
+
+    void tick(uint64_t now_ns) {
+        if (paused() || first_ns == 0 || now_ns < bucket_start) return;
+        advance(now_ns);
+        publish_rate(now_ns);
+    }
+
+    static void describe(TypeDescriptor& desc, std::string_view name, size_t offset) {
+        TypeDescriptor type{detail::stats_type_name("memglass::RateMeter", N),
+                            sizeof(RateMeter), alignof(RateMeter), {}};
+        detail::describe_stat<double>(type, "rate", offsetof(RateMeter, rate));
+        detail::describe_stat<uint64_t>(type, "total", offsetof(RateMeter, total));
+        detail::describe_stat<uint64_t>(type, "window_ns", offsetof(RateMeter, window_ns),
+                                        Atomicity::None);
+        detail::describe_nested(desc, name, offset, type);
+    }
+
+private:
+    void advance(uint64_t now_ns) {
+        if (now_ns < bucket_start + bucket_ns) return;  // also samples from the past
+
+        uint64_t steps = (now_ns - bucket_start) / bucket_ns;
+        for (uint64_t i = 0; i < std::min<uint64_t>(steps, N); ++i) {
+            head = (head + 1) % N;
+            buckets[head] = 0;
+        }
+        bucket_start += steps * bucket_ns;
+
+        closed = 0;
+        for (uint32_t i = 0; i < N; ++i) {
+            if (i != head) closed += buckets[i];
+        }
+    }
+
+    void publish_rate(uint64_t now_ns) {
+        uint64_t span = (N - 1) * bucket_ns + (now_ns - bucket_start);
+        span = std::max(std::min(span, now_ns - first_ns), bucket_ns);
+        detail::publish(rate, static_cast<double>(closed + buckets[head]) * 1e9 / static_cast<double>(span));
+    }
+};
+
+#ifdef MEMGLASS_DISABLE
+} // namespace disabled
+#endif
+
+} // namespace memglass
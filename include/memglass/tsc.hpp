@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace memglass {
+
+// Cheapest monotonic tick on this CPU: the TSC on x86 (invariant and
+// synchronized across cores on current CPUs), the virtual counter on
+// AArch64, steady_clock nanoseconds elsewhere. Only differences and
+// TscClock conversions are meaningful.
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Converts ticks to wall-clock nanoseconds from an origin pair (tick and
+// wall time read together) and the rate measured against it. The rate
+// gets more precise the longer ago the origin was; calibrate() again from
+// time to time.
+class TscClock {
+public:
+    void set_origin(uint64_t tsc, uint64_t wall_ns) {
+        origin_tsc_ = tsc;
+        origin_ns_ = wall_ns;
+        ns_per_tick_ = 0;
+    }
+
+    // Measure the rate against the origin. If the origin is too recent for
+    // a precise rate, spins for up to min_span first.
+    void calibrate(std::chrono::nanoseconds min_span = std::chrono::milliseconds(10)) {
+        uint64_t tsc = read_tsc();
+        uint64_t ns = wall_now();
+        uint64_t span = static_cast<uint64_t>(min_span.count());
+        if (ns < origin_ns_ + span) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(origin_ns_ + span - ns));
+            tsc = read_tsc();
+            ns = wall_now();
+        }
+        if (tsc > origin_tsc_ && ns > origin_ns_) {
+            ns_per_tick_ = static_cast<double>(ns - origin_ns_) / static_cast<double>(tsc - origin_tsc_);
+        }
+    }
+
+    bool calibrated() const { return ns_per_tick_ > 0; }
+    double ns_per_tick() const { return ns_per_tick_; }
+
+    uint64_t to_wall_ns(uint64_t tsc) const {
+        double delta = static_cast<double>(static_cast<int64_t>(tsc - origin_tsc_)) * ns_per_tick_;
+        return origin_ns_ + static_cast<uint64_t>(static_cast<int64_t>(delta));
+    }
+
+    static uint64_t wall_now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    uint64_t origin_tsc_ = 0;
+    uint64_t origin_ns_ = 0;
+    double ns_per_tick_ = 0;
+};
+
+} // namespace memglass
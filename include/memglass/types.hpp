@@ -12,7 +12,11 @@ namespace memglass {
 constexpr uint64_t HEADER_MAGIC = 0x4D454D474C415353ULL;  // "MEMGLASS"
 constexpr uint64_t REGION_MAGIC = 0x5245474E4D454D47ULL;  // "REGNMEMG"
 constexpr uint64_t OVERFLOW_MAGIC = 0x4F56464C574D4547ULL; // "OVFLWMEG"
-constexpr uint32_t PROTOCOL_VERSION = 1;
+constexpr uint64_t EVENTS_MAGIC = 0x5356544E454D454DULL;   // "MEMENTVS"
+constexpr uint64_t CDC_MAGIC = 0x43444347454D454DULL;      // "MEMEGCDC"
+constexpr uint64_t STAMPS_MAGIC = 0x53504D5453454D4DULL;   // "MMESTMPS"
+constexpr uint64_t HEARTBEATS_MAGIC = 0x54414542544D454DULL; // "MEMTBEAT"
+constexpr uint32_t PROTOCOL_VERSION = 2;
 
 // Primitive type IDs for reflection
 enum class PrimitiveType : uint32_t {
@@ -100,12 +104,27 @@ struct TypeEntry {
 };
 static_assert(std::is_trivially_copyable_v<TypeEntry>);
 
+// An object's generation and ObjectState share one word, so destroying
+// through a handle checks both with a single compare-and-swap
+constexpr uint64_t object_status(uint64_t generation, ObjectState state) {
+    return (generation << 2) | static_cast<uint64_t>(state);
+}
+
+constexpr ObjectState status_state(uint64_t status) {
+    return static_cast<ObjectState>(status & 3);
+}
+
+constexpr uint64_t status_generation(uint64_t status) {
+    return status >> 2;
+}
+
 struct ObjectEntry {
-    std::atomic<uint32_t> state;  // ObjectState
+    std::atomic<uint64_t> status; // object_status(generation, state); the
+                                  // generation is incremented on reuse
     uint32_t type_id;             // References TypeEntry
+    uint32_t reserved;
     uint64_t region_id;           // Which region contains the object
     uint64_t offset;              // Offset within that region
-    uint64_t generation;          // Incremented on reuse (ABA prevention)
     char label[64];               // Instance label
 
     void set_label(std::string_view l) {
@@ -194,9 +213,167 @@ struct TelemetryHeader {
     char session_name[64];               // Human-readable session identifier
     uint64_t producer_pid;               // Producer process ID
     uint64_t start_timestamp;            // When session started
+
+    // Label index over the header object directory (detail/label_index.hpp).
+    // Absent when header_size does not cover these fields.
+    uint64_t label_index_offset;
+    uint32_t label_index_capacity;       // Power of two
+    std::atomic<uint32_t> label_index_complete; // 0 once an object is not indexed
+
+    // Publishing kill switch (pause.hpp), set by the producer or by a
+    // writable observer. Absent when header_size does not cover it.
+    std::atomic<uint32_t> paused;
+
+    // Odd while an erase moves label index entries. Readers do not trust
+    // the index when header_size does not cover it.
+    std::atomic<uint32_t> label_index_seq;
 };
 static_assert(std::is_trivially_copyable_v<TelemetryHeader>);
 
+// Producer events published to the events segment
+enum class EventKind : uint32_t {
+    CycleEnd = 1,  // memglass::cycle_end()
+    Mark = 2       // memglass::mark(name)
+};
+
+struct EventEntry {
+    // 2n+1 while event n is being written, 2n+2 once it is complete
+    std::atomic<uint64_t> stamp;
+    uint64_t epoch;                      // Completed cycles when published
+    uint64_t timestamp_ns;               // steady_clock
+    uint32_t kind;                       // EventKind
+    uint32_t reserved;
+    char name[32];                       // Mark name, empty for CycleEnd
+
+    void set_name(std::string_view n) {
+        size_t len = std::min(n.size(), sizeof(name) - 1);
+        std::memcpy(name, n.data(), len);
+        name[len] = '\0';
+    }
+};
+static_assert(sizeof(EventEntry) == 64);
+
+// Events segment: a ring of EventEntry after this header. Observers map it
+// writable to set the waiter flag; it holds no producer data.
+struct EventRingHeader {
+    uint64_t magic;                      // EVENTS_MAGIC
+    uint32_t capacity;                   // Entries, power of two
+    uint32_t entries_offset;             // Offset to EventEntry array
+    std::atomic<uint64_t> head;          // Events published so far
+    std::atomic<uint64_t> epoch;         // Completed cycles
+    alignas(64) std::atomic<uint32_t> futex; // Bumped on every publish
+    std::atomic<uint32_t> waiters;       // Set by sleepers, cleared on wake
+};
+static_assert(std::is_trivially_copyable_v<EventRingHeader>);
+
+// One tracked store (cdc.hpp), as logged by the producer
+struct CdcRecord {
+    uint64_t tsc;                        // read_tsc() at the store
+    uint64_t address;                    // Producer address of the field
+    uint64_t value;                      // Stored bytes, zero-extended
+    uint32_t size;                       // Bytes of value (1-8)
+    uint32_t reserved;
+};
+static_assert(sizeof(CdcRecord) == 32);
+
+// Ring of CdcRecord owned by one producer thread at a time and drained by
+// one consumer. A full ring drops new records and counts them.
+struct CdcRing {
+    std::atomic<uint32_t> owner;         // 0 = free, 1 = claimed by a thread
+    uint32_t reserved;
+    std::atomic<uint64_t> dropped;       // Records lost to a full ring
+    alignas(64) std::atomic<uint64_t> head; // Records written (producer)
+    alignas(64) std::atomic<uint64_t> tail; // Records consumed (consumer)
+};
+static_assert(std::is_trivially_copyable_v<CdcRing>);
+
+// Where a data region is mapped in the producer, so consumers can turn a
+// record's address into (region, offset)
+struct CdcRegion {
+    uint64_t region_id;
+    uint64_t base;
+    uint64_t size;
+};
+
+constexpr uint32_t CDC_MAX_REGIONS = 256;
+
+// Change-data-capture segment: this header, then ring_count rings of
+// ring_stride bytes, each a CdcRing followed by its records. Consumers
+// map it writable to advance the tails.
+struct CdcHeader {
+    uint64_t magic;                      // CDC_MAGIC
+    uint32_t ring_count;
+    uint32_t ring_capacity;              // Records per ring, power of two
+    uint64_t rings_offset;               // Offset to the first ring
+    uint64_t ring_stride;                // Bytes per ring, records included
+    uint32_t records_offset;             // Offset of the records within a ring
+    uint32_t reserved;
+    uint64_t origin_tsc;                 // read_tsc() at session start...
+    uint64_t origin_ns;                  // ...and the system_clock time with it
+    std::atomic<uint64_t> unowned_drops; // Records from threads that found no free ring
+    std::atomic<uint32_t> region_count;  // Entries of regions published
+    uint32_t reserved2;
+    CdcRegion regions[CDC_MAX_REGIONS];
+};
+static_assert(std::is_trivially_copyable_v<CdcHeader>);
+
+// One stage boundary crossed by a sampled message (memglass::stamp)
+struct StampEntry {
+    // 2n+1 while stamp n is being written, 2n+2 once it is complete
+    std::atomic<uint64_t> seq;
+    uint64_t message_id;
+    uint64_t tsc;                        // read_tsc() at the boundary
+    uint32_t stage;
+    uint32_t reserved;
+};
+static_assert(sizeof(StampEntry) == 32);
+
+constexpr uint32_t MAX_STAGES = 32;
+
+// Stamps segment: a ring of StampEntry after this header, written by any
+// producer thread, same protocol as the events ring
+struct StampRingHeader {
+    uint64_t magic;                      // STAMPS_MAGIC
+    uint32_t capacity;                   // Entries, power of two
+    uint32_t entries_offset;             // Offset to StampEntry array
+    uint64_t sample_mask;                // Messages whose mixed id & mask is 0 are stamped
+    uint64_t origin_tsc;                 // read_tsc() at session start...
+    uint64_t origin_ns;                  // ...and the system_clock time with it
+    std::atomic<uint64_t> head;          // Stamps published so far
+    std::atomic<uint32_t> stage_count;   // 1 + highest stage named or stamped
+    uint32_t reserved;
+    char stage_names[MAX_STAGES][32];    // define_stage() names, empty if unnamed
+};
+static_assert(std::is_trivially_copyable_v<StampRingHeader>);
+
+enum class HeartbeatState : uint32_t {
+    Free = 0,
+    Claiming = 1,   // A thread is filling in the slot
+    Active = 2,
+};
+
+// One producer thread's heartbeat (memglass::heartbeat). Only the owning
+// thread writes it, on a cache line of its own.
+struct alignas(64) HeartbeatSlot {
+    std::atomic<uint64_t> count;         // Loop iterations so far
+    std::atomic<uint64_t> tsc;           // read_tsc() at the last beat
+    std::atomic<uint32_t> state;         // HeartbeatState
+    uint32_t tid;                        // Kernel thread id
+    uint64_t max_silence_ns;             // Thread's own stall threshold, 0: observer's
+    char name[32];
+};
+static_assert(sizeof(HeartbeatSlot) == 64);
+
+// Heartbeats segment: slot_count HeartbeatSlots after this header
+struct HeartbeatHeader {
+    uint64_t magic;                      // HEARTBEATS_MAGIC
+    uint32_t slot_count;
+    uint32_t slots_offset;               // Offset to the HeartbeatSlot array
+    uint64_t origin_tsc;                 // read_tsc() at session start...
+    uint64_t origin_ns;                  // ...and the system_clock time with it
+};
+static_assert(std::is_trivially_copyable_v<HeartbeatHeader>);
+
 // Configuration
 struct Config {
     size_t initial_region_size = 1024 * 1024;       // 1 MB
@@ -205,6 +382,12 @@ struct Config {
     uint32_t max_types = 256;
     uint32_t max_fields = 4096;
     uint32_t max_objects = 4096;
+    uint32_t event_ring_capacity = 1024;            // 0 disables mark()/cycle_end()
+    uint32_t cdc_ring_capacity = 0;                 // Records per thread ring; 0 disables CDC
+    uint32_t cdc_rings = 16;                        // Producer threads that can log at once
+    uint32_t stamp_ring_capacity = 0;               // Stage stamps kept; 0 disables stamp()
+    uint32_t stamp_sample_every = 1;                // Stamp 1 in N messages (rounded to a power of two)
+    uint32_t heartbeat_slots = 0;                   // Threads that can heartbeat; 0 disables heartbeat()
 };
 
 // Type trait to check if a type is observable (POD)
@@ -1,6 +1,9 @@
 #include "memglass/allocator.hpp"
 #include "memglass/memglass.hpp"
+#include "memglass/cdc.hpp"
+#include "memglass/detail/label_index.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 namespace memglass {
@@ -55,6 +58,11 @@ RegionManager::Region* RegionManager::create_region(size_t size) {
     region->descriptor->next_region_id.store(0, std::memory_order_release);
     region->descriptor->set_shm_name(shm_name);
 
+    // Let CDC readers map tracked addresses back to this region
+    if (CdcHeader* cdc = ctx_.cdc()) {
+        detail::cdc_add_region(cdc, region->id, region->shm.data(), total_size);
+    }
+
     // Link to previous region if exists
     if (!regions_.empty()) {
         regions_.back()->descriptor->next_region_id.store(
@@ -63,6 +71,7 @@ RegionManager::Region* RegionManager::create_region(size_t size) {
 
     Region* ptr = region.get();
     regions_.push_back(std::move(region));
+    current_.store(ptr, std::memory_order_release);
     return ptr;
 }
 
@@ -71,41 +80,58 @@ RegionManager::Region* RegionManager::current_region() {
     return regions_.back().get();
 }
 
-void* RegionManager::allocate(size_t size, size_t alignment) {
+void* RegionManager::try_allocate(Region* region, size_t size, size_t alignment,
+                                  uint64_t* region_id, uint64_t* offset) {
+    auto& used = region->descriptor->used;
+    uint64_t current = used.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t aligned = (current + alignment - 1) & ~(uint64_t{alignment} - 1);
+        uint64_t new_used = aligned + size;
+        if (new_used > region->descriptor->size) {
+            return nullptr;
+        }
+        if (used.compare_exchange_weak(current, new_used, std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+            if (region_id) *region_id = region->id;
+            if (offset) *offset = aligned;
+            return static_cast<char*>(region->shm.data()) + aligned;
+        }
+    }
+}
+
+void* RegionManager::allocate(size_t size, size_t alignment,
+                              uint64_t* region_id, uint64_t* offset) {
+    // Fast path: bump the current region without the lock
+    if (Region* region = current_.load(std::memory_order_acquire)) {
+        if (void* ptr = try_allocate(region, size, alignment, region_id, offset)) {
+            return ptr;
+        }
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
 
+    // Another thread may have added a region while we waited
     Region* region = current_region();
     if (!region) return nullptr;
-
-    // Align the current position
-    uint64_t current = region->descriptor->used.load(std::memory_order_acquire);
-    uint64_t aligned = (current + alignment - 1) & ~(alignment - 1);
-    uint64_t new_used = aligned + size;
-
-    // Check if fits in current region
-    if (new_used > region->descriptor->size) {
-        // Need new region
-        size_t new_size = std::max(size + sizeof(RegionDescriptor),
-                                   current_region_size_ * 2);
-        new_size = std::min(new_size, ctx_.config().max_region_size);
-        current_region_size_ = new_size;
-
-        region = create_region(new_size);
-        if (!region) return nullptr;
-
-        // Update header sequence
-        ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
-
-        // Recalculate
-        current = region->descriptor->used.load(std::memory_order_acquire);
-        aligned = (current + alignment - 1) & ~(alignment - 1);
-        new_used = aligned + size;
+    if (void* ptr = try_allocate(region, size, alignment, region_id, offset)) {
+        return ptr;
     }
 
-    // Allocate
-    region->descriptor->used.store(new_used, std::memory_order_release);
+    // Need new region
+    size_t new_size = std::max(size + sizeof(RegionDescriptor),
+                               current_region_size_ * 2);
+    new_size = std::min(new_size, ctx_.config().max_region_size);
+    current_region_size_ = new_size;
+
+    region = create_region(new_size);
+    if (!region) return nullptr;
+
+    // Update header sequence
+    ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
 
-    return static_cast<char*>(region->shm.data()) + aligned;
+    // Null if the request exceeds max_region_size, or if other threads
+    // already filled the new region
+    return try_allocate(region, size, alignment, region_id, offset);
 }
 
 void* RegionManager::get_region_data(uint64_t region_id) {
@@ -217,6 +243,7 @@ MetadataManager::OverflowRegion* MetadataManager::create_overflow_region() {
 
     OverflowRegion* ptr = region.get();
     overflow_regions_.push_back(std::move(region));
+    current_overflow_.store(ptr, std::memory_order_release);
 
     // Increment sequence for observers to detect new region
     ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
@@ -224,146 +251,122 @@ MetadataManager::OverflowRegion* MetadataManager::create_overflow_region() {
     return ptr;
 }
 
-MetadataManager::OverflowRegion* MetadataManager::current_overflow_region() {
-    if (overflow_regions_.empty()) return nullptr;
-    return overflow_regions_.back().get();
-}
+namespace {
 
-ObjectEntry* MetadataManager::allocate_object_entry() {
-    std::lock_guard<std::mutex> lock(mutex_);
+constexpr uint32_t NO_SLOT = ~0u;
 
-    TelemetryHeader* header = ctx_.header();
+// Reserve n consecutive slots with a single fetch_add. Once a section is
+// full the count may overshoot its capacity by the reservations in flight,
+// so readers clamp it; the pre-check keeps the overshoot from growing.
+uint32_t reserve_slots(std::atomic<uint32_t>& count, uint32_t capacity, uint32_t n) {
+    if (count.load(std::memory_order_relaxed) + n > capacity) return NO_SLOT;
+    uint32_t first = count.fetch_add(n, std::memory_order_acq_rel);
+    if (first + n > capacity) return NO_SLOT;
+    return first;
+}
+
+} // anonymous namespace
 
+template<typename Entry>
+Entry* MetadataManager::reserve_entries(
+    uint32_t n, std::atomic<uint32_t>& header_count, uint32_t header_capacity,
+    uint64_t header_offset,
+    std::atomic<uint32_t> MetadataOverflowDescriptor::*overflow_count,
+    uint32_t MetadataOverflowDescriptor::*overflow_capacity,
+    uint32_t MetadataOverflowDescriptor::*overflow_offset) {
     // First try to allocate from header
-    uint32_t count = header->object_count.load(std::memory_order_acquire);
-    if (count < header->object_dir_capacity) {
-        auto* entries = reinterpret_cast<ObjectEntry*>(
-            static_cast<char*>(ctx_.header_shm().data()) + header->object_dir_offset);
-        header->object_count.store(count + 1, std::memory_order_release);
-        return &entries[count];
+    uint32_t index = reserve_slots(header_count, header_capacity, n);
+    if (index != NO_SLOT) {
+        auto* entries = reinterpret_cast<Entry*>(
+            static_cast<char*>(ctx_.header_shm().data()) + header_offset);
+        return &entries[index];
     }
 
     // Header full - try overflow regions
-    OverflowRegion* region = current_overflow_region();
-    if (region) {
-        uint32_t overflow_count = region->descriptor->object_entry_count.load(std::memory_order_acquire);
-        if (overflow_count < region->descriptor->object_entry_capacity) {
-            auto* entries = reinterpret_cast<ObjectEntry*>(
-                static_cast<char*>(region->shm.data()) + region->descriptor->object_entry_offset);
-            region->descriptor->object_entry_count.store(overflow_count + 1, std::memory_order_release);
-            return &entries[overflow_count];
+    while (true) {
+        OverflowRegion* region = current_overflow_.load(std::memory_order_acquire);
+        if (region) {
+            MetadataOverflowDescriptor* desc = region->descriptor;
+            index = reserve_slots(desc->*overflow_count, desc->*overflow_capacity, n);
+            if (index != NO_SLOT) {
+                auto* entries = reinterpret_cast<Entry*>(
+                    static_cast<char*>(region->shm.data()) + desc->*overflow_offset);
+                return &entries[index];
+            }
+            // Request too large for a single region
+            if (n > desc->*overflow_capacity) return nullptr;
         }
-    }
 
-    // Need new overflow region
-    region = create_overflow_region();
-    if (!region) return nullptr;
+        // Need new overflow region, unless another thread just added one
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_overflow_.load(std::memory_order_relaxed) == region &&
+            !create_overflow_region()) {
+            return nullptr;
+        }
+    }
+}
 
-    auto* entries = reinterpret_cast<ObjectEntry*>(
-        static_cast<char*>(region->shm.data()) + region->descriptor->object_entry_offset);
-    region->descriptor->object_entry_count.store(1, std::memory_order_release);
-    return &entries[0];
+ObjectEntry* MetadataManager::allocate_object_entry() {
+    TelemetryHeader* header = ctx_.header();
+    return reserve_entries<ObjectEntry>(
+        1, header->object_count, header->object_dir_capacity, header->object_dir_offset,
+        &MetadataOverflowDescriptor::object_entry_count,
+        &MetadataOverflowDescriptor::object_entry_capacity,
+        &MetadataOverflowDescriptor::object_entry_offset);
 }
 
 TypeEntry* MetadataManager::allocate_type_entry() {
-    std::lock_guard<std::mutex> lock(mutex_);
-
     TelemetryHeader* header = ctx_.header();
-
-    // First try to allocate from header
-    uint32_t count = header->type_count.load(std::memory_order_acquire);
-    if (count < header->type_registry_capacity) {
-        auto* entries = reinterpret_cast<TypeEntry*>(
-            static_cast<char*>(ctx_.header_shm().data()) + header->type_registry_offset);
-        header->type_count.store(count + 1, std::memory_order_release);
-        return &entries[count];
-    }
-
-    // Header full - try overflow regions
-    OverflowRegion* region = current_overflow_region();
-    if (region) {
-        uint32_t overflow_count = region->descriptor->type_entry_count.load(std::memory_order_acquire);
-        if (overflow_count < region->descriptor->type_entry_capacity) {
-            auto* entries = reinterpret_cast<TypeEntry*>(
-                static_cast<char*>(region->shm.data()) + region->descriptor->type_entry_offset);
-            region->descriptor->type_entry_count.store(overflow_count + 1, std::memory_order_release);
-            return &entries[overflow_count];
-        }
-    }
-
-    // Need new overflow region
-    region = create_overflow_region();
-    if (!region) return nullptr;
-
-    auto* entries = reinterpret_cast<TypeEntry*>(
-        static_cast<char*>(region->shm.data()) + region->descriptor->type_entry_offset);
-    region->descriptor->type_entry_count.store(1, std::memory_order_release);
-    return &entries[0];
+    return reserve_entries<TypeEntry>(
+        1, header->type_count, header->type_registry_capacity, header->type_registry_offset,
+        &MetadataOverflowDescriptor::type_entry_count,
+        &MetadataOverflowDescriptor::type_entry_capacity,
+        &MetadataOverflowDescriptor::type_entry_offset);
 }
 
 FieldEntry* MetadataManager::allocate_field_entries(uint32_t count) {
     if (count == 0) return nullptr;
 
-    std::lock_guard<std::mutex> lock(mutex_);
-
     TelemetryHeader* header = ctx_.header();
-
-    // First try to allocate from header
-    uint32_t current = header->field_count.load(std::memory_order_acquire);
-    if (current + count <= header->field_entries_capacity) {
-        auto* entries = reinterpret_cast<FieldEntry*>(
-            static_cast<char*>(ctx_.header_shm().data()) + header->field_entries_offset);
-        header->field_count.store(current + count, std::memory_order_release);
-        return &entries[current];
-    }
-
-    // Header full - try overflow regions
-    OverflowRegion* region = current_overflow_region();
-    if (region) {
-        uint32_t overflow_count = region->descriptor->field_entry_count.load(std::memory_order_acquire);
-        if (overflow_count + count <= region->descriptor->field_entry_capacity) {
-            auto* entries = reinterpret_cast<FieldEntry*>(
-                static_cast<char*>(region->shm.data()) + region->descriptor->field_entry_offset);
-            region->descriptor->field_entry_count.store(overflow_count + count, std::memory_order_release);
-            return &entries[overflow_count];
-        }
-    }
-
-    // Need new overflow region
-    region = create_overflow_region();
-    if (!region) return nullptr;
-
-    // Check if new region can hold all requested fields
-    if (count > region->descriptor->field_entry_capacity) {
-        return nullptr;  // Request too large for a single region
-    }
-
-    auto* entries = reinterpret_cast<FieldEntry*>(
-        static_cast<char*>(region->shm.data()) + region->descriptor->field_entry_offset);
-    region->descriptor->field_entry_count.store(count, std::memory_order_release);
-    return &entries[0];
+    return reserve_entries<FieldEntry>(
+        count, header->field_count, header->field_entries_capacity, header->field_entries_offset,
+        &MetadataOverflowDescriptor::field_entry_count,
+        &MetadataOverflowDescriptor::field_entry_capacity,
+        &MetadataOverflowDescriptor::field_entry_offset);
 }
 
 uint32_t MetadataManager::total_object_count() const {
-    uint32_t total = ctx_.header()->object_count.load(std::memory_order_acquire);
+    const TelemetryHeader* header = ctx_.header();
+    uint32_t total = std::min(header->object_count.load(std::memory_order_acquire),
+                              header->object_dir_capacity);
+    std::lock_guard<std::mutex> lock(mutex_);
     for (const auto& region : overflow_regions_) {
-        total += region->descriptor->object_entry_count.load(std::memory_order_acquire);
+        total += std::min(region->descriptor->object_entry_count.load(std::memory_order_acquire),
+                          region->descriptor->object_entry_capacity);
     }
     return total;
 }
 
 uint32_t MetadataManager::total_type_count() const {
-    uint32_t total = ctx_.header()->type_count.load(std::memory_order_acquire);
+    const TelemetryHeader* header = ctx_.header();
+    uint32_t total = std::min(header->type_count.load(std::memory_order_acquire),
+                              header->type_registry_capacity);
+    std::lock_guard<std::mutex> lock(mutex_);
     for (const auto& region : overflow_regions_) {
-        total += region->descriptor->type_entry_count.load(std::memory_order_acquire);
+        total += std::min(region->descriptor->type_entry_count.load(std::memory_order_acquire),
+                          region->descriptor->type_entry_capacity);
     }
     return total;
 }
 
 uint32_t MetadataManager::total_field_count() const {
-    uint32_t total = ctx_.header()->field_count.load(std::memory_order_acquire);
+    const TelemetryHeader* header = ctx_.header();
+    uint32_t total = std::min(header->field_count.load(std::memory_order_acquire),
+                              header->field_entries_capacity);
+    std::lock_guard<std::mutex> lock(mutex_);
     for (const auto& region : overflow_regions_) {
-        total += region->descriptor->field_entry_count.load(std::memory_order_acquire);
+        total += std::min(region->descriptor->field_entry_count.load(std::memory_order_acquire),
+                          region->descriptor->field_entry_capacity);
     }
     return total;
 }
@@ -373,63 +376,159 @@ uint32_t MetadataManager::total_field_count() const {
 ObjectManager::ObjectManager(Context& ctx)
     : ctx_(ctx)
 {
+    TelemetryHeader* header = ctx_.header();
+    header_entries_ = reinterpret_cast<ObjectEntry*>(
+        static_cast<char*>(ctx_.header_shm().data()) + header->object_dir_offset);
+    header_capacity_ = header->object_dir_capacity;
+    free_next_ = std::make_unique<std::atomic<uint32_t>[]>(header_capacity_);
+    label_index_ = reinterpret_cast<std::atomic<uint64_t>*>(
+        static_cast<char*>(ctx_.header_shm().data()) + header->label_index_offset);
+    label_index_capacity_ = header->label_index_capacity;
 }
 
-ObjectEntry* ObjectManager::register_object(void* ptr, uint32_t type_id, std::string_view label) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void ObjectManager::index_label(ObjectEntry* entry) {
+    // Objects in overflow directories are only found by scanning
+    bool indexed = false;
+    if (entry >= header_entries_ && entry < header_entries_ + header_capacity_) {
+        std::lock_guard<std::mutex> lock(label_mutex_);
+        indexed = detail::label_index_insert(label_index_, label_index_capacity_,
+                                             detail::label_hash(entry->label),
+                                             static_cast<uint32_t>(entry - header_entries_));
+    }
+    if (!indexed) {
+        ctx_.header()->label_index_complete.store(0, std::memory_order_release);
+    }
+}
 
-    // Get location
-    uint64_t region_id, offset;
-    if (!ctx_.regions().get_location(ptr, region_id, offset)) {
-        return nullptr;
+void ObjectManager::unindex_label(ObjectEntry* entry) {
+    if (entry < header_entries_ || entry >= header_entries_ + header_capacity_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(label_mutex_);
+    detail::label_index_erase(label_index_, label_index_capacity_,
+                              ctx_.header()->label_index_seq, detail::label_hash(entry->label),
+                              static_cast<uint32_t>(entry - header_entries_));
+}
+
+ObjectEntry* ObjectManager::acquire_entry() {
+    // Reuse a destroyed header slot if there is one
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    while (static_cast<uint32_t>(head) != NO_SLOT) {
+        uint32_t index = static_cast<uint32_t>(head);
+        uint64_t next = (((head >> 32) + 1) << 32) |
+                        free_next_[index].load(std::memory_order_relaxed);
+        if (free_head_.compare_exchange_weak(head, next, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            return &header_entries_[index];
+        }
     }
 
     // Allocate entry via MetadataManager (handles overflow automatically)
-    ObjectEntry* entry = ctx_.metadata().allocate_object_entry();
+    return ctx_.metadata().allocate_object_entry();
+}
+
+void ObjectManager::release_entry(ObjectEntry* entry) {
+    // Overflow slots are not reused
+    if (entry < header_entries_ || entry >= header_entries_ + header_capacity_) {
+        return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(entry - header_entries_);
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        free_next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (!free_head_.compare_exchange_weak(head, next, std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+ObjectHandle ObjectManager::register_object(uint64_t region_id, uint64_t offset,
+                                            uint32_t type_id, std::string_view label) {
+    ObjectEntry* entry = acquire_entry();
     if (!entry) {
-        return nullptr;
+        return {};
     }
 
-    // Initialize entry
-    entry->state.store(static_cast<uint32_t>(ObjectState::Alive), std::memory_order_release);
+    // Initialize entry while it is still Free/Destroyed, then publish it
+    // alive under the next generation
+    uint64_t next_generation =
+        status_generation(entry->status.load(std::memory_order_relaxed)) + 1;
     entry->type_id = type_id;
     entry->region_id = region_id;
     entry->offset = offset;
-    entry->generation = 1;
     entry->set_label(label);
+    entry->status.store(object_status(next_generation, ObjectState::Alive),
+                        std::memory_order_release);
+    index_label(entry);
 
     // Increment sequence for observers
     ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
 
-    ptr_to_entry_[ptr] = entry;
-
-    return entry;
+    return {entry, next_generation};
 }
 
-void ObjectManager::destroy_object(void* ptr) {
+ObjectEntry* ObjectManager::register_object(void* ptr, uint32_t type_id, std::string_view label) {
+    // Get location
+    uint64_t region_id, offset;
+    if (!ctx_.regions().get_location(ptr, region_id, offset)) {
+        return nullptr;
+    }
+
+    ObjectHandle handle = register_object(region_id, offset, type_id, label);
+    if (!handle) {
+        return nullptr;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
+    ptr_to_entry_[ptr] = handle;
+    return handle.entry;
+}
 
-    auto it = ptr_to_entry_.find(ptr);
-    if (it != ptr_to_entry_.end()) {
-        it->second->state.store(static_cast<uint32_t>(ObjectState::Destroyed),
-                                std::memory_order_release);
-        ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
+void ObjectManager::destroy_object(void* ptr) {
+    ObjectHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ptr_to_entry_.find(ptr);
+        if (it == ptr_to_entry_.end()) {
+            return;
+        }
+        handle = it->second;
         ptr_to_entry_.erase(it);
     }
+    destroy_object(handle);
 }
 
-ObjectEntry* ObjectManager::find_object(std::string_view label) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool ObjectManager::destroy_object(const ObjectHandle& handle) {
+    if (!handle.entry) {
+        return false;
+    }
 
+    // Fails if the slot was destroyed, or destroyed and reused, meanwhile
+    uint64_t alive = object_status(handle.generation, ObjectState::Alive);
+    if (!handle.entry->status.compare_exchange_strong(
+            alive, object_status(handle.generation, ObjectState::Destroyed),
+            std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    unindex_label(handle.entry);
+    ctx_.header()->sequence.fetch_add(1, std::memory_order_release);
+    release_entry(handle.entry);
+    return true;
+}
+
+ObjectEntry* ObjectManager::find_object(std::string_view label) {
     TelemetryHeader* header = ctx_.header();
-    uint32_t count = header->object_count.load(std::memory_order_acquire);
+    uint32_t count = std::min(header->object_count.load(std::memory_order_acquire),
+                              header->object_dir_capacity);
 
     auto* entries = reinterpret_cast<ObjectEntry*>(
         static_cast<char*>(ctx_.header_shm().data()) + header->object_dir_offset);
 
     for (uint32_t i = 0; i < count; ++i) {
-        if (entries[i].state.load(std::memory_order_acquire) ==
-                static_cast<uint32_t>(ObjectState::Alive) &&
+        if (status_state(entries[i].status.load(std::memory_order_acquire)) ==
+                ObjectState::Alive &&
             std::string_view(entries[i].label) == label) {
             return &entries[i];
         }
@@ -438,18 +537,17 @@ ObjectEntry* ObjectManager::find_object(std::string_view label) {
 }
 
 std::vector<ObjectEntry*> ObjectManager::get_all_objects() {
-    std::lock_guard<std::mutex> lock(mutex_);
-
     std::vector<ObjectEntry*> result;
     TelemetryHeader* header = ctx_.header();
-    uint32_t count = header->object_count.load(std::memory_order_acquire);
+    uint32_t count = std::min(header->object_count.load(std::memory_order_acquire),
+                              header->object_dir_capacity);
 
     auto* entries = reinterpret_cast<ObjectEntry*>(
         static_cast<char*>(ctx_.header_shm().data()) + header->object_dir_offset);
 
     for (uint32_t i = 0; i < count; ++i) {
-        if (entries[i].state.load(std::memory_order_acquire) ==
-                static_cast<uint32_t>(ObjectState::Alive)) {
+        if (status_state(entries[i].status.load(std::memory_order_acquire)) ==
+                ObjectState::Alive) {
             result.push_back(&entries[i]);
         }
     }
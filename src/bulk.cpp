@@ -0,0 +1,243 @@
+#include "memglass/bulk.hpp"
+#include "memglass/diff.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace memglass {
+
+namespace {
+
+constexpr size_t LINE = 16;
+
+size_t align_down(size_t v) { return v & ~(LINE - 1); }
+size_t align_up(size_t v) { return (v + LINE - 1) & ~(LINE - 1); }
+
+// Both pointers 16-byte aligned, size a multiple of 16. Aligned 16-byte
+// loads never split an aligned 8-byte word, so std::atomic fields up to 8
+// bytes are copied untorn.
+#if defined(__x86_64__)
+void copy_span(void* dst, const void* src, size_t size) {
+    auto* s = static_cast<const __m128i*>(src);
+    auto* d = static_cast<__m128i*>(dst);
+    for (size_t i = 0; i < size / LINE; ++i) {
+        _mm_store_si128(d + i, _mm_load_si128(s + i));
+    }
+}
+#else
+void copy_span(void* dst, const void* src, size_t size) {
+    auto* s = static_cast<const uint64_t*>(src);
+    auto* d = static_cast<uint64_t*>(dst);
+    for (size_t i = 0; i < size / sizeof(uint64_t); ++i) {
+        d[i] = __atomic_load_n(s + i, __ATOMIC_RELAXED);
+    }
+}
+#endif
+
+// Offset of the sequence within Guarded<T>, 0 if the layout is unknown
+size_t seq_offset(const FieldEntry& field) {
+    size_t value = primitive_size(static_cast<PrimitiveType>(field.type_id));
+    if (value == 0) value = field.size;
+    return (value + alignof(size_t) - 1) & ~(alignof(size_t) - 1);
+}
+
+const std::atomic<size_t>* seq_of(const unsigned char* object, const FieldRef& field) {
+    return reinterpret_cast<const std::atomic<size_t>*>(
+        object + field.offset() + seq_offset(*field.entry));
+}
+
+// Sequence of a primitive Locked<T>, after the flag and the value
+const std::atomic<uint32_t>* locked_seq_of(const unsigned char* object, const FieldRef& field) {
+    size_t prim = primitive_size(static_cast<PrimitiveType>(field.entry->type_id));
+    return reinterpret_cast<const std::atomic<uint32_t>*>(
+        object + field.offset() + detail::locked_seq_offset(prim));
+}
+
+} // anonymous namespace
+
+BulkCopy::BulkCopy(Observer& obs, const BulkOptions& options)
+    : obs_(obs)
+    , options_(options)
+{
+}
+
+const void* BulkCopy::data(size_t index) const {
+    if (index >= offsets_.size() || offsets_[index] == NO_COPY) return nullptr;
+    return reinterpret_cast<const unsigned char*>(arena_.data()) + offsets_[index];
+}
+
+void BulkCopy::plan(const std::vector<ObservedObject>& objects) {
+    spans_.clear();
+    guards_.clear();
+    offsets_.assign(objects.size(), NO_COPY);
+    sources_.assign(objects.size(), nullptr);
+    types_.assign(objects.size(), nullptr);
+
+    std::vector<size_t> order;
+    order.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        types_[i] = obs_.get_type(objects[i].type_id);
+        if (types_[i]) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (objects[a].region_id != objects[b].region_id) {
+            return objects[a].region_id < objects[b].region_id;
+        }
+        return objects[a].offset < objects[b].offset;
+    });
+
+    // Merge objects into spans; offsets_ holds the span-relative start until
+    // the span's arena offset is known
+    size_t arena_size = 0;
+    uint64_t span_region = 0;
+    size_t span_start = 0, span_end = 0;
+    size_t first = 0;
+
+    auto close_span = [&](size_t last) {
+        auto* base = static_cast<const unsigned char*>(obs_.get_object_data(span_region, span_start));
+        if (!base) {
+            for (size_t k = first; k < last; ++k) offsets_[order[k]] = NO_COPY;
+            return;
+        }
+        spans_.push_back({base, arena_size, span_end - span_start});
+        for (size_t k = first; k < last; ++k) {
+            size_t i = order[k];
+            sources_[i] = base + (objects[i].offset - span_start);
+            offsets_[i] = arena_size + (objects[i].offset - span_start);
+        }
+        arena_size += span_end - span_start;
+    };
+
+    for (size_t k = 0; k < order.size(); ++k) {
+        const ObservedObject& obj = objects[order[k]];
+        size_t start = align_down(obj.offset);
+        size_t end = align_up(obj.offset + types_[order[k]]->size);
+
+        bool extend = k > 0 && obj.region_id == span_region &&
+                      (start <= span_end || start - span_end <= options_.merge_gap);
+        if (extend) {
+            span_end = std::max(span_end, end);
+            continue;
+        }
+        if (k > 0) close_span(k);
+        span_region = obj.region_id;
+        span_start = start;
+        span_end = end;
+        first = k;
+    }
+    if (!order.empty()) close_span(order.size());
+
+    arena_.resize(arena_size / LINE);
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (!sources_[i]) continue;
+        for (const FieldRef& f : types_[i]->guarded_fields) {
+            guards_.push_back({i, f, 0});
+        }
+    }
+}
+
+size_t BulkCopy::copy(const std::vector<ObservedObject>& objects) {
+    plan(objects);
+
+    // Sample guards, copy, then check the guards again: the usual seqlock
+    // read with the whole burst as the critical section
+    for (auto& g : guards_) {
+        const unsigned char* src = sources_[g.object];
+        g.before = g.field.entry->atomicity == Atomicity::Seqlock
+            ? seq_of(src, g.field)->load(std::memory_order_acquire)
+            : locked_seq_of(src, g.field)->load(std::memory_order_acquire);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto* arena = reinterpret_cast<unsigned char*>(arena_.data());
+    bytes_copied_ = 0;
+    for (const auto& span : spans_) {
+        copy_span(arena + span.arena_offset, span.src, span.size);
+        bytes_copied_ += span.size;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    burst_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    validate(objects);
+
+    size_t copied = 0;
+    for (size_t offset : offsets_) {
+        if (offset != NO_COPY) ++copied;
+    }
+    return copied;
+}
+
+void BulkCopy::validate(const std::vector<ObservedObject>& objects) {
+    retried_fields_ = 0;
+    dropped_objects_ = 0;
+
+    for (const auto& g : guards_) {
+        const unsigned char* src = sources_[g.object];
+        size_t after = g.field.entry->atomicity == Atomicity::Seqlock
+            ? seq_of(src, g.field)->load(std::memory_order_relaxed)
+            : locked_seq_of(src, g.field)->load(std::memory_order_relaxed);
+        bool stable = (g.before & 1) == 0 && g.before == after;
+        if (!stable) {
+            reread_field(g.object, g.field, src);
+            ++retried_fields_;
+        }
+    }
+
+    // Destroyed or reused while we copied
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (offsets_[i] == NO_COPY || !objects[i].entry) continue;
+        const ObjectEntry* entry = objects[i].entry;
+        bool alive = entry->status.load(std::memory_order_acquire) ==
+                     object_status(objects[i].generation, ObjectState::Alive);
+        if (!alive) {
+            offsets_[i] = NO_COPY;
+            ++dropped_objects_;
+        }
+    }
+}
+
+void BulkCopy::reread_field(size_t object, const FieldRef& field, const unsigned char* src) {
+    unsigned char* dst = reinterpret_cast<unsigned char*>(arena_.data()) + offsets_[object];
+    size_t prim = primitive_size(static_cast<PrimitiveType>(field.entry->type_id));
+
+    if (field.entry->atomicity == Atomicity::Seqlock) {
+        size_t size = prim ? prim : field.entry->size;
+        const std::atomic<size_t>* seq = seq_of(src, field);
+        while (true) {
+            size_t s1 = seq->load(std::memory_order_acquire);
+            if (s1 & 1) {
+                MEMGLASS_PAUSE();
+                continue;
+            }
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            std::memcpy(dst + field.offset(), src + field.offset(), size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq->load(std::memory_order_relaxed) == s1) return;
+        }
+    }
+
+    // Locked<T>: same sequence check as Locked<T>::read_unlocked()
+    const std::atomic<uint32_t>* seq = locked_seq_of(src, field);
+    size_t value = field.offset() + detail::locked_value_offset(prim);
+    while (true) {
+        uint32_t s1 = seq->load(std::memory_order_acquire);
+        if (s1 & 1) {
+            MEMGLASS_PAUSE();
+            continue;
+        }
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        std::memcpy(dst + value, src + value, prim);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq->load(std::memory_order_relaxed) == s1) return;
+    }
+}
+
+} // namespace memglass
@@ -0,0 +1,282 @@
+#include "memglass/cdc.hpp"
+#include "memglass/observer.hpp"
+#include "memglass/detail/session_slot.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace memglass {
+
+namespace {
+
+CdcRing* ring_at(CdcHeader* header, uint32_t i) {
+    return reinterpret_cast<CdcRing*>(reinterpret_cast<char*>(header) + header->rings_offset +
+                                      i * header->ring_stride);
+}
+
+CdcRecord* ring_records(CdcHeader* header, CdcRing* ring) {
+    return reinterpret_cast<CdcRecord*>(reinterpret_cast<char*>(ring) + header->records_offset);
+}
+
+void free_ring(CdcRing* ring) {
+    ring->owner.store(0, std::memory_order_release);
+}
+
+// Session threads log to
+detail::SessionSegment<CdcHeader> g_session;
+
+// The calling thread's ring
+struct ThreadRing {
+    detail::SlotClaim<CdcHeader, CdcRing, free_ring> claim{g_session};
+    CdcRecord* records = nullptr;
+    uint64_t mask = 0;
+    uint64_t tail = 0;  // last tail seen, reloaded only when the ring looks full
+
+    // Claim a free ring of the current session; nullptr if there is none
+    CdcRing* acquire() {
+        return claim.claim([this](CdcHeader* header) -> CdcRing* {
+            for (uint32_t i = 0; i < header->ring_count; ++i) {
+                CdcRing* r = ring_at(header, i);
+                uint32_t expected = 0;
+                if (r->owner.load(std::memory_order_relaxed) == 0 &&
+                    r->owner.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+                    records = ring_records(header, r);
+                    mask = header->ring_capacity - 1;
+                    tail = r->tail.load(std::memory_order_acquire);
+                    return r;
+                }
+            }
+            header->unowned_drops.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        });
+    }
+};
+
+thread_local ThreadRing t_ring;
+
+// Name the primitive value rel bytes into an instance of type, descending
+// into nested types; false for padding and the rest of Guarded/Locked<T>
+bool name_value(const ObservedType& type, uint64_t rel, std::string& name, PrimitiveType& out) {
+    for (size_t j = 0; j < type.fields.size(); ++j) {
+        const FieldEntry& field = type.fields[j];
+        bool is_array = field.flags & static_cast<uint32_t>(FieldFlags::IsArray);
+        uint32_t count = is_array ? std::max<uint32_t>(field.array_size, 1) : 1;
+
+        const ObservedType* nested = j < type.nested_types.size() ? type.nested_types[j] : nullptr;
+        if (nested) {
+            if (nested->size == 0 || rel < field.offset ||
+                rel >= field.offset + static_cast<uint64_t>(nested->size) * count) {
+                continue;
+            }
+            uint64_t element = (rel - field.offset) / nested->size;
+            name.append(field.name, strnlen(field.name, sizeof(field.name)));
+            if (is_array) name += "[" + std::to_string(element) + "]";
+            name += '.';
+            return name_value(*nested, rel - field.offset - element * nested->size, name, out);
+        }
+
+        auto prim = static_cast<PrimitiveType>(field.type_id);
+        size_t size = primitive_size(prim);
+        if (size == 0) continue;
+
+        // Locked<T> keeps its value after the flag
+        uint64_t start = field.offset;
+        if (field.atomicity == Atomicity::Locked) start += detail::locked_value_offset(size);
+        if (rel < start || rel >= start + size * count || (rel - start) % size != 0) continue;
+
+        out = prim;
+        name.append(field.name, strnlen(field.name, sizeof(field.name)));
+        if (is_array) name += "[" + std::to_string((rel - start) / size) + "]";
+        return true;
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+void cdc_append(const void* address, uint64_t value, uint32_t size) {
+    ThreadRing& t = t_ring;
+    CdcRing* ring = t.claim.slot();
+    if (t.claim.stale() || !ring) {
+        ring = t.acquire();
+        if (!ring) return;
+    }
+
+    // Single writer: plain loads and stores of head and dropped suffice
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - t.tail > t.mask) {
+        t.tail = ring->tail.load(std::memory_order_acquire);
+        if (head - t.tail > t.mask) {
+            ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    CdcRecord& r = t.records[head & t.mask];
+    r.tsc = read_tsc();
+    r.address = reinterpret_cast<uint64_t>(address);
+    r.value = value;
+    r.size = size;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void cdc_attach(CdcHeader* header) {
+    g_session.attach(header);
+}
+
+void cdc_detach() {
+    g_session.detach();
+}
+
+void cdc_add_region(CdcHeader* header, uint64_t region_id, const void* base, uint64_t size) {
+    uint32_t n = header->region_count.load(std::memory_order_relaxed);
+    if (n >= CDC_MAX_REGIONS) return;  // stores there read as unresolved
+    header->regions[n] = {region_id, reinterpret_cast<uint64_t>(base), size};
+    header->region_count.store(n + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+// CdcReader implementation
+
+CdcReader::CdcReader(Observer& obs)
+    : obs_(obs)
+{
+}
+
+bool CdcReader::attach() {
+    if (header_) return true;
+
+    // Writable: the reader advances the ring tails
+    if (!shm_.open(detail::make_cdc_shm_name(obs_.session_name()))) {
+        return false;
+    }
+
+    auto* header = static_cast<CdcHeader*>(shm_.data());
+    if (shm_.size() < sizeof(CdcHeader) || header->magic != CDC_MAGIC ||
+        header->ring_capacity == 0 ||
+        shm_.size() < header->rings_offset + header->ring_count * header->ring_stride) {
+        shm_.close();
+        return false;
+    }
+
+    header_ = header;
+    clock_.set_origin(header->origin_tsc, header->origin_ns);
+    return true;
+}
+
+CdcRing* CdcReader::ring(uint32_t i) const {
+    return ring_at(header_, i);
+}
+
+void CdcReader::rebuild_index() {
+    obs_.refresh();
+    indexed_sequence_ = obs_.sequence();
+    spans_.clear();
+    for (const auto& obj : obs_.objects()) {
+        const ObservedType* type = obs_.get_type(obj.type_id);
+        if (!type) continue;
+        spans_[obj.region_id].push_back({obj.offset, obj.offset + type->size, obj.label, type});
+    }
+    for (auto& [region, spans] : spans_) {
+        std::sort(spans.begin(), spans.end(),
+                  [](const ObjectSpan& a, const ObjectSpan& b) { return a.offset < b.offset; });
+    }
+}
+
+bool CdcReader::resolve(uint64_t address, Resolved& out) const {
+    uint32_t regions = std::min(header_->region_count.load(std::memory_order_acquire), CDC_MAX_REGIONS);
+    for (uint32_t i = 0; i < regions; ++i) {
+        const CdcRegion& region = header_->regions[i];
+        if (address < region.base || address >= region.base + region.size) continue;
+
+        auto it = spans_.find(region.region_id);
+        if (it == spans_.end()) return false;
+        uint64_t offset = address - region.base;
+        const auto& spans = it->second;
+        auto span = std::upper_bound(spans.begin(), spans.end(), offset,
+                                     [](uint64_t off, const ObjectSpan& s) { return off < s.offset; });
+        if (span == spans.begin()) return false;
+        --span;
+        if (offset >= span->end) return false;
+
+        out.label = &span->label;
+        out.field.clear();
+        return name_value(*span->type, offset - span->offset, out.field, out.type);
+    }
+    return false;
+}
+
+size_t CdcReader::drain(std::vector<SnapshotDiff>& out) {
+    if (!header_) return 0;
+
+    records_.clear();
+    uint64_t dropped = header_->unowned_drops.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < header_->ring_count; ++i) {
+        CdcRing* r = ring(i);
+        dropped += r->dropped.load(std::memory_order_relaxed);
+        const CdcRecord* records = ring_records(header_, r);
+        uint64_t mask = header_->ring_capacity - 1;
+        uint64_t head = r->head.load(std::memory_order_acquire);
+        uint64_t tail = r->tail.load(std::memory_order_relaxed);
+        for (uint64_t n = tail; n != head; ++n) {
+            records_.push_back(records[n & mask]);
+        }
+        r->tail.store(head, std::memory_order_release);
+    }
+    stats_.dropped = dropped;
+    if (records_.empty()) return 0;
+    stats_.records += records_.size();
+
+    std::stable_sort(records_.begin(), records_.end(),
+                     [](const CdcRecord& a, const CdcRecord& b) { return a.tsc < b.tsc; });
+
+    // Refine the tick rate now and then; it only gets better with time
+    uint64_t now = TscClock::wall_now();
+    if (!clock_.calibrated() || now - calibrated_at_ > 1'000'000'000ull) {
+        clock_.calibrate();
+        calibrated_at_ = now;
+    }
+
+    if (indexed_sequence_ != obs_.sequence()) rebuild_index();
+
+    Resolved resolved;
+    bool rebuilt = false;
+    for (const auto& rec : records_) {
+        if (!resolve(rec.address, resolved)) {
+            // Possibly an object created since the index was built
+            if (rebuilt || (rebuild_index(), rebuilt = true, !resolve(rec.address, resolved))) {
+                stats_.unresolved++;
+                continue;
+            }
+        }
+
+        FieldValue value;
+        value.type = resolved.type;
+        std::memcpy(&value.data, &rec.value, std::min<size_t>(rec.size, sizeof(value.data)));
+
+        uint64_t ts = clock_.to_wall_ns(rec.tsc);
+        if (out.empty() || out.back().timestamp_ns != ts) {
+            SnapshotDiff diff;
+            diff.timestamp_ns = ts;
+            diff.old_sequence = diff.new_sequence = indexed_sequence_;
+            out.push_back(std::move(diff));
+        }
+
+        FieldChange change;
+        change.object_label = *resolved.label;
+        change.field_name = resolved.field;
+        FieldValue& last = last_[rec.address];
+        change.old_value = last;
+        change.new_value = value;
+        last = value;
+        out.back().field_changes.push_back(std::move(change));
+    }
+    return records_.size();
+}
+
+} // namespace memglass
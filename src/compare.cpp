@@ -0,0 +1,241 @@
+#include "memglass/compare.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace memglass {
+
+namespace {
+
+// Where the value bytes of a field live: Locked<T> keeps its flag first
+const char* value_ptr(const ObjectView& view, const FieldRef& field) {
+    const char* p = static_cast<const char*>(view.data()) + field.offset();
+    if (field.entry->atomicity == Atomicity::Locked) {
+        p += detail::locked_value_offset(primitive_size(static_cast<PrimitiveType>(field.entry->type_id)));
+    }
+    return p;
+}
+
+bool is_primitive(const FieldRef& field) {
+    return primitive_size(static_cast<PrimitiveType>(field.entry->type_id)) != 0;
+}
+
+bool within(const FieldValue& a, const FieldValue& b, double tolerance) {
+    if (a == b) return true;
+    if (a.is_integer() && b.is_integer() && tolerance == 0) {
+        return a.type != b.type && a.as_int64() == b.as_int64();
+    }
+    double x = a.as_double();
+    double y = b.as_double();
+    if (std::isnan(x) || std::isnan(y)) return std::isnan(x) && std::isnan(y);
+    return std::fabs(x - y) <= tolerance;
+}
+
+} // anonymous namespace
+
+double CompareOptions::tolerance_for(std::string_view label, std::string_view field) const {
+    if (tolerances.empty()) return tolerance;
+
+    std::string key;
+    key.reserve(label.size() + 1 + field.size());
+    key.append(label).append(1, '.').append(field);
+    auto it = tolerances.find(key);
+    if (it != tolerances.end()) return it->second;
+
+    it = tolerances.find(std::string(field));
+    return it != tolerances.end() ? it->second : tolerance;
+}
+
+bool parse_tolerance(std::string_view spec, CompareOptions& options) {
+    size_t eq = spec.rfind('=');
+    std::string_view name = eq == std::string_view::npos ? std::string_view{} : spec.substr(0, eq);
+    std::string value(eq == std::string_view::npos ? spec : spec.substr(eq + 1));
+    if (eq != std::string_view::npos && name.empty()) return false;
+
+    double tolerance;
+    if (value == "ignore") {
+        if (name.empty()) return false;
+        tolerance = std::numeric_limits<double>::infinity();
+    } else {
+        char* end = nullptr;
+        tolerance = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !(tolerance >= 0)) return false;
+    }
+
+    if (name.empty()) {
+        options.tolerance = tolerance;
+    } else {
+        options.tolerances[std::string(name)] = tolerance;
+    }
+    return true;
+}
+
+SessionComparator::SessionComparator(Observer& a, Observer& b, CompareOptions options)
+    : a_(a)
+    , b_(b)
+    , options_(std::move(options))
+{
+}
+
+void SessionComparator::rebuild() {
+    // Sample first: a change during the rebuild triggers another one
+    sequence_a_ = a_.sequence();
+    sequence_b_ = b_.sequence();
+    a_.refresh();
+    b_.refresh();
+
+    // Keeps FieldEntry pointers valid even if the observers reload types
+    schema_a_ = a_.schema();
+    schema_b_ = b_.schema();
+
+    objects_.clear();
+    fields_.clear();
+    spans_.clear();
+    only_in_a_.clear();
+    only_in_b_.clear();
+    unmatched_fields_.clear();
+    result_.diverged.clear();
+    result_.converged.clear();
+
+    auto live_a = a_.objects();
+    auto live_b = b_.objects();
+    auto by_label = [](const ObservedObject& x, const ObservedObject& y) { return x.label < y.label; };
+    std::sort(live_a.begin(), live_a.end(), by_label);
+    std::sort(live_b.begin(), live_b.end(), by_label);
+
+    // FieldProxy keeps a reference to its ObjectView; never reallocate
+    objects_.reserve(std::min(live_a.size(), live_b.size()));
+
+    auto ib = live_b.begin();
+    for (const auto& oa : live_a) {
+        while (ib != live_b.end() && ib->label < oa.label) {
+            only_in_b_.push_back(ib++->label);
+        }
+        if (ib == live_b.end() || ib->label != oa.label) {
+            only_in_a_.push_back(oa.label);
+            continue;
+        }
+        const ObservedObject& ob = *ib++;
+
+        ObjectView va = a_.get(oa);
+        ObjectView vb = b_.get(ob);
+        if (!va || !vb || !va.type() || !vb.type()) continue;
+
+        uint32_t index = static_cast<uint32_t>(objects_.size());
+        objects_.push_back({oa.label, va, vb});
+        const ObjectPlan& obj = objects_.back();
+
+        size_t first_field = fields_.size();
+        obj.a.type()->for_each_leaf([&](std::string_view name, const FieldRef& fa) {
+            if (!is_primitive(fa)) return;
+
+            FieldRef fb = obj.b.type()->find_field(name);
+            if (!fb) {
+                unmatched_fields_.push_back(oa.label + "." + std::string(name));
+                return;
+            }
+            if (!is_primitive(fb)) return;
+
+            double tolerance = options_.tolerance_for(oa.label, name);
+            if (std::isinf(tolerance)) return;
+            fields_.push_back({index, std::string(name), fa, fb, tolerance});
+        });
+        obj.b.type()->for_each_leaf([&](std::string_view name, const FieldRef& fb) {
+            if (is_primitive(fb) && !obj.a.type()->find_field(name)) {
+                unmatched_fields_.push_back(oa.label + "." + std::string(name));
+            }
+        });
+
+        // Value order in A, so neighbouring values can share a span
+        std::sort(fields_.begin() + first_field, fields_.end(),
+                  [](const FieldPlan& x, const FieldPlan& y) { return x.a.offset() < y.a.offset(); });
+    }
+    while (ib != live_b.end()) {
+        only_in_b_.push_back(ib++->label);
+    }
+
+    // Merge runs of identically typed values that are adjacent in both
+    // sessions, across object boundaries too
+    for (uint32_t i = 0; i < fields_.size(); ++i) {
+        const FieldPlan& f = fields_[i];
+        const ObjectPlan& obj = objects_[f.object];
+        bool same_type = f.a.entry->type_id == f.b.entry->type_id;
+        uint32_t size = same_type
+            ? static_cast<uint32_t>(primitive_size(static_cast<PrimitiveType>(f.a.entry->type_id)))
+            : 0;
+        const char* pa = value_ptr(obj.a, f.a);
+        const char* pb = value_ptr(obj.b, f.b);
+
+        if (size && !spans_.empty()) {
+            Span& prev = spans_.back();
+            if (prev.size && prev.last == i && prev.a + prev.size == pa && prev.b + prev.size == pb) {
+                prev.size += size;
+                prev.last = i + 1;
+                continue;
+            }
+        }
+        spans_.push_back({pa, pb, size, i, i + 1});
+    }
+
+    stats_.objects = objects_.size();
+    stats_.fields = fields_.size();
+    stats_.spans = spans_.size();
+    stats_.slow_fields = static_cast<size_t>(std::count_if(
+        spans_.begin(), spans_.end(), [](const Span& s) { return s.size == 0; }));
+    stats_.rebuilds++;
+}
+
+FieldValue SessionComparator::read(ObjectView& view, const FieldRef& field) {
+    char* data = static_cast<char*>(const_cast<void*>(view.data())) + field.offset();
+    return read_field_value(FieldProxy(view, field.entry, data));
+}
+
+void SessionComparator::check_fields(Span& span) {
+    for (uint32_t i = span.first; i < span.last; ++i) {
+        FieldPlan& f = fields_[i];
+        ObjectPlan& obj = objects_[f.object];
+        FieldValue va = read(obj.a, f.a);
+        FieldValue vb = read(obj.b, f.b);
+
+        if (!within(va, vb, f.tolerance)) {
+            if (!f.diverged) {
+                f.diverged = true;
+                f.since_ns = result_.timestamp_ns;
+                span.diverged++;
+            }
+            result_.diverged.push_back({obj.label, f.name, va, vb, f.since_ns});
+        } else if (f.diverged) {
+            f.diverged = false;
+            span.diverged--;
+            result_.converged.push_back({obj.label, f.name, va, vb, f.since_ns});
+        }
+    }
+}
+
+const CompareResult& SessionComparator::compare() {
+    if (a_.sequence() != sequence_a_ || b_.sequence() != sequence_b_) {
+        rebuild();
+    }
+
+    result_.timestamp_ns = wall_clock_ns();
+    result_.diverged.clear();
+    result_.converged.clear();
+
+    for (auto& span : spans_) {
+        if (span.size && std::memcmp(span.a, span.b, span.size) == 0) {
+            // Identical bytes: any field of the span that was out is back
+            if (span.diverged) check_fields(span);
+            continue;
+        }
+        if (span.size) stats_.spans_mismatched++;
+        check_fields(span);
+    }
+
+    stats_.compares++;
+    return result_;
+}
+
+} // namespace memglass
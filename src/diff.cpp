@@ -0,0 +1,485 @@
+#include "memglass/diff.hpp"
+#include "memglass/bulk.hpp"
+#include "memglass/dirty.hpp"
+#include "memglass/ladder.hpp"
+
+#include <fmt/format.h>
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+
+namespace memglass {
+
+// FieldValue implementation
+
+bool FieldValue::operator==(const FieldValue& other) const {
+    if (type != other.type) return false;
+    switch (type) {
+        case PrimitiveType::Bool: return data.b == other.data.b;
+        case PrimitiveType::Int8: return data.i8 == other.data.i8;
+        case PrimitiveType::UInt8: return data.u8 == other.data.u8;
+        case PrimitiveType::Int16: return data.i16 == other.data.i16;
+        case PrimitiveType::UInt16: return data.u16 == other.data.u16;
+        case PrimitiveType::Int32: return data.i32 == other.data.i32;
+        case PrimitiveType::UInt32: return data.u32 == other.data.u32;
+        case PrimitiveType::Int64: return data.i64 == other.data.i64;
+        case PrimitiveType::UInt64: return data.u64 == other.data.u64;
+        case PrimitiveType::Float32: return data.f32 == other.data.f32;
+        case PrimitiveType::Float64: return data.f64 == other.data.f64;
+        case PrimitiveType::Char: return data.c == other.data.c;
+        default: return true;
+    }
+}
+
+int64_t FieldValue::as_int64() const {
+    switch (type) {
+        case PrimitiveType::Bool: return data.b ? 1 : 0;
+        case PrimitiveType::Int8: return data.i8;
+        case PrimitiveType::UInt8: return data.u8;
+        case PrimitiveType::Int16: return data.i16;
+        case PrimitiveType::UInt16: return data.u16;
+        case PrimitiveType::Int32: return data.i32;
+        case PrimitiveType::UInt32: return data.u32;
+        case PrimitiveType::Int64: return data.i64;
+        case PrimitiveType::UInt64: return static_cast<int64_t>(data.u64);
+        case PrimitiveType::Char: return data.c;
+        default: return 0;
+    }
+}
+
+double FieldValue::as_double() const {
+    switch (type) {
+        case PrimitiveType::Float32: return data.f32;
+        case PrimitiveType::Float64: return data.f64;
+        case PrimitiveType::UInt64: return static_cast<double>(data.u64);
+        default: return static_cast<double>(as_int64());
+    }
+}
+
+void FieldValue::set_int64(int64_t v) {
+    switch (type) {
+        case PrimitiveType::Bool: data.b = v != 0; break;
+        case PrimitiveType::Int8: data.i8 = static_cast<int8_t>(v); break;
+        case PrimitiveType::UInt8: data.u8 = static_cast<uint8_t>(v); break;
+        case PrimitiveType::Int16: data.i16 = static_cast<int16_t>(v); break;
+        case PrimitiveType::UInt16: data.u16 = static_cast<uint16_t>(v); break;
+        case PrimitiveType::Int32: data.i32 = static_cast<int32_t>(v); break;
+        case PrimitiveType::UInt32: data.u32 = static_cast<uint32_t>(v); break;
+        case PrimitiveType::Int64: data.i64 = v; break;
+        case PrimitiveType::UInt64: data.u64 = static_cast<uint64_t>(v); break;
+        case PrimitiveType::Char: data.c = static_cast<char>(v); break;
+        default: break;
+    }
+}
+
+bool FieldValue::is_integer() const {
+    switch (type) {
+        case PrimitiveType::Bool:
+        case PrimitiveType::Int8:
+        case PrimitiveType::UInt8:
+        case PrimitiveType::Int16:
+        case PrimitiveType::UInt16:
+        case PrimitiveType::Int32:
+        case PrimitiveType::UInt32:
+        case PrimitiveType::Int64:
+        case PrimitiveType::UInt64:
+        case PrimitiveType::Char:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string FieldValue::to_string() const {
+    switch (type) {
+        case PrimitiveType::Bool: return data.b ? "true" : "false";
+        case PrimitiveType::Int8: return std::to_string(data.i8);
+        case PrimitiveType::UInt8: return std::to_string(data.u8);
+        case PrimitiveType::Int16: return std::to_string(data.i16);
+        case PrimitiveType::UInt16: return std::to_string(data.u16);
+        case PrimitiveType::Int32: return std::to_string(data.i32);
+        case PrimitiveType::UInt32: return std::to_string(data.u32);
+        case PrimitiveType::Int64: return std::to_string(data.i64);
+        case PrimitiveType::UInt64: return std::to_string(data.u64);
+        case PrimitiveType::Float32: return fmt::format("{:.6g}", data.f32);
+        case PrimitiveType::Float64: return fmt::format("{:.6g}", data.f64);
+        case PrimitiveType::Char: return fmt::format("'{}'", data.c);
+        default: return "?";
+    }
+}
+
+std::string FieldValue::to_json() const {
+    switch (type) {
+        case PrimitiveType::Bool: return data.b ? "true" : "false";
+        case PrimitiveType::Int8: return std::to_string(data.i8);
+        case PrimitiveType::UInt8: return std::to_string(data.u8);
+        case PrimitiveType::Int16: return std::to_string(data.i16);
+        case PrimitiveType::UInt16: return std::to_string(data.u16);
+        case PrimitiveType::Int32: return std::to_string(data.i32);
+        case PrimitiveType::UInt32: return std::to_string(data.u32);
+        case PrimitiveType::Int64: return std::to_string(data.i64);
+        case PrimitiveType::UInt64: return std::to_string(data.u64);
+        case PrimitiveType::Float32: return fmt::format("{:.6g}", data.f32);
+        case PrimitiveType::Float64: return fmt::format("{:.6g}", data.f64);
+        case PrimitiveType::Char: return fmt::format("\"{}\"", data.c);
+        default: return "null";
+    }
+}
+
+FieldValue read_field_value(const FieldProxy& field) {
+    FieldValue v;
+    auto* info = field.info();
+    if (!info) return v;
+
+    v.type = static_cast<PrimitiveType>(info->type_id);
+    v.atomicity = info->atomicity;
+
+    switch (v.type) {
+        case PrimitiveType::Bool: v.data.b = field.as<bool>(); break;
+        case PrimitiveType::Int8: v.data.i8 = field.as<int8_t>(); break;
+        case PrimitiveType::UInt8: v.data.u8 = field.as<uint8_t>(); break;
+        case PrimitiveType::Int16: v.data.i16 = field.as<int16_t>(); break;
+        case PrimitiveType::UInt16: v.data.u16 = field.as<uint16_t>(); break;
+        case PrimitiveType::Int32: v.data.i32 = field.as<int32_t>(); break;
+        case PrimitiveType::UInt32: v.data.u32 = field.as<uint32_t>(); break;
+        case PrimitiveType::Int64: v.data.i64 = field.as<int64_t>(); break;
+        case PrimitiveType::UInt64: v.data.u64 = field.as<uint64_t>(); break;
+        case PrimitiveType::Float32: v.data.f32 = field.as<float>(); break;
+        case PrimitiveType::Float64: v.data.f64 = field.as<double>(); break;
+        case PrimitiveType::Char: v.data.c = field.as<char>(); break;
+        default: break;
+    }
+    return v;
+}
+
+FieldValue decode_field_value(const FieldEntry& field, const void* object) {
+    FieldValue v;
+    v.type = static_cast<PrimitiveType>(field.type_id);
+    v.atomicity = field.atomicity;
+
+    size_t size = primitive_size(v.type);
+    if (size == 0) return v;
+
+    // Locked<T> stores its flag first, the value at alignof(T)
+    const char* src = static_cast<const char*>(object) + field.offset;
+    if (field.atomicity == Atomicity::Locked) src += detail::locked_value_offset(size);
+    std::memcpy(&v.data, src, size);
+    return v;
+}
+
+std::string_view primitive_type_name(PrimitiveType type) {
+    switch (type) {
+        case PrimitiveType::Bool: return "bool";
+        case PrimitiveType::Int8: return "int8";
+        case PrimitiveType::UInt8: return "uint8";
+        case PrimitiveType::Int16: return "int16";
+        case PrimitiveType::UInt16: return "uint16";
+        case PrimitiveType::Int32: return "int32";
+        case PrimitiveType::UInt32: return "uint32";
+        case PrimitiveType::Int64: return "int64";
+        case PrimitiveType::UInt64: return "uint64";
+        case PrimitiveType::Float32: return "float32";
+        case PrimitiveType::Float64: return "float64";
+        case PrimitiveType::Char: return "char";
+        default: return "unknown";
+    }
+}
+
+size_t primitive_size(PrimitiveType type) {
+    switch (type) {
+        case PrimitiveType::Bool:
+        case PrimitiveType::Int8:
+        case PrimitiveType::UInt8:
+        case PrimitiveType::Char: return 1;
+        case PrimitiveType::Int16:
+        case PrimitiveType::UInt16: return 2;
+        case PrimitiveType::Int32:
+        case PrimitiveType::UInt32:
+        case PrimitiveType::Float32: return 4;
+        case PrimitiveType::Int64:
+        case PrimitiveType::UInt64:
+        case PrimitiveType::Float64: return 8;
+        default: return 0;
+    }
+}
+
+uint64_t wall_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Snapshot implementation
+
+namespace {
+
+ObjectSnapshot read_object(Observer& obs, const ObservedObject& obj, const ObservedType* type_info) {
+    ObjectSnapshot os;
+    os.label = obj.label;
+    os.type_name = obj.type_name;
+    os.region_id = obj.region_id;
+    os.offset = obj.offset;
+
+    if (type_info) {
+        auto view = obs.get(obj);
+        if (view) {
+            char* data = static_cast<char*>(const_cast<void*>(view.data()));
+            type_info->for_each_leaf([&](std::string_view path, const FieldRef& field) {
+                os.fields[std::string(path)] =
+                    read_field_value(FieldProxy(view, field.entry, data + field.offset()));
+            });
+        }
+    }
+    return os;
+}
+
+ObjectSnapshot decode_object(const ObservedObject& obj, const ObservedType* type_info,
+                             const void* data) {
+    ObjectSnapshot os;
+    os.label = obj.label;
+    os.type_name = obj.type_name;
+    os.region_id = obj.region_id;
+    os.offset = obj.offset;
+
+    if (type_info && data) {
+        type_info->for_each_leaf([&](std::string_view path, const FieldRef& field) {
+            os.fields[std::string(path)] =
+                decode_field_value(*field.entry, static_cast<const char*>(data) + field.base);
+        });
+    }
+    return os;
+}
+
+Snapshot begin_snapshot(Observer& obs) {
+    Snapshot snap;
+    snap.timestamp_ns = wall_clock_ns();
+    snap.sequence = obs.sequence();
+    snap.pid = obs.producer_pid();
+    obs.refresh();
+    return snap;
+}
+
+// Book<Levels> fields (see book.hpp) are diffed by price level instead of
+// by slot, so an insert reads as one new level rather than a change to
+// every level behind it
+std::vector<std::string> snapshot_books(const ObjectSnapshot& obj) {
+    std::vector<std::string> books;
+    constexpr std::string_view suffix = ".epoch";
+    for (const auto& [name, value] : obj.fields) {
+        if (name.size() <= suffix.size() || !name.ends_with(suffix)) continue;
+        std::string book = name.substr(0, name.size() - suffix.size());
+        if (obj.fields.count(book + ".bids[0].version")) books.push_back(std::move(book));
+    }
+    return books;
+}
+
+bool is_level_field(std::string_view name, const std::vector<std::string>& books) {
+    for (const auto& book : books) {
+        if (name.size() <= book.size() || !name.starts_with(book) || name[book.size()] != '.') continue;
+        std::string_view rest = name.substr(book.size() + 1);
+        if (rest == "epoch" || rest.starts_with("bids[") || rest.starts_with("asks[")) return true;
+    }
+    return false;
+}
+
+void diff_books(const std::string& label, const std::vector<std::string>& books,
+                const ObjectSnapshot& old_obj, const ObjectSnapshot& new_obj, SnapshotDiff& diff) {
+    for (const auto& book : books) {
+        Ladder old_ladder;
+        Ladder new_ladder;
+        if (!read_ladder(old_obj, book, old_ladder) || !read_ladder(new_obj, book, new_ladder)) continue;
+
+        for (const auto& level : diff_ladders(old_ladder, new_ladder)) {
+            std::string name = fmt::format("{}.{}[@{}]", book,
+                                           level.side == BookSide::Bid ? "bids" : "asks", level.price);
+            FieldChange change;
+            change.object_label = label;
+            if (level.old_level.qty != level.new_level.qty) {
+                change.field_name = name;
+                change.old_value.type = change.new_value.type = PrimitiveType::Float64;
+                change.old_value.data.f64 = level.old_level.qty;
+                change.new_value.data.f64 = level.new_level.qty;
+                diff.field_changes.push_back(change);
+            }
+            if (level.old_level.orders != level.new_level.orders) {
+                change.field_name = name + ".orders";
+                change.old_value.type = change.new_value.type = PrimitiveType::UInt64;
+                change.old_value.data.u64 = level.old_level.orders;
+                change.new_value.data.u64 = level.new_level.orders;
+                diff.field_changes.push_back(change);
+            }
+        }
+    }
+}
+
+void diff_fields(const std::string& label, const ObjectSnapshot& old_obj,
+                 const ObjectSnapshot& new_obj, SnapshotDiff& diff) {
+    std::vector<std::string> books = snapshot_books(new_obj);
+    if (!books.empty()) diff_books(label, books, old_obj, new_obj, diff);
+
+    for (const auto& [field_name, new_value] : new_obj.fields) {
+        if (!books.empty() && is_level_field(field_name, books)) continue;
+        auto old_field_it = old_obj.fields.find(field_name);
+        if (old_field_it == old_obj.fields.end()) {
+            // New field (shouldn't happen normally)
+            FieldChange change;
+            change.object_label = label;
+            change.field_name = field_name;
+            change.new_value = new_value;
+            diff.field_changes.push_back(change);
+        } else if (old_field_it->second != new_value) {
+            FieldChange change;
+            change.object_label = label;
+            change.field_name = field_name;
+            change.old_value = old_field_it->second;
+            change.new_value = new_value;
+            diff.field_changes.push_back(change);
+        }
+    }
+}
+
+} // anonymous namespace
+
+Snapshot take_snapshot(Observer& obs) {
+    Snapshot snap = begin_snapshot(obs);
+
+    for (const auto& obj : obs.objects()) {
+        snap.objects[obj.label] = read_object(obs, obj, obs.get_type(obj.type_id));
+    }
+
+    return snap;
+}
+
+Snapshot take_snapshot(Observer& obs, BulkCopy& bulk) {
+    Snapshot snap = begin_snapshot(obs);
+
+    auto live = obs.objects();
+    bulk.copy(live);
+
+    for (size_t i = 0; i < live.size(); ++i) {
+        const ObservedType* type_info = obs.get_type(live[i].type_id);
+        const void* data = bulk.data(i);
+        // Destroyed during the copy
+        if (type_info && !data) continue;
+        snap.objects[live[i].label] = decode_object(live[i], type_info, data);
+    }
+
+    return snap;
+}
+
+SnapshotDiff compute_diff(const Snapshot& old_snap, const Snapshot& new_snap) {
+    SnapshotDiff diff;
+    diff.timestamp_ns = new_snap.timestamp_ns;
+    diff.old_sequence = old_snap.sequence;
+    diff.new_sequence = new_snap.sequence;
+
+    // Find added and removed objects
+    for (const auto& [label, obj] : new_snap.objects) {
+        if (old_snap.objects.find(label) == old_snap.objects.end()) {
+            diff.added_objects.push_back(label);
+        }
+    }
+    for (const auto& [label, obj] : old_snap.objects) {
+        if (new_snap.objects.find(label) == new_snap.objects.end()) {
+            diff.removed_objects.push_back(label);
+        }
+    }
+
+    // Find field changes in existing objects
+    for (const auto& [label, new_obj] : new_snap.objects) {
+        auto old_it = old_snap.objects.find(label);
+        if (old_it == old_snap.objects.end()) continue;  // new object, skip
+
+        diff_fields(label, old_it->second, new_obj, diff);
+    }
+
+    return diff;
+}
+
+namespace {
+
+// Field-by-field reads when bulk is null
+SnapshotDiff update_snapshot_impl(Observer& obs, Snapshot& snap, const DirtyTracker& dirty,
+                                  BulkCopy* bulk) {
+    SnapshotDiff diff;
+    diff.old_sequence = snap.sequence;
+
+    Snapshot next = begin_snapshot(obs);
+    diff.timestamp_ns = next.timestamp_ns;
+    diff.new_sequence = next.sequence;
+    snap.timestamp_ns = next.timestamp_ns;
+    snap.sequence = next.sequence;
+    snap.pid = next.pid;
+
+    auto live = obs.objects();
+    std::unordered_set<std::string_view> live_labels;
+    live_labels.reserve(live.size());
+
+    // Objects to (re-)read: new ones, and ones that moved or sit on dirty pages
+    std::vector<ObservedObject> pending;
+    for (const auto& obj : live) {
+        live_labels.insert(obj.label);
+        const ObservedType* type_info = obs.get_type(obj.type_id);
+
+        auto it = snap.objects.find(obj.label);
+        if (it != snap.objects.end()) {
+            // Same object at the same place on clean pages: nothing to decode
+            const ObjectSnapshot& cached = it->second;
+            bool moved = cached.region_id != obj.region_id || cached.offset != obj.offset ||
+                         cached.type_name != obj.type_name;
+            if (!moved && type_info && !dirty.is_dirty(obj.region_id, obj.offset, type_info->size)) {
+                continue;
+            }
+        }
+        pending.push_back(obj);
+    }
+
+    if (bulk) bulk->copy(pending);
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const ObservedObject& obj = pending[i];
+        const ObservedType* type_info = obs.get_type(obj.type_id);
+
+        ObjectSnapshot fresh;
+        if (bulk) {
+            const void* data = bulk->data(i);
+            // Destroyed during the copy; picked up next time
+            if (type_info && !data) continue;
+            fresh = decode_object(obj, type_info, data);
+        } else {
+            fresh = read_object(obs, obj, type_info);
+        }
+
+        auto it = snap.objects.find(obj.label);
+        if (it == snap.objects.end()) {
+            snap.objects[obj.label] = std::move(fresh);
+            diff.added_objects.push_back(obj.label);
+        } else {
+            diff_fields(obj.label, it->second, fresh, diff);
+            it->second = std::move(fresh);
+        }
+    }
+
+    for (auto it = snap.objects.begin(); it != snap.objects.end();) {
+        if (live_labels.count(it->first) == 0) {
+            diff.removed_objects.push_back(it->first);
+            it = snap.objects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return diff;
+}
+
+} // anonymous namespace
+
+SnapshotDiff update_snapshot(Observer& obs, Snapshot& snap, const DirtyTracker& dirty) {
+    return update_snapshot_impl(obs, snap, dirty, nullptr);
+}
+
+SnapshotDiff update_snapshot(Observer& obs, Snapshot& snap, const DirtyTracker& dirty,
+                             BulkCopy& bulk) {
+    return update_snapshot_impl(obs, snap, dirty, &bulk);
+}
+
+} // namespace memglass
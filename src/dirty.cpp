@@ -0,0 +1,203 @@
+#include "memglass/dirty.hpp"
+#include "memglass/observer.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace memglass {
+
+namespace {
+
+constexpr uint64_t PAGEMAP_SOFT_DIRTY = 1ull << 55;
+
+// The soft-dirty bit reads as zero on kernels built without
+// CONFIG_MEM_SOFT_DIRTY. Newly faulted pages always carry it when the
+// feature exists, so fault in a private page and look at our own pagemap.
+bool kernel_has_soft_dirty(size_t page_size) {
+    void* page = mmap(nullptr, page_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED) return false;
+    *static_cast<volatile char*>(page) = 1;
+
+    bool result = false;
+    int fd = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        uint64_t entry = 0;
+        off_t pos = static_cast<off_t>(reinterpret_cast<uintptr_t>(page) / page_size * 8);
+        if (pread(fd, &entry, sizeof(entry), pos) == sizeof(entry)) {
+            result = (entry & PAGEMAP_SOFT_DIRTY) != 0;
+        }
+        ::close(fd);
+    }
+    munmap(page, page_size);
+    return result;
+}
+
+} // anonymous namespace
+
+DirtyTracker::DirtyTracker(Observer& obs)
+    : obs_(obs)
+{
+    long ps = sysconf(_SC_PAGESIZE);
+    if (ps > 0) page_size_ = static_cast<size_t>(ps);
+}
+
+DirtyTracker::~DirtyTracker() {
+    if (pagemap_fd_ != -1) {
+        ::close(pagemap_fd_);
+    }
+}
+
+bool DirtyTracker::attach() {
+    if (pagemap_fd_ != -1) return true;
+
+    pid_ = obs_.producer_pid();
+    if (pid_ == 0 || !kernel_has_soft_dirty(page_size_)) {
+        return false;
+    }
+
+    std::string path = fmt::format("/proc/{}/pagemap", pid_);
+    pagemap_fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (pagemap_fd_ == -1) {
+        return false;
+    }
+
+    if (!clear_refs()) {
+        ::close(pagemap_fd_);
+        pagemap_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool DirtyTracker::clear_refs() {
+    std::string path = fmt::format("/proc/{}/clear_refs", pid_);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    bool ok = ::write(fd, "4", 1) == 1;  // 4 = clear soft-dirty bits
+    ::close(fd);
+    return ok;
+}
+
+bool DirtyTracker::load_mappings() {
+    std::string path = fmt::format("/proc/{}/maps", pid_);
+    FILE* maps = std::fopen(path.c_str(), "re");
+    if (!maps) return false;
+
+    for (auto& [id, region] : regions_) {
+        region.mappings.clear();
+    }
+
+    // Region segments show up as /dev/shm/memglass_<session>_region_NNNN
+    std::string needle = fmt::format("memglass_{}_region_", obs_.session_name());
+
+    char line[4096];
+    while (std::fgets(line, sizeof(line), maps)) {
+        char* name = std::strstr(line, needle.c_str());
+        if (!name) continue;
+
+        char* end = nullptr;
+        uint64_t region_id = std::strtoull(name + needle.size(), &end, 10);
+        if (end == name + needle.size()) continue;
+
+        unsigned long long start = 0, stop = 0, offset = 0;
+        if (std::sscanf(line, "%llx-%llx %*s %llx", &start, &stop, &offset) != 3) {
+            continue;
+        }
+        regions_[region_id].mappings.push_back({start, stop, offset});
+    }
+    std::fclose(maps);
+    return true;
+}
+
+void DirtyTracker::read_dirty_bits(RegionPages& region) {
+    size_t total = 0;
+    for (const auto& m : region.mappings) {
+        total = std::max<size_t>(total, (m.file_offset + (m.end - m.start)) / page_size_);
+    }
+    size_t words = (total + 63) / 64;
+    region.dirty.assign(words, 0);
+    region.previous.resize(words, 0);
+    region.known = true;
+    tracked_pages_ += total;
+
+    // A segment mapped more than once (e.g. producer and observer in one
+    // process) is dirty if any of its mappings wrote the page
+    for (const auto& m : region.mappings) {
+        size_t count = (m.end - m.start) / page_size_;
+        size_t first_page = m.file_offset / page_size_;
+        entries_.resize(count);
+
+        off_t pos = static_cast<off_t>(m.start / page_size_ * sizeof(uint64_t));
+        ssize_t n = pread(pagemap_fd_, entries_.data(), count * sizeof(uint64_t), pos);
+        if (n < 0) {
+            // Unreadable: report every page of the mapping as dirty
+            std::fill(entries_.begin(), entries_.end(), PAGEMAP_SOFT_DIRTY);
+            n = static_cast<ssize_t>(count * sizeof(uint64_t));
+        }
+
+        size_t read_count = static_cast<size_t>(n) / sizeof(uint64_t);
+        for (size_t i = 0; i < read_count; ++i) {
+            if (entries_[i] & PAGEMAP_SOFT_DIRTY) {
+                size_t page = first_page + i;
+                region.dirty[page / 64] |= 1ull << (page % 64);
+            }
+        }
+    }
+
+    // A store between the pagemap read and the clear below is lost to
+    // soft-dirty; pages written steadily are re-read one round late instead
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t fresh = region.dirty[i];
+        region.dirty[i] |= region.previous[i];
+        region.previous[i] = fresh;
+        dirty_pages_ += static_cast<size_t>(__builtin_popcountll(region.dirty[i]));
+    }
+}
+
+bool DirtyTracker::collect() {
+    if (!supported()) return false;
+
+    // Regions only appear on structural changes
+    uint64_t seq = obs_.sequence();
+    if (seq != mappings_sequence_) {
+        if (!load_mappings()) return false;
+        mappings_sequence_ = seq;
+    }
+
+    dirty_pages_ = 0;
+    tracked_pages_ = 0;
+    for (auto& [id, region] : regions_) {
+        read_dirty_bits(region);
+    }
+
+    ++collects_;
+    full_scan_ = full_scan_interval_ != 0 && collects_ % full_scan_interval_ == 0;
+    if (full_scan_) dirty_pages_ = tracked_pages_;
+    return clear_refs();
+}
+
+bool DirtyTracker::is_dirty(uint64_t region_id, uint64_t offset, uint64_t size) const {
+    if (!supported() || full_scan_) return true;
+
+    auto it = regions_.find(region_id);
+    if (it == regions_.end() || !it->second.known) return true;
+
+    const auto& bits = it->second.dirty;
+    uint64_t first = offset / page_size_;
+    uint64_t last = (offset + (size ? size : 1) - 1) / page_size_;
+    for (uint64_t page = first; page <= last; ++page) {
+        if (page / 64 >= bits.size()) return true;
+        if (bits[page / 64] & (1ull << (page % 64))) return true;
+    }
+    return false;
+}
+
+} // namespace memglass
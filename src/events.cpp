@@ -0,0 +1,168 @@
+#include "memglass/events.hpp"
+#include "memglass/observer.hpp"
+#include "memglass/detail/futex.hpp"
+#include "memglass/detail/seqlock.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace memglass {
+
+namespace {
+
+// Re-check Ctrl+C style flags and dead producers at least this often
+constexpr std::chrono::milliseconds MAX_SLEEP{100};
+
+EventEntry* ring_entries(EventRingHeader* ring) {
+    return reinterpret_cast<EventEntry*>(reinterpret_cast<char*>(ring) + ring->entries_offset);
+}
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+void publish_event(EventRingHeader* ring, EventKind kind, std::string_view name) {
+    uint64_t epoch = kind == EventKind::CycleEnd
+        ? ring->epoch.fetch_add(1, std::memory_order_relaxed) + 1
+        : ring->epoch.load(std::memory_order_relaxed);
+
+    uint64_t n = ring->head.fetch_add(1, std::memory_order_relaxed);
+    EventEntry& e = ring_entries(ring)[n & (ring->capacity - 1)];
+
+    // Same protocol as Guarded<T>, with the stamp naming the event
+    e.stamp.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.epoch = epoch;
+    e.timestamp_ns = steady_ns();
+    e.kind = static_cast<uint32_t>(kind);
+    e.set_name(name);
+    e.stamp.store(2 * n + 2, std::memory_order_release);
+
+    // Pairs with the waiter flag in EventListener::next(): either we see
+    // the flag or the waiter sees the new futex value. Clearing the flag
+    // with the wake means a listener that died while waiting costs one
+    // extra wake, not one per event; woken waiters set it again.
+    ring->futex.fetch_add(1, std::memory_order_seq_cst);
+    if (ring->waiters.load(std::memory_order_seq_cst) != 0 &&
+        ring->waiters.exchange(0, std::memory_order_seq_cst) != 0) {
+        futex_wake_all(&ring->futex);
+    }
+}
+
+} // namespace detail
+
+EventListener::EventListener(Observer& obs)
+    : obs_(obs)
+{
+}
+
+bool EventListener::attach() {
+    if (ring_) return true;
+
+    // Writable: waiters set a flag in the segment so the producer only
+    // issues a wake syscall when someone is blocked
+    if (!shm_.open(detail::make_events_shm_name(obs_.session_name()))) {
+        return false;
+    }
+
+    auto* ring = static_cast<EventRingHeader*>(shm_.data());
+    if (shm_.size() < sizeof(EventRingHeader) || ring->magic != EVENTS_MAGIC ||
+        ring->capacity == 0 ||
+        shm_.size() < ring->entries_offset + ring->capacity * sizeof(EventEntry)) {
+        shm_.close();
+        return false;
+    }
+
+    ring_ = ring;
+    entries_ = ring_entries(ring);
+    cursor_ = ring->head.load(std::memory_order_acquire);
+    return true;
+}
+
+bool EventListener::next(Event& out, std::chrono::nanoseconds timeout) {
+    if (!ring_) return false;
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    uint32_t mask = ring_->capacity - 1;
+
+    while (true) {
+        uint64_t head = ring_->head.load(std::memory_order_acquire);
+
+        if (cursor_ < head) {
+            if (head - cursor_ > ring_->capacity) {
+                missed_ += head - ring_->capacity - cursor_;
+                cursor_ = head - ring_->capacity;
+            }
+
+            const EventEntry& e = entries_[cursor_ & mask];
+            uint64_t want = 2 * cursor_ + 2;
+            uint64_t before = e.stamp.load(std::memory_order_acquire);
+            if (before == want) {
+                out.index = cursor_;
+                out.epoch = e.epoch;
+                out.timestamp_ns = e.timestamp_ns;
+                out.kind = static_cast<EventKind>(e.kind);
+                out.name.assign(e.name, strnlen(e.name, sizeof(e.name)));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (e.stamp.load(std::memory_order_relaxed) == want) {
+                    ++cursor_;
+                    return true;
+                }
+            }
+            if (e.stamp.load(std::memory_order_acquire) > want) {
+                // Overwritten by a newer event before we got to it
+                ++missed_;
+                ++cursor_;
+                continue;
+            }
+
+            // Reserved but still being written
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            MEMGLASS_PAUSE();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+
+        // Set the waiter flag before sampling the futex word so a publish
+        // after the head check either sees it or changes the word we sleep
+        // on. The producer clears the flag when it wakes us, so it is set
+        // again on every sleep and never left to be undone.
+        ring_->waiters.store(1, std::memory_order_seq_cst);
+        uint32_t word = ring_->futex.load(std::memory_order_seq_cst);
+        if (ring_->head.load(std::memory_order_seq_cst) == head) {
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+            detail::futex_wait(&ring_->futex, word, std::min<std::chrono::nanoseconds>(remaining, MAX_SLEEP));
+        }
+    }
+}
+
+bool EventListener::wait_for(EventKind kind, std::string_view name, Event& out,
+                             std::chrono::nanoseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (!next(out, std::max(remaining, std::chrono::nanoseconds(0)))) return false;
+        if (out.kind != kind) continue;
+        if (kind == EventKind::Mark && out.name != name) continue;
+        return true;
+    }
+}
+
+void EventListener::skip_to_head() {
+    if (ring_) cursor_ = ring_->head.load(std::memory_order_acquire);
+}
+
+uint64_t EventListener::epoch() const {
+    return ring_ ? ring_->epoch.load(std::memory_order_acquire) : 0;
+}
+
+} // namespace memglass
@@ -0,0 +1,212 @@
+#include "memglass/heartbeat.hpp"
+#include "memglass/memglass.hpp"
+#include "memglass/observer.hpp"
+#include "memglass/detail/session_slot.hpp"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace memglass {
+
+namespace {
+
+HeartbeatSlot* slot_at(HeartbeatHeader* header, uint32_t i) {
+    return reinterpret_cast<HeartbeatSlot*>(reinterpret_cast<char*>(header) + header->slots_offset) + i;
+}
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void free_slot(HeartbeatSlot* slot) {
+    slot->state.store(static_cast<uint32_t>(HeartbeatState::Free), std::memory_order_release);
+}
+
+// Session threads beat into
+detail::SessionSegment<HeartbeatHeader> g_session;
+
+// The calling thread's slot
+struct ThreadSlot {
+    detail::SlotClaim<HeartbeatHeader, HeartbeatSlot, free_slot> claim{g_session};  // stale until the first beat
+    uint64_t count = 0;
+    char name[32] = {};       // register_heartbeat() name, kept for re-claims
+    uint64_t max_silence_ns = 0;
+
+    // Claim a free slot of the current session. Tried once per session
+    // (or per unregister), so threads without a slot beat for free.
+    bool acquire() {
+        return claim.claim([this](HeartbeatHeader* header) -> HeartbeatSlot* {
+            for (uint32_t i = 0; i < header->slot_count; ++i) {
+                HeartbeatSlot* s = slot_at(header, i);
+                uint32_t expected = static_cast<uint32_t>(HeartbeatState::Free);
+                if (s->state.load(std::memory_order_relaxed) == expected &&
+                    s->state.compare_exchange_strong(expected, static_cast<uint32_t>(HeartbeatState::Claiming),
+                                                     std::memory_order_acquire)) {
+                    count = 0;
+                    s->count.store(0, std::memory_order_relaxed);
+                    s->tsc.store(read_tsc(), std::memory_order_relaxed);
+                    s->tid = static_cast<uint32_t>(syscall(SYS_gettid));
+                    s->max_silence_ns = max_silence_ns;
+                    std::memset(s->name, 0, sizeof(s->name));
+                    if (name[0]) {
+                        std::memcpy(s->name, name, sizeof(name));
+                    } else if (pthread_getname_np(pthread_self(), s->name, sizeof(s->name)) != 0) {
+                        s->name[0] = '\0';
+                    }
+                    s->state.store(static_cast<uint32_t>(HeartbeatState::Active), std::memory_order_release);
+                    return s;
+                }
+            }
+            return nullptr;
+        }) != nullptr;
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+} // anonymous namespace
+
+namespace detail {
+
+void heartbeat_attach(HeartbeatHeader* header) {
+    g_session.attach(header);
+}
+
+void heartbeat_detach() {
+    g_session.detach();
+}
+
+} // namespace detail
+
+void heartbeat() {
+    ThreadSlot& t = t_slot;
+    if (t.claim.stale()) t.acquire();
+
+    // Single writer: plain stores, no read-modify-write
+    if (HeartbeatSlot* s = t.claim.slot()) {
+        s->tsc.store(read_tsc(), std::memory_order_relaxed);
+        s->count.store(++t.count, std::memory_order_relaxed);
+    }
+}
+
+bool register_heartbeat(std::string_view name, std::chrono::nanoseconds max_silence) {
+    ThreadSlot& t = t_slot;
+    size_t len = std::min(name.size(), sizeof(t.name) - 1);
+    std::memset(t.name, 0, sizeof(t.name));
+    std::memcpy(t.name, name.data(), len);
+    t.max_silence_ns = static_cast<uint64_t>(std::max<int64_t>(0, max_silence.count()));
+
+    if (HeartbeatSlot* s = t.claim.current()) {
+        s->max_silence_ns = t.max_silence_ns;
+        std::memcpy(s->name, t.name, sizeof(t.name));
+        return true;
+    }
+    return t.acquire();
+}
+
+void unregister_heartbeat() {
+    t_slot.claim.reset();
+}
+
+// StallDetector implementation
+
+StallDetector::StallDetector(Observer& obs, const StallOptions& options)
+    : obs_(obs)
+    , options_(options)
+{
+}
+
+bool StallDetector::attach() {
+    if (header_) return true;
+
+    detail::MapOptions map;
+    map.writable = false;
+    if (!shm_.open(detail::make_heartbeats_shm_name(obs_.session_name()), map)) {
+        return false;
+    }
+
+    auto* header = static_cast<const HeartbeatHeader*>(shm_.data());
+    if (shm_.size() < sizeof(HeartbeatHeader) || header->magic != HEARTBEATS_MAGIC ||
+        shm_.size() < header->slots_offset + static_cast<size_t>(header->slot_count) * sizeof(HeartbeatSlot)) {
+        shm_.close();
+        return false;
+    }
+
+    header_ = header;
+    slots_ = reinterpret_cast<const HeartbeatSlot*>(static_cast<const char*>(shm_.data()) + header->slots_offset);
+    previous_.assign(header->slot_count, {});
+    clock_.set_origin(header->origin_tsc, header->origin_ns);
+    clock_.calibrate();
+    calibrated_at_ = TscClock::wall_now();
+    return true;
+}
+
+const std::vector<ThreadHeartbeat>& StallDetector::check() {
+    threads_.clear();
+    if (!header_) return threads_;
+
+    uint64_t wall = TscClock::wall_now();
+    if (wall - calibrated_at_ > 1'000'000'000ull) {
+        clock_.calibrate();
+        calibrated_at_ = wall;
+    }
+
+    uint64_t now_tsc = read_tsc();
+    uint64_t now_ns = steady_ns();
+    uint64_t default_threshold = static_cast<uint64_t>(std::max<int64_t>(0, options_.threshold.count()));
+    std::vector<size_t> stalls, recoveries;
+
+    for (uint32_t i = 0; i < header_->slot_count; ++i) {
+        const HeartbeatSlot& s = slots_[i];
+        Previous& prev = previous_[i];
+        if (s.state.load(std::memory_order_acquire) != static_cast<uint32_t>(HeartbeatState::Active)) {
+            prev = {};  // Exited or unregistered: not a stall
+            continue;
+        }
+
+        ThreadHeartbeat t;
+        t.slot = i;
+        t.tid = s.tid;
+        t.name.assign(s.name, strnlen(s.name, sizeof(s.name)));
+        if (t.name.empty()) t.name = "tid " + std::to_string(t.tid);
+        t.count = s.count.load(std::memory_order_relaxed);
+        uint64_t tsc = s.tsc.load(std::memory_order_relaxed);
+        t.silent_ns = now_tsc > tsc ? static_cast<uint64_t>(static_cast<double>(now_tsc - tsc) *
+                                                            (clock_.calibrated() ? clock_.ns_per_tick() : 1.0))
+                                    : 0;
+        t.threshold_ns = s.max_silence_ns ? s.max_silence_ns : default_threshold;
+        t.stalled = t.silent_ns > t.threshold_ns;
+
+        // Another thread took the slot: start over
+        if (prev.active && prev.tid != t.tid) prev = {};
+        if (prev.active && now_ns > prev.checked_ns && t.count >= prev.count) {
+            t.rate = static_cast<double>(t.count - prev.count) * 1e9 / static_cast<double>(now_ns - prev.checked_ns);
+        }
+
+        if (t.stalled && !prev.stalled) stalls.push_back(threads_.size());
+        if (!t.stalled && prev.stalled) recoveries.push_back(threads_.size());
+
+        prev = {t.tid, t.count, now_ns, true, t.stalled};
+        threads_.push_back(std::move(t));
+    }
+
+    if (on_stall_) {
+        for (size_t i : stalls) on_stall_(threads_[i]);
+    }
+    if (on_recover_) {
+        for (size_t i : recoveries) on_recover_(threads_[i]);
+    }
+    return threads_;
+}
+
+size_t StallDetector::stalled() const {
+    return static_cast<size_t>(std::count_if(threads_.begin(), threads_.end(),
+                                             [](const ThreadHeartbeat& t) { return t.stalled; }));
+}
+
+} // namespace memglass
@@ -0,0 +1,200 @@
+#include "memglass/ladder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace memglass {
+
+namespace {
+
+std::string level_field(std::string_view book, std::string_view side, uint32_t index,
+                        std::string_view member) {
+    std::string name(book);
+    name.append(".").append(side).append("[").append(std::to_string(index)).append("].");
+    name.append(member);
+    return name;
+}
+
+template<typename T>
+T load(const char* base, uint32_t offset, std::memory_order order) {
+    return reinterpret_cast<const std::atomic<T>*>(base + offset)->load(order);
+}
+
+bool snapshot_value(const ObjectSnapshot& obj, const std::string& name, FieldValue& out) {
+    auto it = obj.fields.find(name);
+    if (it == obj.fields.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void read_snapshot_side(const ObjectSnapshot& obj, std::string_view book, std::string_view side,
+                        uint64_t count, std::vector<LadderLevel>& out) {
+    out.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        FieldValue price;
+        FieldValue qty;
+        FieldValue orders;
+        if (!snapshot_value(obj, level_field(book, side, i, "price"), price) ||
+            !snapshot_value(obj, level_field(book, side, i, "qty"), qty)) {
+            break;
+        }
+        snapshot_value(obj, level_field(book, side, i, "orders"), orders);
+        out.push_back({price.as_double(), qty.as_double(), static_cast<uint64_t>(orders.as_int64())});
+    }
+}
+
+void diff_side(BookSide side, const std::vector<LadderLevel>& old_levels,
+               const std::vector<LadderLevel>& new_levels, std::vector<LevelChange>& out) {
+    // Both sides are sorted best first: merge on price
+    auto better = [side](double a, double b) { return side == BookSide::Bid ? a > b : a < b; };
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old_levels.size() || j < new_levels.size()) {
+        LevelChange change;
+        change.side = side;
+        if (j == new_levels.size() ||
+            (i < old_levels.size() && better(old_levels[i].price, new_levels[j].price))) {
+            change.price = old_levels[i].price;
+            change.old_level = old_levels[i++];
+            change.new_level.price = change.price;
+        } else if (i == old_levels.size() || better(new_levels[j].price, old_levels[i].price)) {
+            change.price = new_levels[j].price;
+            change.old_level.price = change.price;
+            change.new_level = new_levels[j++];
+        } else {
+            const LadderLevel& a = old_levels[i++];
+            const LadderLevel& b = new_levels[j++];
+            if (a.qty == b.qty && a.orders == b.orders) continue;
+            change.price = b.price;
+            change.old_level = a;
+            change.new_level = b;
+        }
+        out.push_back(change);
+    }
+}
+
+} // anonymous namespace
+
+std::vector<std::string> find_books(const ObservedType& type) {
+    std::vector<std::string> books;
+    constexpr std::string_view suffix = ".epoch";
+    type.for_each_leaf([&](std::string_view name, const FieldRef&) {
+        if (name.size() <= suffix.size() || !name.ends_with(suffix)) return;
+
+        std::string book(name.substr(0, name.size() - suffix.size()));
+        if (type.find_field(book + ".bid_count") && type.find_field(level_field(book, "bids", 0, "version"))) {
+            books.push_back(std::move(book));
+        }
+    });
+    return books;
+}
+
+BookReader::BookReader(const ObservedType& type, std::string_view name)
+    : name_(name)
+{
+    FieldRef epoch = type.find_field(name_ + ".epoch");
+    FieldRef bid_count = type.find_field(name_ + ".bid_count");
+    FieldRef ask_count = type.find_field(name_ + ".ask_count");
+    if (!epoch || !bid_count || !ask_count) return;
+
+    for (auto [side, slots] : {std::pair{"bids", &bids_}, std::pair{"asks", &asks_}}) {
+        for (uint32_t i = 0;; ++i) {
+            FieldRef version = type.find_field(level_field(name_, side, i, "version"));
+            FieldRef price = type.find_field(level_field(name_, side, i, "price"));
+            FieldRef qty = type.find_field(level_field(name_, side, i, "qty"));
+            FieldRef orders = type.find_field(level_field(name_, side, i, "orders"));
+            if (!version || !price || !qty || !orders) break;
+            slots->push_back({version.offset(), price.offset(), qty.offset(), orders.offset()});
+        }
+    }
+    if (bids_.empty() || bids_.size() != asks_.size()) {
+        bids_.clear();
+        asks_.clear();
+        return;
+    }
+
+    epoch_ = epoch.offset();
+    bid_count_ = bid_count.offset();
+    ask_count_ = ask_count.offset();
+    depth_ = static_cast<uint32_t>(bids_.size());
+}
+
+bool BookReader::read(const void* object, Ladder& out, uint32_t max_attempts) const {
+    if (!object || depth_ == 0) return false;
+    const char* base = static_cast<const char*>(object);
+
+    for (uint32_t attempt = 0; attempt < max_attempts; ++attempt) {
+        uint64_t e1 = load<uint64_t>(base, epoch_, std::memory_order_acquire);
+        if (e1 & 1) {
+            out.book_retries++;
+            MEMGLASS_PAUSE();
+            continue;
+        }
+
+        uint32_t bids = std::min(load<uint32_t>(base, bid_count_, std::memory_order_relaxed), depth_);
+        uint32_t asks = std::min(load<uint32_t>(base, ask_count_, std::memory_order_relaxed), depth_);
+        if (!read_side(base, bids_, bids, out.bids, out.level_retries, max_attempts) ||
+            !read_side(base, asks_, asks, out.asks, out.level_retries, max_attempts)) {
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (load<uint64_t>(base, epoch_, std::memory_order_relaxed) == e1) {
+            out.epoch = e1;
+            return true;
+        }
+        out.book_retries++;
+    }
+    return false;
+}
+
+bool BookReader::read_side(const char* base, const std::vector<Slot>& slots, uint32_t count,
+                           std::vector<LadderLevel>& out, uint32_t& retries,
+                           uint32_t max_attempts) const {
+    out.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const Slot& slot = slots[i];
+        uint32_t attempt = 0;
+        while (true) {
+            uint64_t v1 = load<uint64_t>(base, slot.version, std::memory_order_acquire);
+            if (!(v1 & 1)) {
+                out[i].price = load<double>(base, slot.price, std::memory_order_relaxed);
+                out[i].qty = load<double>(base, slot.qty, std::memory_order_relaxed);
+                out[i].orders = load<uint64_t>(base, slot.orders, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (load<uint64_t>(base, slot.version, std::memory_order_relaxed) == v1) break;
+            }
+            if (++attempt == max_attempts) return false;
+            retries++;
+            MEMGLASS_PAUSE();
+        }
+    }
+    return true;
+}
+
+bool read_ladder(const ObjectSnapshot& obj, std::string_view name, Ladder& out) {
+    std::string book(name);
+    FieldValue epoch;
+    FieldValue bid_count;
+    FieldValue ask_count;
+    if (!snapshot_value(obj, book + ".epoch", epoch) ||
+        !snapshot_value(obj, book + ".bid_count", bid_count) ||
+        !snapshot_value(obj, book + ".ask_count", ask_count)) {
+        return false;
+    }
+
+    out.epoch = static_cast<uint64_t>(epoch.as_int64());
+    read_snapshot_side(obj, name, "bids", static_cast<uint64_t>(bid_count.as_int64()), out.bids);
+    read_snapshot_side(obj, name, "asks", static_cast<uint64_t>(ask_count.as_int64()), out.asks);
+    return true;
+}
+
+std::vector<LevelChange> diff_ladders(const Ladder& old_ladder, const Ladder& new_ladder) {
+    std::vector<LevelChange> changes;
+    diff_side(BookSide::Bid, old_ladder.bids, new_ladder.bids, changes);
+    diff_side(BookSide::Ask, old_ladder.asks, new_ladder.asks, changes);
+    return changes;
+}
+
+} // namespace memglass
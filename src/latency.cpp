@@ -0,0 +1,306 @@
+#include "memglass/latency.hpp"
+#include "memglass/observer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace memglass {
+
+namespace {
+
+StampEntry* ring_entries(StampRingHeader* ring) {
+    return reinterpret_cast<StampEntry*>(reinterpret_cast<char*>(ring) + ring->entries_offset);
+}
+
+void raise_stage_count(StampRingHeader* ring, uint32_t count) {
+    uint32_t cur = ring->stage_count.load(std::memory_order_relaxed);
+    while (cur < count &&
+           !ring->stage_count.compare_exchange_weak(cur, count, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {
+    }
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+void publish_stamp(StampRingHeader* ring, uint64_t message_id, uint32_t stage) {
+    if (stage >= MAX_STAGES || !stamp_sampled(ring->sample_mask, message_id)) return;
+    uint64_t tsc = read_tsc();
+
+    if (stage >= ring->stage_count.load(std::memory_order_relaxed)) {
+        raise_stage_count(ring, stage + 1);
+    }
+
+    uint64_t n = ring->head.fetch_add(1, std::memory_order_relaxed);
+    StampEntry& e = ring_entries(ring)[n & (ring->capacity - 1)];
+
+    // Same protocol as the events ring
+    e.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.message_id = message_id;
+    e.tsc = tsc;
+    e.stage = stage;
+    e.seq.store(2 * n + 2, std::memory_order_release);
+}
+
+void name_stage(StampRingHeader* ring, uint32_t stage, std::string_view name) {
+    if (stage >= MAX_STAGES) return;
+    char* dst = ring->stage_names[stage];
+    size_t len = std::min(name.size(), sizeof(ring->stage_names[stage]) - 1);
+    std::memcpy(dst, name.data(), len);
+    std::memset(dst + len, 0, sizeof(ring->stage_names[stage]) - len);
+    raise_stage_count(ring, stage + 1);
+}
+
+} // namespace detail
+
+// LatencyHistogram
+
+size_t LatencyHistogram::index(uint64_t ns) {
+    if (ns < 16) return static_cast<size_t>(ns);
+    int e = 63 - __builtin_clzll(ns);
+    size_t sub = static_cast<size_t>((ns >> (e - 3)) & 7);
+    return 16 + static_cast<size_t>(e - 4) * 8 + sub;
+}
+
+uint64_t LatencyHistogram::lower_bound(size_t index) {
+    if (index < 16) return index;
+    size_t e = (index - 16) / 8 + 4;
+    uint64_t sub = (index - 16) % 8;
+    return (8 + sub) << (e - 3);
+}
+
+void LatencyHistogram::add(uint64_t ns) {
+    ++counts_[index(ns)];
+    ++count_;
+    sum_ += ns;
+    min_ = std::min(min_, ns);
+    max_ = std::max(max_, ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (count_ == 0) return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count_))));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            uint64_t lo = lower_bound(i);
+            uint64_t width = i < 16 ? 1 : lower_bound(i + 1) - lo;
+            return std::clamp(lo + width / 2, min_, max_);
+        }
+    }
+    return max_;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> LatencyHistogram::buckets() const {
+    std::vector<std::pair<uint64_t, uint64_t>> out;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        if (counts_[i]) out.emplace_back(lower_bound(i), counts_[i]);
+    }
+    return out;
+}
+
+// StampJoiner
+
+StampJoiner::StampJoiner(Observer& obs, const JoinOptions& options)
+    : obs_(obs)
+    , options_(options)
+{
+}
+
+bool StampJoiner::attach() {
+    if (ring_) return true;
+
+    detail::MapOptions map;
+    map.writable = false;
+    if (!shm_.open(detail::make_stamps_shm_name(obs_.session_name()), map)) {
+        return false;
+    }
+
+    auto* ring = static_cast<StampRingHeader*>(shm_.data());
+    if (shm_.size() < sizeof(StampRingHeader) || ring->magic != STAMPS_MAGIC ||
+        ring->capacity == 0 || (ring->capacity & (ring->capacity - 1)) != 0 ||
+        shm_.size() < ring->entries_offset + static_cast<size_t>(ring->capacity) * sizeof(StampEntry)) {
+        shm_.close();
+        return false;
+    }
+
+    ring_ = ring;
+    entries_ = ring_entries(ring);
+    cursor_ = ring->head.load(std::memory_order_acquire);
+    clock_.set_origin(ring->origin_tsc, ring->origin_ns);
+    clock_.calibrate();
+    calibrated_at_ = TscClock::wall_now();
+    refresh_stages();
+    return true;
+}
+
+size_t StampJoiner::poll() {
+    if (!ring_) return 0;
+
+    uint64_t now = TscClock::wall_now();
+    if (now - calibrated_at_ > 1'000'000'000ull) {
+        clock_.calibrate();
+        calibrated_at_ = now;
+    }
+    refresh_stages();
+
+    uint64_t head = ring_->head.load(std::memory_order_acquire);
+    uint32_t mask = ring_->capacity - 1;
+    size_t read = 0;
+
+    while (cursor_ < head) {
+        if (head - cursor_ > ring_->capacity) {
+            report_.missed += head - ring_->capacity - cursor_;
+            cursor_ = head - ring_->capacity;
+        }
+
+        const StampEntry& e = entries_[cursor_ & mask];
+        uint64_t want = 2 * cursor_ + 2;
+        if (e.seq.load(std::memory_order_acquire) == want) {
+            uint64_t id = e.message_id;
+            uint64_t tsc = e.tsc;
+            uint32_t stage = e.stage;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) == want) {
+                add(id, stage, tsc);
+                ++read;
+                ++cursor_;
+                continue;
+            }
+        }
+        if (e.seq.load(std::memory_order_acquire) > want) {
+            ++report_.missed;
+            ++cursor_;
+            continue;
+        }
+        break;  // Still being written; pick it up next poll
+    }
+
+    expire();
+    return read;
+}
+
+void StampJoiner::reset() {
+    report_ = {};
+    refresh_stages();
+}
+
+void StampJoiner::refresh_stages() {
+    uint32_t count = std::min<uint32_t>(ring_->stage_count.load(std::memory_order_acquire), MAX_STAGES);
+    if (report_.stages.size() < count) report_.stages.resize(count);
+    report_.stage_names.resize(report_.stages.size());
+
+    final_stage_ = options_.final_stage;
+    bool pick = final_stage_ == ~0u;
+    for (uint32_t i = 0; i < report_.stage_names.size(); ++i) {
+        const char* name = ring_->stage_names[i];
+        size_t len = strnlen(name, sizeof(ring_->stage_names[i]));
+        if (len) {
+            report_.stage_names[i].assign(name, len);
+            if (pick) final_stage_ = i;
+        } else {
+            report_.stage_names[i] = "stage" + std::to_string(i);
+        }
+    }
+}
+
+uint64_t StampJoiner::to_ns(uint64_t ticks) const {
+    if (!clock_.calibrated()) return ticks;
+    return static_cast<uint64_t>(static_cast<double>(ticks) * clock_.ns_per_tick());
+}
+
+void StampJoiner::add(uint64_t message_id, uint32_t stage, uint64_t tsc) {
+    if (stage >= MAX_STAGES) return;
+    if (stage >= report_.stages.size()) refresh_stages();
+    if (stage >= report_.stages.size()) return;
+
+    Pending& p = pending_[message_id];
+    if (p.stamps.empty()) {
+        p.first_tsc = tsc;
+        p.last_tsc = tsc;
+    }
+    for (const auto& s : p.stamps) {
+        if (s.first == stage) return;  // Only the first pass through a stage counts
+    }
+    p.stamps.emplace_back(stage, tsc);
+    p.first_tsc = std::min(p.first_tsc, tsc);
+    p.last_tsc = std::max(p.last_tsc, tsc);
+
+    if (stage == final_stage_) {
+        complete(message_id, p);
+        pending_.erase(message_id);
+    }
+}
+
+void StampJoiner::complete(uint64_t message_id, Pending& p) {
+    std::sort(p.stamps.begin(), p.stamps.end());
+
+    for (size_t i = 1; i < p.stamps.size(); ++i) {
+        uint64_t prev = p.stamps[i - 1].second;
+        uint64_t cur = p.stamps[i].second;
+        report_.stages[p.stamps[i].first].add(cur > prev ? to_ns(cur - prev) : 0);
+    }
+
+    uint64_t total = to_ns(p.last_tsc - p.first_tsc);
+    report_.end_to_end.add(total);
+    ++report_.messages;
+
+    auto& worst = report_.worst;
+    if (options_.worst == 0) return;
+    if (worst.size() >= options_.worst && total <= worst.back().total_ns) return;
+
+    MessageTrace trace;
+    trace.message_id = message_id;
+    trace.start_ns = clock_.calibrated() ? clock_.to_wall_ns(p.first_tsc) : 0;
+    trace.total_ns = total;
+    trace.stages.reserve(p.stamps.size());
+    for (const auto& [stage, tsc] : p.stamps) {
+        trace.stages.emplace_back(stage, to_ns(tsc - p.first_tsc));
+    }
+
+    auto pos = std::upper_bound(worst.begin(), worst.end(), total,
+                                [](uint64_t t, const MessageTrace& m) { return t > m.total_ns; });
+    worst.insert(pos, std::move(trace));
+    if (worst.size() > options_.worst) worst.pop_back();
+}
+
+void StampJoiner::expire() {
+    if (pending_.empty()) return;
+
+    double ns_per_tick = clock_.calibrated() ? clock_.ns_per_tick() : 1.0;
+    auto timeout = static_cast<uint64_t>(static_cast<double>(options_.timeout.count()) / ns_per_tick);
+
+    uint64_t now = read_tsc();
+
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        Pending& p = it->second;
+        if (now < p.last_tsc || now - p.last_tsc < timeout) {
+            ++it;
+            continue;
+        }
+        // Without a final stage a message is done once it goes quiet
+        if (final_stage_ == ~0u && p.stamps.size() > 1) {
+            complete(it->first, p);
+        } else {
+            ++report_.incomplete;
+        }
+        it = pending_.erase(it);
+    }
+}
+
+} // namespace memglass
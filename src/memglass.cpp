@@ -1,4 +1,8 @@
 #include "memglass/memglass.hpp"
+#include "memglass/cdc.hpp"
+#include "memglass/events.hpp"
+#include "memglass/heartbeat.hpp"
+#include "memglass/latency.hpp"
 
 #include <chrono>
 #include <unistd.h>
@@ -39,10 +43,15 @@ bool Context::init(std::string_view session_name, const Config& config) {
     size_t type_registry_size = config.max_types * sizeof(TypeEntry);
     size_t field_entries_size = config.max_fields * sizeof(FieldEntry);
     size_t object_dir_size = config.max_objects * sizeof(ObjectEntry);
+    // At most half full, so probes stay short
+    uint32_t label_index_capacity = 1;
+    while (label_index_capacity < config.max_objects * 2) label_index_capacity <<= 1;
+    size_t label_index_size = label_index_capacity * sizeof(uint64_t);
     size_t header_total_size = sizeof(TelemetryHeader) +
                                type_registry_size +
                                field_entries_size +
-                               object_dir_size;
+                               object_dir_size +
+                               label_index_size;
 
     // Create header shared memory
     std::string header_shm_name = detail::make_header_shm_name(session_name);
@@ -59,7 +68,7 @@ bool Context::init(std::string_view session_name, const Config& config) {
     header_->header_size = sizeof(TelemetryHeader);
     header_->sequence.store(0, std::memory_order_release);
 
-    // Layout: [TelemetryHeader][TypeEntry...][FieldEntry...][ObjectEntry...]
+    // Layout: [TelemetryHeader][TypeEntry...][FieldEntry...][ObjectEntry...][label index]
     header_->type_registry_offset = sizeof(TelemetryHeader);
     header_->type_registry_capacity = config.max_types;
     header_->type_count.store(0, std::memory_order_release);
@@ -72,6 +81,10 @@ bool Context::init(std::string_view session_name, const Config& config) {
     header_->object_dir_capacity = config.max_objects;
     header_->object_count.store(0, std::memory_order_release);
 
+    header_->label_index_offset = header_->object_dir_offset + object_dir_size;
+    header_->label_index_capacity = label_index_capacity;
+    header_->label_index_complete.store(1, std::memory_order_release);
+
     header_->first_region_id.store(0, std::memory_order_release);
     header_->first_overflow_region_id.store(0, std::memory_order_release);
 
@@ -83,9 +96,37 @@ bool Context::init(std::string_view session_name, const Config& config) {
     header_->start_timestamp = static_cast<uint64_t>(
         std::chrono::steady_clock::now().time_since_epoch().count());
 
+    // Create the CDC segment before any data region, so every region is
+    // published in it
+    if (config.cdc_ring_capacity > 0 && config.cdc_rings > 0) {
+        uint32_t capacity = 1;
+        while (capacity < config.cdc_ring_capacity) capacity <<= 1;
+        size_t rings_offset = (sizeof(CdcHeader) + alignof(CdcRing) - 1) & ~(alignof(CdcRing) - 1);
+        size_t records_offset = (sizeof(CdcRing) + alignof(CdcRecord) - 1) & ~(alignof(CdcRecord) - 1);
+        size_t ring_stride = (records_offset + capacity * sizeof(CdcRecord) + alignof(CdcRing) - 1) &
+                             ~(alignof(CdcRing) - 1);
+        size_t cdc_size = rings_offset + config.cdc_rings * ring_stride;
+
+        if (!cdc_shm_.create(detail::make_cdc_shm_name(session_name), cdc_size)) {
+            header_shm_.close();
+            return false;
+        }
+        cdc_ = static_cast<CdcHeader*>(cdc_shm_.data());
+        std::memset(static_cast<void*>(cdc_), 0, cdc_size);
+        cdc_->ring_count = config.cdc_rings;
+        cdc_->ring_capacity = capacity;
+        cdc_->rings_offset = rings_offset;
+        cdc_->ring_stride = ring_stride;
+        cdc_->records_offset = static_cast<uint32_t>(records_offset);
+        cdc_->origin_tsc = read_tsc();
+        cdc_->origin_ns = TscClock::wall_now();
+        cdc_->magic = CDC_MAGIC;
+    }
+
     // Create region manager
     regions_ = std::make_unique<RegionManager>(*this);
     if (!regions_->init(session_name, config.initial_region_size)) {
+        close_cdc();
         header_shm_.close();
         return false;
     }
@@ -94,6 +135,7 @@ bool Context::init(std::string_view session_name, const Config& config) {
     metadata_ = std::make_unique<MetadataManager>(*this);
     if (!metadata_->init(session_name)) {
         regions_.reset();
+        close_cdc();
         header_shm_.close();
         return false;
     }
@@ -101,21 +143,129 @@ bool Context::init(std::string_view session_name, const Config& config) {
     // Create object manager
     objects_ = std::make_unique<ObjectManager>(*this);
 
+    // Create events segment
+    if (config.event_ring_capacity > 0) {
+        uint32_t capacity = 1;
+        while (capacity < config.event_ring_capacity) capacity <<= 1;
+        size_t entries_offset = (sizeof(EventRingHeader) + alignof(EventEntry) - 1) &
+                                ~(alignof(EventEntry) - 1);
+        size_t events_size = entries_offset + capacity * sizeof(EventEntry);
+
+        if (!events_shm_.create(detail::make_events_shm_name(session_name), events_size)) {
+            objects_.reset();
+            metadata_.reset();
+            regions_.reset();
+            close_cdc();
+            header_shm_.close();
+            return false;
+        }
+        events_ = static_cast<EventRingHeader*>(events_shm_.data());
+        std::memset(static_cast<void*>(events_), 0, events_size);
+        events_->capacity = capacity;
+        events_->entries_offset = static_cast<uint32_t>(entries_offset);
+        events_->magic = EVENTS_MAGIC;
+    }
+
+    // Create stamps segment
+    if (config.stamp_ring_capacity > 0) {
+        uint32_t capacity = 1;
+        while (capacity < config.stamp_ring_capacity) capacity <<= 1;
+        uint64_t sample_every = 1;
+        while (sample_every < config.stamp_sample_every) sample_every <<= 1;
+        size_t entries_offset = (sizeof(StampRingHeader) + alignof(StampEntry) - 1) &
+                                ~(alignof(StampEntry) - 1);
+        size_t stamps_size = entries_offset + capacity * sizeof(StampEntry);
+
+        if (!stamps_shm_.create(detail::make_stamps_shm_name(session_name), stamps_size)) {
+            objects_.reset();
+            metadata_.reset();
+            regions_.reset();
+            close_cdc();
+            events_shm_.close();
+            events_ = nullptr;
+            header_shm_.close();
+            return false;
+        }
+        stamps_ = static_cast<StampRingHeader*>(stamps_shm_.data());
+        std::memset(static_cast<void*>(stamps_), 0, stamps_size);
+        stamps_->capacity = capacity;
+        stamps_->entries_offset = static_cast<uint32_t>(entries_offset);
+        stamps_->sample_mask = sample_every - 1;
+        stamps_->origin_tsc = read_tsc();
+        stamps_->origin_ns = TscClock::wall_now();
+        stamps_->magic = STAMPS_MAGIC;
+    }
+
+    // Create heartbeats segment
+    if (config.heartbeat_slots > 0) {
+        size_t slots_offset = (sizeof(HeartbeatHeader) + alignof(HeartbeatSlot) - 1) &
+                              ~(alignof(HeartbeatSlot) - 1);
+        size_t heartbeats_size = slots_offset + config.heartbeat_slots * sizeof(HeartbeatSlot);
+
+        if (!heartbeats_shm_.create(detail::make_heartbeats_shm_name(session_name), heartbeats_size)) {
+            objects_.reset();
+            metadata_.reset();
+            regions_.reset();
+            close_cdc();
+            stamps_shm_.close();
+            stamps_ = nullptr;
+            events_shm_.close();
+            events_ = nullptr;
+            header_shm_.close();
+            return false;
+        }
+        heartbeats_ = static_cast<HeartbeatHeader*>(heartbeats_shm_.data());
+        std::memset(static_cast<void*>(heartbeats_), 0, heartbeats_size);
+        heartbeats_->slot_count = config.heartbeat_slots;
+        heartbeats_->slots_offset = static_cast<uint32_t>(slots_offset);
+        heartbeats_->origin_tsc = read_tsc();
+        heartbeats_->origin_ns = TscClock::wall_now();
+        heartbeats_->magic = HEARTBEATS_MAGIC;
+    }
+
     // Write type registry to header
     registry::write_to_header(header_, header_shm_.data());
 
+    // Carry a pause set before init() over to the session, where observers
+    // can flip it
+    header_->paused.store(detail::local_paused.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    detail::paused_flag = &header_->paused;
+
+    if (cdc_) detail::cdc_attach(cdc_);
+    if (heartbeats_) detail::heartbeat_attach(heartbeats_);
+
     initialized_ = true;
     return true;
 }
 
+void Context::close_cdc() {
+    cdc_shm_.close();
+    cdc_ = nullptr;
+}
+
 void Context::shutdown() {
     if (!initialized_) return;
 
+    detail::local_paused.store(header_->paused.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    detail::paused_flag = &detail::local_paused;
+
+    if (cdc_) detail::cdc_detach();
+    if (heartbeats_) detail::heartbeat_detach();
+
     objects_.reset();
     metadata_.reset();
     regions_.reset();
+    close_cdc();
+    heartbeats_shm_.close();
+    stamps_shm_.close();
+    events_shm_.close();
     header_shm_.close();
 
+    heartbeats_ = nullptr;
+    stamps_ = nullptr;
+    events_ = nullptr;
     header_ = nullptr;
     initialized_ = false;
 }
@@ -145,6 +295,34 @@ void shutdown() {
     }
 }
 
+void mark(std::string_view name) {
+    Context* ctx = detail::get_context();
+    if (ctx && ctx->events() && !paused()) {
+        detail::publish_event(ctx->events(), EventKind::Mark, name);
+    }
+}
+
+void cycle_end() {
+    Context* ctx = detail::get_context();
+    if (ctx && ctx->events() && !paused()) {
+        detail::publish_event(ctx->events(), EventKind::CycleEnd, {});
+    }
+}
+
+void stamp(uint64_t message_id, uint32_t stage) {
+    Context* ctx = detail::get_context();
+    if (ctx && ctx->stamps() && !paused()) {
+        detail::publish_stamp(ctx->stamps(), message_id, stage);
+    }
+}
+
+void define_stage(uint32_t stage, std::string_view name) {
+    Context* ctx = detail::get_context();
+    if (ctx && ctx->stamps()) {
+        detail::name_stage(ctx->stamps(), stage, name);
+    }
+}
+
 Config& config() {
     static Config default_config;
     Context* ctx = detail::get_context();
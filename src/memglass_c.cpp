@@ -0,0 +1,574 @@
+#include "memglass/memglass_c.h"
+
+#include "memglass/diff.hpp"
+#include "memglass/events.hpp"
+#include "memglass/observer.hpp"
+#include "memglass/query.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace memglass;
+
+struct memglass_observer {
+    explicit memglass_observer(const char* session, const ObserverOptions& options)
+        : observer(session, options) {}
+
+    Observer observer;
+    std::vector<ObservedObject> objects;
+    uint64_t sequence = 0;  // as of the last open/refresh
+    std::unique_ptr<EventListener> events;  // attached by the first wait_event
+
+    // Returned strings must outlive refreshes, which rebuild the type list
+    mutable std::unordered_set<std::string> strings;
+
+    const char* intern(const std::string& s) const {
+        return strings.insert(s).first->c_str();
+    }
+};
+
+struct memglass_recording {
+    mgdf::MappedFile file;
+    query::QueryResult result;  // of the last query
+    std::string error;
+};
+
+namespace {
+
+// Bound on seqlock/lock retries before reporting MEMGLASS_ERR_BUSY
+constexpr int READ_RETRIES = 1 << 16;
+
+// Spin briefly, then sleep with growing intervals (capped at 1ms)
+class Backoff {
+public:
+    void wait() {
+        if (rounds_ < 64) {
+            MEMGLASS_PAUSE();
+        } else {
+            auto us = std::min<int64_t>(1000, int64_t{10} << std::min(rounds_ - 64, 7));
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+        rounds_++;
+    }
+
+private:
+    int rounds_ = 0;
+};
+
+class Deadline {
+public:
+    explicit Deadline(int32_t timeout_ms)
+        : forever_(timeout_ms < 0)
+        , end_(std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0))) {}
+
+    bool expired() const {
+        return !forever_ && std::chrono::steady_clock::now() >= end_;
+    }
+
+private:
+    bool forever_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+size_t align_up(size_t n, size_t a) {
+    return (n + a - 1) / a * a;
+}
+
+void fill_type(const ObservedType& t, const memglass_observer* obs, memglass_type_info* out) {
+    out->name = obs->intern(t.name);
+    out->type_id = t.type_id;
+    out->size = t.size;
+    out->alignment = t.alignment;
+    out->field_count = static_cast<uint32_t>(t.fields.size());
+}
+
+int fill_object(memglass_observer* obs, const ObservedObject& o, memglass_object* out) {
+    const ObservedType* type = obs->observer.get_type(o.type_id);
+    const void* data = obs->observer.get_object_data(o.region_id, o.offset);
+    if (!type || !data) return MEMGLASS_ERR_NOT_FOUND;
+
+    out->label = obs->intern(o.label);
+    out->type_name = obs->intern(type->name);
+    out->data = data;
+    out->type_id = o.type_id;
+    out->size = type->size;
+    out->generation = o.generation;
+    out->entry = o.entry;
+    return MEMGLASS_OK;
+}
+
+size_t primitive_size(uint32_t type_id) {
+    switch (type_id) {
+        case MEMGLASS_TYPE_BOOL:
+        case MEMGLASS_TYPE_INT8:
+        case MEMGLASS_TYPE_UINT8:
+        case MEMGLASS_TYPE_CHAR: return 1;
+        case MEMGLASS_TYPE_INT16:
+        case MEMGLASS_TYPE_UINT16: return 2;
+        case MEMGLASS_TYPE_INT32:
+        case MEMGLASS_TYPE_UINT32:
+        case MEMGLASS_TYPE_FLOAT32: return 4;
+        case MEMGLASS_TYPE_INT64:
+        case MEMGLASS_TYPE_UINT64:
+        case MEMGLASS_TYPE_FLOAT64: return 8;
+        default: return 0;
+    }
+}
+
+// Bytes of the value itself. Registrations of Guarded/Locked fields may
+// give the wrapper's size, so primitives use their element size instead.
+uint32_t value_size(const FieldEntry& f) {
+    size_t elem = primitive_size(f.type_id);
+    if (elem == 0) return f.size;
+    return static_cast<uint32_t>(elem * std::max<uint32_t>(f.array_size, 1));
+}
+
+// Resolve a path like ObjectView::operator[]: a field, or a dotted path
+// through the nested types, then fields of types the schema leaves opaque
+bool resolve_field(const Observer& observer, const ObservedType* type, std::string_view path,
+                   uint32_t base, memglass_field& out) {
+    if (!type) return false;
+
+    if (FieldRef f = type->find_field(path)) {
+        out.offset = base + f.offset();
+        out.size = value_size(*f.entry);
+        out.type_id = f.entry->type_id;
+        out.array_size = f.entry->array_size;
+        out.atomicity = static_cast<uint8_t>(f.entry->atomicity);
+        return true;
+    }
+
+    size_t dot = path.find('.');
+    if (dot == std::string_view::npos) return false;
+
+    FieldRef f = type->find_field(path.substr(0, dot));
+    return f && resolve_field(observer, observer.get_type(f.entry->type_id), path.substr(dot + 1),
+                              base + f.offset(), out);
+}
+
+int read_atomic(const char* p, size_t size, void* out) {
+    switch (size) {
+        case 1: { uint8_t v = __atomic_load_n(reinterpret_cast<const uint8_t*>(p), __ATOMIC_ACQUIRE); std::memcpy(out, &v, 1); break; }
+        case 2: { uint16_t v = __atomic_load_n(reinterpret_cast<const uint16_t*>(p), __ATOMIC_ACQUIRE); std::memcpy(out, &v, 2); break; }
+        case 4: { uint32_t v = __atomic_load_n(reinterpret_cast<const uint32_t*>(p), __ATOMIC_ACQUIRE); std::memcpy(out, &v, 4); break; }
+        case 8: { uint64_t v = __atomic_load_n(reinterpret_cast<const uint64_t*>(p), __ATOMIC_ACQUIRE); std::memcpy(out, &v, 8); break; }
+        default: std::memcpy(out, p, size); break;
+    }
+    return MEMGLASS_OK;
+}
+
+// Guarded<T>: value, then the sequence counter
+int read_seqlock(const char* p, size_t size, void* out) {
+    auto* seq = reinterpret_cast<const std::atomic<size_t>*>(p + align_up(size, alignof(size_t)));
+    for (int i = 0; i < READ_RETRIES; ++i) {
+        size_t s1 = seq->load(std::memory_order_acquire);
+        if (s1 & 1) {
+            MEMGLASS_PAUSE();
+            continue;
+        }
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        std::memcpy(out, p, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq->load(std::memory_order_relaxed) == s1) {
+            return MEMGLASS_OK;
+        }
+    }
+    return MEMGLASS_ERR_BUSY;
+}
+
+// Locked<T>: flag, value, then the sequence bumped under the lock;
+// validated like Locked<T>::read_unlocked() since the mapping is read-only
+int read_locked(const char* p, const memglass_field& f, void* out) {
+    size_t elem = f.array_size ? f.size / f.array_size : f.size;
+    const char* value = p + detail::locked_value_offset(elem);
+    auto* seq = reinterpret_cast<const std::atomic<uint32_t>*>(p + detail::locked_seq_offset(elem));
+    for (int i = 0; i < READ_RETRIES; ++i) {
+        uint32_t s1 = seq->load(std::memory_order_acquire);
+        if (s1 & 1) {
+            MEMGLASS_PAUSE();
+            continue;
+        }
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        std::memcpy(out, value, f.size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq->load(std::memory_order_relaxed) == s1) {
+            return MEMGLASS_OK;
+        }
+    }
+    return MEMGLASS_ERR_BUSY;
+}
+
+int read_field(const memglass_object* obj, const memglass_field* field, void* out) {
+    const char* p = static_cast<const char*>(obj->data) + field->offset;
+    switch (field->atomicity) {
+        case MEMGLASS_ATOMICITY_ATOMIC: return read_atomic(p, field->size, out);
+        case MEMGLASS_ATOMICITY_SEQLOCK: return read_seqlock(p, field->size, out);
+        case MEMGLASS_ATOMICITY_LOCKED: return read_locked(p, *field, out);
+        default:
+            std::memcpy(out, p, field->size);
+            return MEMGLASS_OK;
+    }
+}
+
+// Read a scalar primitive into a FieldValue
+int read_value(const memglass_object* obj, const memglass_field* field, FieldValue& v) {
+    if (!field || field->array_size != 0 || field->type_id == MEMGLASS_TYPE_UNKNOWN ||
+        field->type_id > MEMGLASS_TYPE_CHAR || field->size > sizeof(v.data)) {
+        return MEMGLASS_ERR_TYPE;
+    }
+    v.type = static_cast<PrimitiveType>(field->type_id);
+    return memglass_read(obj, field, &v.data, sizeof(v.data));
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+uint32_t memglass_abi_version(void) {
+    return MEMGLASS_C_ABI_VERSION;
+}
+
+const char* memglass_strerror(int status) {
+    switch (status) {
+        case MEMGLASS_OK: return "ok";
+        case MEMGLASS_ERR_INVALID: return "invalid argument";
+        case MEMGLASS_ERR_NOT_FOUND: return "not found";
+        case MEMGLASS_ERR_STALE: return "object destroyed or reused";
+        case MEMGLASS_ERR_BUSY: return "no consistent read (writer busy)";
+        case MEMGLASS_ERR_TIMEOUT: return "timed out";
+        case MEMGLASS_ERR_TYPE: return "field type mismatch";
+        default: return "unknown error";
+    }
+}
+
+memglass_observer* memglass_open(const char* session, uint32_t flags) {
+    if (!session) return nullptr;
+    if ((flags & MEMGLASS_OPEN_POPULATE) && (flags & MEMGLASS_OPEN_LAZY)) return nullptr;
+
+    ObserverOptions options;
+    options.writable = false;
+    if (flags & MEMGLASS_OPEN_POPULATE) options.regions = RegionMapping::Populate;
+    if (flags & MEMGLASS_OPEN_LAZY) options.regions = RegionMapping::Lazy;
+
+    auto* obs = new memglass_observer(session, options);
+    if (!obs->observer.connect()) {
+        delete obs;
+        return nullptr;
+    }
+    obs->sequence = obs->observer.sequence();
+    obs->objects = obs->observer.objects();
+    return obs;
+}
+
+void memglass_close(memglass_observer* obs) {
+    delete obs;
+}
+
+int memglass_refresh(memglass_observer* obs) {
+    if (!obs) return MEMGLASS_ERR_INVALID;
+
+    uint64_t seq = obs->observer.sequence();
+    if (seq == obs->sequence) return 0;
+
+    obs->observer.refresh();
+    obs->objects = obs->observer.objects();
+    obs->sequence = seq;
+    return 1;
+}
+
+uint64_t memglass_sequence(const memglass_observer* obs) {
+    return obs ? obs->observer.sequence() : 0;
+}
+
+uint64_t memglass_producer_pid(const memglass_observer* obs) {
+    return obs ? obs->observer.producer_pid() : 0;
+}
+
+uint64_t memglass_start_timestamp(const memglass_observer* obs) {
+    return obs ? obs->observer.start_timestamp() : 0;
+}
+
+uint32_t memglass_type_count(const memglass_observer* obs) {
+    return obs ? static_cast<uint32_t>(obs->observer.types().size()) : 0;
+}
+
+int memglass_type_at(const memglass_observer* obs, uint32_t index, memglass_type_info* out) {
+    if (!obs || !out) return MEMGLASS_ERR_INVALID;
+    const auto& types = obs->observer.types();
+    if (index >= types.size()) return MEMGLASS_ERR_NOT_FOUND;
+    fill_type(types[index], obs, out);
+    return MEMGLASS_OK;
+}
+
+int memglass_type_find(const memglass_observer* obs, const char* name, memglass_type_info* out) {
+    if (!obs || !name || !out) return MEMGLASS_ERR_INVALID;
+    for (const auto& t : obs->observer.types()) {
+        if (t.name == name) {
+            fill_type(t, obs, out);
+            return MEMGLASS_OK;
+        }
+    }
+    return MEMGLASS_ERR_NOT_FOUND;
+}
+
+int memglass_field_at(const memglass_observer* obs, uint32_t type_id, uint32_t index,
+                      memglass_field_info* out) {
+    if (!obs || !out) return MEMGLASS_ERR_INVALID;
+    const ObservedType* type = obs->observer.get_type(type_id);
+    if (!type || index >= type->fields.size()) return MEMGLASS_ERR_NOT_FOUND;
+
+    const FieldEntry& f = type->fields[index];
+    *out = memglass_field_info{};
+    out->name = obs->intern(f.name);
+    out->offset = f.offset;
+    out->size = f.size;
+    out->type_id = f.type_id;
+    out->flags = f.flags;
+    out->array_size = f.array_size;
+    out->atomicity = static_cast<uint8_t>(f.atomicity);
+    return MEMGLASS_OK;
+}
+
+int memglass_field_compile(const memglass_observer* obs, uint32_t type_id, const char* path,
+                           memglass_field* out) {
+    if (!obs || !path || !out) return MEMGLASS_ERR_INVALID;
+
+    memglass_field f{};
+    f.owner_type_id = type_id;
+    if (!resolve_field(obs->observer, obs->observer.get_type(type_id), path, 0, f)) {
+        return MEMGLASS_ERR_NOT_FOUND;
+    }
+    *out = f;
+    return MEMGLASS_OK;
+}
+
+uint32_t memglass_object_count(const memglass_observer* obs) {
+    return obs ? static_cast<uint32_t>(obs->objects.size()) : 0;
+}
+
+int memglass_object_at(memglass_observer* obs, uint32_t index, memglass_object* out) {
+    if (!obs || !out) return MEMGLASS_ERR_INVALID;
+    if (index >= obs->objects.size()) return MEMGLASS_ERR_NOT_FOUND;
+    return fill_object(obs, obs->objects[index], out);
+}
+
+int memglass_object_find(memglass_observer* obs, const char* label, memglass_object* out) {
+    if (!obs || !label || !out) return MEMGLASS_ERR_INVALID;
+    ObjectView view = obs->observer.find(label);
+    if (!view) return MEMGLASS_ERR_NOT_FOUND;
+    return fill_object(obs, view.info(), out);
+}
+
+int memglass_object_check(const memglass_object* obj) {
+    if (!obj || !obj->entry) return MEMGLASS_ERR_INVALID;
+    auto* entry = static_cast<const ObjectEntry*>(obj->entry);
+    if (entry->status.load(std::memory_order_acquire) !=
+        object_status(obj->generation, ObjectState::Alive)) {
+        return MEMGLASS_ERR_STALE;
+    }
+    return MEMGLASS_OK;
+}
+
+int memglass_read(const memglass_object* obj, const memglass_field* field, void* out,
+                  size_t out_size) {
+    if (!obj || !obj->data || !field || !out) return MEMGLASS_ERR_INVALID;
+    if (field->owner_type_id != obj->type_id) return MEMGLASS_ERR_TYPE;
+    if (out_size < field->size || field->offset + field->size > obj->size) {
+        return MEMGLASS_ERR_INVALID;
+    }
+
+    int rc = read_field(obj, field, out);
+    if (rc != MEMGLASS_OK) return rc;
+    return memglass_object_check(obj);
+}
+
+int memglass_read_i64(const memglass_object* obj, const memglass_field* field, int64_t* out) {
+    if (!out) return MEMGLASS_ERR_INVALID;
+    FieldValue v;
+    int rc = read_value(obj, field, v);
+    if (rc != MEMGLASS_OK) return rc;
+    if (!v.is_integer()) return MEMGLASS_ERR_TYPE;
+    *out = v.as_int64();
+    return MEMGLASS_OK;
+}
+
+int memglass_read_f64(const memglass_object* obj, const memglass_field* field, double* out) {
+    if (!out) return MEMGLASS_ERR_INVALID;
+    FieldValue v;
+    int rc = read_value(obj, field, v);
+    if (rc != MEMGLASS_OK) return rc;
+    *out = v.as_double();
+    return MEMGLASS_OK;
+}
+
+int memglass_read_object(const memglass_object* obj, void* out, size_t out_size) {
+    if (!obj || !obj->data || !out || out_size < obj->size) return MEMGLASS_ERR_INVALID;
+    std::memcpy(out, obj->data, obj->size);
+    return memglass_object_check(obj);
+}
+
+int memglass_wait_sequence(const memglass_observer* obs, uint64_t last_sequence,
+                           int32_t timeout_ms, uint64_t* sequence) {
+    if (!obs) return MEMGLASS_ERR_INVALID;
+
+    Deadline deadline(timeout_ms);
+    Backoff backoff;
+    while (true) {
+        uint64_t seq = obs->observer.sequence();
+        if (seq != last_sequence) {
+            if (sequence) *sequence = seq;
+            return MEMGLASS_OK;
+        }
+        if (deadline.expired()) return MEMGLASS_ERR_TIMEOUT;
+        backoff.wait();
+    }
+}
+
+int memglass_wait_field(const memglass_object* obj, const memglass_field* field, void* previous,
+                        size_t size, int32_t timeout_ms) {
+    if (!obj || !field || !previous || size < field->size) return MEMGLASS_ERR_INVALID;
+
+    std::vector<char> current(field->size);
+    Deadline deadline(timeout_ms);
+    Backoff backoff;
+    while (true) {
+        int rc = memglass_read(obj, field, current.data(), current.size());
+        if (rc != MEMGLASS_OK && rc != MEMGLASS_ERR_BUSY) return rc;
+        if (rc == MEMGLASS_OK && std::memcmp(current.data(), previous, field->size) != 0) {
+            std::memcpy(previous, current.data(), field->size);
+            return MEMGLASS_OK;
+        }
+        if (deadline.expired()) return MEMGLASS_ERR_TIMEOUT;
+        backoff.wait();
+    }
+}
+
+int memglass_wait_event(memglass_observer* obs, const char* mark, int32_t timeout_ms,
+                        uint64_t* epoch) {
+    if (!obs) return MEMGLASS_ERR_INVALID;
+
+    if (!obs->events) {
+        auto events = std::make_unique<EventListener>(obs->observer);
+        if (!events->attach()) return MEMGLASS_ERR_NOT_FOUND;
+        obs->events = std::move(events);
+    }
+
+    EventKind kind = mark ? EventKind::Mark : EventKind::CycleEnd;
+    std::chrono::nanoseconds timeout = timeout_ms < 0
+        ? std::chrono::nanoseconds::max() / 2
+        : std::chrono::milliseconds(timeout_ms);
+
+    obs->events->skip_to_head();
+    Event event;
+    if (!obs->events->wait_for(kind, mark ? mark : "", event, timeout)) {
+        return MEMGLASS_ERR_TIMEOUT;
+    }
+    if (epoch) *epoch = event.epoch;
+    return MEMGLASS_OK;
+}
+
+memglass_recording* memglass_recording_open(const char* path) {
+    if (!path) return nullptr;
+    auto* rec = new memglass_recording;
+    if (!rec->file.open(path)) {
+        delete rec;
+        return nullptr;
+    }
+    return rec;
+}
+
+void memglass_recording_close(memglass_recording* rec) {
+    delete rec;
+}
+
+int memglass_recording_describe(const memglass_recording* rec, memglass_recording_info* out) {
+    if (!rec || !out) return MEMGLASS_ERR_INVALID;
+
+    const auto& blocks = rec->file.blocks();
+    *out = memglass_recording_info{};
+    out->version = rec->file.version();
+    out->flags = rec->file.flags();
+    out->block_count = static_cast<uint32_t>(blocks.size());
+    out->has_index = rec->file.has_index() ? 1 : 0;
+    if (!blocks.empty()) {
+        out->first_ts = blocks.front().first_ts;
+        for (const auto& b : blocks) out->last_ts = std::max(out->last_ts, b.last_ts);
+    }
+    return MEMGLASS_OK;
+}
+
+int memglass_recording_query(memglass_recording* rec, const memglass_query* request,
+                             memglass_query_stats* stats) {
+    if (!rec || !request) return MEMGLASS_ERR_INVALID;
+    rec->error.clear();
+    rec->result = query::QueryResult{};
+
+    if (request->aggregation > MEMGLASS_AGG_COUNT || (request->label_count && !request->labels) ||
+        (request->field_count && !request->fields)) {
+        rec->error = "invalid query";
+        return MEMGLASS_ERR_INVALID;
+    }
+
+    query::Query q;
+    for (uint32_t i = 0; i < request->label_count; ++i) {
+        if (request->labels[i]) q.labels.emplace_back(request->labels[i]);
+    }
+    for (uint32_t i = 0; i < request->field_count; ++i) {
+        if (request->fields[i]) q.fields.emplace_back(request->fields[i]);
+    }
+    q.start_ns = request->start_ns;
+    if (request->end_ns) q.end_ns = request->end_ns;
+    q.interval_ns = request->interval_ns;
+    q.aggregation = static_cast<query::Aggregation>(request->aggregation);
+    q.fill = request->fill != 0;
+    q.threads = request->threads;
+
+    if (!query::run_query(rec->file, q, rec->result, &rec->error)) {
+        rec->result = query::QueryResult{};
+        return MEMGLASS_ERR_INVALID;
+    }
+
+    if (stats) {
+        const auto& s = rec->result.stats;
+        stats->blocks_total = s.blocks_total;
+        stats->blocks_in_range = s.blocks_in_range;
+        stats->blocks_decoded = s.blocks_decoded;
+        stats->records = s.records;
+        stats->points = s.points;
+    }
+    return MEMGLASS_OK;
+}
+
+uint32_t memglass_series_count(const memglass_recording* rec) {
+    return rec ? static_cast<uint32_t>(rec->result.series.size()) : 0;
+}
+
+int memglass_series_at(const memglass_recording* rec, uint32_t index, memglass_series* out) {
+    if (!rec || !out) return MEMGLASS_ERR_INVALID;
+    if (index >= rec->result.series.size()) return MEMGLASS_ERR_NOT_FOUND;
+
+    const query::Series& s = rec->result.series[index];
+    *out = memglass_series{};
+    out->label = s.label.c_str();
+    out->field = s.field.c_str();
+    out->type_id = static_cast<uint32_t>(s.type);
+    out->integer = s.integer ? 1 : 0;
+    out->count = s.size();
+    out->timestamps = s.timestamps.data();
+    out->ints = s.integer ? s.ints.data() : nullptr;
+    out->doubles = s.integer ? nullptr : s.doubles.data();
+    return MEMGLASS_OK;
+}
+
+const char* memglass_recording_error(const memglass_recording* rec) {
+    return rec ? rec->error.c_str() : "";
+}
+
+} // extern "C"
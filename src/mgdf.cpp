@@ -0,0 +1,874 @@
+#include "memglass/mgdf.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace memglass::mgdf {
+
+void put_varint(std::string& out, uint64_t v) {
+    // Standard LEB128 encoding
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void put_varint_signed(std::string& out, int64_t v) {
+    // ZigZag encoding then varint
+    uint64_t encoded = (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    put_varint(out, encoded);
+}
+
+void put_string(std::string& out, std::string_view s) {
+    put_varint(out, s.size());
+    out.append(s.data(), s.size());
+}
+
+// Fixed-width fields are little endian, like the raw float payloads
+void put_u32(std::string& out, uint32_t v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void put_u64(std::string& out, uint64_t v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+uint32_t get_u32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t get_u64(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+bool get_varint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool get_varint_signed(const char*& p, const char* end, int64_t& v) {
+    uint64_t encoded;
+    if (!get_varint(p, end, encoded)) return false;
+    v = static_cast<int64_t>((encoded >> 1) ^ -(encoded & 1));
+    return true;
+}
+
+namespace {
+
+bool value_less(const FieldValue& a, const FieldValue& b) {
+    if (a.type == PrimitiveType::UInt64) return a.data.u64 < b.data.u64;
+    if (a.is_integer()) return a.as_int64() < b.as_int64();
+    return a.as_double() < b.as_double();
+}
+
+void put_float(std::string& out, const FieldValue& v) {
+    if (v.type == PrimitiveType::Float32) {
+        out.append(reinterpret_cast<const char*>(&v.data.f32), sizeof(float));
+    } else {
+        out.append(reinterpret_cast<const char*>(&v.data.f64), sizeof(double));
+    }
+}
+
+bool get_float(const char*& p, const char* end, FieldValue& v) {
+    size_t n = v.type == PrimitiveType::Float32 ? sizeof(float) : sizeof(double);
+    if (static_cast<size_t>(end - p) < n) return false;
+    std::memcpy(v.type == PrimitiveType::Float32
+                    ? static_cast<void*>(&v.data.f32)
+                    : static_cast<void*>(&v.data.f64),
+                p, n);
+    p += n;
+    return true;
+}
+
+} // anonymous namespace
+
+// Rollup implementation
+
+void Rollup::add(const FieldValue& v) {
+    if (count == 0) {
+        first = v;
+        min = v;
+        max = v;
+    } else {
+        if (value_less(v, min)) min = v;
+        if (value_less(max, v)) max = v;
+    }
+    last = v;
+    sum += v.as_double();
+    count++;
+}
+
+void Rollup::merge(const Rollup& later) {
+    if (later.count == 0) return;
+    if (count == 0) {
+        first = later.first;
+        min = later.min;
+        max = later.max;
+    } else {
+        if (value_less(later.min, min)) min = later.min;
+        if (value_less(max, later.max)) max = later.max;
+    }
+    last = later.last;
+    sum += later.sum;
+    count += later.count;
+}
+
+// Writer implementation
+
+void Writer::write_header(std::string& out) {
+    out.append("MGDF", 4);  // Magic
+    out.push_back(static_cast<char>(VERSION_1));
+    out.push_back(0);  // Flags
+    out.push_back(0);  // Reserved
+    out.push_back(0);  // Reserved
+    last_timestamp_ = 0;
+}
+
+void Writer::write_diff(std::string& out, const SnapshotDiff& diff) {
+    out.push_back(static_cast<char>(RECORD_DIFF));
+
+    // Timestamp delta (can be negative if clock skew, but usually positive)
+    int64_t ts_delta = static_cast<int64_t>(diff.timestamp_ns - last_timestamp_);
+    put_varint_signed(out, ts_delta);
+    last_timestamp_ = diff.timestamp_ns;
+
+    put_varint(out, diff.new_sequence);
+    put_varint(out, diff.added_objects.size());
+    put_varint(out, diff.removed_objects.size());
+    put_varint(out, diff.field_changes.size());
+
+    for (const auto& obj : diff.added_objects) {
+        put_string(out, obj);
+    }
+    for (const auto& obj : diff.removed_objects) {
+        put_string(out, obj);
+    }
+
+    for (const auto& c : diff.field_changes) {
+        put_string(out, c.object_label);
+        put_string(out, c.field_name);
+        out.push_back(static_cast<char>(c.new_value.type));
+
+        // For integer types, write delta; for others, write raw value
+        if (c.new_value.is_integer()) {
+            put_varint_signed(out, c.new_value.as_int64() - c.old_value.as_int64());
+        } else if (c.new_value.type == PrimitiveType::Float32) {
+            out.append(reinterpret_cast<const char*>(&c.new_value.data.f32), sizeof(float));
+        } else if (c.new_value.type == PrimitiveType::Float64) {
+            out.append(reinterpret_cast<const char*>(&c.new_value.data.f64), sizeof(double));
+        } else {
+            put_varint_signed(out, 0);
+        }
+    }
+}
+
+void Writer::write_end(std::string& out) {
+    out.push_back(static_cast<char>(RECORD_END));
+}
+
+// Reader implementation
+
+bool Reader::read_header() {
+    char magic[4];
+    in_.read(magic, 4);
+    if (!in_ || std::memcmp(magic, "MGDF", 4) != 0) {
+        return false;
+    }
+
+    version_ = read_u8();
+    flags_ = read_u8();
+    read_u8();  // Reserved
+    read_u8();  // Reserved
+    last_timestamp_ = 0;
+
+    return version_ == VERSION_1 || version_ == VERSION_2;
+}
+
+std::optional<SnapshotDiff> Reader::read_diff() {
+    if (version_ == VERSION_2) {
+        while (pending_.empty()) {
+            if (!read_block()) return std::nullopt;
+        }
+        SnapshotDiff diff = std::move(pending_.front());
+        pending_.pop_front();
+        return diff;
+    }
+
+    uint8_t record_type = read_u8();
+    if (record_type == RECORD_END || in_.eof()) {
+        return std::nullopt;
+    }
+
+    SnapshotDiff diff;
+
+    int64_t ts_delta = read_varint_signed();
+    diff.timestamp_ns = last_timestamp_ + ts_delta;
+    last_timestamp_ = diff.timestamp_ns;
+
+    diff.new_sequence = read_varint();
+    size_t num_added = read_varint();
+    size_t num_removed = read_varint();
+    size_t num_changes = read_varint();
+
+    for (size_t i = 0; i < num_added && in_; ++i) {
+        diff.added_objects.push_back(read_string());
+    }
+    for (size_t i = 0; i < num_removed && in_; ++i) {
+        diff.removed_objects.push_back(read_string());
+    }
+    for (size_t i = 0; i < num_changes && in_; ++i) {
+        FieldChange c;
+        c.object_label = read_string();
+        c.field_name = read_string();
+        c.new_value.type = static_cast<PrimitiveType>(read_u8());
+        read_raw_value(c.new_value);
+        diff.field_changes.push_back(std::move(c));
+    }
+
+    if (!in_) return std::nullopt;
+    return diff;
+}
+
+namespace {
+
+// Rebuilds SnapshotDiffs from a decoded block
+class DiffBuilder : public BlockVisitor {
+public:
+    DiffBuilder(const BlockDecoder& block, std::deque<SnapshotDiff>& out)
+        : block_(block), out_(out) {}
+
+    void on_record(uint64_t timestamp_ns, uint64_t old_sequence, uint64_t sequence) override {
+        SnapshotDiff& diff = out_.emplace_back();
+        diff.timestamp_ns = timestamp_ns;
+        diff.old_sequence = old_sequence;
+        diff.new_sequence = sequence;
+    }
+
+    void on_object(bool added, uint32_t label) override {
+        auto& list = added ? out_.back().added_objects : out_.back().removed_objects;
+        list.emplace_back(block_.strings()[label]);
+    }
+
+    void on_change(uint32_t label, uint32_t field, const FieldValue& value) override {
+        FieldChange& c = out_.back().field_changes.emplace_back();
+        c.object_label = block_.strings()[label];
+        c.field_name = block_.strings()[field];
+        c.new_value = value;
+    }
+
+private:
+    const BlockDecoder& block_;
+    std::deque<SnapshotDiff>& out_;
+};
+
+} // anonymous namespace
+
+bool Reader::read_block() {
+    char header[BLOCK_HEADER_SIZE];
+    in_.read(header, 4);
+    if (!in_ || std::memcmp(header, "MGBK", 4) != 0) {
+        return false;  // index, footer or truncated file
+    }
+    in_.read(header + 4, BLOCK_HEADER_SIZE - 4);
+    if (!in_) return false;
+
+    uint32_t payload = get_u32(header + 4);
+    block_.assign(header, BLOCK_HEADER_SIZE);
+    block_.resize(BLOCK_HEADER_SIZE + payload);
+    in_.read(block_.data() + BLOCK_HEADER_SIZE, payload);
+    if (!in_) return false;
+
+    BlockDecoder decoder;
+    if (!decoder.open(block_.data(), block_.size())) return false;
+    DiffBuilder builder(decoder, pending_);
+    return decoder.decode(builder);
+}
+
+uint8_t Reader::read_u8() {
+    return static_cast<uint8_t>(in_.get());
+}
+
+uint64_t Reader::read_varint() {
+    uint64_t result = 0;
+    int shift = 0;
+    while (in_ && shift < 64) {
+        uint8_t b = read_u8();
+        result |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) break;
+        shift += 7;
+    }
+    return result;
+}
+
+int64_t Reader::read_varint_signed() {
+    uint64_t encoded = read_varint();
+    return static_cast<int64_t>((encoded >> 1) ^ -(encoded & 1));
+}
+
+std::string Reader::read_string() {
+    size_t len = read_varint();
+    std::string s(len, '\0');
+    in_.read(s.data(), static_cast<std::streamsize>(len));
+    return s;
+}
+
+void Reader::read_raw_value(FieldValue& v) {
+    switch (v.type) {
+        case PrimitiveType::Float32:
+            in_.read(reinterpret_cast<char*>(&v.data.f32), sizeof(float));
+            break;
+        case PrimitiveType::Float64:
+            in_.read(reinterpret_cast<char*>(&v.data.f64), sizeof(double));
+            break;
+        default:
+            v.set_int64(read_varint_signed());
+            break;
+    }
+}
+
+// BlockWriter implementation
+
+BlockWriter::BlockWriter(size_t block_bytes, uint64_t block_span_ns)
+    : block_bytes_(block_bytes)
+    , block_span_ns_(block_span_ns)
+{
+    records_.reserve(block_bytes_);
+}
+
+void BlockWriter::write_header(std::string& out, uint8_t flags) {
+    out.append("MGDF", 4);  // Magic
+    out.push_back(static_cast<char>(VERSION_2));
+    out.push_back(static_cast<char>(flags));
+    out.push_back(0);  // Reserved
+    out.push_back(0);  // Reserved
+    written_ = FILE_HEADER_SIZE;
+    index_.clear();
+}
+
+uint32_t BlockWriter::intern(std::string_view s) {
+    key_.assign(s.data(), s.size());  // reused to avoid a temporary per lookup
+    auto it = string_ids_.find(key_);
+    if (it != string_ids_.end()) return it->second;
+
+    uint32_t id = header_.string_count++;
+    string_ids_.emplace(key_, id);
+    put_string(strings_, s);
+    return id;
+}
+
+int64_t& BlockWriter::last_value(uint32_t label, uint32_t field) {
+    return last_values_.try_emplace((static_cast<uint64_t>(label) << 32) | field, 0).first->second;
+}
+
+void BlockWriter::begin_record(std::string& out, uint8_t type, uint64_t timestamp_ns) {
+    if (header_.record_count > 0 &&
+        (records_.size() + strings_.size() >= block_bytes_ ||
+         timestamp_ns - header_.first_ts >= block_span_ns_)) {
+        finish_block(out);
+    }
+
+    if (header_.record_count == 0) {
+        header_.first_ts = timestamp_ns;
+        header_.last_ts = timestamp_ns;
+        last_timestamp_ = timestamp_ns;
+    }
+
+    records_.push_back(static_cast<char>(type));
+    put_varint_signed(records_, static_cast<int64_t>(timestamp_ns - last_timestamp_));
+    last_timestamp_ = timestamp_ns;
+    header_.last_ts = std::max(header_.last_ts, timestamp_ns);
+}
+
+void BlockWriter::write_diff(std::string& out, const SnapshotDiff& diff) {
+    begin_record(out, RECORD_DIFF, diff.timestamp_ns);
+
+    put_varint(records_, diff.new_sequence);
+    put_varint_signed(records_, static_cast<int64_t>(diff.new_sequence - diff.old_sequence));
+    put_varint(records_, diff.added_objects.size());
+    put_varint(records_, diff.removed_objects.size());
+    put_varint(records_, diff.field_changes.size());
+
+    for (const auto& obj : diff.added_objects) {
+        put_varint(records_, intern(obj));
+    }
+    for (const auto& obj : diff.removed_objects) {
+        put_varint(records_, intern(obj));
+    }
+
+    for (const auto& c : diff.field_changes) {
+        uint32_t label = intern(c.object_label);
+        uint32_t field = intern(c.field_name);
+        put_varint(records_, label);
+        put_varint(records_, field);
+        records_.push_back(static_cast<char>(c.new_value.type));
+
+        if (c.new_value.is_integer()) {
+            // Delta against the previous value in this block keeps counters small
+            int64_t& prev = last_value(label, field);
+            int64_t v = c.new_value.as_int64();
+            put_varint_signed(records_, v - prev);
+            prev = v;
+        } else if (c.new_value.type == PrimitiveType::Float32) {
+            records_.append(reinterpret_cast<const char*>(&c.new_value.data.f32), sizeof(float));
+        } else if (c.new_value.type == PrimitiveType::Float64) {
+            records_.append(reinterpret_cast<const char*>(&c.new_value.data.f64), sizeof(double));
+        } else {
+            put_varint_signed(records_, 0);
+        }
+    }
+
+    header_.record_count++;
+}
+
+void BlockWriter::write_rollups(std::string& out, uint64_t start_ns, uint64_t interval_ns,
+                                const RollupMap& rollups) {
+    begin_record(out, RECORD_ROLLUP, start_ns);
+    put_varint(records_, interval_ns);
+    put_varint(records_, rollups.size());
+
+    for (const auto& [key, r] : rollups) {
+        uint32_t label = intern(key.first);
+        uint32_t field = intern(key.second);
+        put_varint(records_, label);
+        put_varint(records_, field);
+        records_.push_back(static_cast<char>(r.last.type));
+        put_varint(records_, r.count);
+
+        if (r.last.is_integer()) {
+            int64_t& prev = last_value(label, field);
+            int64_t first = r.first.as_int64();
+            put_varint_signed(records_, first - prev);
+            put_varint_signed(records_, r.last.as_int64() - first);
+            put_varint_signed(records_, r.min.as_int64() - first);
+            put_varint_signed(records_, r.max.as_int64() - first);
+            prev = r.last.as_int64();
+        } else if (r.last.is_float()) {
+            put_float(records_, r.first);
+            put_float(records_, r.last);
+            put_float(records_, r.min);
+            put_float(records_, r.max);
+        }
+        records_.append(reinterpret_cast<const char*>(&r.sum), sizeof(double));
+    }
+
+    header_.record_count++;
+}
+
+void BlockWriter::finish_block(std::string& out) {
+    if (header_.record_count == 0) return;
+
+    header_.payload_size = static_cast<uint32_t>(strings_.size() + records_.size());
+
+    BlockInfo info;
+    info.offset = written_;
+    info.first_ts = header_.first_ts;
+    info.last_ts = header_.last_ts;
+    info.record_count = header_.record_count;
+    info.size = static_cast<uint32_t>(BLOCK_HEADER_SIZE + header_.payload_size);
+    index_.push_back(info);
+
+    out.append("MGBK", 4);
+    put_u32(out, header_.payload_size);
+    put_u32(out, header_.record_count);
+    put_u32(out, header_.string_count);
+    put_u64(out, header_.first_ts);
+    put_u64(out, header_.last_ts);
+    out.append(strings_);
+    out.append(records_);
+    written_ += info.size;
+
+    // Next block starts from scratch so it decodes on its own
+    records_.clear();
+    strings_.clear();
+    string_ids_.clear();
+    last_values_.clear();
+    header_ = BlockHeader{};
+}
+
+void BlockWriter::write_end(std::string& out) {
+    finish_block(out);
+
+    uint64_t index_offset = written_;
+    out.append("MGIX", 4);
+    put_u32(out, static_cast<uint32_t>(index_.size()));
+    for (const auto& b : index_) {
+        put_u64(out, b.offset);
+        put_u64(out, b.first_ts);
+        put_u64(out, b.last_ts);
+        put_u32(out, b.record_count);
+        put_u32(out, b.size);
+    }
+
+    put_u64(out, index_offset);
+    out.append("MGFT", 4);
+    put_u32(out, 0);
+    written_ += 8 + index_.size() * INDEX_ENTRY_SIZE + FOOTER_SIZE;
+}
+
+// BlockDecoder implementation
+
+bool parse_block_header(const char* data, size_t size, BlockHeader& header) {
+    if (size < BLOCK_HEADER_SIZE || std::memcmp(data, "MGBK", 4) != 0) {
+        return false;
+    }
+    header.payload_size = get_u32(data + 4);
+    header.record_count = get_u32(data + 8);
+    header.string_count = get_u32(data + 12);
+    header.first_ts = get_u64(data + 16);
+    header.last_ts = get_u64(data + 24);
+    return size - BLOCK_HEADER_SIZE >= header.payload_size;
+}
+
+bool BlockDecoder::open(const char* data, size_t size) {
+    if (!parse_block_header(data, size, header_)) {
+        return false;
+    }
+
+    data_ = data;
+    end_ = data + BLOCK_HEADER_SIZE + header_.payload_size;
+
+    const char* p = data + BLOCK_HEADER_SIZE;
+    strings_.clear();
+    strings_.reserve(header_.string_count);
+    for (uint32_t i = 0; i < header_.string_count; ++i) {
+        uint64_t len;
+        if (!get_varint(p, end_, len) || len > static_cast<uint64_t>(end_ - p)) {
+            return false;
+        }
+        strings_.emplace_back(p, len);
+        p += len;
+    }
+    records_ = p;
+    return true;
+}
+
+uint32_t BlockDecoder::find(std::string_view s) const {
+    for (uint32_t i = 0; i < strings_.size(); ++i) {
+        if (strings_[i] == s) return i;
+    }
+    return NO_STRING;
+}
+
+bool BlockDecoder::decode(BlockVisitor& visitor) {
+    const char* p = records_;
+    const uint64_t string_count = strings_.size();
+    uint64_t timestamp = header_.first_ts;
+    last_values_.clear();
+
+    for (uint32_t r = 0; r < header_.record_count; ++r) {
+        if (p >= end_) return false;
+        uint8_t type = static_cast<uint8_t>(*p++);
+        if (type == RECORD_ROLLUP) {
+            if (!decode_rollups(p, timestamp, visitor)) return false;
+            continue;
+        }
+        if (type != RECORD_DIFF) return false;
+
+        int64_t ts_delta, seq_delta;
+        uint64_t sequence, num_added, num_removed, num_changes;
+        if (!get_varint_signed(p, end_, ts_delta) || !get_varint(p, end_, sequence) ||
+            !get_varint_signed(p, end_, seq_delta) || !get_varint(p, end_, num_added) ||
+            !get_varint(p, end_, num_removed) || !get_varint(p, end_, num_changes)) {
+            return false;
+        }
+        timestamp += static_cast<uint64_t>(ts_delta);
+        visitor.on_record(timestamp, sequence - static_cast<uint64_t>(seq_delta), sequence);
+
+        for (uint64_t i = 0; i < num_added + num_removed; ++i) {
+            uint64_t id;
+            if (!get_varint(p, end_, id) || id >= string_count) return false;
+            visitor.on_object(i < num_added, static_cast<uint32_t>(id));
+        }
+
+        for (uint64_t i = 0; i < num_changes; ++i) {
+            uint64_t label, field;
+            if (!get_varint(p, end_, label) || !get_varint(p, end_, field) ||
+                label >= string_count || field >= string_count || p >= end_) {
+                return false;
+            }
+
+            FieldValue v;
+            v.type = static_cast<PrimitiveType>(static_cast<uint8_t>(*p++));
+            if (v.is_integer()) {
+                int64_t delta;
+                if (!get_varint_signed(p, end_, delta)) return false;
+                auto [it, inserted] = last_values_.try_emplace((label << 32) | field, 0);
+                it->second += delta;
+                v.set_int64(it->second);
+            } else if (v.is_float()) {
+                if (!get_float(p, end_, v)) return false;
+            } else {
+                int64_t ignored;
+                if (!get_varint_signed(p, end_, ignored)) return false;
+            }
+
+            visitor.on_change(static_cast<uint32_t>(label), static_cast<uint32_t>(field), v);
+        }
+    }
+    return true;
+}
+
+bool BlockDecoder::decode_rollups(const char*& p, uint64_t& timestamp, BlockVisitor& visitor) {
+    const uint64_t string_count = strings_.size();
+    int64_t ts_delta;
+    uint64_t interval, num_entries;
+    if (!get_varint_signed(p, end_, ts_delta) || !get_varint(p, end_, interval) ||
+        !get_varint(p, end_, num_entries)) {
+        return false;
+    }
+    timestamp += static_cast<uint64_t>(ts_delta);
+
+    Rollup r;
+    r.start_ns = timestamp;
+    r.interval_ns = interval;
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        uint64_t label, field;
+        if (!get_varint(p, end_, label) || !get_varint(p, end_, field) ||
+            label >= string_count || field >= string_count || p >= end_) {
+            return false;
+        }
+
+        PrimitiveType type = static_cast<PrimitiveType>(static_cast<uint8_t>(*p++));
+        r.first = r.last = r.min = r.max = FieldValue{};
+        r.first.type = r.last.type = r.min.type = r.max.type = type;
+        if (!get_varint(p, end_, r.count)) return false;
+
+        if (r.first.is_integer()) {
+            int64_t first, last, min, max;
+            if (!get_varint_signed(p, end_, first) || !get_varint_signed(p, end_, last) ||
+                !get_varint_signed(p, end_, min) || !get_varint_signed(p, end_, max)) {
+                return false;
+            }
+            auto [it, inserted] = last_values_.try_emplace((label << 32) | field, 0);
+            first += it->second;
+            r.first.set_int64(first);
+            r.last.set_int64(first + last);
+            r.min.set_int64(first + min);
+            r.max.set_int64(first + max);
+            it->second = first + last;
+        } else if (r.first.is_float()) {
+            if (!get_float(p, end_, r.first) || !get_float(p, end_, r.last) ||
+                !get_float(p, end_, r.min) || !get_float(p, end_, r.max)) {
+                return false;
+            }
+        }
+
+        if (static_cast<size_t>(end_ - p) < sizeof(double)) return false;
+        std::memcpy(&r.sum, p, sizeof(double));
+        p += sizeof(double);
+
+        visitor.on_rollup(static_cast<uint32_t>(label), static_cast<uint32_t>(field), r);
+    }
+    return true;
+}
+
+// RollupWriter implementation
+
+RollupWriter::RollupWriter(uint64_t interval_ns, size_t block_bytes)
+    : interval_ns_(interval_ns)
+    // A few hundred buckets per block, so time pruning stays useful at
+    // coarse resolutions
+    , writer_(block_bytes, interval_ns * 600)
+{
+}
+
+void RollupWriter::write_header(std::string& out) {
+    writer_.write_header(out, FLAG_ROLLUP);
+    open_.clear();
+    has_bucket_ = false;
+    rollups_ = 0;
+}
+
+Rollup& RollupWriter::slot(std::string& out, uint64_t timestamp_ns, std::string_view label,
+                           std::string_view field) {
+    uint64_t start = timestamp_ns - timestamp_ns % interval_ns_;
+    if (!has_bucket_) {
+        bucket_start_ = start;
+        has_bucket_ = true;
+    } else if (start > bucket_start_) {
+        flush_bucket(out);
+        bucket_start_ = start;
+    }
+
+    key_.first.assign(label.data(), label.size());
+    key_.second.assign(field.data(), field.size());
+    auto it = open_.find(key_);
+    if (it == open_.end()) {
+        it = open_.emplace(key_, Rollup{}).first;
+    }
+    return it->second;
+}
+
+void RollupWriter::write_diff(std::string& out, const SnapshotDiff& diff) {
+    for (const auto& c : diff.field_changes) {
+        write_change(out, diff.timestamp_ns, c.object_label, c.field_name, c.new_value);
+    }
+}
+
+void RollupWriter::write_change(std::string& out, uint64_t timestamp_ns, std::string_view label,
+                                std::string_view field, const FieldValue& value) {
+    slot(out, timestamp_ns, label, field).add(value);
+}
+
+bool RollupWriter::write_rollup(std::string& out, std::string_view label, std::string_view field,
+                                const Rollup& rollup) {
+    if (rollup.interval_ns == 0 || interval_ns_ % rollup.interval_ns != 0) {
+        return false;
+    }
+    slot(out, rollup.start_ns, label, field).merge(rollup);
+    return true;
+}
+
+void RollupWriter::flush_bucket(std::string& out) {
+    if (open_.empty()) return;
+    writer_.write_rollups(out, bucket_start_, interval_ns_, open_);
+    rollups_ += open_.size();
+    open_.clear();
+}
+
+void RollupWriter::write_end(std::string& out) {
+    flush_bucket(out);
+    writer_.write_end(out);
+}
+
+// MappedFile implementation
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path, std::string* error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (error) *error = fmt::format("cannot open '{}': {}", path, std::strerror(errno));
+        return false;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || static_cast<size_t>(sb.st_size) < FILE_HEADER_SIZE) {
+        if (error) *error = fmt::format("'{}' is not an MGDF file", path);
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(sb.st_size);
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        if (error) *error = fmt::format("cannot map '{}': {}", path, std::strerror(errno));
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const char*>(data);
+
+    if (std::memcmp(data_, "MGDF", 4) != 0) {
+        if (error) *error = fmt::format("'{}' is not an MGDF file", path);
+        close();
+        return false;
+    }
+    version_ = static_cast<uint8_t>(data_[4]);
+    flags_ = static_cast<uint8_t>(data_[5]);
+
+    if (version_ == VERSION_2) {
+        if (!load_index()) {
+            scan_blocks();
+        }
+    } else if (version_ != VERSION_1) {
+        if (error) *error = fmt::format("unsupported MGDF version {}", version_);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::will_need(const BlockInfo& block) const {
+    if (!data_ || block.offset >= size_) return;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = block.offset / page * page;
+    size_t end = std::min<size_t>(block.offset + block.size, size_);
+    madvise(const_cast<char*>(data_) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    version_ = 0;
+    flags_ = 0;
+    has_index_ = false;
+    blocks_.clear();
+}
+
+bool MappedFile::load_index() {
+    if (size_ < FILE_HEADER_SIZE + FOOTER_SIZE) return false;
+
+    const char* footer = data_ + size_ - FOOTER_SIZE;
+    if (std::memcmp(footer + 8, "MGFT", 4) != 0) return false;
+
+    uint64_t index_offset = get_u64(footer);
+    if (index_offset < FILE_HEADER_SIZE || index_offset + 8 > size_ - FOOTER_SIZE) return false;
+
+    const char* index = data_ + index_offset;
+    if (std::memcmp(index, "MGIX", 4) != 0) return false;
+
+    uint32_t count = get_u32(index + 4);
+    if (index_offset + 8 + static_cast<uint64_t>(count) * INDEX_ENTRY_SIZE > size_ - FOOTER_SIZE) {
+        return false;
+    }
+
+    blocks_.resize(count);
+    const char* e = index + 8;
+    for (uint32_t i = 0; i < count; ++i, e += INDEX_ENTRY_SIZE) {
+        BlockInfo& b = blocks_[i];
+        b.offset = get_u64(e);
+        b.first_ts = get_u64(e + 8);
+        b.last_ts = get_u64(e + 16);
+        b.record_count = get_u32(e + 24);
+        b.size = get_u32(e + 28);
+        if (b.offset + b.size > index_offset) {
+            blocks_.clear();
+            return false;
+        }
+    }
+    has_index_ = true;
+    return true;
+}
+
+void MappedFile::scan_blocks() {
+    blocks_.clear();
+    uint64_t offset = FILE_HEADER_SIZE;
+    BlockHeader h;
+    while (parse_block_header(data_ + offset, size_ - offset, h)) {
+        BlockInfo b;
+        b.offset = offset;
+        b.first_ts = h.first_ts;
+        b.last_ts = h.last_ts;
+        b.record_count = h.record_count;
+        b.size = static_cast<uint32_t>(BLOCK_HEADER_SIZE + h.payload_size);
+        blocks_.push_back(b);
+        offset += b.size;
+    }
+}
+
+} // namespace memglass::mgdf
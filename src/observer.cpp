@@ -1,5 +1,9 @@
 #include "memglass/observer.hpp"
+#include "memglass/detail/label_index.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 
 namespace memglass {
@@ -25,14 +29,11 @@ FieldProxy FieldProxy::operator[](std::string_view name) const {
     }
 
     // Find the field in the nested type
-    for (const auto& f : nested_type->fields) {
-        if (std::string_view(f.name) == name) {
-            void* field_data = static_cast<char*>(data_) + f.offset;
-            return FieldProxy(obj_, &f, field_data);
-        }
+    FieldRef f = nested_type->find_field(name);
+    if (!f) {
+        return FieldProxy(obj_, nullptr, nullptr);
     }
-
-    return FieldProxy(obj_, nullptr, nullptr);
+    return FieldProxy(obj_, f.entry, static_cast<char*>(data_) + f.offset());
 }
 
 FieldProxy FieldProxy::operator[](size_t index) const {
@@ -58,6 +59,10 @@ FieldProxy FieldProxy::operator[](size_t index) const {
     return FieldProxy(obj_, field_, element_data);
 }
 
+bool FieldProxy::writable() const {
+    return obj_.writable_;
+}
+
 // ObjectView implementation
 
 ObjectView::ObjectView(Observer& observer, const ObservedObject& obj_info)
@@ -66,17 +71,18 @@ ObjectView::ObjectView(Observer& observer, const ObservedObject& obj_info)
 {
     type_ = observer.get_type(obj_info.type_id);
     data_ = observer.get_object_data(obj_info.region_id, obj_info.offset);
+    writable_ = observer.options().writable;
 }
 
 FieldProxy ObjectView::operator[](std::string_view field_name) {
-    // First try exact match (handles flat dotted names like "position.symbol_id")
-    const FieldEntry* field = find_field(field_name);
+    // A field, or a path through the nested types ("quote.bid", "levels[1].bid")
+    FieldRef field = find_field(field_name);
     if (field && data_) {
-        void* field_data = static_cast<char*>(data_) + field->offset;
-        return FieldProxy(*this, field, field_data);
+        void* field_data = static_cast<char*>(data_) + field.offset();
+        return FieldProxy(*this, field.entry, field_data);
     }
 
-    // Fallback: Handle dot notation for nested types
+    // Fallback: descend into nested types the schema leaves opaque
     size_t dot_pos = field_name.find('.');
     if (dot_pos != std::string_view::npos) {
         std::string_view first = field_name.substr(0, dot_pos);
@@ -87,21 +93,16 @@ FieldProxy ObjectView::operator[](std::string_view field_name) {
     return FieldProxy(*this, nullptr, nullptr);
 }
 
-const FieldEntry* ObjectView::find_field(std::string_view name) const {
-    if (!type_) return nullptr;
-
-    for (const auto& field : type_->fields) {
-        if (std::string_view(field.name) == name) {
-            return &field;
-        }
-    }
-    return nullptr;
+FieldRef ObjectView::find_field(std::string_view name) const {
+    return type_ ? type_->find_field(name) : FieldRef{};
 }
 
 // Observer implementation
 
-Observer::Observer(std::string_view session_name)
+Observer::Observer(std::string_view session_name, const ObserverOptions& options)
     : session_name_(session_name)
+    , options_(options)
+    , schema_cache_(options.schema_cache ? options.schema_cache : SchemaCache::shared())
 {
 }
 
@@ -114,7 +115,7 @@ bool Observer::connect() {
 
     // Open header shared memory
     std::string header_shm_name = detail::make_header_shm_name(session_name_);
-    if (!header_shm_.open(header_shm_name)) {
+    if (!header_shm_.open(header_shm_name, map_options(false))) {
         return false;
     }
 
@@ -147,8 +148,7 @@ void Observer::disconnect() {
 
     region_shms_.clear();
     overflow_shms_.clear();
-    types_.clear();
-    type_id_to_index_.clear();
+    schema_.reset();
     header_shm_.close();
     header_ = nullptr;
     connected_ = false;
@@ -181,6 +181,26 @@ uint64_t Observer::sequence() const {
     return header_->sequence.load(std::memory_order_acquire);
 }
 
+std::atomic<uint32_t>* Observer::paused_flag() const {
+    // Producers built before the switch have a shorter header
+    if (!header_ || header_->header_size < offsetof(TelemetryHeader, paused) + sizeof(uint32_t)) {
+        return nullptr;
+    }
+    return &header_->paused;
+}
+
+bool Observer::paused() const {
+    auto* flag = paused_flag();
+    return flag && flag->load(std::memory_order_relaxed) != 0;
+}
+
+bool Observer::set_paused(bool paused) {
+    auto* flag = paused_flag();
+    if (!flag || !options_.writable) return false;
+    flag->store(paused ? 1 : 0, std::memory_order_relaxed);
+    return true;
+}
+
 std::vector<ObservedObject> Observer::objects() const {
     std::vector<ObservedObject> result;
     if (!header_) return result;
@@ -188,22 +208,26 @@ std::vector<ObservedObject> Observer::objects() const {
     // Helper lambda to add object entries from a memory region
     auto add_objects = [&](const ObjectEntry* entries, uint32_t count) {
         for (uint32_t i = 0; i < count; ++i) {
-            ObjectState state = static_cast<ObjectState>(
-                entries[i].state.load(std::memory_order_acquire));
-            if (state != ObjectState::Alive) continue;
+            uint64_t status = entries[i].status.load(std::memory_order_acquire);
+            if (status_state(status) != ObjectState::Alive) continue;
 
             ObservedObject obj;
             obj.label = entries[i].label;
             obj.type_id = entries[i].type_id;
             obj.region_id = entries[i].region_id;
             obj.offset = entries[i].offset;
-            obj.generation = entries[i].generation;
-            obj.state = state;
+            obj.generation = status_generation(status);
+            obj.state = ObjectState::Alive;
+            obj.entry = &entries[i];
+
+            // Slot reused while we read it
+            if (entries[i].status.load(std::memory_order_acquire) != status) {
+                continue;
+            }
 
             // Get type name
-            auto it = type_id_to_index_.find(obj.type_id);
-            if (it != type_id_to_index_.end()) {
-                obj.type_name = types_[it->second].name;
+            if (const ObservedType* type = get_type(obj.type_id)) {
+                obj.type_name = type->name;
             }
 
             result.push_back(std::move(obj));
@@ -211,7 +235,8 @@ std::vector<ObservedObject> Observer::objects() const {
     };
 
     // Add objects from header
-    uint32_t count = header_->object_count.load(std::memory_order_acquire);
+    uint32_t count = std::min(header_->object_count.load(std::memory_order_acquire),
+                              header_->object_dir_capacity);
     auto* entries = reinterpret_cast<const ObjectEntry*>(
         static_cast<const char*>(header_shm_.data()) + header_->object_dir_offset);
     add_objects(entries, count);
@@ -219,7 +244,8 @@ std::vector<ObservedObject> Observer::objects() const {
     // Add objects from overflow regions
     for (const auto& [id, shm] : overflow_shms_) {
         auto* desc = static_cast<const MetadataOverflowDescriptor*>(shm.data());
-        uint32_t overflow_count = desc->object_entry_count.load(std::memory_order_acquire);
+        uint32_t overflow_count = std::min(desc->object_entry_count.load(std::memory_order_acquire),
+                                           desc->object_entry_capacity);
         auto* overflow_entries = reinterpret_cast<const ObjectEntry*>(
             static_cast<const char*>(shm.data()) + desc->object_entry_offset);
         add_objects(overflow_entries, overflow_count);
@@ -234,9 +260,8 @@ ObjectView Observer::find(std::string_view label) {
     // Helper lambda to search for an object by label
     auto search_entries = [&](const ObjectEntry* entries, uint32_t count) -> std::optional<ObservedObject> {
         for (uint32_t i = 0; i < count; ++i) {
-            ObjectState state = static_cast<ObjectState>(
-                entries[i].state.load(std::memory_order_acquire));
-            if (state != ObjectState::Alive) continue;
+            uint64_t status = entries[i].status.load(std::memory_order_acquire);
+            if (status_state(status) != ObjectState::Alive) continue;
 
             if (std::string_view(entries[i].label) == label) {
                 ObservedObject obj;
@@ -244,12 +269,17 @@ ObjectView Observer::find(std::string_view label) {
                 obj.type_id = entries[i].type_id;
                 obj.region_id = entries[i].region_id;
                 obj.offset = entries[i].offset;
-                obj.generation = entries[i].generation;
-                obj.state = state;
+                obj.generation = status_generation(status);
+                obj.state = ObjectState::Alive;
+                obj.entry = &entries[i];
 
-                auto it = type_id_to_index_.find(obj.type_id);
-                if (it != type_id_to_index_.end()) {
-                    obj.type_name = types_[it->second].name;
+                // Slot reused while we read it
+                if (entries[i].status.load(std::memory_order_acquire) != status) {
+                    continue;
+                }
+
+                if (const ObservedType* type = get_type(obj.type_id)) {
+                    obj.type_name = type->name;
                 }
 
                 return obj;
@@ -258,11 +288,32 @@ ObjectView Observer::find(std::string_view label) {
         return std::nullopt;
     };
 
-    // Search in header
-    uint32_t count = header_->object_count.load(std::memory_order_acquire);
     auto* entries = reinterpret_cast<const ObjectEntry*>(
         static_cast<const char*>(header_shm_.data()) + header_->object_dir_offset);
 
+    // Label index: a few cache lines instead of a directory scan
+    if (const auto* index = label_index()) {
+        std::optional<ObservedObject> found;
+        auto lookup = detail::label_index_lookup(
+            index, header_->label_index_capacity, header_->label_index_seq,
+            detail::label_hash(label), [&](uint32_t i) {
+                if (i >= header_->object_dir_capacity) return false;
+                found = search_entries(&entries[i], 1);
+                return found.has_value();
+            });
+        if (found) {
+            return ObjectView(*this, *found);
+        }
+        if (lookup == detail::LabelLookup::Missing &&
+            header_->label_index_complete.load(std::memory_order_acquire)) {
+            return ObjectView();
+        }
+    }
+
+    // Search in header
+    uint32_t count = std::min(header_->object_count.load(std::memory_order_acquire),
+                              header_->object_dir_capacity);
+
     if (auto found = search_entries(entries, count)) {
         return ObjectView(*this, *found);
     }
@@ -270,7 +321,8 @@ ObjectView Observer::find(std::string_view label) {
     // Search in overflow regions
     for (const auto& [id, shm] : overflow_shms_) {
         auto* desc = static_cast<const MetadataOverflowDescriptor*>(shm.data());
-        uint32_t overflow_count = desc->object_entry_count.load(std::memory_order_acquire);
+        uint32_t overflow_count = std::min(desc->object_entry_count.load(std::memory_order_acquire),
+                                           desc->object_entry_capacity);
         auto* overflow_entries = reinterpret_cast<const ObjectEntry*>(
             static_cast<const char*>(shm.data()) + desc->object_entry_offset);
 
@@ -286,83 +338,85 @@ ObjectView Observer::get(const ObservedObject& obj) {
     return ObjectView(*this, obj);
 }
 
-const ObservedType* Observer::get_type(uint32_t type_id) const {
-    auto it = type_id_to_index_.find(type_id);
-    if (it != type_id_to_index_.end()) {
-        return &types_[it->second];
+const std::atomic<uint64_t>* Observer::label_index() const {
+    // Producers built before the index have a shorter header
+    if (header_->header_size < offsetof(TelemetryHeader, label_index_seq) + sizeof(uint32_t) ||
+        header_->label_index_capacity == 0) {
+        return nullptr;
     }
-    return nullptr;
+    return reinterpret_cast<const std::atomic<uint64_t>*>(
+        static_cast<const char*>(header_shm_.data()) + header_->label_index_offset);
+}
+
+const std::vector<ObservedType>& Observer::types() const {
+    static const std::vector<ObservedType> none;
+    return schema_ ? schema_->types : none;
+}
+
+const ObservedType* Observer::get_type(uint32_t type_id) const {
+    return schema_ ? schema_->get_type(type_id) : nullptr;
 }
 
 void* Observer::get_object_data(uint64_t region_id, uint64_t offset) {
     auto it = region_shms_.find(region_id);
-    if (it == region_shms_.end()) {
+    if (it != region_shms_.end()) {
+        return static_cast<char*>(it->second.data()) + offset;
+    }
+
+    if (options_.regions != RegionMapping::Lazy || !connected_) {
         return nullptr;
     }
-    return static_cast<char*>(it->second.data()) + offset;
-}
 
-void Observer::load_types() {
-    types_.clear();
-    type_id_to_index_.clear();
+    detail::SharedMemory* shm = map_region(region_id);
+    if (!shm) return nullptr;
+    return static_cast<char*>(shm->data()) + offset;
+}
 
-    if (!header_) return;
+detail::MapOptions Observer::map_options(bool populate) const {
+    detail::MapOptions opts;
+    opts.writable = options_.writable;
+    opts.populate = populate;
+    return opts;
+}
 
-    uint32_t type_count = header_->type_count.load(std::memory_order_acquire);
-    auto* type_entries = reinterpret_cast<const TypeEntry*>(
-        static_cast<const char*>(header_shm_.data()) + header_->type_registry_offset);
-    auto* field_entries = reinterpret_cast<const FieldEntry*>(
-        static_cast<const char*>(header_shm_.data()) + header_->field_entries_offset);
-
-    for (uint32_t i = 0; i < type_count; ++i) {
-        const TypeEntry& te = type_entries[i];
-
-        ObservedType type;
-        type.type_id = te.type_id;
-        type.name = te.name;
-        type.size = te.size;
-        type.alignment = te.alignment;
-
-        // Load fields
-        size_t field_start = (te.fields_offset - header_->field_entries_offset) / sizeof(FieldEntry);
-        for (uint32_t j = 0; j < te.field_count; ++j) {
-            type.fields.push_back(field_entries[field_start + j]);
-        }
+detail::SharedMemory* Observer::map_region(uint64_t region_id) {
+    std::string shm_name = detail::make_region_shm_name(session_name_, region_id);
+    detail::SharedMemory shm;
+    if (!shm.open(shm_name, map_options(options_.regions == RegionMapping::Populate))) {
+        return nullptr;
+    }
 
-        type_id_to_index_[type.type_id] = types_.size();
-        types_.push_back(std::move(type));
+    auto* desc = static_cast<const RegionDescriptor*>(shm.data());
+    if (desc->magic != REGION_MAGIC) {
+        return nullptr;
     }
+
+    auto [it, inserted] = region_shms_.emplace(region_id, std::move(shm));
+    return &it->second;
+}
+
+void Observer::load_types() {
+    // Sessions with identical types share one parsed schema
+    schema_ = header_ ? schema_cache_->load(header_) : nullptr;
 }
 
 void Observer::load_regions() {
     if (!header_) return;
 
+    // Lazy observers map regions from get_object_data() on first use
+    if (options_.regions == RegionMapping::Lazy) return;
+
     uint64_t region_id = header_->first_region_id.load(std::memory_order_acquire);
 
     while (region_id != 0) {
-        // Skip if already loaded
-        if (region_shms_.find(region_id) != region_shms_.end()) {
-            // Get next region ID from existing region
-            auto* desc = static_cast<RegionDescriptor*>(region_shms_[region_id].data());
-            region_id = desc->next_region_id.load(std::memory_order_acquire);
-            continue;
-        }
-
-        // Load new region
-        std::string shm_name = detail::make_region_shm_name(session_name_, region_id);
-        detail::SharedMemory shm;
-        if (!shm.open(shm_name)) {
+        auto it = region_shms_.find(region_id);
+        detail::SharedMemory* shm = (it != region_shms_.end()) ? &it->second : map_region(region_id);
+        if (!shm) {
             break;  // Can't load region
         }
 
-        auto* desc = static_cast<RegionDescriptor*>(shm.data());
-        if (desc->magic != REGION_MAGIC) {
-            break;  // Invalid region
-        }
-
-        uint64_t next_id = desc->next_region_id.load(std::memory_order_acquire);
-        region_shms_[region_id] = std::move(shm);
-        region_id = next_id;
+        auto* desc = static_cast<const RegionDescriptor*>(shm->data());
+        region_id = desc->next_region_id.load(std::memory_order_acquire);
     }
 }
 
@@ -383,7 +437,7 @@ void Observer::load_overflow_regions() {
         // Load new overflow region
         std::string shm_name = detail::make_overflow_shm_name(session_name_, overflow_id);
         detail::SharedMemory shm;
-        if (!shm.open(shm_name)) {
+        if (!shm.open(shm_name, map_options(false))) {
             break;  // Can't load overflow region
         }
 
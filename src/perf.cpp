@@ -0,0 +1,134 @@
+#include "memglass/perf.hpp"
+
+#if defined(__linux__) && defined(__x86_64__)
+#define MEMGLASS_HAVE_RDPMC 1
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <x86intrin.h>
+#endif
+
+namespace memglass {
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#ifdef MEMGLASS_HAVE_RDPMC
+
+constexpr int COUNTERS = 4;
+
+// The calling thread's perf_event group: cycles leads, the others follow
+struct ThreadCounters {
+    int fds[COUNTERS] = {-1, -1, -1, -1};
+    perf_event_mmap_page* pages[COUNTERS] = {};
+    size_t page_size = 4096;
+    bool opened = false;
+    bool available = false;
+
+    ~ThreadCounters() { close(); }
+
+    void open() {
+        opened = true;
+        long ps = sysconf(_SC_PAGESIZE);
+        if (ps > 0) page_size = static_cast<size_t>(ps);
+
+        static constexpr uint64_t configs[COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int i = 0; i < COUNTERS; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.pinned = i == 0;  // keep the group on the PMU, no multiplexing
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1,
+                                              i == 0 ? -1 : fds[0], 0));
+            if (fd == -1) return close();
+            fds[i] = fd;
+
+            void* page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (page == MAP_FAILED) return close();
+            pages[i] = static_cast<perf_event_mmap_page*>(page);
+            if (!pages[i]->cap_user_rdpmc) return close();
+        }
+        available = true;
+    }
+
+    void close() {
+        for (int i = 0; i < COUNTERS; ++i) {
+            if (pages[i]) munmap(pages[i], page_size);
+            if (fds[i] != -1) ::close(fds[i]);
+            pages[i] = nullptr;
+            fds[i] = -1;
+        }
+        available = false;
+    }
+
+    // Self-monitoring read as documented in perf_event_open(2): the kernel
+    // bumps lock around updates of index and offset
+    static bool read(const perf_event_mmap_page* pc, uint64_t& value) {
+        uint32_t seq;
+        uint64_t count;
+        uint32_t index;
+        do {
+            seq = pc->lock;
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            index = pc->index;
+            count = static_cast<uint64_t>(pc->offset);
+            if (index != 0) {
+                int64_t pmc = static_cast<int64_t>(__rdpmc(static_cast<int>(index - 1)));
+                int shift = 64 - pc->pmc_width;
+                count += static_cast<uint64_t>((pmc << shift) >> shift);
+            }
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        } while (pc->lock != seq);
+        value = count;
+        return index != 0;  // 0: the group is not on the PMU right now
+    }
+
+    bool sample(PerfSample& s) const {
+        return read(pages[0], s.cycles) && read(pages[1], s.instructions) &&
+               read(pages[2], s.llc_misses) && read(pages[3], s.branch_misses);
+    }
+};
+
+thread_local ThreadCounters t_counters;
+
+ThreadCounters& counters() {
+    if (!t_counters.opened) t_counters.open();
+    return t_counters;
+}
+
+#endif
+
+} // anonymous namespace
+
+PerfSample perf_sample() {
+    PerfSample s;
+#ifdef MEMGLASS_HAVE_RDPMC
+    ThreadCounters& c = counters();
+    if (c.available) s.counters = c.sample(s);
+#endif
+    s.ns = now_ns();
+    return s;
+}
+
+bool perf_counters_available() {
+#ifdef MEMGLASS_HAVE_RDPMC
+    return counters().available;
+#else
+    return false;
+#endif
+}
+
+} // namespace memglass
@@ -83,7 +83,7 @@ bool SharedMemory::create(std::string_view name, size_t size) {
     return true;
 }
 
-bool SharedMemory::open(std::string_view name) {
+bool SharedMemory::open(std::string_view name, const MapOptions& options) {
     if (data_) {
         close();
     }
@@ -91,7 +91,7 @@ bool SharedMemory::open(std::string_view name) {
     name_ = std::string(name);
 
     // Open existing shared memory object
-    fd_ = shm_open(name_.c_str(), O_RDWR, 0666);
+    fd_ = shm_open(name_.c_str(), options.writable ? O_RDWR : O_RDONLY, 0666);
     if (fd_ == -1) {
         return false;
     }
@@ -106,7 +106,12 @@ bool SharedMemory::open(std::string_view name) {
     size_ = static_cast<size_t>(sb.st_size);
 
     // Map memory
-    data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    int prot = options.writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (options.populate) flags |= MAP_POPULATE;
+#endif
+    data_ = mmap(nullptr, size_, prot, flags, fd_, 0);
     if (data_ == MAP_FAILED) {
         data_ = nullptr;
         ::close(fd_);
@@ -114,6 +119,16 @@ bool SharedMemory::open(std::string_view name) {
         return false;
     }
 
+#ifndef MAP_POPULATE
+    if (options.populate) {
+        // Touch one byte per page so the first snapshot does not take the faults
+        long page = sysconf(_SC_PAGESIZE);
+        for (size_t off = 0; off < size_; off += static_cast<size_t>(page)) {
+            (void)*static_cast<volatile const char*>(static_cast<const char*>(data_) + off);
+        }
+    }
+#endif
+
     is_owner_ = false;
     return true;
 }
@@ -179,4 +194,20 @@ std::string make_overflow_shm_name(std::string_view session_name, uint64_t overf
     return fmt::format("/memglass_{}_overflow_{:04d}", session_name, overflow_id);
 }
 
+std::string make_events_shm_name(std::string_view session_name) {
+    return fmt::format("/memglass_{}_events", session_name);
+}
+
+std::string make_stamps_shm_name(std::string_view session_name) {
+    return fmt::format("/memglass_{}_stamps", session_name);
+}
+
+std::string make_heartbeats_shm_name(std::string_view session_name) {
+    return fmt::format("/memglass_{}_heartbeats", session_name);
+}
+
+std::string make_cdc_shm_name(std::string_view session_name) {
+    return fmt::format("/memglass_{}_cdc", session_name);
+}
+
 } // namespace memglass::detail
@@ -0,0 +1,535 @@
+#include "memglass/query.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+namespace memglass::query {
+
+namespace {
+
+// Partial aggregate for one bucket of one series
+struct Bucket {
+    uint64_t index = 0;  // timestamp / interval
+    mgdf::Rollup agg{};
+};
+
+// Everything one thread collected for one series
+struct Accumulator {
+    PrimitiveType type = PrimitiveType::Unknown;
+    uint64_t rollup_interval_ns = 0;   // rollup file at native resolution
+    std::vector<uint64_t> timestamps;  // raw mode
+    std::vector<FieldValue> values;    // raw mode
+    std::vector<Bucket> buckets;       // resampling mode, ordered by index
+};
+
+using SeriesKey = std::pair<std::string, std::string>;  // label, field
+using ChunkResult = std::map<SeriesKey, Accumulator>;
+
+Bucket& bucket_for(std::vector<Bucket>& buckets, uint64_t index) {
+    if (buckets.empty() || buckets.back().index < index) {
+        buckets.push_back(Bucket{index, {}});
+        return buckets.back();
+    }
+    if (buckets.back().index == index) {
+        return buckets.back();
+    }
+    // Out-of-order timestamp (clock step); keep buckets sorted
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), index,
+                               [](const Bucket& b, uint64_t i) { return b.index < i; });
+    if (it == buckets.end() || it->index != index) {
+        it = buckets.insert(it, Bucket{index, {}});
+    }
+    return *it;
+}
+
+// Decodes the blocks of one chunk, keeping only matching changes
+class ChunkDecoder : public mgdf::BlockVisitor {
+public:
+    ChunkDecoder(const Query& query, ChunkResult& out, QueryStats& stats)
+        : query_(query), out_(out), stats_(stats) {}
+
+    // Resolve the filters against the block's string table. Returns false
+    // when the block cannot contain a wanted label or field.
+    bool prepare(const mgdf::BlockDecoder& block) {
+        block_ = &block;
+        slots_.clear();
+        return resolve(query_.labels, label_ok_) && resolve(query_.fields, field_ok_);
+    }
+
+    void on_record(uint64_t timestamp_ns, uint64_t, uint64_t) override {
+        timestamp_ = timestamp_ns;
+        in_range_ = timestamp_ns >= query_.start_ns && timestamp_ns < query_.end_ns;
+        stats_.records++;
+    }
+
+    void on_change(uint32_t label, uint32_t field, const FieldValue& value) override {
+        if (!in_range_ || !label_ok_[label] || !field_ok_[field]) return;
+
+        Accumulator& acc = series(label, field);
+        acc.type = value.type;
+        stats_.points++;
+
+        if (query_.interval_ns == 0) {
+            acc.timestamps.push_back(timestamp_);
+            acc.values.push_back(value);
+        } else {
+            bucket_for(acc.buckets, timestamp_ / query_.interval_ns).agg.add(value);
+        }
+    }
+
+    // Rollup files: buckets arrive pre-aggregated and are re-bucketed at
+    // the query interval, or kept at their own resolution without one
+    void on_rollup(uint32_t label, uint32_t field, const mgdf::Rollup& rollup) override {
+        stats_.records++;
+        if (rollup.start_ns < query_.start_ns || rollup.start_ns >= query_.end_ns ||
+            !label_ok_[label] || !field_ok_[field]) {
+            return;
+        }
+
+        uint64_t interval = query_.interval_ns ? query_.interval_ns : rollup.interval_ns;
+        if (interval % rollup.interval_ns != 0) {
+            mismatched_interval_ = rollup.interval_ns;
+            return;
+        }
+
+        Accumulator& acc = series(label, field);
+        acc.type = rollup.last.type;
+        if (query_.interval_ns == 0) acc.rollup_interval_ns = rollup.interval_ns;
+        stats_.points++;
+        bucket_for(acc.buckets, rollup.start_ns / interval).agg.merge(rollup);
+    }
+
+    // Resolution of a rollup that the query interval is not a multiple of
+    uint64_t mismatched_interval() const { return mismatched_interval_; }
+
+private:
+    Accumulator& series(uint32_t label, uint32_t field) {
+        uint64_t key = (static_cast<uint64_t>(label) << 32) | field;
+        auto it = slots_.find(key);
+        if (it == slots_.end()) {
+            SeriesKey series(block_->strings()[label], block_->strings()[field]);
+            it = slots_.emplace(key, &out_[series]).first;
+        }
+        return *it->second;
+    }
+
+    bool resolve(const std::vector<std::string>& wanted, std::vector<uint8_t>& ok) {
+        size_t n = block_->strings().size();
+        ok.assign(n, wanted.empty() ? 1 : 0);
+        if (wanted.empty()) return true;
+
+        bool any = false;
+        for (const auto& name : wanted) {
+            uint32_t id = block_->find(name);
+            if (id != mgdf::NO_STRING) {
+                ok[id] = 1;
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    const Query& query_;
+    ChunkResult& out_;
+    QueryStats& stats_;
+    const mgdf::BlockDecoder* block_ = nullptr;
+    std::vector<uint8_t> label_ok_;
+    std::vector<uint8_t> field_ok_;
+    std::unordered_map<uint64_t, Accumulator*> slots_;  // per block
+    uint64_t timestamp_ = 0;
+    bool in_range_ = false;
+    uint64_t mismatched_interval_ = 0;
+};
+
+void append_value(Series& s, const FieldValue& v) {
+    if (s.integer) {
+        s.ints.push_back(v.as_int64());
+    } else {
+        s.doubles.push_back(v.as_double());
+    }
+}
+
+void emit_bucket(Series& s, const Bucket& b, uint64_t interval, Aggregation agg) {
+    const mgdf::Rollup& r = b.agg;
+    s.timestamps.push_back(b.index * interval);
+    switch (agg) {
+        case Aggregation::Last: append_value(s, r.last); break;
+        case Aggregation::First: append_value(s, r.first); break;
+        case Aggregation::Min: append_value(s, r.min); break;
+        case Aggregation::Max: append_value(s, r.max); break;
+        case Aggregation::Mean: s.doubles.push_back(r.sum / static_cast<double>(r.count)); break;
+        case Aggregation::Sum: s.doubles.push_back(r.sum); break;
+        case Aggregation::Count: s.ints.push_back(static_cast<int64_t>(r.count)); break;
+    }
+}
+
+Series build_series(const SeriesKey& key, const Accumulator& acc, const Query& query) {
+    Series s;
+    s.label = key.first;
+    s.field = key.second;
+    s.type = acc.type;
+
+    // Rollup recordings without a query interval come out at their own
+    uint64_t interval = query.interval_ns ? query.interval_ns : acc.rollup_interval_ns;
+
+    FieldValue probe;
+    probe.type = acc.type;
+    s.integer = probe.is_integer();
+    if (interval != 0) {
+        if (query.aggregation == Aggregation::Mean || query.aggregation == Aggregation::Sum) {
+            s.integer = false;
+        }
+        if (query.aggregation == Aggregation::Count) s.integer = true;
+    }
+
+    if (interval == 0) {
+        s.timestamps = acc.timestamps;
+        for (const auto& v : acc.values) append_value(s, v);
+        return s;
+    }
+
+    bool fill = query.fill && query.aggregation == Aggregation::Last;
+    const Bucket* prev = nullptr;
+    for (const auto& b : acc.buckets) {
+        if (fill && prev) {
+            Bucket carried = *prev;
+            for (uint64_t i = prev->index + 1; i < b.index; ++i) {
+                carried.index = i;
+                emit_bucket(s, carried, interval, query.aggregation);
+            }
+        }
+        emit_bucket(s, b, interval, query.aggregation);
+        prev = &b;
+    }
+
+    // Carry the last value to the end of a bounded range
+    if (fill && prev && query.end_ns != std::numeric_limits<uint64_t>::max()) {
+        Bucket carried = *prev;
+        uint64_t last_index = (query.end_ns - 1) / interval;
+        for (uint64_t i = prev->index + 1; i <= last_index; ++i) {
+            carried.index = i;
+            emit_bucket(s, carried, interval, query.aggregation);
+        }
+    }
+    return s;
+}
+
+} // anonymous namespace
+
+bool parse_aggregation(std::string_view name, Aggregation& agg) {
+    if (name == "last") agg = Aggregation::Last;
+    else if (name == "first") agg = Aggregation::First;
+    else if (name == "min") agg = Aggregation::Min;
+    else if (name == "max") agg = Aggregation::Max;
+    else if (name == "mean" || name == "avg") agg = Aggregation::Mean;
+    else if (name == "sum") agg = Aggregation::Sum;
+    else if (name == "count") agg = Aggregation::Count;
+    else return false;
+    return true;
+}
+
+bool run_query(const mgdf::MappedFile& file, const Query& query, QueryResult& result,
+               std::string* error) {
+    result = QueryResult{};
+
+    if (file.version() != mgdf::VERSION_2) {
+        if (error) {
+            *error = fmt::format("MGDF version {} has no blocks; record with a newer memglass-diff",
+                                 file.version());
+        }
+        return false;
+    }
+
+    // Time pruning from the block index
+    std::vector<const mgdf::BlockInfo*> blocks;
+    uint64_t total_bytes = 0;
+    for (const auto& b : file.blocks()) {
+        if (b.last_ts >= query.start_ns && b.first_ts < query.end_ns) {
+            blocks.push_back(&b);
+            total_bytes += b.size;
+            file.will_need(b);
+        }
+    }
+    result.stats.blocks_total = file.blocks().size();
+    result.stats.blocks_in_range = blocks.size();
+
+    unsigned threads = query.threads ? query.threads : std::thread::hardware_concurrency();
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(blocks.size())));
+
+    // Contiguous chunks of roughly equal size keep each chunk's output in
+    // time order, so merging is a concatenation
+    std::vector<size_t> bounds{0};
+    uint64_t acc_bytes = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        acc_bytes += blocks[i]->size;
+        if (bounds.size() < threads && acc_bytes * threads >= total_bytes * bounds.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    while (bounds.size() <= threads) bounds.push_back(blocks.size());
+
+    std::vector<ChunkResult> chunks(threads);
+    std::vector<QueryStats> chunk_stats(threads);
+    std::vector<uint8_t> chunk_ok(threads, 1);
+    std::vector<uint64_t> chunk_mismatch(threads, 0);
+
+    auto work = [&](unsigned t) {
+        ChunkDecoder visitor(query, chunks[t], chunk_stats[t]);
+        mgdf::BlockDecoder decoder;
+        for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+            const auto* b = blocks[i];
+            if (!decoder.open(file.data() + b->offset, file.size() - b->offset)) {
+                chunk_ok[t] = 0;
+                return;
+            }
+            if (!visitor.prepare(decoder)) continue;
+            chunk_stats[t].blocks_decoded++;
+            if (!decoder.decode(visitor)) {
+                chunk_ok[t] = 0;
+                return;
+            }
+        }
+        chunk_mismatch[t] = visitor.mismatched_interval();
+    };
+
+    if (threads == 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back(work, t);
+        }
+        for (auto& th : pool) th.join();
+    }
+
+    // Merge chunk results in time order
+    ChunkResult merged;
+    for (unsigned t = 0; t < threads; ++t) {
+        if (!chunk_ok[t]) {
+            if (error) *error = "corrupt block in recording";
+            return false;
+        }
+        if (chunk_mismatch[t]) {
+            if (error) {
+                *error = fmt::format("recording holds {} ns rollups; resample to a multiple of that",
+                                     chunk_mismatch[t]);
+            }
+            return false;
+        }
+        result.stats.blocks_decoded += chunk_stats[t].blocks_decoded;
+        result.stats.records += chunk_stats[t].records;
+        result.stats.points += chunk_stats[t].points;
+
+        for (auto& [key, acc] : chunks[t]) {
+            Accumulator& into = merged[key];
+            into.type = acc.type;
+            into.rollup_interval_ns = std::max(into.rollup_interval_ns, acc.rollup_interval_ns);
+            into.timestamps.insert(into.timestamps.end(), acc.timestamps.begin(), acc.timestamps.end());
+            into.values.insert(into.values.end(), acc.values.begin(), acc.values.end());
+            for (const auto& b : acc.buckets) {
+                bucket_for(into.buckets, b.index).agg.merge(b.agg);
+            }
+        }
+        chunks[t].clear();
+    }
+
+    result.series.reserve(merged.size());
+    for (const auto& [key, acc] : merged) {
+        result.series.push_back(build_series(key, acc, query));
+    }
+    return true;
+}
+
+namespace {
+
+// Feeds every change or rollup of a block into a RollupWriter
+class Compactor : public mgdf::BlockVisitor {
+public:
+    Compactor(mgdf::RollupWriter& writer, std::string& buffer, CompactStats& stats)
+        : writer_(writer), buffer_(buffer), stats_(stats) {}
+
+    void set_block(const mgdf::BlockDecoder& block) { block_ = &block; }
+
+    void on_record(uint64_t timestamp_ns, uint64_t, uint64_t) override {
+        timestamp_ = timestamp_ns;
+        stats_.records++;
+    }
+
+    void on_change(uint32_t label, uint32_t field, const FieldValue& value) override {
+        writer_.write_change(buffer_, timestamp_, block_->strings()[label],
+                             block_->strings()[field], value);
+    }
+
+    void on_rollup(uint32_t label, uint32_t field, const mgdf::Rollup& rollup) override {
+        stats_.records++;
+        if (!writer_.write_rollup(buffer_, block_->strings()[label], block_->strings()[field],
+                                  rollup)) {
+            mismatched_interval_ = rollup.interval_ns;
+        }
+    }
+
+    uint64_t mismatched_interval() const { return mismatched_interval_; }
+
+private:
+    mgdf::RollupWriter& writer_;
+    std::string& buffer_;
+    CompactStats& stats_;
+    const mgdf::BlockDecoder* block_ = nullptr;
+    uint64_t timestamp_ = 0;
+    uint64_t mismatched_interval_ = 0;
+};
+
+} // anonymous namespace
+
+bool compact(const mgdf::MappedFile& file, uint64_t interval_ns, std::ostream& out,
+             CompactStats* stats, std::string* error) {
+    if (file.version() != mgdf::VERSION_2) {
+        if (error) {
+            *error = fmt::format("MGDF version {} has no blocks; record with a newer memglass-diff",
+                                 file.version());
+        }
+        return false;
+    }
+    if (interval_ns == 0) {
+        if (error) *error = "rollup interval must be positive";
+        return false;
+    }
+
+    CompactStats local;
+    mgdf::RollupWriter writer(interval_ns);
+    std::string buffer;
+    Compactor visitor(writer, buffer, local);
+
+    auto drain = [&] {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        local.bytes += buffer.size();
+        buffer.clear();
+    };
+
+    writer.write_header(buffer);
+    mgdf::BlockDecoder decoder;
+    for (const auto& b : file.blocks()) {
+        if (!decoder.open(file.data() + b.offset, file.size() - b.offset)) {
+            if (error) *error = "corrupt block in recording";
+            return false;
+        }
+        visitor.set_block(decoder);
+        if (!decoder.decode(visitor)) {
+            if (error) *error = "corrupt block in recording";
+            return false;
+        }
+        if (visitor.mismatched_interval()) {
+            if (error) {
+                *error = fmt::format("recording holds {} ns rollups; compact to a multiple of that",
+                                     visitor.mismatched_interval());
+            }
+            return false;
+        }
+        if (buffer.size() >= 1024 * 1024) drain();
+    }
+    writer.write_end(buffer);
+    drain();
+
+    local.rollups = writer.rollups();
+    if (stats) *stats = local;
+    if (!out) {
+        if (error) *error = "write failed";
+        return false;
+    }
+    return true;
+}
+
+bool parse_duration(std::string_view text, uint64_t& ns) {
+    std::string s(text);
+    char* end = nullptr;
+    double value = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || value < 0) return false;
+
+    std::string_view unit(end);
+    double scale;
+    if (unit.empty() || unit == "ns") scale = 1;
+    else if (unit == "us") scale = 1e3;
+    else if (unit == "ms") scale = 1e6;
+    else if (unit == "s") scale = 1e9;
+    else if (unit == "m" || unit == "min") scale = 60e9;
+    else if (unit == "h") scale = 3600e9;
+    else return false;
+
+    ns = static_cast<uint64_t>(value * scale);
+    return true;
+}
+
+namespace {
+
+// Parses "HH:MM[:SS[.frac]]" into nanoseconds since midnight
+bool parse_time_of_day(std::string_view text, uint64_t& ns) {
+    unsigned h = 0, m = 0, sec = 0;
+    int consumed = 0;
+    std::string s(text);
+    int n = std::sscanf(s.c_str(), "%u:%u%n:%u%n", &h, &m, &consumed, &sec, &consumed);
+    if (n < 2 || h > 23 || m > 59 || sec > 60) return false;
+
+    uint64_t frac_ns = 0;
+    std::string_view rest = text.substr(static_cast<size_t>(consumed));
+    if (!rest.empty()) {
+        if (n < 3 || rest[0] != '.') return false;
+        uint64_t scale = 100'000'000;
+        for (char c : rest.substr(1)) {
+            if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+            frac_ns += static_cast<uint64_t>(c - '0') * scale;
+            scale /= 10;
+        }
+    }
+    ns = ((h * 60ull + m) * 60ull + sec) * 1'000'000'000ull + frac_ns;
+    return true;
+}
+
+} // anonymous namespace
+
+bool parse_time(std::string_view text, uint64_t reference_ns, uint64_t& ns) {
+    if (text.empty()) return false;
+
+    if (std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        ns = std::strtoull(std::string(text).c_str(), nullptr, 10);
+        return true;
+    }
+
+    constexpr uint64_t DAY_NS = 86'400'000'000'000ull;
+
+    size_t t = text.find('T');
+    if (t == std::string_view::npos) {
+        uint64_t tod;
+        if (!parse_time_of_day(text, tod)) return false;
+        ns = reference_ns / DAY_NS * DAY_NS + tod;
+        return true;
+    }
+
+    std::tm tm{};
+    std::string date(text.substr(0, t));
+    if (std::sscanf(date.c_str(), "%d-%d-%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday) != 3) {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+
+    std::string_view clock = text.substr(t + 1);
+    if (!clock.empty() && clock.back() == 'Z') clock.remove_suffix(1);
+
+    uint64_t tod;
+    if (!parse_time_of_day(clock, tod)) return false;
+
+    time_t day = timegm(&tm);
+    if (day < 0) return false;
+    ns = static_cast<uint64_t>(day) * 1'000'000'000ull + tod;
+    return true;
+}
+
+} // namespace memglass::query
@@ -0,0 +1,184 @@
+#include "memglass/recorder.hpp"
+#include "memglass/diff.hpp"
+#include "memglass/dirty.hpp"
+#include "memglass/memglass.hpp"
+#include "memglass/observer.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace memglass {
+
+// Everything the capture thread touches
+struct Recorder::State {
+    explicit State(std::string_view session)
+        : obs(session)
+        , tracker(obs)
+    {
+    }
+
+    Observer obs;
+    DirtyTracker tracker;
+    bool use_tracker = false;
+    size_t page_size = 4096;
+    Snapshot snap;
+    std::unique_ptr<DiffSink> sink;
+};
+
+Recorder::Recorder(const RecorderOptions& options)
+    : options_(options)
+{
+}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(std::string* error) {
+    if (running()) return true;
+
+    Context* ctx = detail::get_context();
+    if (!ctx) {
+        if (error) *error = "no session; call memglass::init() first";
+        return false;
+    }
+
+    auto state = std::make_unique<State>(ctx->session_name());
+    if (!state->obs.connect()) {
+        if (error) *error = "cannot map session '" + ctx->session_name() + "'";
+        return false;
+    }
+
+    auto sink = make_sink(options_.output, ctx->session_name(), error);
+    if (!sink) return false;
+    state->sink = std::make_unique<AsyncSink>(std::move(sink), options_.queue_depth);
+
+    // Clear soft-dirty bits before the baseline read so nothing is missed
+    if (options_.dirty_tracking) {
+        state->use_tracker = state->tracker.attach();
+    }
+    long ps = sysconf(_SC_PAGESIZE);
+    if (ps > 0) state->page_size = static_cast<size_t>(ps);
+    state->snap = take_snapshot(state->obs);
+
+    state_ = std::move(state);
+    stop_ = false;
+    thread_ = std::thread([this] { run(); });
+    if (!configure_thread(error)) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+bool Recorder::configure_thread(std::string* error) {
+    pthread_t handle = thread_.native_handle();
+#ifdef __linux__
+    if (options_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options_.cpu, &set);
+        if (pthread_setaffinity_np(handle, sizeof(set), &set) != 0) {
+            if (error) *error = "cannot pin recorder thread to CPU " + std::to_string(options_.cpu);
+            return false;
+        }
+    }
+    if (options_.idle_priority) {
+        sched_param param{};
+        pthread_setschedparam(handle, SCHED_IDLE, &param);  // best effort
+    }
+#else
+    (void)handle;
+    if (options_.cpu >= 0) {
+        if (error) *error = "CPU pinning is only supported on Linux";
+        return false;
+    }
+#endif
+    return true;
+}
+
+void Recorder::stop() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    state_->sink->close();
+    dropped_.store(state_->sink->dropped(), std::memory_order_relaxed);
+    state_.reset();
+}
+
+RecorderStats Recorder::stats() const {
+    RecorderStats st;
+    st.captures = captures_.load(std::memory_order_relaxed);
+    st.diffs = diffs_.load(std::memory_order_relaxed);
+    st.changes = changes_.load(std::memory_order_relaxed);
+    st.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    st.throttled_ns = throttled_ns_.load(std::memory_order_relaxed);
+    st.dropped = dropped_.load(std::memory_order_relaxed);
+    return st;
+}
+
+void Recorder::run() {
+    using clock = std::chrono::steady_clock;
+    auto next = clock::now() + options_.interval;
+
+    std::unique_lock lock(mutex_);
+    while (true) {
+        bool last = cv_.wait_until(lock, next, [this] { return stop_; });
+        lock.unlock();
+
+        uint64_t bytes = paused() ? 0 : capture();
+        auto start = clock::now();
+        next = start + options_.interval;
+
+        // Stretch the interval so re-reads average out under the cap
+        if (options_.max_read_bytes_per_sec > 0 && bytes > 0) {
+            auto budget = std::chrono::nanoseconds(bytes * 1'000'000'000ull /
+                                                   options_.max_read_bytes_per_sec);
+            if (budget > options_.interval) {
+                next = start + budget;
+                throttled_ns_.fetch_add(static_cast<uint64_t>((budget - options_.interval).count()),
+                                        std::memory_order_relaxed);
+            }
+        }
+
+        lock.lock();
+        if (last) break;
+    }
+}
+
+uint64_t Recorder::capture() {
+    State& s = *state_;
+    uint64_t bytes = 0;
+
+    std::shared_ptr<const SnapshotDiff> diff;
+    if (s.use_tracker) {
+        s.tracker.collect();
+        bytes = s.tracker.dirty_pages() * s.page_size;
+        diff = std::make_shared<const SnapshotDiff>(update_snapshot(s.obs, s.snap, s.tracker));
+    } else {
+        Snapshot snap = take_snapshot(s.obs);
+        for (const auto& obj : s.obs.objects()) {
+            if (const ObservedType* type = s.obs.get_type(obj.type_id)) bytes += type->size;
+        }
+        diff = std::make_shared<const SnapshotDiff>(compute_diff(s.snap, snap));
+        s.snap = std::move(snap);
+    }
+
+    captures_.fetch_add(1, std::memory_order_relaxed);
+    bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+    if (!diff->empty() || !options_.skip_empty) {
+        s.sink->submit(diff);
+        diffs_.fetch_add(1, std::memory_order_relaxed);
+        changes_.fetch_add(diff->field_changes.size(), std::memory_order_relaxed);
+    }
+    dropped_.store(s.sink->dropped(), std::memory_order_relaxed);
+    return bytes;
+}
+
+} // namespace memglass
@@ -1,10 +1,12 @@
 #include "memglass/registry.hpp"
 #include "memglass/types.hpp"
 
+#include <atomic>
 #include <cstring>
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_set>
 
 namespace memglass::registry {
 
@@ -14,6 +16,7 @@ std::mutex g_mutex;
 std::vector<std::pair<uint32_t, TypeDescriptor>> g_types;
 std::map<std::string, uint32_t> g_name_to_id;
 uint32_t g_next_type_id = static_cast<uint32_t>(PrimitiveType::UserTypeBase);
+std::unordered_set<std::string> g_interned;  // node-based: views stay valid
 
 // Simple hash function for type names
 uint32_t hash_name(std::string_view name) {
@@ -96,6 +99,11 @@ void clear() {
     g_name_to_id.clear();
 }
 
+std::string_view intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return *g_interned.emplace(name).first;
+}
+
 void write_to_header(TelemetryHeader* header, void* base) {
     std::lock_guard<std::mutex> lock(g_mutex);
 
@@ -111,7 +119,6 @@ void write_to_header(TelemetryHeader* header, void* base) {
         if (type_count >= header->type_registry_capacity) break;
 
         TypeEntry& entry = type_entries[type_count];
-        entry.type_id = type_id;
         entry.size = desc.size;
         entry.alignment = desc.alignment;
         entry.field_count = static_cast<uint32_t>(desc.fields.size());
@@ -133,6 +140,9 @@ void write_to_header(TelemetryHeader* header, void* base) {
             if (field_desc.array_size > 0) {
                 field.flags |= static_cast<uint32_t>(FieldFlags::IsArray);
             }
+            if (field_desc.primitive_type == PrimitiveType::Unknown && field_desc.user_type_id != 0) {
+                field.flags |= static_cast<uint32_t>(FieldFlags::IsNested);
+            }
             field.array_size = field_desc.array_size;
             field.atomicity = field_desc.atomicity;
             field.set_name(field_desc.name);
@@ -140,6 +150,8 @@ void write_to_header(TelemetryHeader* header, void* base) {
             field_count++;
         }
 
+        // Publish the type and its fields
+        std::atomic_ref<uint32_t>(entry.type_id).store(type_id, std::memory_order_release);
         type_count++;
     }
 
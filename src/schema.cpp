@@ -0,0 +1,269 @@
+#include "memglass/schema.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <string>
+
+namespace memglass {
+
+namespace {
+
+// FNV-1a, 64-bit
+class Fingerprint {
+public:
+    void add(const void* data, size_t size) {
+        auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ ^= bytes[i];
+            hash_ *= 1099511628211ull;
+        }
+    }
+
+    template<typename T>
+    void add(const T& value) { add(&value, sizeof(value)); }
+
+    void add_name(const char* name, size_t capacity) {
+        add(name, strnlen(name, capacity));
+        add(uint8_t{0});
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 14695981039346656037ull;
+};
+
+const TypeEntry* type_entries(const TelemetryHeader* header) {
+    return reinterpret_cast<const TypeEntry*>(
+        reinterpret_cast<const char*>(header) + header->type_registry_offset);
+}
+
+const FieldEntry* type_fields(const TelemetryHeader* header, const TypeEntry& te) {
+    return reinterpret_cast<const FieldEntry*>(
+        reinterpret_cast<const char*>(header) + te.fields_offset);
+}
+
+// Types reserved but not yet published have type_id 0; published entries
+// never change, so the same list feeds the fingerprint and the parse
+std::vector<uint32_t> published_types(const TelemetryHeader* header) {
+    uint32_t count = std::min(header->type_count.load(std::memory_order_acquire),
+                              header->type_registry_capacity);
+    const TypeEntry* entries = type_entries(header);
+
+    std::vector<uint32_t> result;
+    result.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::atomic_ref<uint32_t> published(const_cast<uint32_t&>(entries[i].type_id));
+        if (published.load(std::memory_order_acquire) != 0) result.push_back(i);
+    }
+    return result;
+}
+
+// Hash what observers see, not raw bytes: padding is not guaranteed zero and
+// fields_offset depends on where the pool slice landed
+uint64_t fingerprint(const TelemetryHeader* header, const std::vector<uint32_t>& published) {
+    const TypeEntry* entries = type_entries(header);
+    Fingerprint fp;
+    for (uint32_t i : published) {
+        const TypeEntry& te = entries[i];
+        fp.add(te.type_id);
+        fp.add_name(te.name, sizeof(te.name));
+        fp.add(te.size);
+        fp.add(te.alignment);
+        fp.add(te.field_count);
+
+        const FieldEntry* fields = type_fields(header, te);
+        for (uint32_t j = 0; j < te.field_count; ++j) {
+            const FieldEntry& f = fields[j];
+            fp.add_name(f.name, sizeof(f.name));
+            fp.add(f.offset);
+            fp.add(f.size);
+            fp.add(f.type_id);
+            fp.add(f.array_size);
+            fp.add(f.flags);
+            fp.add(f.atomicity);
+        }
+    }
+    return fp.value();
+}
+
+bool is_primitive(uint32_t type_id) {
+    return type_id >= static_cast<uint32_t>(PrimitiveType::Bool) &&
+           type_id <= static_cast<uint32_t>(PrimitiveType::Char);
+}
+
+std::string_view field_name(const FieldEntry& f) {
+    return std::string_view(f.name, strnlen(f.name, sizeof(f.name)));
+}
+
+enum class Linking : uint8_t { Pending, Running, Done };
+
+// Point type i's nested struct fields at their types, linking those first,
+// and collect its guarded fields, nested ones rebased. Each nested type is
+// linked once however many parents embed it; unknown, cyclic or oversized
+// references stay opaque.
+void link(Schema& schema, size_t i, std::vector<Linking>& state) {
+    state[i] = Linking::Running;
+    ObservedType& type = schema.types[i];
+    type.nested_types.assign(type.fields.size(), nullptr);
+
+    for (uint32_t j = 0; j < type.fields.size(); ++j) {
+        const FieldEntry& f = type.fields[j];
+        // Guarded<T>/Locked<T> of a struct is read as a whole, not by leaf
+        auto it = schema.type_id_to_index.end();
+        if ((f.flags & static_cast<uint32_t>(FieldFlags::IsNested)) && f.atomicity == Atomicity::None) {
+            it = schema.type_id_to_index.find(f.type_id);
+        }
+        if (it == schema.type_id_to_index.end() || state[it->second] == Linking::Running) {
+            // Locked<T> value offset is only known for primitives
+            if (f.atomicity == Atomicity::Seqlock ||
+                (f.atomicity == Atomicity::Locked && is_primitive(f.type_id))) {
+                type.guarded_fields.push_back({&f, 0});
+            }
+            continue;
+        }
+        if (state[it->second] == Linking::Pending) link(schema, it->second, state);
+
+        const ObservedType& nested = schema.types[it->second];
+        uint32_t count = (f.flags & static_cast<uint32_t>(FieldFlags::IsArray)) ? f.array_size : 1;
+        if (static_cast<uint64_t>(nested.size) * count > f.size) continue;
+        type.nested_types[j] = &nested;
+
+        for (uint32_t e = 0; e < count; ++e) {
+            for (const FieldRef& g : nested.guarded_fields) {
+                type.guarded_fields.push_back({g.entry, f.offset + e * nested.size + g.base});
+            }
+        }
+    }
+    state[i] = Linking::Done;
+}
+
+std::shared_ptr<Schema> parse(const TelemetryHeader* header, const std::vector<uint32_t>& published) {
+    auto schema = std::make_shared<Schema>();
+    const TypeEntry* entries = type_entries(header);
+
+    schema->types.reserve(published.size());
+    for (uint32_t i : published) {
+        const TypeEntry& te = entries[i];
+
+        ObservedType type;
+        type.type_id = te.type_id;
+        type.name = std::string(te.name, strnlen(te.name, sizeof(te.name)));
+        type.size = te.size;
+        type.alignment = te.alignment;
+
+        const FieldEntry* fields = type_fields(header, te);
+        type.fields.assign(fields, fields + te.field_count);
+
+        schema->type_id_to_index[type.type_id] = schema->types.size();
+        schema->types.push_back(std::move(type));
+    }
+
+    for (ObservedType& type : schema->types) {
+        type.field_index.reserve(type.fields.size());
+        for (uint32_t j = 0; j < type.fields.size(); ++j) {
+            type.field_index.emplace(std::string(field_name(type.fields[j])), j);
+        }
+    }
+
+    // Types are in place now; nested_types points into schema->types
+    std::vector<Linking> state(schema->types.size(), Linking::Pending);
+    for (size_t i = 0; i < schema->types.size(); ++i) {
+        if (state[i] == Linking::Pending) link(*schema, i, state);
+    }
+    return schema;
+}
+
+} // anonymous namespace
+
+FieldRef ObservedType::find_field(std::string_view path) const {
+    auto it = field_index.find(path);
+    if (it != field_index.end()) return {&fields[it->second], 0};
+
+    // Published names may contain dots themselves, so try every split
+    for (size_t dot = path.find('.'); dot != std::string_view::npos; dot = path.find('.', dot + 1)) {
+        std::string_view head = path.substr(0, dot);
+        uint32_t element = 0;
+        bool indexed = head.ends_with(']');
+        if (indexed) {
+            size_t open = head.rfind('[');
+            if (open == std::string_view::npos) continue;
+            const char* first = head.data() + open + 1;
+            const char* last = head.data() + head.size() - 1;
+            auto [end, ec] = std::from_chars(first, last, element);
+            if (first == last || ec != std::errc() || end != last) continue;
+            head = head.substr(0, open);
+        }
+
+        auto f = field_index.find(head);
+        if (f == field_index.end() || !nested_types[f->second]) continue;
+        const FieldEntry& field = fields[f->second];
+        bool is_array = field.flags & static_cast<uint32_t>(FieldFlags::IsArray);
+        if (indexed != is_array || (indexed && element >= field.array_size)) continue;
+
+        const ObservedType* nested = nested_types[f->second];
+        if (FieldRef ref = nested->find_field(path.substr(dot + 1))) {
+            ref.base += field.offset + element * nested->size;
+            return ref;
+        }
+    }
+    return {};
+}
+
+const ObservedType* Schema::get_type(uint32_t type_id) const {
+    auto it = type_id_to_index.find(type_id);
+    return it != type_id_to_index.end() ? &types[it->second] : nullptr;
+}
+
+const std::shared_ptr<SchemaCache>& SchemaCache::shared() {
+    static const std::shared_ptr<SchemaCache> cache = std::make_shared<SchemaCache>();
+    return cache;
+}
+
+std::shared_ptr<const Schema> SchemaCache::load(const TelemetryHeader* header) {
+    std::vector<uint32_t> published = published_types(header);
+    uint64_t fp = fingerprint(header, published);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = schemas_.find(fp);
+        if (it != schemas_.end()) {
+            if (auto schema = it->second.lock()) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return schema;
+            }
+        }
+    }
+
+    // Parse outside the lock; if another observer raced us, keep theirs
+    std::shared_ptr<Schema> parsed = parse(header, published);
+    parsed->fingerprint = fp;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = schemas_[fp];
+    if (auto existing = slot.lock()) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return existing;
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    slot = parsed;
+
+    // Drop entries whose sessions are all gone
+    for (auto it = schemas_.begin(); it != schemas_.end();) {
+        it = it->second.expired() ? schemas_.erase(it) : std::next(it);
+    }
+    return parsed;
+}
+
+size_t SchemaCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t live = 0;
+    for (const auto& [fp, schema] : schemas_) {
+        if (!schema.expired()) ++live;
+    }
+    return live;
+}
+
+} // namespace memglass
@@ -0,0 +1,619 @@
+#include "memglass/sink.hpp"
+#include "memglass/query.hpp"
+
+#include <fmt/format.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace memglass {
+
+void append_json_escaped(std::string& out, std::string_view s) {
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+}
+
+void append_csv_field(std::string& out, std::string_view s) {
+    if (s.find_first_of(",\"\n\r") == std::string_view::npos) {
+        out.append(s);
+        return;
+    }
+    out += '"';
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+namespace {
+
+// Line protocol escaping for tag keys, tag values and field keys
+void append_lp_key(std::string& out, std::string_view s) {
+    for (char c : s) {
+        if (c == ',' || c == '=' || c == ' ') out += '\\';
+        out += c;
+    }
+}
+
+void append_lp_value(std::string& out, const FieldValue& v) {
+    switch (v.type) {
+        case PrimitiveType::Bool:
+            out += v.data.b ? "true" : "false";
+            break;
+        case PrimitiveType::UInt8:
+        case PrimitiveType::UInt16:
+        case PrimitiveType::UInt32:
+        case PrimitiveType::UInt64:
+            fmt::format_to(std::back_inserter(out), "{}u", static_cast<uint64_t>(v.as_int64()));
+            break;
+        case PrimitiveType::Int8:
+        case PrimitiveType::Int16:
+        case PrimitiveType::Int32:
+        case PrimitiveType::Int64:
+            fmt::format_to(std::back_inserter(out), "{}i", v.as_int64());
+            break;
+        case PrimitiveType::Float32:
+        case PrimitiveType::Float64: {
+            double d = v.as_double();
+            // Line protocol has no NaN/Inf; send them as strings
+            if (std::isfinite(d)) {
+                fmt::format_to(std::back_inserter(out), "{}", d);
+            } else {
+                fmt::format_to(std::back_inserter(out), "\"{}\"", d);
+            }
+            break;
+        }
+        case PrimitiveType::Char:
+            out += '"';
+            if (v.data.c == '"' || v.data.c == '\\') out += '\\';
+            out += v.data.c;
+            out += '"';
+            break;
+        default:
+            out += "\"?\"";
+            break;
+    }
+}
+
+void append_plain_value(std::string& out, const FieldValue& v) {
+    switch (v.type) {
+        case PrimitiveType::Char:
+            out += v.data.c;
+            break;
+        case PrimitiveType::Unknown:
+            break;
+        default:
+            out += v.to_string();
+            break;
+    }
+}
+
+} // anonymous namespace
+
+// SinkOutput implementation
+
+SinkOutput::~SinkOutput() {
+    close();
+}
+
+bool SinkOutput::open(std::string_view target, std::string* error) {
+    close();
+    target_ = std::string(target);
+    failed_ = false;
+
+    if (target == "-" || target.empty()) {
+        fd_ = STDOUT_FILENO;
+        owns_fd_ = false;
+        return true;
+    }
+
+    if (target.substr(0, 5) == "unix:") {
+        std::string path(target.substr(5));
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            if (error) *error = fmt::format("socket path too long: {}", path);
+            return false;
+        }
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            if (error) *error = fmt::format("socket: {}", std::strerror(errno));
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            if (error) *error = fmt::format("connect {}: {}", path, std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        fd_ = fd;
+        owns_fd_ = true;
+        is_socket_ = true;
+        return true;
+    }
+
+    int fd = ::open(target_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        if (error) *error = fmt::format("cannot open '{}': {}", target_, std::strerror(errno));
+        return false;
+    }
+    fd_ = fd;
+    owns_fd_ = true;
+    return true;
+}
+
+bool SinkOutput::write(std::string_view data) {
+    if (fd_ == -1 || failed_) return false;
+
+    const char* p = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t n = is_socket_
+            ? ::send(fd_, p, remaining, MSG_NOSIGNAL)
+            : ::write(fd_, p, remaining);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed_ = true;
+            return false;
+        }
+        p += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void SinkOutput::close() {
+    if (fd_ != -1 && owns_fd_) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    owns_fd_ = false;
+    is_socket_ = false;
+}
+
+// BufferedSink implementation
+
+BufferedSink::BufferedSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes)
+    : out_(std::move(out))
+    , batch_bytes_(batch_bytes)
+{
+    buffer_.reserve(batch_bytes_);
+}
+
+void BufferedSink::flush() {
+    if (buffer_.empty()) return;
+    out_->write(buffer_);
+    buffer_.clear();  // keeps capacity for the next batch
+}
+
+void BufferedSink::close() {
+    flush();
+    out_->close();
+}
+
+void BufferedSink::maybe_flush() {
+    if (buffer_.size() >= batch_bytes_) {
+        flush();
+    }
+}
+
+// TextSink implementation
+
+TextSink::TextSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+{
+}
+
+void TextSink::write(const SnapshotDiff& diff) {
+    auto out = std::back_inserter(buffer_);
+    fmt::format_to(out, "@{} seq:{}->{}", diff.timestamp_ns, diff.old_sequence,
+                   diff.new_sequence);
+
+    if (!diff.added_objects.empty()) {
+        fmt::format_to(out, " +objs:[{}]", fmt::join(diff.added_objects, ","));
+    }
+    if (!diff.removed_objects.empty()) {
+        fmt::format_to(out, " -objs:[{}]", fmt::join(diff.removed_objects, ","));
+    }
+    buffer_ += '\n';
+
+    for (const auto& c : diff.field_changes) {
+        fmt::format_to(out, "  {}.{}: {} -> {}\n", c.object_label, c.field_name,
+                       c.old_value.to_string(), c.new_value.to_string());
+    }
+    maybe_flush();
+}
+
+// JsonSink implementation
+
+JsonSink::JsonSink(std::unique_ptr<SinkOutput> out, bool pretty, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+    , pretty_(pretty)
+{
+}
+
+void JsonSink::write(const SnapshotDiff& diff) {
+    const char* nl = pretty_ ? "\n" : "";
+    const char* sp = pretty_ ? "  " : "";
+    auto out = std::back_inserter(buffer_);
+
+    fmt::format_to(out, "{{{}", nl);
+    fmt::format_to(out, "{}\"timestamp_ns\":{},{}", sp, diff.timestamp_ns, nl);
+    fmt::format_to(out, "{}\"old_sequence\":{},{}", sp, diff.old_sequence, nl);
+    fmt::format_to(out, "{}\"new_sequence\":{},{}", sp, diff.new_sequence, nl);
+
+    auto write_labels = [&](const char* key, const std::vector<std::string>& labels) {
+        fmt::format_to(out, "{}\"{}\":[", sp, key);
+        for (size_t i = 0; i < labels.size(); ++i) {
+            if (i > 0) buffer_ += ',';
+            buffer_ += '"';
+            append_json_escaped(buffer_, labels[i]);
+            buffer_ += '"';
+        }
+        fmt::format_to(out, "],{}", nl);
+    };
+    write_labels("added", diff.added_objects);
+    write_labels("removed", diff.removed_objects);
+
+    fmt::format_to(out, "{}\"changes\":[", sp);
+    for (size_t i = 0; i < diff.field_changes.size(); ++i) {
+        if (i > 0) buffer_ += ',';
+        const auto& c = diff.field_changes[i];
+        fmt::format_to(out, "{}{}{}{{\"obj\":\"", nl, sp, sp);
+        append_json_escaped(buffer_, c.object_label);
+        buffer_ += "\",\"field\":\"";
+        append_json_escaped(buffer_, c.field_name);
+        fmt::format_to(out, "\",\"old\":{},\"new\":{}}}", c.old_value.to_json(),
+                       c.new_value.to_json());
+    }
+    fmt::format_to(out, "{}{}]{}", nl, sp, nl);
+    fmt::format_to(out, "}}{}", nl);
+    if (!pretty_) buffer_ += '\n';
+    maybe_flush();
+}
+
+// CsvSink implementation
+
+CsvSink::CsvSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+{
+}
+
+void CsvSink::write(const SnapshotDiff& diff) {
+    if (!header_written_) {
+        buffer_ += "timestamp_ns,sequence,event,object,field,type,old,new\n";
+        header_written_ = true;
+    }
+
+    auto out = std::back_inserter(buffer_);
+    auto write_event = [&](const char* event, const std::string& label) {
+        fmt::format_to(out, "{},{},{},", diff.timestamp_ns, diff.new_sequence, event);
+        append_csv_field(buffer_, label);
+        buffer_ += ",,,,\n";
+    };
+    for (const auto& label : diff.added_objects) write_event("added", label);
+    for (const auto& label : diff.removed_objects) write_event("removed", label);
+
+    for (const auto& c : diff.field_changes) {
+        fmt::format_to(out, "{},{},change,", diff.timestamp_ns, diff.new_sequence);
+        append_csv_field(buffer_, c.object_label);
+        buffer_ += ',';
+        append_csv_field(buffer_, c.field_name);
+        buffer_ += ',';
+        buffer_ += primitive_type_name(c.new_value.type);
+        buffer_ += ',';
+        if (c.new_value.type == PrimitiveType::Char) {
+            std::string_view old_c(&c.old_value.data.c, c.old_value.type == PrimitiveType::Char);
+            append_csv_field(buffer_, old_c);
+            buffer_ += ',';
+            append_csv_field(buffer_, std::string_view(&c.new_value.data.c, 1));
+        } else {
+            append_plain_value(buffer_, c.old_value);
+            buffer_ += ',';
+            append_plain_value(buffer_, c.new_value);
+        }
+        buffer_ += '\n';
+    }
+    maybe_flush();
+}
+
+// LineProtocolSink implementation
+
+LineProtocolSink::LineProtocolSink(std::unique_ptr<SinkOutput> out, std::string_view session,
+                                   size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+{
+    append_lp_key(session_tag_, session);
+}
+
+void LineProtocolSink::write(const SnapshotDiff& diff) {
+    auto out = std::back_inserter(buffer_);
+
+    auto write_event = [&](const char* event, const std::string& label) {
+        buffer_ += "memglass_events,session=";
+        buffer_ += session_tag_;
+        buffer_ += ",object=";
+        append_lp_key(buffer_, label);
+        fmt::format_to(out, " event=\"{}\" {}\n", event, diff.timestamp_ns);
+    };
+    for (const auto& label : diff.added_objects) write_event("added", label);
+    for (const auto& label : diff.removed_objects) write_event("removed", label);
+
+    // compute_diff emits changes grouped by object, so one line per run
+    const std::string* current = nullptr;
+    for (const auto& c : diff.field_changes) {
+        if (!current || *current != c.object_label) {
+            if (current) fmt::format_to(out, " {}\n", diff.timestamp_ns);
+            current = &c.object_label;
+            buffer_ += "memglass,session=";
+            buffer_ += session_tag_;
+            buffer_ += ",object=";
+            append_lp_key(buffer_, c.object_label);
+            buffer_ += ' ';
+        } else {
+            buffer_ += ',';
+        }
+        append_lp_key(buffer_, c.field_name);
+        buffer_ += '=';
+        append_lp_value(buffer_, c.new_value);
+    }
+    if (current) fmt::format_to(out, " {}\n", diff.timestamp_ns);
+    maybe_flush();
+}
+
+// NdjsonSink implementation
+
+NdjsonSink::NdjsonSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+{
+}
+
+void NdjsonSink::write(const SnapshotDiff& diff) {
+    auto out = std::back_inserter(buffer_);
+
+    auto write_event = [&](const char* event, const std::string& label) {
+        fmt::format_to(out, "{{\"ts\":{},\"seq\":{},\"event\":\"{}\",\"obj\":\"",
+                       diff.timestamp_ns, diff.new_sequence, event);
+        append_json_escaped(buffer_, label);
+        buffer_ += "\"}\n";
+    };
+    for (const auto& label : diff.added_objects) write_event("added", label);
+    for (const auto& label : diff.removed_objects) write_event("removed", label);
+
+    for (const auto& c : diff.field_changes) {
+        fmt::format_to(out, "{{\"ts\":{},\"seq\":{},\"event\":\"change\",\"obj\":\"",
+                       diff.timestamp_ns, diff.new_sequence);
+        append_json_escaped(buffer_, c.object_label);
+        buffer_ += "\",\"field\":\"";
+        append_json_escaped(buffer_, c.field_name);
+        fmt::format_to(out, "\",\"type\":\"{}\",\"old\":{},\"new\":{}}}\n",
+                       primitive_type_name(c.new_value.type), c.old_value.to_json(),
+                       c.new_value.to_json());
+    }
+    maybe_flush();
+}
+
+// MgdfSink implementation
+
+MgdfSink::MgdfSink(std::unique_ptr<SinkOutput> out, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+{
+}
+
+void MgdfSink::write(const SnapshotDiff& diff) {
+    if (!header_written_) {
+        writer_.write_header(buffer_);
+        header_written_ = true;
+    }
+    writer_.write_diff(buffer_, diff);
+    maybe_flush();
+}
+
+void MgdfSink::close() {
+    if (closed_) return;
+    closed_ = true;
+    if (!header_written_) {
+        writer_.write_header(buffer_);
+        header_written_ = true;
+    }
+    writer_.write_end(buffer_);
+    BufferedSink::close();
+}
+
+// RollupSink implementation
+
+RollupSink::RollupSink(std::unique_ptr<SinkOutput> out, uint64_t interval_ns, size_t batch_bytes)
+    : BufferedSink(std::move(out), batch_bytes)
+    , writer_(interval_ns)
+{
+}
+
+void RollupSink::write(const SnapshotDiff& diff) {
+    if (!header_written_) {
+        writer_.write_header(buffer_);
+        header_written_ = true;
+    }
+    writer_.write_diff(buffer_, diff);
+    maybe_flush();
+}
+
+void RollupSink::close() {
+    if (closed_) return;
+    closed_ = true;
+    if (!header_written_) {
+        writer_.write_header(buffer_);
+        header_written_ = true;
+    }
+    writer_.write_end(buffer_);
+    BufferedSink::close();
+}
+
+// AsyncSink implementation
+
+AsyncSink::AsyncSink(std::unique_ptr<DiffSink> inner, size_t max_queue)
+    : inner_(std::move(inner))
+    , max_queue_(max_queue)
+{
+    queue_.reserve(max_queue_);
+    thread_ = std::thread([this] { run(); });
+}
+
+AsyncSink::~AsyncSink() {
+    close();
+}
+
+void AsyncSink::write(const SnapshotDiff& diff) {
+    submit(std::make_shared<const SnapshotDiff>(diff));
+}
+
+void AsyncSink::submit(const std::shared_ptr<const SnapshotDiff>& diff) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return;
+        if (queue_.size() >= max_queue_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queue_.push_back(diff);
+    }
+    cv_.notify_one();
+}
+
+void AsyncSink::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_requested_ = true;
+    }
+    cv_.notify_one();
+}
+
+void AsyncSink::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    inner_->close();
+}
+
+void AsyncSink::run() {
+    // Swap the whole queue out under the lock and encode the batch outside it;
+    // both vectors keep their capacity so steady state does not allocate
+    std::vector<std::shared_ptr<const SnapshotDiff>> batch;
+    batch.reserve(max_queue_);
+
+    while (true) {
+        bool do_flush = false;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || flush_requested_ || !queue_.empty(); });
+            batch.swap(queue_);
+            do_flush = flush_requested_;
+            flush_requested_ = false;
+            stopping = stop_;
+        }
+
+        for (const auto& diff : batch) {
+            inner_->write(*diff);
+        }
+        if (!batch.empty() || do_flush) {
+            inner_->flush();
+        }
+        batch.clear();
+
+        if (stopping) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (queue_.empty()) break;
+        }
+    }
+}
+
+// Factory
+
+bool parse_sink_format(std::string_view name, SinkSpec& spec) {
+    SinkFormat& format = spec.format;
+    if (name == "text") format = SinkFormat::Text;
+    else if (name == "json") format = SinkFormat::Json;
+    else if (name == "json-pretty") format = SinkFormat::JsonPretty;
+    else if (name == "binary" || name == "mgdf") format = SinkFormat::Binary;
+    else if (name == "csv") format = SinkFormat::Csv;
+    else if (name == "influx" || name == "line") format = SinkFormat::LineProtocol;
+    else if (name == "ndjson") format = SinkFormat::Ndjson;
+    else if (name.substr(0, 7) == "rollup-") {
+        uint64_t interval;
+        if (!query::parse_duration(name.substr(7), interval) || interval == 0) return false;
+        format = SinkFormat::Rollup;
+        spec.rollup_interval_ns = interval;
+    }
+    else return false;
+    return true;
+}
+
+bool parse_sink_spec(std::string_view spec, SinkSpec& out) {
+    size_t colon = spec.find(':');
+    std::string_view format_name = spec.substr(0, colon);
+    if (!parse_sink_format(format_name, out)) {
+        return false;
+    }
+    out.target = (colon == std::string_view::npos) ? "-" : std::string(spec.substr(colon + 1));
+    return !out.target.empty();
+}
+
+std::unique_ptr<DiffSink> make_sink(const SinkSpec& spec, std::string_view session,
+                                    std::string* error) {
+    auto out = std::make_unique<SinkOutput>();
+    if (!out->open(spec.target, error)) {
+        return nullptr;
+    }
+
+    switch (spec.format) {
+        case SinkFormat::Text:
+            return std::make_unique<TextSink>(std::move(out));
+        case SinkFormat::Json:
+            return std::make_unique<JsonSink>(std::move(out), false);
+        case SinkFormat::JsonPretty:
+            return std::make_unique<JsonSink>(std::move(out), true);
+        case SinkFormat::Binary:
+            return std::make_unique<MgdfSink>(std::move(out));
+        case SinkFormat::Csv:
+            return std::make_unique<CsvSink>(std::move(out));
+        case SinkFormat::LineProtocol:
+            return std::make_unique<LineProtocolSink>(std::move(out), session);
+        case SinkFormat::Ndjson:
+            return std::make_unique<NdjsonSink>(std::move(out));
+        case SinkFormat::Rollup:
+            if (spec.rollup_interval_ns == 0) {
+                if (error) *error = "rollup sink needs an interval";
+                return nullptr;
+            }
+            return std::make_unique<RollupSink>(std::move(out), spec.rollup_interval_ns);
+    }
+    return nullptr;
+}
+
+} // namespace memglass
@@ -1,13 +1,44 @@
 #include <gtest/gtest.h>
 #include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace memglass;
 
+namespace {
+
+struct Slot {
+    uint64_t value;
+    uint32_t owner;
+};
+
+uint32_t register_slot() {
+    TypeDescriptor desc;
+    desc.name = "Slot";
+    desc.size = sizeof(Slot);
+    desc.alignment = alignof(Slot);
+    desc.fields = {
+        {"value", offsetof(Slot, value), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::None, false},
+        {"owner", offsetof(Slot, owner), sizeof(uint32_t), PrimitiveType::UInt32, 0, 0, Atomicity::None, false},
+    };
+    return registry::register_type_for<Slot>(desc);
+}
+
+} // anonymous namespace
+
 class AllocatorTest : public ::testing::Test {
 protected:
     void SetUp() override {
         registry::clear();
+        register_slot();
         ASSERT_TRUE(memglass::init("test_allocator"));
     }
 
@@ -83,3 +114,287 @@ TEST_F(AllocatorTest, LargeAllocation) {
     // Should be able to write to it
     std::memset(ptr, 0xAB, large_size);
 }
+
+TEST_F(AllocatorTest, ConcurrentAllocationsDoNotOverlap) {
+    auto* ctx = detail::get_context();
+    ASSERT_NE(ctx, nullptr);
+
+    constexpr int threads = 8;
+    constexpr int per_thread = 2000;
+    std::vector<std::vector<char*>> ptrs(threads);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                // Large enough to force several new regions along the way
+                auto* p = static_cast<char*>(ctx->regions().allocate(256, 64));
+                ASSERT_NE(p, nullptr);
+                std::memset(p, t, 256);
+                ptrs[t].push_back(p);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::vector<char*> all;
+    for (int t = 0; t < threads; ++t) {
+        for (char* p : ptrs[t]) {
+            // Nobody else wrote into this block
+            EXPECT_EQ(p[0], static_cast<char>(t));
+            EXPECT_EQ(p[255], static_cast<char>(t));
+            all.push_back(p);
+        }
+    }
+    std::sort(all.begin(), all.end());
+    for (size_t i = 1; i < all.size(); ++i) {
+        EXPECT_GE(all[i] - all[i - 1], 256);
+    }
+}
+
+TEST_F(AllocatorTest, HandleCreateDestroy) {
+    auto handle = memglass::create_handle<Slot>("slot");
+    ASSERT_TRUE(handle);
+    handle->value = 42;
+
+    auto* ctx = detail::get_context();
+    ObjectEntry* entry = ctx->objects().find_object("slot");
+    ASSERT_EQ(entry, handle.entry);
+    EXPECT_EQ(status_generation(entry->status.load()), handle.generation);
+
+    uint64_t region_id, offset;
+    ASSERT_TRUE(ctx->regions().get_location(handle.get(), region_id, offset));
+    EXPECT_EQ(entry->region_id, region_id);
+    EXPECT_EQ(entry->offset, offset);
+
+    ObjectHandle copy = handle;
+    EXPECT_TRUE(memglass::destroy(handle));
+    EXPECT_FALSE(handle);
+    EXPECT_EQ(ctx->objects().find_object("slot"), nullptr);
+
+    // Second destroy through a copy of the handle fails
+    EXPECT_FALSE(ctx->objects().destroy_object(copy));
+}
+
+TEST_F(AllocatorTest, StaleHandleAfterSlotReuse) {
+    auto* ctx = detail::get_context();
+
+    auto first = memglass::create_handle<Slot>("first");
+    ASSERT_TRUE(first);
+    ObjectHandle stale = first;
+    ASSERT_TRUE(memglass::destroy(first));
+
+    // The destroyed slot is reused with a new generation
+    auto second = memglass::create_handle<Slot>("second");
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second.entry, stale.entry);
+    EXPECT_GT(second.generation, stale.generation);
+
+    EXPECT_FALSE(ctx->objects().destroy_object(stale));
+    EXPECT_EQ(ctx->objects().find_object("second"), second.entry);
+    EXPECT_TRUE(memglass::destroy(second));
+}
+
+TEST_F(AllocatorTest, StaleDestroysRacingSlotReuse) {
+    constexpr int owners = 4;
+    constexpr int rounds = 5000;
+    constexpr int stalers = 4;
+
+    // Handles to objects that were already destroyed, whose slots the
+    // owners keep reusing
+    std::mutex mutex;
+    std::vector<ObjectHandle> stale;
+    std::atomic<bool> done{false};
+    std::atomic<int> stale_destroyed{0};
+    std::atomic<int> owner_failures{0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < owners; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < rounds; ++i) {
+                auto h = memglass::create_handle<Slot>("o" + std::to_string(t));
+                ASSERT_TRUE(h);
+                h->owner = t;
+                ObjectHandle copy = h;
+                if (!memglass::destroy(h)) ++owner_failures;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stale.size() < 64) {
+                    stale.push_back(copy);
+                } else {
+                    stale[i % stale.size()] = copy;
+                }
+            }
+        });
+    }
+    for (int t = 0; t < stalers; ++t) {
+        workers.emplace_back([&] {
+            auto* ctx = detail::get_context();
+            std::vector<ObjectHandle> mine;
+            while (!done.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    mine = stale;
+                }
+                for (const auto& h : mine) {
+                    if (ctx->objects().destroy_object(h)) ++stale_destroyed;
+                }
+            }
+        });
+    }
+    for (int t = 0; t < owners; ++t) workers[t].join();
+    done = true;
+    for (size_t t = owners; t < workers.size(); ++t) workers[t].join();
+
+    // A stale handle never destroys the object that took its slot
+    EXPECT_EQ(stale_destroyed.load(), 0);
+    EXPECT_EQ(owner_failures.load(), 0);
+}
+
+TEST_F(AllocatorTest, ObserverSkipsSlotsReusedMidRead) {
+    auto* ctx = detail::get_context();
+    uint32_t type_id = registry::get_type_id("Slot");
+
+    // Two fixed locations; one directory slot alternates between them
+    auto* a = memglass::create<Slot>("a");
+    auto* b = memglass::create<Slot>("b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    uint64_t region_a, offset_a, region_b, offset_b;
+    ASSERT_TRUE(ctx->regions().get_location(a, region_a, offset_a));
+    ASSERT_TRUE(ctx->regions().get_location(b, region_b, offset_b));
+    const std::string alpha(60, 'x');
+    const std::string beta = "beta";
+
+    Observer obs("test_allocator");
+    ASSERT_TRUE(obs.connect());
+
+    std::atomic<bool> done{false};
+    std::thread churn([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            ObjectHandle h = ctx->objects().register_object(region_a, offset_a, type_id, alpha);
+            ctx->objects().destroy_object(h);
+            h = ctx->objects().register_object(region_b, offset_b, type_id, beta);
+            ctx->objects().destroy_object(h);
+        }
+    });
+
+    // A read that straddles a reuse must be dropped, not mix the two objects
+    int mismatched = 0;
+    for (int i = 0; i < 200000; ++i) {
+        for (const auto& obj : obs.objects()) {
+            if (obj.label == alpha) {
+                if (obj.offset != offset_a) ++mismatched;
+            } else if (obj.label == beta) {
+                if (obj.offset != offset_b) ++mismatched;
+            } else if (obj.label != "a" && obj.label != "b") {
+                ++mismatched;  // torn label
+            }
+        }
+    }
+    done = true;
+    churn.join();
+    EXPECT_EQ(mismatched, 0);
+}
+
+TEST_F(AllocatorTest, ConcurrentChurn) {
+    auto* ctx = detail::get_context();
+
+    constexpr int threads = 8;
+    constexpr int rounds = 2000;
+    constexpr int live = 16;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t] {
+            std::vector<Handle<Slot>> handles;
+            std::vector<Slot*> ptrs;
+            for (int i = 0; i < rounds; ++i) {
+                std::string label = "t" + std::to_string(t) + "_" + std::to_string(i);
+                if (i % 2 == 0) {
+                    auto h = memglass::create_handle<Slot>(label);
+                    ASSERT_TRUE(h);
+                    h->owner = t;
+                    handles.push_back(h);
+                } else {
+                    auto* p = memglass::create<Slot>(label);
+                    ASSERT_NE(p, nullptr);
+                    p->owner = t;
+                    ptrs.push_back(p);
+                }
+
+                if (handles.size() > live) {
+                    EXPECT_EQ(handles.front()->owner, static_cast<uint32_t>(t));
+                    EXPECT_TRUE(memglass::destroy(handles.front()));
+                    handles.erase(handles.begin());
+                }
+                if (ptrs.size() > live) {
+                    memglass::destroy(ptrs.front());
+                    ptrs.erase(ptrs.begin());
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    // Only the objects each thread kept are alive, each exactly once
+    auto alive = ctx->objects().get_all_objects();
+    EXPECT_EQ(alive.size(), static_cast<size_t>(threads * live * 2));
+
+    std::vector<std::string> labels;
+    for (auto* entry : alive) labels.emplace_back(entry->label);
+    std::sort(labels.begin(), labels.end());
+    EXPECT_EQ(std::unique(labels.begin(), labels.end()), labels.end());
+}
+
+TEST_F(AllocatorTest, ConcurrentMetadataReservation) {
+    // Small header directories so every section spills into overflow regions
+    memglass::shutdown();
+    Config config;
+    config.max_objects = 64;
+    config.max_types = 8;
+    config.max_fields = 32;
+    config.overflow_region_size = 16 * 1024;
+    ASSERT_TRUE(memglass::init("test_allocator", config));
+    auto* ctx = detail::get_context();
+    auto& metadata = ctx->metadata();
+
+    uint32_t base_types = metadata.total_type_count();
+    uint32_t base_fields = metadata.total_field_count();
+
+    constexpr int threads = 8;
+    constexpr int per_thread = 300;
+    std::vector<std::vector<std::pair<char*, size_t>>> spans(threads);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                auto* object = metadata.allocate_object_entry();
+                auto* type = metadata.allocate_type_entry();
+                auto* fields = metadata.allocate_field_entries(3);
+                ASSERT_NE(object, nullptr);
+                ASSERT_NE(type, nullptr);
+                ASSERT_NE(fields, nullptr);
+                spans[t].emplace_back(reinterpret_cast<char*>(object), sizeof(ObjectEntry));
+                spans[t].emplace_back(reinterpret_cast<char*>(type), sizeof(TypeEntry));
+                spans[t].emplace_back(reinterpret_cast<char*>(fields), 3 * sizeof(FieldEntry));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    // No two reservations share memory
+    std::vector<std::pair<char*, size_t>> all;
+    for (auto& s : spans) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    for (size_t i = 1; i < all.size(); ++i) {
+        EXPECT_LE(all[i - 1].first + all[i - 1].second, all[i].first);
+    }
+
+    // Totals are clamped to capacity but include slots skipped when a
+    // reservation did not fit at the end of a section
+    EXPECT_GE(metadata.total_object_count(), static_cast<uint32_t>(threads * per_thread));
+    EXPECT_GE(metadata.total_type_count() - base_types, static_cast<uint32_t>(threads * per_thread));
+    EXPECT_GE(metadata.total_field_count() - base_fields, static_cast<uint32_t>(threads * per_thread * 3));
+}
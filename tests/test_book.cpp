@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/book.hpp>
+#include <memglass/diff.hpp>
+#include <memglass/ladder.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <thread>
+
+using namespace memglass;
+
+struct Instrument {
+    int64_t last_trade;
+    Book<8> book;
+};
+
+namespace {
+
+void register_instrument() {
+    registry::clear();
+    TypeDescriptor desc;
+    desc.name = "Instrument";
+    desc.size = sizeof(Instrument);
+    desc.alignment = alignof(Instrument);
+    desc.fields = {
+        {"last_trade", offsetof(Instrument, last_trade), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+    };
+    Book<8>::describe(desc, "book", offsetof(Instrument, book));
+    registry::register_type_for<Instrument>(desc);
+}
+
+} // anonymous namespace
+
+TEST(BookTest, InsertUpdateRemoveKeepSidesSorted) {
+    Book<4> b;
+    EXPECT_TRUE(b.insert(BookSide::Bid, 100, 5));
+    EXPECT_TRUE(b.insert(BookSide::Bid, 102, 1));
+    EXPECT_TRUE(b.insert(BookSide::Bid, 101, 3, 2));
+    EXPECT_FALSE(b.insert(BookSide::Bid, 101, 9));  // already there
+    EXPECT_TRUE(b.insert(BookSide::Ask, 104, 7));
+    EXPECT_TRUE(b.insert(BookSide::Ask, 103, 2));
+
+    ASSERT_EQ(b.bid_count, 3u);
+    EXPECT_EQ(b.bids[0].price, 102);
+    EXPECT_EQ(b.bids[1].price, 101);
+    EXPECT_EQ(b.bids[1].orders, 2u);
+    EXPECT_EQ(b.bids[2].price, 100);
+    ASSERT_EQ(b.ask_count, 2u);
+    EXPECT_EQ(b.asks[0].price, 103);
+    EXPECT_EQ(b.asks[1].price, 104);
+
+    // An update only bumps its level's version, not the epoch
+    uint64_t epoch = b.epoch;
+    uint64_t version = b.bids[1].version;
+    EXPECT_TRUE(b.update(BookSide::Bid, 101, 4));
+    EXPECT_FALSE(b.update(BookSide::Bid, 99, 4));
+    EXPECT_EQ(b.bids[1].qty, 4);
+    EXPECT_EQ(b.epoch, epoch);
+    EXPECT_EQ(b.bids[1].version, version + 2);
+
+    EXPECT_TRUE(b.remove(BookSide::Bid, 102));
+    EXPECT_FALSE(b.remove(BookSide::Bid, 102));
+    EXPECT_EQ(b.epoch, epoch + 2);
+    ASSERT_EQ(b.bid_count, 2u);
+    EXPECT_EQ(b.bids[0].price, 101);
+    EXPECT_EQ(b.bids[2].price, 0);  // vacated level is cleared
+
+    // set() follows feed semantics: qty 0 deletes
+    EXPECT_TRUE(b.set(BookSide::Ask, 103, 0));
+    EXPECT_TRUE(b.set(BookSide::Ask, 104, 8));
+    EXPECT_TRUE(b.set(BookSide::Ask, 105, 1));
+    EXPECT_EQ(b.ask_count, 2u);
+    EXPECT_EQ(b.asks[0].qty, 8);
+    EXPECT_EQ(b.find(BookSide::Ask, 105), 1u);
+    EXPECT_EQ(b.find(BookSide::Ask, 103), 4u);
+
+    b.clear();
+    EXPECT_EQ(b.bid_count + b.ask_count, 0u);
+    EXPECT_EQ(b.epoch % 2, 0u);
+}
+
+TEST(BookTest, FullSideDropsWorstLevel) {
+    Book<3> b;
+    for (double p : {10.0, 20.0, 30.0}) b.insert(BookSide::Ask, p, 1);
+    EXPECT_FALSE(b.insert(BookSide::Ask, 40, 1));  // behind the book
+    EXPECT_TRUE(b.insert(BookSide::Ask, 15, 1));
+    EXPECT_EQ(b.ask_count, 3u);
+    EXPECT_EQ(b.asks[0].price, 10);
+    EXPECT_EQ(b.asks[1].price, 15);
+    EXPECT_EQ(b.asks[2].price, 20);
+}
+
+TEST(BookTest, ObservedAsLadder) {
+    register_instrument();
+    ASSERT_TRUE(memglass::init("test_book"));
+    Instrument* inst = memglass::create<Instrument>("ESZ6");
+    ASSERT_NE(inst, nullptr);
+    inst->book.insert(BookSide::Bid, 4500.25, 10, 3);
+    inst->book.insert(BookSide::Bid, 4500.00, 20, 5);
+    inst->book.insert(BookSide::Ask, 4500.50, 7, 1);
+
+    Observer obs("test_book");
+    ASSERT_TRUE(obs.connect());
+    auto view = obs.find("ESZ6");
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view["book.bids[1].price"].as<double>(), 4500.00);
+    EXPECT_EQ(view["book.ask_count"].as<uint32_t>(), 1u);
+
+    auto books = find_books(*view.type());
+    ASSERT_EQ(books.size(), 1u);
+    EXPECT_EQ(books[0], "book");
+
+    BookReader reader(*view.type(), "book");
+    ASSERT_TRUE(reader);
+    EXPECT_EQ(reader.depth(), 8u);
+    EXPECT_FALSE(BookReader(*view.type(), "last_trade"));
+
+    Ladder ladder;
+    ASSERT_TRUE(reader.read(view.data(), ladder));
+    ASSERT_EQ(ladder.bids.size(), 2u);
+    ASSERT_EQ(ladder.asks.size(), 1u);
+    EXPECT_EQ(ladder.bids[0].price, 4500.25);
+    EXPECT_EQ(ladder.bids[0].qty, 10);
+    EXPECT_EQ(ladder.bids[0].orders, 3u);
+    EXPECT_EQ(ladder.asks[0].price, 4500.50);
+    EXPECT_EQ(ladder.epoch, inst->book.epoch);
+
+    memglass::shutdown();
+    registry::clear();
+}
+
+TEST(BookTest, ConcurrentReadsSeeConsistentLadders) {
+    register_instrument();
+    ASSERT_TRUE(memglass::init("test_book_mt"));
+    Instrument* inst = memglass::create<Instrument>("inst");
+    ASSERT_NE(inst, nullptr);
+
+    Observer obs("test_book_mt");
+    ASSERT_TRUE(obs.connect());
+    auto view = obs.find("inst");
+    ASSERT_TRUE(view);
+    BookReader reader(*view.type(), "book");
+    ASSERT_TRUE(reader);
+
+    // Every level's qty equals its price, so a torn level or a read
+    // straddling a shift shows up as a mismatch or an unsorted side
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint64_t i = 0; !done.load(std::memory_order_relaxed); ++i) {
+            double p = static_cast<double>(100 + i % 16);
+            if (i % 3 == 0) {
+                inst->book.set(BookSide::Bid, p, 0);
+            } else {
+                inst->book.set(BookSide::Bid, p, p, i);
+            }
+        }
+    });
+
+    uint32_t reads = 0;
+    for (int n = 0; n < 20000; ++n) {
+        Ladder ladder;
+        if (!reader.read(view.data(), ladder)) continue;
+        reads++;
+        for (size_t i = 0; i < ladder.bids.size(); ++i) {
+            ASSERT_EQ(ladder.bids[i].qty, ladder.bids[i].price);
+            if (i > 0) {
+                ASSERT_GT(ladder.bids[i - 1].price, ladder.bids[i].price);
+            }
+        }
+    }
+    done = true;
+    writer.join();
+    EXPECT_GT(reads, 0u);
+
+    memglass::shutdown();
+    registry::clear();
+}
+
+TEST(BookTest, DiffsByPriceLevel) {
+    register_instrument();
+    ASSERT_TRUE(memglass::init("test_book_diff"));
+    Instrument* inst = memglass::create<Instrument>("inst");
+    ASSERT_NE(inst, nullptr);
+    for (double p : {99.0, 98.0, 97.0}) inst->book.insert(BookSide::Bid, p, 1);
+    inst->book.insert(BookSide::Ask, 101, 4);
+
+    Observer obs("test_book_diff");
+    ASSERT_TRUE(obs.connect());
+    Snapshot before = take_snapshot(obs);
+
+    // A new best bid shifts every slot but is one level change
+    inst->book.insert(BookSide::Bid, 100, 6);
+    inst->book.update(BookSide::Ask, 101, 4, 2);
+    Snapshot after = take_snapshot(obs);
+
+    SnapshotDiff diff = compute_diff(before, after);
+    std::map<std::string, FieldChange> changes;
+    for (const auto& c : diff.field_changes) changes[c.field_name] = c;
+
+    ASSERT_EQ(changes.size(), 3u);
+    ASSERT_TRUE(changes.count("book.bids[@100]"));
+    EXPECT_EQ(changes["book.bids[@100]"].old_value.as_double(), 0);
+    EXPECT_EQ(changes["book.bids[@100]"].new_value.as_double(), 6);
+    ASSERT_TRUE(changes.count("book.asks[@101].orders"));
+    EXPECT_EQ(changes["book.asks[@101].orders"].new_value.as_int64(), 2);
+    EXPECT_TRUE(changes.count("book.bid_count"));
+
+    // Removing a level reads as its qty going to zero
+    Ladder old_ladder;
+    Ladder new_ladder;
+    ASSERT_TRUE(read_ladder(after.objects["inst"], "book", old_ladder));
+    inst->book.remove(BookSide::Bid, 98);
+    ASSERT_TRUE(read_ladder(take_snapshot(obs).objects["inst"], "book", new_ladder));
+    auto levels = diff_ladders(old_ladder, new_ladder);
+    ASSERT_EQ(levels.size(), 1u);
+    EXPECT_EQ(levels[0].side, BookSide::Bid);
+    EXPECT_EQ(levels[0].price, 98);
+    EXPECT_EQ(levels[0].old_level.qty, 1);
+    EXPECT_EQ(levels[0].new_level.qty, 0);
+
+    memglass::shutdown();
+    registry::clear();
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/bulk.hpp>
+#include <memglass/diff.hpp>
+#include <memglass/dirty.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace memglass;
+
+struct Book {
+    int64_t bid;
+    uint32_t size;
+    float ratio;
+    std::atomic<uint64_t> trades;
+    Guarded<double> mid;
+    Locked<int32_t> position;
+};
+
+class BulkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry::clear();
+
+        TypeDescriptor desc;
+        desc.name = "Book";
+        desc.size = sizeof(Book);
+        desc.alignment = alignof(Book);
+        desc.fields = {
+            {"bid", offsetof(Book, bid), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"size", offsetof(Book, size), sizeof(uint32_t), PrimitiveType::UInt32, 0, 0, Atomicity::None, false},
+            {"ratio", offsetof(Book, ratio), sizeof(float), PrimitiveType::Float32, 0, 0, Atomicity::None, false},
+            {"trades", offsetof(Book, trades), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::Atomic, false},
+            {"mid", offsetof(Book, mid), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::Seqlock, false},
+            {"position", offsetof(Book, position), sizeof(Locked<int32_t>), PrimitiveType::Int32, 0, 0, Atomicity::Locked, false},
+        };
+        registry::register_type_for<Book>(desc);
+
+        ASSERT_TRUE(memglass::init("test_bulk"));
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+
+    static Book* make(const char* label, int64_t bid) {
+        auto* b = memglass::create<Book>(label);
+        if (!b) return nullptr;
+        b->bid = bid;
+        b->size = static_cast<uint32_t>(bid * 2);
+        b->ratio = 0.25f;
+        b->trades.store(static_cast<uint64_t>(bid) + 1);
+        b->mid.write(bid + 0.5);
+        b->position.write(static_cast<int32_t>(-bid));
+        return b;
+    }
+};
+
+TEST_F(BulkTest, MatchesFieldByFieldSnapshot) {
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_NE(make(("book" + std::to_string(i)).c_str(), 100 + i), nullptr);
+    }
+
+    Observer obs("test_bulk");
+    ASSERT_TRUE(obs.connect());
+
+    BulkCopy bulk(obs);
+    Snapshot fields = take_snapshot(obs);
+    Snapshot copied = take_snapshot(obs, bulk);
+
+    ASSERT_EQ(copied.objects.size(), 16u);
+    EXPECT_TRUE(compute_diff(fields, copied).empty());
+
+    const auto& book = copied.objects.at("book3");
+    EXPECT_EQ(book.fields.at("bid").data.i64, 103);
+    EXPECT_EQ(book.fields.at("size").data.u32, 206u);
+    EXPECT_FLOAT_EQ(book.fields.at("ratio").data.f32, 0.25f);
+    EXPECT_EQ(book.fields.at("trades").data.u64, 104u);
+    EXPECT_DOUBLE_EQ(book.fields.at("mid").data.f64, 103.5);
+    EXPECT_EQ(book.fields.at("position").data.i32, -103);
+
+    // Objects allocated back to back are copied as one span
+    EXPECT_EQ(bulk.spans(), 1u);
+    EXPECT_GE(bulk.bytes_copied(), 16 * sizeof(Book));
+    EXPECT_EQ(bulk.retried_fields(), 0u);
+}
+
+TEST_F(BulkTest, SpansSplitOnGaps) {
+    auto* ctx = detail::get_context();
+    ASSERT_NE(make("a", 1), nullptr);
+    ctx->regions().allocate(4096, 8);
+    ASSERT_NE(make("b", 2), nullptr);
+
+    Observer obs("test_bulk");
+    ASSERT_TRUE(obs.connect());
+    auto objects = obs.objects();
+
+    BulkCopy split(obs);
+    EXPECT_EQ(split.copy(objects), 2u);
+    EXPECT_EQ(split.spans(), 2u);
+    EXPECT_LT(split.bytes_copied(), 4096u);
+
+    BulkOptions whole;
+    whole.merge_gap = SIZE_MAX;
+    BulkCopy merged(obs, whole);
+    EXPECT_EQ(merged.copy(objects), 2u);
+    EXPECT_EQ(merged.spans(), 1u);
+    EXPECT_GT(merged.bytes_copied(), 4096u);
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        int64_t bid = objects[i].label == "a" ? 1 : 2;
+        auto* from_split = static_cast<const Book*>(split.data(i));
+        auto* from_merged = static_cast<const Book*>(merged.data(i));
+        ASSERT_NE(from_split, nullptr);
+        ASSERT_NE(from_merged, nullptr);
+        EXPECT_EQ(from_split->bid, bid);
+        EXPECT_EQ(from_merged->bid, bid);
+    }
+}
+
+TEST_F(BulkTest, DropsDestroyedObjects) {
+    auto* a = make("a", 1);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(make("b", 2), nullptr);
+
+    Observer obs("test_bulk");
+    ASSERT_TRUE(obs.connect());
+    auto objects = obs.objects();
+    ASSERT_EQ(objects.size(), 2u);
+
+    memglass::destroy(a);
+
+    BulkCopy bulk(obs);
+    EXPECT_EQ(bulk.copy(objects), 1u);
+    EXPECT_EQ(bulk.dropped_objects(), 1u);
+    EXPECT_EQ(bulk.data(objects[0].label == "a" ? 0 : 1), nullptr);
+}
+
+TEST_F(BulkTest, RereadsHeldLockedField) {
+    auto* a = make("a", 1);
+    ASSERT_NE(a, nullptr);
+
+    Observer obs("test_bulk");
+    ASSERT_TRUE(obs.connect());
+    auto objects = obs.objects();
+
+    // Producer holds the lock across the burst, then publishes a new value
+    while (a->position.lock_.test_and_set(std::memory_order_acquire)) {}
+    a->position.seq_.fetch_add(1, std::memory_order_release);
+    std::thread writer([a] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        a->position.value = 77;
+        a->position.seq_.fetch_add(1, std::memory_order_release);
+        a->position.lock_.clear(std::memory_order_release);
+    });
+
+    BulkCopy bulk(obs);
+    EXPECT_EQ(bulk.copy(objects), 1u);
+    writer.join();
+
+    EXPECT_EQ(bulk.retried_fields(), 1u);
+    const ObservedType* type = obs.get_type(objects[0].type_id);
+    ASSERT_NE(type, nullptr);
+    FieldValue position = decode_field_value(type->fields[5], bulk.data(0));
+    EXPECT_EQ(position.data.i32, 77);
+}
+
+TEST_F(BulkTest, UpdateSnapshotMatchesFieldReads) {
+    auto* a = make("a", 1);
+    auto* b = make("b", 2);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    Observer obs("test_bulk");
+    ASSERT_TRUE(obs.connect());
+
+    // Unattached tracker: every object is re-read
+    DirtyTracker tracker(obs);
+    BulkCopy bulk(obs);
+    Snapshot snap = take_snapshot(obs, bulk);
+
+    a->mid.write(9.5);
+    memglass::destroy(b);
+    ASSERT_NE(make("c", 3), nullptr);
+
+    SnapshotDiff diff = update_snapshot(obs, snap, tracker, bulk);
+    ASSERT_EQ(diff.field_changes.size(), 1u);
+    EXPECT_EQ(diff.field_changes[0].field_name, "mid");
+    EXPECT_DOUBLE_EQ(diff.field_changes[0].new_value.data.f64, 9.5);
+    ASSERT_EQ(diff.added_objects.size(), 1u);
+    EXPECT_EQ(diff.added_objects[0], "c");
+    ASSERT_EQ(diff.removed_objects.size(), 1u);
+    EXPECT_EQ(diff.removed_objects[0], "b");
+
+    EXPECT_TRUE(compute_diff(snap, take_snapshot(obs)).empty());
+}
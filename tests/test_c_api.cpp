@@ -0,0 +1,372 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/memglass_c.h>
+#include <memglass/mgdf.hpp>
+#include <memglass/registry.hpp>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+using namespace memglass;
+
+extern "C" int memglass_c_header_check(void);
+
+namespace {
+
+struct Inner {
+    int32_t a;
+    double b;
+};
+
+struct Quote {
+    int64_t bid;
+    uint32_t size;
+    float ratio;
+    Inner inner;
+};
+
+struct Counter {
+    std::atomic<uint64_t> hits;
+    Guarded<int64_t> price;
+    Locked<int32_t> total;
+};
+
+} // anonymous namespace
+
+class CApiTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry::clear();
+
+        TypeDescriptor inner;
+        inner.name = "Inner";
+        inner.size = sizeof(Inner);
+        inner.alignment = alignof(Inner);
+        inner.fields = {
+            {"a", offsetof(Inner, a), sizeof(int32_t), PrimitiveType::Int32, 0, 0, Atomicity::None, false},
+            {"b", offsetof(Inner, b), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+        };
+        uint32_t inner_id = registry::register_type_for<Inner>(inner);
+
+        TypeDescriptor quote;
+        quote.name = "Quote";
+        quote.size = sizeof(Quote);
+        quote.alignment = alignof(Quote);
+        quote.fields = {
+            {"bid", offsetof(Quote, bid), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"size", offsetof(Quote, size), sizeof(uint32_t), PrimitiveType::UInt32, 0, 0, Atomicity::None, false},
+            {"ratio", offsetof(Quote, ratio), sizeof(float), PrimitiveType::Float32, 0, 0, Atomicity::None, false},
+            {"inner", offsetof(Quote, inner), sizeof(Inner), PrimitiveType::Unknown, inner_id, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<Quote>(quote);
+
+        TypeDescriptor counter;
+        counter.name = "Counter";
+        counter.size = sizeof(Counter);
+        counter.alignment = alignof(Counter);
+        counter.fields = {
+            {"hits", offsetof(Counter, hits), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::Atomic, false},
+            {"price", offsetof(Counter, price), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::Seqlock, false},
+            {"total", offsetof(Counter, total), sizeof(Locked<int32_t>), PrimitiveType::Int32, 0, 0, Atomicity::Locked, false},
+        };
+        registry::register_type_for<Counter>(counter);
+
+        ASSERT_TRUE(memglass::init("c_api_test"));
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+};
+
+TEST(CApiHeader, CompilesAsC) {
+    EXPECT_EQ(memglass_c_header_check(), MEMGLASS_C_ABI_VERSION);
+    EXPECT_STREQ(memglass_strerror(MEMGLASS_ERR_STALE), "object destroyed or reused");
+}
+
+TEST_F(CApiTest, OpenMissingSession) {
+    EXPECT_EQ(memglass_open("c_api_no_such_session", 0), nullptr);
+    EXPECT_EQ(memglass_open("c_api_test", MEMGLASS_OPEN_LAZY | MEMGLASS_OPEN_POPULATE), nullptr);
+}
+
+TEST_F(CApiTest, SchemaAndObjects) {
+    auto* q = memglass::create<Quote>("AAPL");
+    ASSERT_NE(q, nullptr);
+    q->bid = 15025;
+    q->size = 300;
+    q->ratio = 0.5f;
+    q->inner.a = -7;
+    q->inner.b = 2.5;
+
+    memglass_observer* obs = memglass_open("c_api_test", 0);
+    ASSERT_NE(obs, nullptr);
+    EXPECT_GE(memglass_type_count(obs), 3u);
+
+    memglass_type_info type;
+    ASSERT_EQ(memglass_type_find(obs, "Quote", &type), MEMGLASS_OK);
+    EXPECT_EQ(type.size, sizeof(Quote));
+    EXPECT_EQ(type.field_count, 4u);
+
+    memglass_field_info info;
+    ASSERT_EQ(memglass_field_at(obs, type.type_id, 1, &info), MEMGLASS_OK);
+    EXPECT_STREQ(info.name, "size");
+    EXPECT_EQ(info.type_id, static_cast<uint32_t>(MEMGLASS_TYPE_UINT32));
+    ASSERT_EQ(memglass_field_at(obs, type.type_id, 3, &info), MEMGLASS_OK);
+    EXPECT_STREQ(info.name, "inner");
+    EXPECT_TRUE(info.flags & MEMGLASS_FIELD_NESTED);
+
+    memglass_type_info inner;
+    ASSERT_EQ(memglass_type_find(obs, "Inner", &inner), MEMGLASS_OK);
+    EXPECT_EQ(info.type_id, inner.type_id);
+    EXPECT_EQ(memglass_field_at(obs, type.type_id, 4, &info), MEMGLASS_ERR_NOT_FOUND);
+
+    ASSERT_EQ(memglass_object_count(obs), 1u);
+    memglass_object obj;
+    ASSERT_EQ(memglass_object_at(obs, 0, &obj), MEMGLASS_OK);
+    EXPECT_STREQ(obj.label, "AAPL");
+    EXPECT_STREQ(obj.type_name, "Quote");
+    EXPECT_EQ(obj.size, sizeof(Quote));
+
+    memglass_field bid, size, ratio, nested;
+    ASSERT_EQ(memglass_field_compile(obs, type.type_id, "bid", &bid), MEMGLASS_OK);
+    ASSERT_EQ(memglass_field_compile(obs, type.type_id, "size", &size), MEMGLASS_OK);
+    ASSERT_EQ(memglass_field_compile(obs, type.type_id, "ratio", &ratio), MEMGLASS_OK);
+    ASSERT_EQ(memglass_field_compile(obs, type.type_id, "inner.b", &nested), MEMGLASS_OK);
+    EXPECT_EQ(memglass_field_compile(obs, type.type_id, "ask", &bid), MEMGLASS_ERR_NOT_FOUND);
+
+    int64_t i = 0;
+    double d = 0;
+    EXPECT_EQ(memglass_read_i64(&obj, &bid, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, 15025);
+    EXPECT_EQ(memglass_read_i64(&obj, &size, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, 300);
+    EXPECT_EQ(memglass_read_f64(&obj, &ratio, &d), MEMGLASS_OK);
+    EXPECT_DOUBLE_EQ(d, 0.5);
+    EXPECT_EQ(memglass_read_i64(&obj, &ratio, &i), MEMGLASS_ERR_TYPE);
+    EXPECT_EQ(memglass_read_f64(&obj, &nested, &d), MEMGLASS_OK);
+    EXPECT_DOUBLE_EQ(d, 2.5);
+
+    // Zero-copy: the data pointer sees producer writes directly
+    q->bid = 15030;
+    EXPECT_EQ(memglass_read_i64(&obj, &bid, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, 15030);
+    EXPECT_EQ(static_cast<const Quote*>(obj.data)->bid, 15030);
+
+    Quote copy;
+    EXPECT_EQ(memglass_read_object(&obj, &copy, sizeof(copy)), MEMGLASS_OK);
+    EXPECT_EQ(copy.inner.a, -7);
+
+    memglass_close(obs);
+}
+
+TEST_F(CApiTest, StaleAfterDestroy) {
+    auto* q = memglass::create<Quote>("MSFT");
+    ASSERT_NE(q, nullptr);
+
+    memglass_observer* obs = memglass_open("c_api_test", 0);
+    ASSERT_NE(obs, nullptr);
+
+    memglass_object obj;
+    ASSERT_EQ(memglass_object_find(obs, "MSFT", &obj), MEMGLASS_OK);
+    memglass_field bid;
+    ASSERT_EQ(memglass_field_compile(obs, obj.type_id, "bid", &bid), MEMGLASS_OK);
+    EXPECT_EQ(memglass_object_check(&obj), MEMGLASS_OK);
+
+    memglass::destroy(q);
+    int64_t i = 0;
+    EXPECT_EQ(memglass_object_check(&obj), MEMGLASS_ERR_STALE);
+    EXPECT_EQ(memglass_read_i64(&obj, &bid, &i), MEMGLASS_ERR_STALE);
+    EXPECT_EQ(memglass_object_find(obs, "MSFT", &obj), MEMGLASS_ERR_NOT_FOUND);
+
+    memglass_close(obs);
+}
+
+TEST_F(CApiTest, AtomicSeqlockAndLockedFields) {
+    auto* c = memglass::create<Counter>("counter");
+    ASSERT_NE(c, nullptr);
+    c->hits.store(41);
+    c->price.write(-100);
+    c->total.write(77);
+
+    memglass_observer* obs = memglass_open("c_api_test", MEMGLASS_OPEN_LAZY);
+    ASSERT_NE(obs, nullptr);
+
+    memglass_object obj;
+    ASSERT_EQ(memglass_object_find(obs, "counter", &obj), MEMGLASS_OK);
+    memglass_field hits, price, total;
+    ASSERT_EQ(memglass_field_compile(obs, obj.type_id, "hits", &hits), MEMGLASS_OK);
+    ASSERT_EQ(memglass_field_compile(obs, obj.type_id, "price", &price), MEMGLASS_OK);
+    ASSERT_EQ(memglass_field_compile(obs, obj.type_id, "total", &total), MEMGLASS_OK);
+    EXPECT_EQ(price.atomicity, MEMGLASS_ATOMICITY_SEQLOCK);
+    EXPECT_EQ(total.size, sizeof(int32_t));
+
+    int64_t i = 0;
+    EXPECT_EQ(memglass_read_i64(&obj, &hits, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, 41);
+    EXPECT_EQ(memglass_read_i64(&obj, &price, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, -100);
+    EXPECT_EQ(memglass_read_i64(&obj, &total, &i), MEMGLASS_OK);
+    EXPECT_EQ(i, 77);
+
+    // Field of another type
+    memglass_type_info quote;
+    ASSERT_EQ(memglass_type_find(obs, "Quote", &quote), MEMGLASS_OK);
+    memglass_field bid;
+    ASSERT_EQ(memglass_field_compile(obs, quote.type_id, "bid", &bid), MEMGLASS_OK);
+    EXPECT_EQ(memglass_read_i64(&obj, &bid, &i), MEMGLASS_ERR_TYPE);
+
+    memglass_close(obs);
+}
+
+TEST_F(CApiTest, WaitForChanges) {
+    auto* c = memglass::create<Counter>("waiter");
+    ASSERT_NE(c, nullptr);
+    c->hits.store(1);
+
+    memglass_observer* obs = memglass_open("c_api_test", 0);
+    ASSERT_NE(obs, nullptr);
+
+    memglass_object obj;
+    ASSERT_EQ(memglass_object_find(obs, "waiter", &obj), MEMGLASS_OK);
+    memglass_field hits;
+    ASSERT_EQ(memglass_field_compile(obs, obj.type_id, "hits", &hits), MEMGLASS_OK);
+
+    uint64_t seen = 1;
+    EXPECT_EQ(memglass_wait_field(&obj, &hits, &seen, sizeof(seen), 10), MEMGLASS_ERR_TIMEOUT);
+
+    std::thread writer([c] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        c->hits.store(2);
+    });
+    EXPECT_EQ(memglass_wait_field(&obj, &hits, &seen, sizeof(seen), 5000), MEMGLASS_OK);
+    EXPECT_EQ(seen, 2u);
+    writer.join();
+
+    // Structural change: a new object bumps the sequence
+    uint64_t seq = memglass_sequence(obs);
+    EXPECT_EQ(memglass_wait_sequence(obs, seq, 0, nullptr), MEMGLASS_ERR_TIMEOUT);
+    ASSERT_NE(memglass::create<Quote>("late"), nullptr);
+    uint64_t now = 0;
+    EXPECT_EQ(memglass_wait_sequence(obs, seq, 1000, &now), MEMGLASS_OK);
+    EXPECT_NE(now, seq);
+
+    EXPECT_EQ(memglass_object_count(obs), 1u);
+    EXPECT_EQ(memglass_refresh(obs), 1);
+    EXPECT_EQ(memglass_object_count(obs), 2u);
+    EXPECT_EQ(memglass_refresh(obs), 0);
+
+    memglass_close(obs);
+}
+
+TEST_F(CApiTest, WaitForEvents) {
+    memglass_observer* obs = memglass_open("c_api_test", 0);
+    ASSERT_NE(obs, nullptr);
+
+    EXPECT_EQ(memglass_wait_event(obs, "burst", 10, nullptr), MEMGLASS_ERR_TIMEOUT);
+
+    std::thread producer([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        memglass::cycle_end();
+        memglass::mark("other");
+        memglass::mark("burst");
+    });
+    uint64_t epoch = 0;
+    EXPECT_EQ(memglass_wait_event(obs, "burst", 5000, &epoch), MEMGLASS_OK);
+    EXPECT_EQ(epoch, 1u);
+    producer.join();
+
+    memglass_close(obs);
+}
+
+TEST(CApiRecording, QueriesColumns) {
+    std::string path = "/tmp/memglass_test_c_api_" + std::to_string(getpid()) + ".mgdf";
+    EXPECT_EQ(memglass_recording_open(path.c_str()), nullptr);
+
+    // One diff every 10ms over small blocks: AAPL.bid = 100 + i, AAPL.mid = i / 2
+    constexpr uint64_t BASE = 1'700'000'000'000'000'000ull;
+    mgdf::BlockWriter writer(256, 100'000'000ull);
+    std::string out;
+    writer.write_header(out);
+    for (uint64_t i = 0; i < 100; ++i) {
+        SnapshotDiff diff;
+        diff.timestamp_ns = BASE + i * 10'000'000ull;
+        diff.new_sequence = i + 1;
+        FieldValue bid, mid, other;
+        bid.type = PrimitiveType::UInt32;
+        bid.set_int64(100 + static_cast<int64_t>(i));
+        mid.type = PrimitiveType::Float64;
+        mid.data.f64 = i / 2.0;
+        other.type = PrimitiveType::Int64;
+        other.data.i64 = -static_cast<int64_t>(i);
+        diff.field_changes.push_back({"AAPL", "bid", {}, bid});
+        diff.field_changes.push_back({"AAPL", "mid", {}, mid});
+        diff.field_changes.push_back({"MSFT", "bid", {}, other});
+        writer.write_diff(out, diff);
+    }
+    writer.write_end(out);
+    std::ofstream(path, std::ios::binary) << out;
+
+    memglass_recording* rec = memglass_recording_open(path.c_str());
+    ASSERT_NE(rec, nullptr);
+
+    memglass_recording_info info;
+    ASSERT_EQ(memglass_recording_describe(rec, &info), MEMGLASS_OK);
+    EXPECT_EQ(info.version, 2u);
+    EXPECT_EQ(info.has_index, 1u);
+    EXPECT_GT(info.block_count, 1u);
+    EXPECT_EQ(info.first_ts, BASE);
+    EXPECT_EQ(info.last_ts, BASE + 99 * 10'000'000ull);
+
+    // Second half of AAPL only
+    const char* labels[] = {"AAPL"};
+    memglass_query q{};
+    q.labels = labels;
+    q.label_count = 1;
+    q.start_ns = BASE + 500'000'000ull;
+    memglass_query_stats stats;
+    ASSERT_EQ(memglass_recording_query(rec, &q, &stats), MEMGLASS_OK);
+    EXPECT_LT(stats.blocks_in_range, stats.blocks_total);
+    EXPECT_EQ(stats.points, 100u);
+
+    ASSERT_EQ(memglass_series_count(rec), 2u);
+    memglass_series bid, mid;
+    ASSERT_EQ(memglass_series_at(rec, 0, &bid), MEMGLASS_OK);
+    ASSERT_EQ(memglass_series_at(rec, 1, &mid), MEMGLASS_OK);
+    EXPECT_EQ(memglass_series_at(rec, 2, &mid), MEMGLASS_ERR_NOT_FOUND);
+
+    EXPECT_STREQ(bid.label, "AAPL");
+    EXPECT_STREQ(bid.field, "bid");
+    EXPECT_EQ(bid.type_id, static_cast<uint32_t>(MEMGLASS_TYPE_UINT32));
+    EXPECT_EQ(bid.integer, 1u);
+    ASSERT_EQ(bid.count, 50u);
+    ASSERT_NE(bid.ints, nullptr);
+    EXPECT_EQ(bid.timestamps[0], BASE + 500'000'000ull);
+    EXPECT_EQ(bid.ints[0], 150);
+    EXPECT_EQ(bid.ints[49], 199);
+
+    EXPECT_STREQ(mid.field, "mid");
+    EXPECT_EQ(mid.integer, 0u);
+    ASSERT_NE(mid.doubles, nullptr);
+    EXPECT_DOUBLE_EQ(mid.doubles[49], 49.5);
+
+    // Resampled to 100ms buckets
+    q.start_ns = 0;
+    q.interval_ns = 100'000'000ull;
+    q.aggregation = MEMGLASS_AGG_MAX;
+    ASSERT_EQ(memglass_recording_query(rec, &q, nullptr), MEMGLASS_OK);
+    ASSERT_EQ(memglass_series_at(rec, 0, &bid), MEMGLASS_OK);
+    ASSERT_EQ(bid.count, 10u);
+    EXPECT_EQ(bid.ints[0], 109);
+
+    q.aggregation = 99;
+    EXPECT_EQ(memglass_recording_query(rec, &q, nullptr), MEMGLASS_ERR_INVALID);
+    EXPECT_STRNE(memglass_recording_error(rec), "");
+    EXPECT_EQ(memglass_series_count(rec), 0u);
+
+    memglass_recording_close(rec);
+    ::unlink(path.c_str());
+}
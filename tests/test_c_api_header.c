@@ -0,0 +1,14 @@
+/* Compiled as C to keep memglass_c.h free of C++ constructs */
+#include <memglass/memglass_c.h>
+
+int memglass_c_header_check(void) {
+    memglass_field field = {0};
+    memglass_object object = {0};
+    memglass_query query = {0};
+    memglass_series series = {0};
+    (void)field;
+    (void)object;
+    (void)query;
+    (void)series;
+    return (int)memglass_abi_version();
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <memglass/cdc.hpp>
+#include <memglass/memglass.hpp>
+#include <memglass/mgdf.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memglass;
+
+struct Position {
+    Tracked<int64_t> quantity;
+    double pnl;
+    int32_t levels[4];
+};
+
+struct Leg {
+    double price;
+    int32_t qty;
+};
+
+struct Spread {
+    Leg legs[2];
+};
+
+class CdcTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TypeDescriptor desc;
+        desc.name = "Position";
+        desc.size = sizeof(Position);
+        desc.alignment = alignof(Position);
+        desc.fields = {
+            {"quantity", offsetof(Position, quantity), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"pnl", offsetof(Position, pnl), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+            {"levels", offsetof(Position, levels), sizeof(Position::levels), PrimitiveType::Int32, 0, 4, Atomicity::None, false},
+        };
+        registry::register_type_for<Position>(desc);
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        memglass::set_paused(false);
+        registry::clear();
+    }
+
+    static Config cdc_config(uint32_t capacity) {
+        Config config;
+        config.cdc_ring_capacity = capacity;
+        config.cdc_rings = 4;
+        return config;
+    }
+
+    static std::vector<FieldChange> changes(const std::vector<SnapshotDiff>& diffs) {
+        std::vector<FieldChange> out;
+        for (const auto& diff : diffs) {
+            out.insert(out.end(), diff.field_changes.begin(), diff.field_changes.end());
+        }
+        return out;
+    }
+};
+
+TEST_F(CdcTest, NamesFieldsOfNestedTypes) {
+    TypeDescriptor leg;
+    leg.name = "Leg";
+    leg.size = sizeof(Leg);
+    leg.alignment = alignof(Leg);
+    leg.fields = {
+        {"price", offsetof(Leg, price), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+        {"qty", offsetof(Leg, qty), sizeof(int32_t), PrimitiveType::Int32, 0, 0, Atomicity::None, false},
+    };
+    uint32_t leg_id = registry::register_type_for<Leg>(leg);
+
+    TypeDescriptor spread;
+    spread.name = "Spread";
+    spread.size = sizeof(Spread);
+    spread.alignment = alignof(Spread);
+    spread.fields = {
+        {"legs", offsetof(Spread, legs), sizeof(Spread::legs), PrimitiveType::Unknown, leg_id, 2, Atomicity::None, false},
+    };
+    registry::register_type_for<Spread>(spread);
+
+    ASSERT_TRUE(memglass::init("test_cdc", cdc_config(1024)));
+    auto* s = memglass::create<Spread>("spread");
+    ASSERT_NE(s, nullptr);
+
+    Observer obs("test_cdc");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    memglass::store(s->legs[1].qty, 5);
+    memglass::store(s->legs[0].price, 99.5);
+
+    std::vector<SnapshotDiff> diffs;
+    EXPECT_EQ(reader.drain(diffs), 2u);
+    auto c = changes(diffs);
+    ASSERT_EQ(c.size(), 2u);
+    EXPECT_EQ(c[0].field_name, "legs[1].qty");
+    EXPECT_EQ(c[0].new_value.data.i32, 5);
+    EXPECT_EQ(c[1].field_name, "legs[0].price");
+    EXPECT_DOUBLE_EQ(c[1].new_value.data.f64, 99.5);
+}
+
+TEST_F(CdcTest, CapturesChangesBetweenSamples) {
+    ASSERT_TRUE(memglass::init("test_cdc", cdc_config(1024)));
+    auto* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+
+    Observer obs("test_cdc");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    // Back to where it started: a sampler sees no change at all
+    pos->quantity = 100;
+    memglass::store(pos->pnl, 12.5);
+    pos->pnl = 13.0;  // untracked
+    memglass::store(pos->levels[2], 7);
+    pos->quantity = 0;
+
+    std::vector<SnapshotDiff> diffs;
+    EXPECT_EQ(reader.drain(diffs), 4u);
+    auto c = changes(diffs);
+    ASSERT_EQ(c.size(), 4u);
+
+    EXPECT_EQ(c[0].object_label, "pos");
+    EXPECT_EQ(c[0].field_name, "quantity");
+    EXPECT_EQ(c[0].old_value.type, PrimitiveType::Unknown);
+    EXPECT_EQ(c[0].new_value.data.i64, 100);
+    EXPECT_EQ(c[1].field_name, "pnl");
+    EXPECT_DOUBLE_EQ(c[1].new_value.data.f64, 12.5);
+    EXPECT_EQ(c[2].field_name, "levels[2]");
+    EXPECT_EQ(c[2].new_value.data.i32, 7);
+    EXPECT_EQ(c[3].field_name, "quantity");
+    EXPECT_EQ(c[3].old_value.data.i64, 100);
+    EXPECT_EQ(c[3].new_value.data.i64, 0);
+
+    for (size_t i = 1; i < diffs.size(); ++i) {
+        EXPECT_LE(diffs[i - 1].timestamp_ns, diffs[i].timestamp_ns);
+    }
+
+    diffs.clear();
+    EXPECT_EQ(reader.drain(diffs), 0u);
+    EXPECT_TRUE(diffs.empty());
+    EXPECT_EQ(reader.stats().records, 4u);
+    EXPECT_EQ(reader.stats().dropped, 0u);
+    EXPECT_EQ(reader.stats().unresolved, 0u);
+}
+
+TEST_F(CdcTest, CountsDropsWhenRingIsFull) {
+    ASSERT_TRUE(memglass::init("test_cdc_full", cdc_config(8)));
+    auto* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+
+    Observer obs("test_cdc_full");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    for (int64_t i = 1; i <= 20; ++i) pos->quantity = i;
+
+    std::vector<SnapshotDiff> diffs;
+    EXPECT_EQ(reader.drain(diffs), 8u);
+    EXPECT_EQ(reader.stats().dropped, 12u);
+    auto c = changes(diffs);
+    ASSERT_EQ(c.size(), 8u);
+    EXPECT_EQ(c.back().new_value.data.i64, 8);
+
+    // Draining frees the ring again
+    pos->quantity = 42;
+    diffs.clear();
+    EXPECT_EQ(reader.drain(diffs), 1u);
+    EXPECT_EQ(changes(diffs).back().new_value.data.i64, 42);
+}
+
+TEST_F(CdcTest, ThreadsLogToTheirOwnRings) {
+    ASSERT_TRUE(memglass::init("test_cdc_threads", cdc_config(4096)));
+    constexpr int threads = 3;
+    constexpr int64_t stores = 1000;
+    std::vector<Position*> positions;
+    for (int t = 0; t < threads; ++t) {
+        positions.push_back(memglass::create<Position>("pos" + std::to_string(t)));
+        ASSERT_NE(positions.back(), nullptr);
+    }
+
+    Observer obs("test_cdc_threads");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([pos = positions[t]] {
+            for (int64_t i = 1; i <= stores; ++i) pos->quantity = i;
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::vector<SnapshotDiff> diffs;
+    EXPECT_EQ(reader.drain(diffs), static_cast<size_t>(threads * stores));
+    EXPECT_EQ(reader.stats().dropped, 0u);
+
+    // Every object sees each of its values, in order
+    std::map<std::string, int64_t> last;
+    for (const auto& c : changes(diffs)) {
+        EXPECT_EQ(c.new_value.data.i64, last[c.object_label] + 1);
+        last[c.object_label] = c.new_value.data.i64;
+    }
+    EXPECT_EQ(last.size(), static_cast<size_t>(threads));
+}
+
+TEST_F(CdcTest, SkipsLoggingWhilePaused) {
+    ASSERT_TRUE(memglass::init("test_cdc_paused", cdc_config(64)));
+    auto* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+
+    Observer obs("test_cdc_paused");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    memglass::set_paused(true);
+    pos->quantity = 5;
+    EXPECT_EQ(pos->quantity.get(), 5);
+    memglass::set_paused(false);
+    pos->quantity = 6;
+
+    std::vector<SnapshotDiff> diffs;
+    EXPECT_EQ(reader.drain(diffs), 1u);
+    EXPECT_EQ(changes(diffs)[0].new_value.data.i64, 6);
+}
+
+TEST_F(CdcTest, NoSegmentWithoutOptIn) {
+    ASSERT_TRUE(memglass::init("test_cdc_off"));
+    auto* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+    pos->quantity = 1;  // no ring to log to
+
+    Observer obs("test_cdc_off");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    EXPECT_FALSE(reader.attach());
+}
+
+TEST_F(CdcTest, DiffsRoundTripThroughMgdf) {
+    ASSERT_TRUE(memglass::init("test_cdc_mgdf", cdc_config(256)));
+    auto* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+
+    Observer obs("test_cdc_mgdf");
+    ASSERT_TRUE(obs.connect());
+    CdcReader reader(obs);
+    ASSERT_TRUE(reader.attach());
+
+    for (int64_t q : {10, -3, 0, 10}) pos->quantity = q;
+    std::vector<SnapshotDiff> diffs;
+    ASSERT_EQ(reader.drain(diffs), 4u);
+
+    std::string buf;
+    mgdf::BlockWriter writer;
+    writer.write_header(buf);
+    for (const auto& diff : diffs) writer.write_diff(buf, diff);
+    writer.write_end(buf);
+
+    std::istringstream in(buf);
+    mgdf::Reader decoded(in);
+    ASSERT_TRUE(decoded.read_header());
+    std::vector<int64_t> values;
+    while (auto diff = decoded.read_diff()) {
+        for (const auto& c : diff->field_changes) values.push_back(c.new_value.as_int64());
+    }
+    EXPECT_EQ(values, (std::vector<int64_t>{10, -3, 0, 10}));
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/registry.hpp>
+
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+
+using namespace memglass;
+
+namespace {
+
+struct Position {
+    int64_t quantity;
+    double price;
+};
+
+uint32_t register_position() {
+    TypeDescriptor desc;
+    desc.name = "Position";
+    desc.size = sizeof(Position);
+    desc.alignment = alignof(Position);
+    desc.fields = {
+        {"quantity", offsetof(Position, quantity), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+        {"price", offsetof(Position, price), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+    };
+    return registry::register_type_for<Position>(desc);
+}
+
+struct Result {
+    int status = -1;
+    std::string out;
+};
+
+// Run the memglass CLI with these arguments; stderr is discarded
+Result run(const std::string& args) {
+    Result result;
+    std::string command = std::string(MEMGLASS_CLI) + " " + args + " 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return result;
+    char buffer[256];
+    while (size_t n = fread(buffer, 1, sizeof(buffer), pipe)) {
+        result.out.append(buffer, n);
+    }
+    int status = pclose(pipe);
+    result.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return result;
+}
+
+} // anonymous namespace
+
+class CliTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry::clear();
+        register_position();
+        ASSERT_TRUE(memglass::init("test_cli"));
+
+        auto* aapl = memglass::create<Position>("AAPL");
+        auto* msft = memglass::create<Position>("desk.MSFT");
+        ASSERT_NE(aapl, nullptr);
+        ASSERT_NE(msft, nullptr);
+        aapl->quantity = 100;
+        aapl->price = 187.5;
+        msft->quantity = -20;
+        msft->price = 410.25;
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+};
+
+TEST_F(CliTest, GetPrintsBareValues) {
+    auto r = run("get test_cli AAPL.quantity desk.MSFT.price");
+    EXPECT_EQ(r.status, 0);
+    EXPECT_EQ(r.out, "100\n410.25\n");
+
+    r = run("get test_cli AAPL");
+    EXPECT_EQ(r.status, 0);
+    EXPECT_EQ(r.out, "quantity=100\nprice=187.5\n");
+}
+
+TEST_F(CliTest, GetMissingObjectOrField) {
+    auto r = run("get test_cli GOOG");
+    EXPECT_EQ(r.status, 4);
+    EXPECT_EQ(r.out, "");
+
+    // Found values are still printed
+    r = run("get test_cli AAPL.quantity AAPL.nope");
+    EXPECT_EQ(r.status, 4);
+    EXPECT_EQ(r.out, "100\n");
+}
+
+TEST_F(CliTest, LsListsLabelsByPrefix) {
+    auto r = run("ls test_cli");
+    EXPECT_EQ(r.status, 0);
+    EXPECT_EQ(r.out, "AAPL\tPosition\ndesk.MSFT\tPosition\n");
+
+    r = run("ls test_cli desk.");
+    EXPECT_EQ(r.status, 0);
+    EXPECT_EQ(r.out, "desk.MSFT\tPosition\n");
+}
+
+TEST_F(CliTest, CheckExitCodes) {
+    EXPECT_EQ(run("check test_cli 'AAPL.quantity == 100'").status, 0);
+    EXPECT_EQ(run("check test_cli 'desk.MSFT.quantity < 0'").status, 0);
+    EXPECT_EQ(run("check test_cli 'AAPL.price > 200'").status, 1);
+    EXPECT_EQ(run("check test_cli 'AAPL.quantity'").status, 2);
+    EXPECT_EQ(run("check test_cli 'AAPL.quantity == lots'").status, 2);
+    EXPECT_EQ(run("check test_cli 'AAPL.nope == 1'").status, 4);
+    EXPECT_EQ(run("check test_cli 'GOOG.quantity == 1'").status, 4);
+}
+
+TEST_F(CliTest, UsageAndMissingSession) {
+    EXPECT_EQ(run("get test_cli").status, 2);
+    EXPECT_EQ(run("check test_cli").status, 2);
+    EXPECT_EQ(run("get no_such_session AAPL").status, 3);
+    EXPECT_EQ(run("ls no_such_session").status, 3);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <memglass/compare.hpp>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace memglass;
+
+struct Quote {
+    int64_t bid;
+    int64_t ask;
+    Guarded<double> mid;
+};
+
+// Shadow build: same fields reordered, plus one production does not have
+struct QuoteV2 {
+    Guarded<double> mid;
+    int64_t ask;
+    int64_t bid;
+    int32_t venue;
+};
+
+class CompareTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+
+    static void register_quote() {
+        TypeDescriptor desc;
+        desc.name = "Quote";
+        desc.size = sizeof(Quote);
+        desc.alignment = alignof(Quote);
+        desc.fields = {
+            {"bid", offsetof(Quote, bid), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"ask", offsetof(Quote, ask), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"mid", offsetof(Quote, mid), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::Seqlock, false},
+        };
+        registry::register_type_for<Quote>(desc);
+    }
+
+    static void register_quote_v2() {
+        TypeDescriptor desc;
+        desc.name = "Quote";
+        desc.size = sizeof(QuoteV2);
+        desc.alignment = alignof(QuoteV2);
+        desc.fields = {
+            {"mid", offsetof(QuoteV2, mid), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::Seqlock, false},
+            {"ask", offsetof(QuoteV2, ask), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"bid", offsetof(QuoteV2, bid), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"venue", offsetof(QuoteV2, venue), sizeof(int32_t), PrimitiveType::Int32, 0, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<QuoteV2>(desc);
+    }
+
+    // Start a session with the given labels and return a writable observer.
+    // Observers keep their mappings after the producer shuts down, so the
+    // next session can start in the same process.
+    template<typename T>
+    std::unique_ptr<Observer> start(const char* session, bool v2,
+                                    std::initializer_list<const char*> labels) {
+        registry::clear();
+        v2 ? register_quote_v2() : register_quote();
+        memglass::shutdown();
+        EXPECT_TRUE(memglass::init(session));
+        for (const char* label : labels) {
+            EXPECT_NE(memglass::create<T>(label), nullptr);
+        }
+
+        ObserverOptions options;
+        options.writable = true;
+        auto obs = std::make_unique<Observer>(session, options);
+        EXPECT_TRUE(obs->connect());
+        for (const char* label : labels) {
+            auto view = obs->find(label);
+            view["bid"] = int64_t{100};
+            view["ask"] = int64_t{101};
+            view["mid"] = 100.5;
+        }
+        return obs;
+    }
+
+    static bool contains(const std::vector<std::string>& v, const std::string& s) {
+        return std::find(v.begin(), v.end(), s) != v.end();
+    }
+};
+
+TEST_F(CompareTest, PairsByLabelAndFieldName) {
+    auto a = start<Quote>("test_compare_a", false, {"AAPL", "MSFT", "only_a"});
+    auto b = start<QuoteV2>("test_compare_b", true, {"AAPL", "MSFT", "only_b"});
+
+    SessionComparator cmp(*a, *b);
+    const auto& r = cmp.compare();
+    EXPECT_TRUE(r.diverged.empty());
+
+    EXPECT_EQ(cmp.stats().objects, 2u);
+    EXPECT_EQ(cmp.stats().fields, 6u);
+    EXPECT_EQ(cmp.only_in_a(), std::vector<std::string>{"only_a"});
+    EXPECT_EQ(cmp.only_in_b(), std::vector<std::string>{"only_b"});
+    EXPECT_TRUE(contains(cmp.unmatched_fields(), "AAPL.venue"));
+    EXPECT_TRUE(contains(cmp.unmatched_fields(), "MSFT.venue"));
+}
+
+TEST_F(CompareTest, ReportsDivergenceUntilConverged) {
+    auto a = start<Quote>("test_compare_a", false, {"AAPL", "MSFT"});
+    auto b = start<QuoteV2>("test_compare_b", true, {"AAPL", "MSFT"});
+
+    SessionComparator cmp(*a, *b);
+    EXPECT_TRUE(cmp.compare().diverged.empty());
+
+    b->find("MSFT")["bid"] = int64_t{99};
+    const auto& first = cmp.compare();
+    ASSERT_EQ(first.diverged.size(), 1u);
+    EXPECT_EQ(first.diverged[0].label, "MSFT");
+    EXPECT_EQ(first.diverged[0].field, "bid");
+    EXPECT_EQ(first.diverged[0].a.data.i64, 100);
+    EXPECT_EQ(first.diverged[0].b.data.i64, 99);
+    EXPECT_EQ(first.diverged[0].since_ns, first.timestamp_ns);
+    uint64_t since = first.timestamp_ns;
+
+    const auto& second = cmp.compare();
+    ASSERT_EQ(second.diverged.size(), 1u);
+    EXPECT_EQ(second.diverged[0].since_ns, since);
+    EXPECT_TRUE(second.converged.empty());
+
+    b->find("MSFT")["bid"] = int64_t{100};
+    const auto& third = cmp.compare();
+    EXPECT_TRUE(third.diverged.empty());
+    ASSERT_EQ(third.converged.size(), 1u);
+    EXPECT_EQ(third.converged[0].field, "bid");
+    EXPECT_EQ(third.converged[0].since_ns, since);
+}
+
+TEST_F(CompareTest, Tolerances) {
+    auto a = start<Quote>("test_compare_a", false, {"AAPL", "MSFT"});
+    auto b = start<QuoteV2>("test_compare_b", true, {"AAPL", "MSFT"});
+    b->find("AAPL")["mid"] = 100.5 + 1e-9;
+    b->find("AAPL")["ask"] = int64_t{102};
+    b->find("MSFT")["ask"] = int64_t{102};
+
+    CompareOptions options;
+    ASSERT_TRUE(parse_tolerance("mid=1e-6", options));
+    ASSERT_TRUE(parse_tolerance("MSFT.ask=ignore", options));
+    EXPECT_FALSE(parse_tolerance("-1", options));
+    EXPECT_FALSE(parse_tolerance("=1", options));
+    EXPECT_FALSE(parse_tolerance("ignore", options));
+
+    SessionComparator cmp(*a, *b, options);
+    const auto& r = cmp.compare();
+    ASSERT_EQ(r.diverged.size(), 1u);
+    EXPECT_EQ(r.diverged[0].label, "AAPL");
+    EXPECT_EQ(r.diverged[0].field, "ask");
+    EXPECT_EQ(cmp.stats().fields, 5u);
+
+    EXPECT_TRUE(std::isinf(options.tolerance_for("MSFT", "ask")));
+    EXPECT_EQ(options.tolerance_for("AAPL", "ask"), 0.0);
+    EXPECT_EQ(options.tolerance_for("AAPL", "mid"), 1e-6);
+}
+
+TEST_F(CompareTest, IdenticalLayoutsShareSpans) {
+    auto a = start<Quote>("test_compare_a", false, {"AAPL", "MSFT"});
+    auto b = start<Quote>("test_compare_b", false, {"AAPL", "MSFT"});
+
+    SessionComparator cmp(*a, *b);
+    EXPECT_TRUE(cmp.compare().diverged.empty());
+
+    // bid, ask and the value of mid are adjacent in both sessions; the
+    // Guarded<T> sequence counter separates one object from the next
+    EXPECT_EQ(cmp.stats().fields, 6u);
+    EXPECT_EQ(cmp.stats().spans, 2u);
+    EXPECT_EQ(cmp.stats().slow_fields, 0u);
+    EXPECT_EQ(cmp.stats().spans_mismatched, 0u);
+
+    b->find("AAPL")["ask"] = int64_t{105};
+    const auto& r = cmp.compare();
+    ASSERT_EQ(r.diverged.size(), 1u);
+    EXPECT_EQ(r.diverged[0].field, "ask");
+    EXPECT_EQ(cmp.stats().spans_mismatched, 1u);
+}
+
+TEST_F(CompareTest, RebuildsOnStructuralChange) {
+    auto a = start<Quote>("test_compare_a", false, {"AAPL"});
+    auto b = start<Quote>("test_compare_b", false, {"AAPL"});
+
+    SessionComparator cmp(*a, *b);
+    cmp.compare();
+    EXPECT_EQ(cmp.stats().rebuilds, 1u);
+    EXPECT_EQ(cmp.only_in_b().size(), 0u);
+
+    // Session B's producer is still running
+    ASSERT_NE(memglass::create<Quote>("GOOG"), nullptr);
+    cmp.compare();
+    EXPECT_EQ(cmp.stats().rebuilds, 2u);
+    EXPECT_EQ(cmp.only_in_b(), std::vector<std::string>{"GOOG"});
+}
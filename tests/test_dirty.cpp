@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/diff.hpp>
+#include <memglass/dirty.hpp>
+
+using namespace memglass;
+
+struct Counter {
+    int64_t value;
+    double rate;
+};
+
+class DirtyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry::clear();
+
+        TypeDescriptor desc;
+        desc.name = "Counter";
+        desc.size = sizeof(Counter);
+        desc.alignment = alignof(Counter);
+        desc.fields = {
+            {"value", offsetof(Counter, value), sizeof(int64_t),
+             PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"rate", offsetof(Counter, rate), sizeof(double),
+             PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<Counter>(desc);
+
+        ASSERT_TRUE(memglass::init("test_dirty"));
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+};
+
+TEST_F(DirtyTest, UnsupportedTrackerReportsEverythingDirty) {
+    Observer obs("test_dirty");
+    ASSERT_TRUE(obs.connect());
+
+    DirtyTracker tracker(obs);
+    EXPECT_FALSE(tracker.supported());
+    EXPECT_TRUE(tracker.is_dirty(1, 0, 8));
+    EXPECT_FALSE(tracker.collect());
+}
+
+TEST_F(DirtyTest, UpdateSnapshotMatchesFullDiff) {
+    auto* a = memglass::create<Counter>("a");
+    auto* b = memglass::create<Counter>("b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    Observer obs("test_dirty");
+    ASSERT_TRUE(obs.connect());
+
+    // Without attach() every object is re-read, same as a full scan
+    DirtyTracker tracker(obs);
+    Snapshot snap = take_snapshot(obs);
+
+    a->value = 7;
+    memglass::destroy(b);
+    memglass::create<Counter>("c");
+
+    SnapshotDiff diff = update_snapshot(obs, snap, tracker);
+    ASSERT_EQ(diff.field_changes.size(), 1u);
+    EXPECT_EQ(diff.field_changes[0].object_label, "a");
+    EXPECT_EQ(diff.field_changes[0].new_value.data.i64, 7);
+    ASSERT_EQ(diff.added_objects.size(), 1u);
+    EXPECT_EQ(diff.added_objects[0], "c");
+    ASSERT_EQ(diff.removed_objects.size(), 1u);
+    EXPECT_EQ(diff.removed_objects[0], "b");
+
+    // The updated snapshot equals a fresh one
+    Snapshot fresh = take_snapshot(obs);
+    EXPECT_TRUE(compute_diff(snap, fresh).empty());
+    EXPECT_EQ(snap.objects.size(), fresh.objects.size());
+}
+
+TEST_F(DirtyTest, SoftDirtySkipsCleanPages) {
+    auto* ctx = detail::get_context();
+    auto* a = memglass::create<Counter>("a");
+    ctx->regions().allocate(4 * 4096, 8);  // keep b on a different page
+    auto* b = memglass::create<Counter>("b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    Observer obs("test_dirty");
+    ASSERT_TRUE(obs.connect());
+
+    DirtyTracker tracker(obs);
+    if (!tracker.attach()) {
+        GTEST_SKIP() << "soft-dirty tracking not available";
+    }
+
+    Snapshot snap = take_snapshot(obs);
+    b->value = 42;
+
+    ASSERT_TRUE(tracker.collect());
+    EXPECT_GT(tracker.tracked_pages(), 0u);
+
+    uint64_t region_id, a_off, b_off;
+    ASSERT_TRUE(ctx->regions().get_location(a, region_id, a_off));
+    ASSERT_TRUE(ctx->regions().get_location(b, region_id, b_off));
+    EXPECT_FALSE(tracker.is_dirty(region_id, a_off, sizeof(Counter)));
+    EXPECT_TRUE(tracker.is_dirty(region_id, b_off, sizeof(Counter)));
+
+    SnapshotDiff diff = update_snapshot(obs, snap, tracker);
+    ASSERT_EQ(diff.field_changes.size(), 1u);
+    EXPECT_EQ(diff.field_changes[0].object_label, "b");
+}
+
+TEST_F(DirtyTest, RacedStoresAreCoveredByLaterRounds) {
+    auto* ctx = detail::get_context();
+    auto* a = memglass::create<Counter>("a");
+    ctx->regions().allocate(4 * 4096, 8);
+    auto* b = memglass::create<Counter>("b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    Observer obs("test_dirty");
+    ASSERT_TRUE(obs.connect());
+
+    DirtyTracker tracker(obs);
+    if (!tracker.attach()) {
+        GTEST_SKIP() << "soft-dirty tracking not available";
+    }
+    tracker.set_full_scan_interval(3);
+
+    uint64_t region_id, a_off, b_off;
+    ASSERT_TRUE(ctx->regions().get_location(a, region_id, a_off));
+    ASSERT_TRUE(ctx->regions().get_location(b, region_id, b_off));
+
+    // A page dirty in one round is reported again in the next
+    b->value = 1;
+    ASSERT_TRUE(tracker.collect());
+    EXPECT_TRUE(tracker.is_dirty(region_id, b_off, sizeof(Counter)));
+    ASSERT_TRUE(tracker.collect());
+    EXPECT_FALSE(tracker.full_scan());
+    EXPECT_TRUE(tracker.is_dirty(region_id, b_off, sizeof(Counter)));
+    EXPECT_FALSE(tracker.is_dirty(region_id, a_off, sizeof(Counter)));
+
+    // Every third round reports everything
+    ASSERT_TRUE(tracker.collect());
+    EXPECT_TRUE(tracker.full_scan());
+    EXPECT_TRUE(tracker.is_dirty(region_id, a_off, sizeof(Counter)));
+    EXPECT_EQ(tracker.dirty_pages(), tracker.tracked_pages());
+
+    ASSERT_TRUE(tracker.collect());
+    EXPECT_FALSE(tracker.is_dirty(region_id, a_off, sizeof(Counter)));
+    EXPECT_FALSE(tracker.is_dirty(region_id, b_off, sizeof(Counter)));
+}
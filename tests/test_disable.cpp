@@ -0,0 +1,92 @@
+// Built with MEMGLASS_DISABLE: the producer API is compiled out
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/stats.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace memglass;
+
+namespace {
+
+struct Quote {
+    double bid;
+    double ask;
+};
+
+struct alignas(64) Position {
+    int64_t quantity;
+    Guarded<Quote> quote;
+    Locked<Quote> last;
+    Ewma latency;
+};
+
+} // anonymous namespace
+
+TEST(DisableTest, NothingIsPublished) {
+    ASSERT_TRUE(memglass::init("test_disable"));
+
+    // No registration needed and no session appears
+    Position* pos = memglass::create<Position>("pos");
+    ASSERT_NE(pos, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pos) % alignof(Position), 0u);
+    Observer obs("test_disable");
+    EXPECT_FALSE(obs.connect());
+
+    pos->quantity = 10;
+    pos->quote.write({1.0, 2.0});
+    pos->last.update([](Quote& q) { q.ask = 3.0; });
+    pos->latency.update(4.0);
+    EXPECT_EQ(pos->quote.read().ask, 2.0);
+    EXPECT_EQ(pos->quote.try_read()->bid, 1.0);
+    EXPECT_EQ(pos->last.read().ask, 3.0);
+    EXPECT_EQ(pos->latency.count, 1u);
+
+    memglass::mark("burst");
+    memglass::cycle_end();
+    memglass::define_stage(0, "feed");
+    memglass::stamp(1, 0);
+    EXPECT_TRUE(memglass::register_heartbeat("main"));
+    memglass::heartbeat();
+    memglass::unregister_heartbeat();
+    memglass::destroy(pos);
+    memglass::shutdown();
+}
+
+TEST(DisableTest, ArraysAndHandles) {
+    Position* arr = memglass::create_array<Position>("arr", 4);
+    ASSERT_NE(arr, nullptr);
+    EXPECT_EQ(arr[3].quantity, 0);
+    memglass::destroy(arr);
+
+    auto handle = memglass::create_handle<Position>("h");
+    ASSERT_TRUE(handle);
+    handle->quantity = 1;
+    EXPECT_TRUE(memglass::destroy(handle));
+    EXPECT_FALSE(handle);
+    EXPECT_FALSE(memglass::destroy(handle));
+}
+
+TEST(DisableTest, LockedStillExcludesThreads) {
+    // The wrappers are shared with the observer side, so they keep working
+    Locked<int64_t> counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) counter.update([](int64_t& c) { ++c; });
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(counter.read(), 40000);
+}
+
+TEST(DisableTest, NeverPaused) {
+    static_assert(!memglass::paused());
+    memglass::set_paused(true);
+    Ewma ewma;
+    ewma.update(1.0);
+    EXPECT_EQ(ewma.count, 1u);
+}
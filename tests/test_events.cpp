@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/events.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+class EventsTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::shutdown();
+    }
+
+    void start(uint32_t ring_capacity = 1024) {
+        Config cfg;
+        cfg.event_ring_capacity = ring_capacity;
+        ASSERT_TRUE(memglass::init("test_events", cfg));
+    }
+};
+
+TEST_F(EventsTest, MarksAndCycles) {
+    start();
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+
+    Event e;
+    EXPECT_FALSE(events.next(e, 0ns));
+
+    memglass::mark("md_burst");
+    memglass::cycle_end();
+    memglass::cycle_end();
+
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.kind, EventKind::Mark);
+    EXPECT_EQ(e.name, "md_burst");
+    EXPECT_EQ(e.epoch, 0u);
+
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.kind, EventKind::CycleEnd);
+    EXPECT_EQ(e.epoch, 1u);
+    EXPECT_TRUE(e.name.empty());
+
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.epoch, 2u);
+    EXPECT_EQ(e.index, 2u);
+    EXPECT_EQ(events.epoch(), 2u);
+    EXPECT_FALSE(events.next(e, 0ns));
+}
+
+TEST_F(EventsTest, OnlyEventsAfterAttach) {
+    start();
+    memglass::mark("early");
+
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+
+    Event e;
+    EXPECT_FALSE(events.next(e, 0ns));
+    memglass::mark("late");
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.name, "late");
+}
+
+TEST_F(EventsTest, WaitForWakesOnMatchingMark) {
+    start();
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+
+    std::thread producer([] {
+        std::this_thread::sleep_for(20ms);
+        memglass::cycle_end();
+        memglass::mark("fill");
+        memglass::mark("md_burst");
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    Event e;
+    ASSERT_TRUE(events.wait_for(EventKind::Mark, "md_burst", e, 5s));
+    EXPECT_EQ(e.name, "md_burst");
+    EXPECT_EQ(e.epoch, 1u);
+    // Woken as soon as the mark lands
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    producer.join();
+
+    EXPECT_FALSE(events.wait_for(EventKind::CycleEnd, "", e, 10ms));
+}
+
+TEST_F(EventsTest, DeadWaiterCostsOneWake) {
+    start();
+    EventRingHeader* ring = detail::get_context()->events();
+    ASSERT_NE(ring, nullptr);
+
+    // A listener killed in futex_wait leaves its flag behind
+    ring->waiters.store(1);
+    memglass::mark("first");
+    EXPECT_EQ(ring->waiters.load(), 0u);
+    memglass::mark("second");
+    EXPECT_EQ(ring->waiters.load(), 0u);
+
+    // Live waiters set it again on every sleep
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+    std::thread producer([] {
+        std::this_thread::sleep_for(20ms);
+        memglass::mark("one");
+        std::this_thread::sleep_for(20ms);
+        memglass::mark("two");
+    });
+    Event e;
+    ASSERT_TRUE(events.next(e, 5s));
+    EXPECT_EQ(e.name, "one");
+    ASSERT_TRUE(events.next(e, 5s));
+    EXPECT_EQ(e.name, "two");
+    producer.join();
+}
+
+TEST_F(EventsTest, SlowListenerSkipsOverwrittenEvents) {
+    start(8);
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+
+    for (int i = 0; i < 20; ++i) memglass::cycle_end();
+
+    Event e;
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.index, 12u);
+    EXPECT_EQ(e.epoch, 13u);
+    EXPECT_EQ(events.missed(), 12u);
+
+    events.skip_to_head();
+    EXPECT_FALSE(events.next(e, 0ns));
+}
+
+TEST_F(EventsTest, DisabledRing) {
+    start(0);
+    memglass::mark("ignored");
+    memglass::cycle_end();
+
+    Observer obs("test_events");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    EXPECT_FALSE(events.attach());
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <memglass/heartbeat.hpp>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+class HeartbeatTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::unregister_heartbeat();
+        memglass::shutdown();
+        memglass::set_paused(false);
+        registry::clear();
+    }
+
+    static Config config(uint32_t slots = 4) {
+        Config cfg;
+        cfg.heartbeat_slots = slots;
+        return cfg;
+    }
+
+    static StallOptions threshold(std::chrono::nanoseconds t) {
+        StallOptions opts;
+        opts.threshold = t;
+        return opts;
+    }
+};
+
+TEST_F(HeartbeatTest, NoSegmentWithoutSlots) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_off"));
+    memglass::heartbeat();  // no-op
+    EXPECT_FALSE(memglass::register_heartbeat("main"));
+
+    Observer obs("test_heartbeat_off");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs);
+    EXPECT_FALSE(detector.attach());
+    EXPECT_TRUE(detector.check().empty());
+}
+
+TEST_F(HeartbeatTest, ThreadsBeatIntoTheirSlot) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_beat", config()));
+    ASSERT_TRUE(memglass::register_heartbeat("main"));
+    for (int i = 0; i < 3; ++i) memglass::heartbeat();
+
+    Observer obs("test_heartbeat_beat");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs, threshold(1s));
+    ASSERT_TRUE(detector.attach());
+
+    const auto& threads = detector.check();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0].name, "main");
+    EXPECT_EQ(threads[0].tid, static_cast<uint32_t>(syscall(SYS_gettid)));
+    EXPECT_EQ(threads[0].count, 3u);
+    EXPECT_EQ(threads[0].threshold_ns, 1'000'000'000u);
+    EXPECT_FALSE(threads[0].stalled);
+    EXPECT_EQ(detector.stalled(), 0u);
+}
+
+TEST_F(HeartbeatTest, FlagsStallsAndRecoveries) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_stall", config()));
+    ASSERT_TRUE(memglass::register_heartbeat("loop"));
+    memglass::heartbeat();
+
+    Observer obs("test_heartbeat_stall");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs, threshold(5ms));
+    ASSERT_TRUE(detector.attach());
+
+    int stalls = 0, recoveries = 0;
+    detector.on_stall([&](const ThreadHeartbeat& t) {
+        EXPECT_EQ(t.name, "loop");
+        EXPECT_GT(t.silent_ns, 5'000'000u);
+        ++stalls;
+    });
+    detector.on_recover([&](const ThreadHeartbeat&) { ++recoveries; });
+
+    // attach() calibrates for 10ms, so the loop is silent already
+    memglass::heartbeat();
+    detector.check();
+    EXPECT_EQ(detector.stalled(), 0u);
+
+    std::this_thread::sleep_for(20ms);
+    detector.check();
+    detector.check();
+    EXPECT_EQ(detector.stalled(), 1u);
+    EXPECT_EQ(stalls, 1);  // once per stall, not per check
+
+    memglass::heartbeat();
+    detector.check();
+    EXPECT_EQ(detector.stalled(), 0u);
+    EXPECT_EQ(recoveries, 1);
+}
+
+TEST_F(HeartbeatTest, ThreadThresholdOverridesDetector) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_own", config()));
+    ASSERT_TRUE(memglass::register_heartbeat("batch", 1s));
+    memglass::heartbeat();
+
+    Observer obs("test_heartbeat_own");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs, threshold(1ms));
+    ASSERT_TRUE(detector.attach());
+
+    std::this_thread::sleep_for(5ms);
+    const auto& threads = detector.check();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0].threshold_ns, 1'000'000'000u);
+    EXPECT_FALSE(threads[0].stalled);
+}
+
+TEST_F(HeartbeatTest, ExitedAndUnregisteredThreadsAreNotStalls) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_exit", config(1)));
+
+    Observer obs("test_heartbeat_exit");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs, threshold(1ms));
+    ASSERT_TRUE(detector.attach());
+
+    // One slot: the worker holds it until it exits
+    std::thread worker([] {
+        EXPECT_TRUE(memglass::register_heartbeat("worker"));
+        memglass::heartbeat();
+    });
+    worker.join();
+    EXPECT_TRUE(detector.check().empty());
+
+    ASSERT_TRUE(memglass::register_heartbeat("main"));
+    std::thread other([] { EXPECT_FALSE(memglass::register_heartbeat("other")); });
+    other.join();
+
+    memglass::unregister_heartbeat();
+    EXPECT_TRUE(detector.check().empty());
+
+    // The next beat claims a slot again, under the registered name
+    memglass::heartbeat();
+    const auto& threads = detector.check();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0].name, "main");
+    EXPECT_EQ(threads[0].count, 1u);
+}
+
+TEST_F(HeartbeatTest, ThreadsFollowANewSession) {
+    ASSERT_TRUE(memglass::init("test_heartbeat_first", config()));
+    memglass::heartbeat();
+    memglass::shutdown();
+    memglass::heartbeat();  // no session: no-op
+
+    ASSERT_TRUE(memglass::init("test_heartbeat_second", config()));
+    memglass::heartbeat();
+    memglass::heartbeat();
+
+    Observer obs("test_heartbeat_second");
+    ASSERT_TRUE(obs.connect());
+    StallDetector detector(obs, threshold(1s));
+    ASSERT_TRUE(detector.attach());
+    const auto& threads = detector.check();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0].count, 2u);
+    EXPECT_FALSE(threads[0].name.empty());  // the thread's own name
+}
@@ -2,9 +2,12 @@
 #include <memglass/memglass.hpp>
 #include <memglass/observer.hpp>
 #include <memglass/registry.hpp>
+#include <memglass/detail/label_index.hpp>
+#include <atomic>
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 using namespace memglass;
 
@@ -329,3 +332,243 @@ TEST_F(IntegrationTest, MetadataOverflow) {
         EXPECT_NEAR(value, static_cast<double>(i) * 1.5, 0.0001) << "Incorrect value for object " << i;
     }
 }
+
+TEST_F(IntegrationTest, ReadOnlyObserverIgnoresWrites) {
+    ASSERT_TRUE(memglass::init("readonly_test"));
+
+    auto* obj = memglass::create<SimpleStruct>("ro_object");
+    ASSERT_NE(obj, nullptr);
+    obj->x = 5;
+
+    // Default observers map segments read-only
+    Observer observer("readonly_test");
+    ASSERT_TRUE(observer.connect());
+    EXPECT_FALSE(observer.options().writable);
+
+    auto view = observer.find("ro_object");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_EQ(view.mutable_data(), nullptr);
+
+    view["x"] = int32_t{99};
+    EXPECT_EQ(obj->x, 5);
+    EXPECT_EQ(view["x"].as<int32_t>(), 5);
+}
+
+TEST_F(IntegrationTest, WritableObserver) {
+    ASSERT_TRUE(memglass::init("writable_test"));
+
+    auto* obj = memglass::create<SimpleStruct>("rw_object");
+    ASSERT_NE(obj, nullptr);
+
+    ObserverOptions opts;
+    opts.writable = true;
+    Observer observer("writable_test", opts);
+    ASSERT_TRUE(observer.connect());
+
+    auto view = observer.find("rw_object");
+    ASSERT_TRUE(static_cast<bool>(view));
+    view["x"] = int32_t{99};
+    EXPECT_EQ(obj->x, 99);
+}
+
+TEST_F(IntegrationTest, LazyRegionMapping) {
+    ASSERT_TRUE(memglass::init("lazy_test"));
+
+    auto* obj = memglass::create<SimpleStruct>("lazy_object");
+    ASSERT_NE(obj, nullptr);
+    obj->y = 17;
+
+    ObserverOptions opts;
+    opts.regions = RegionMapping::Lazy;
+    Observer observer("lazy_test", opts);
+    ASSERT_TRUE(observer.connect());
+    EXPECT_EQ(observer.mapped_regions(), 0u);
+
+    auto view = observer.find("lazy_object");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_EQ(observer.mapped_regions(), 1u);
+    EXPECT_EQ(view["y"].as<int32_t>(), 17);
+}
+
+TEST_F(IntegrationTest, PopulateRegionMapping) {
+    ASSERT_TRUE(memglass::init("populate_test"));
+
+    auto* obj = memglass::create<SimpleStruct>("hot_object");
+    ASSERT_NE(obj, nullptr);
+    obj->value = 2.5;
+
+    ObserverOptions opts;
+    opts.regions = RegionMapping::Populate;
+    Observer observer("populate_test", opts);
+    ASSERT_TRUE(observer.connect());
+    EXPECT_GE(observer.mapped_regions(), 1u);
+
+    auto view = observer.find("hot_object");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_DOUBLE_EQ(view["value"].as<double>(), 2.5);
+}
+
+struct LockedStruct {
+    Locked<int64_t> total;
+};
+
+TEST_F(IntegrationTest, LockedFieldReadOnly) {
+    TypeDescriptor desc;
+    desc.name = "LockedStruct";
+    desc.size = sizeof(LockedStruct);
+    desc.alignment = alignof(LockedStruct);
+    desc.fields = {
+        {"total", offsetof(LockedStruct, total), sizeof(Locked<int64_t>),
+         PrimitiveType::Int64, 0, 0, Atomicity::Locked, false},
+    };
+    registry::register_type_for<LockedStruct>(desc);
+
+    ASSERT_TRUE(memglass::init("locked_ro_test"));
+    auto* obj = memglass::create<LockedStruct>("locked_object");
+    ASSERT_NE(obj, nullptr);
+    obj->total.write(1234);
+
+    // Reading must not touch the producer's lock through a read-only mapping
+    Observer observer("locked_ro_test");
+    ASSERT_TRUE(observer.connect());
+    auto view = observer.find("locked_object");
+    ASSERT_TRUE(static_cast<bool>(view));
+    EXPECT_EQ(view["total"].as<int64_t>(), 1234);
+}
+
+TEST_F(IntegrationTest, LabelIndexLookup) {
+    ASSERT_TRUE(memglass::init("label_index_test"));
+    auto* header = detail::get_context()->header();
+    ASSERT_GT(header->label_index_capacity, 0u);
+
+    auto* a = memglass::create<SimpleStruct>("alpha");
+    auto* b = memglass::create<SimpleStruct>("beta");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    a->x = 1;
+    b->x = 2;
+
+    Observer observer("label_index_test");
+    ASSERT_TRUE(observer.connect());
+    EXPECT_EQ(observer.find("beta")["x"].as<int32_t>(), 2);
+    EXPECT_FALSE(static_cast<bool>(observer.find("gamma")));
+
+    // Destroyed labels disappear; a reused slot is found under its new label
+    memglass::destroy(b);
+    EXPECT_FALSE(static_cast<bool>(observer.find("beta")));
+    auto* c = memglass::create<SimpleStruct>("gamma");
+    ASSERT_NE(c, nullptr);
+    c->x = 3;
+    EXPECT_EQ(observer.find("gamma")["x"].as<int32_t>(), 3);
+    EXPECT_EQ(observer.find("alpha")["x"].as<int32_t>(), 1);
+    EXPECT_EQ(header->label_index_complete.load(), 1u);
+}
+
+TEST_F(IntegrationTest, LabelIndexEraseShiftsRunBack) {
+    // Three entries homed at slot 6 wrap around the end of the table, then
+    // one homed at 0 lands behind them
+    constexpr uint32_t capacity = 8;
+    std::vector<std::atomic<uint64_t>> table(capacity);
+    std::atomic<uint32_t> seq{0};
+    ASSERT_TRUE(detail::label_index_insert(table.data(), capacity, 6, 1));
+    ASSERT_TRUE(detail::label_index_insert(table.data(), capacity, 14, 2));
+    ASSERT_TRUE(detail::label_index_insert(table.data(), capacity, 22, 3));
+    ASSERT_TRUE(detail::label_index_insert(table.data(), capacity, 8, 4));
+
+    detail::label_index_erase(table.data(), capacity, seq, 6, 1);
+    EXPECT_EQ(seq.load(), 2u);
+
+    auto find = [&](uint32_t hash) {
+        uint32_t found = ~0u;
+        detail::label_index_find(table.data(), capacity, hash, [&](uint32_t i) {
+            found = i;
+            return true;
+        });
+        return found;
+    };
+    EXPECT_EQ(find(6), ~0u);
+    EXPECT_EQ(find(14), 2u);
+    EXPECT_EQ(find(22), 3u);
+    EXPECT_EQ(find(8), 4u);
+
+    // No erased markers: exactly the live entries occupy slots
+    size_t used = 0;
+    for (const auto& slot : table) used += slot.load() != 0;
+    EXPECT_EQ(used, 3u);
+}
+
+TEST_F(IntegrationTest, LabelIndexChurn) {
+    Config cfg;
+    cfg.max_objects = 64;
+    ASSERT_TRUE(memglass::init("label_index_churn_test", cfg));
+    auto* header = detail::get_context()->header();
+
+    for (int i = 0; i < 16; ++i) {
+        auto* obj = memglass::create<SimpleStruct>("stable_" + std::to_string(i));
+        ASSERT_NE(obj, nullptr);
+        obj->x = i;
+    }
+
+    Observer observer("label_index_churn_test");
+    ASSERT_TRUE(observer.connect());
+
+    // Stable objects stay findable while others come and go
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::thread reader([&] {
+        Observer obs("label_index_churn_test");
+        if (!obs.connect()) {
+            ++misses;
+            return;
+        }
+        for (int i = 0; !done.load(std::memory_order_relaxed); ++i) {
+            if (!obs.find("stable_" + std::to_string(i % 16))) ++misses;
+        }
+    });
+
+    for (int round = 0; round < 20000; ++round) {
+        auto* obj = memglass::create<SimpleStruct>("churn_" + std::to_string(round));
+        ASSERT_NE(obj, nullptr);
+        memglass::destroy(obj);
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(misses.load(), 0);
+
+    // Erased labels leave nothing behind, so a miss stops at an empty slot
+    auto* table = reinterpret_cast<const std::atomic<uint64_t>*>(
+        reinterpret_cast<const char*>(header) + header->label_index_offset);
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < header->label_index_capacity; ++i) {
+        used += table[i].load() != 0;
+    }
+    EXPECT_EQ(used, 16u);
+    EXPECT_EQ(header->label_index_complete.load(), 1u);
+    EXPECT_FALSE(static_cast<bool>(observer.find("churn_0")));
+    for (int i = 0; i < 16; ++i) {
+        EXPECT_EQ(observer.find("stable_" + std::to_string(i))["x"].as<int32_t>(), i);
+    }
+}
+
+TEST_F(IntegrationTest, LabelIndexFallsBackForOverflow) {
+    Config cfg;
+    cfg.max_objects = 4;
+    ASSERT_TRUE(memglass::init("label_index_overflow_test", cfg));
+
+    for (int i = 0; i < 8; ++i) {
+        auto* obj = memglass::create<SimpleStruct>("obj_" + std::to_string(i));
+        ASSERT_NE(obj, nullptr);
+        obj->x = i;
+    }
+    // Overflow directory entries are not indexed, so lookups must scan
+    EXPECT_EQ(detail::get_context()->header()->label_index_complete.load(), 0u);
+
+    Observer observer("label_index_overflow_test");
+    ASSERT_TRUE(observer.connect());
+    for (int i = 0; i < 8; ++i) {
+        auto view = observer.find("obj_" + std::to_string(i));
+        ASSERT_TRUE(static_cast<bool>(view)) << i;
+        EXPECT_EQ(view["x"].as<int32_t>(), i);
+    }
+    EXPECT_FALSE(static_cast<bool>(observer.find("obj_8")));
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <memglass/latency.hpp>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+class LatencyTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::shutdown();
+        memglass::set_paused(false);
+        registry::clear();
+    }
+
+    static Config config(uint32_t sample_every = 1) {
+        Config cfg;
+        cfg.stamp_ring_capacity = 1024;
+        cfg.stamp_sample_every = sample_every;
+        return cfg;
+    }
+
+    static void name_pipeline() {
+        memglass::define_stage(0, "feed");
+        memglass::define_stage(1, "strategy");
+        memglass::define_stage(2, "gateway");
+    }
+};
+
+TEST_F(LatencyTest, HistogramPercentiles) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.percentile(0.5), 0u);
+
+    for (uint64_t v = 1; v <= 1000; ++v) h.add(v * 1000);
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.min(), 1000u);
+    EXPECT_EQ(h.max(), 1'000'000u);
+    EXPECT_DOUBLE_EQ(h.mean(), 500'500.0);
+
+    // Within the 12.5% bucket width
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.5)), 500'000.0, 500'000.0 * 0.125);
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.99)), 990'000.0, 990'000.0 * 0.125);
+    EXPECT_EQ(h.percentile(1.0), 1'000'000u);
+    EXPECT_EQ(h.percentile(0.0), 1000u);
+
+    // Small values are exact
+    LatencyHistogram small;
+    for (uint64_t v : {3, 3, 3, 7}) small.add(v);
+    EXPECT_EQ(small.percentile(0.5), 3u);
+    EXPECT_EQ(small.percentile(1.0), 7u);
+
+    LatencyHistogram merged;
+    merged.merge(h);
+    merged.merge(small);
+    EXPECT_EQ(merged.count(), 1004u);
+    EXPECT_EQ(merged.min(), 3u);
+}
+
+TEST_F(LatencyTest, NoRingWithoutCapacity) {
+    ASSERT_TRUE(memglass::init("test_latency_off"));
+    memglass::stamp(1, 0);  // no-op
+
+    Observer obs("test_latency_off");
+    ASSERT_TRUE(obs.connect());
+    StampJoiner joiner(obs);
+    EXPECT_FALSE(joiner.attach());
+}
+
+TEST_F(LatencyTest, JoinsStagesPerMessage) {
+    ASSERT_TRUE(memglass::init("test_latency_join", config()));
+    name_pipeline();
+
+    Observer obs("test_latency_join");
+    ASSERT_TRUE(obs.connect());
+    StampJoiner joiner(obs);
+    ASSERT_TRUE(joiner.attach());
+    EXPECT_EQ(joiner.report().stage_names,
+              (std::vector<std::string>{"feed", "strategy", "gateway"}));
+
+    // Two messages interleaved, the second slow in the strategy
+    memglass::stamp(10, 0);
+    memglass::stamp(11, 0);
+    memglass::stamp(10, 1);
+    memglass::stamp(10, 2);
+    memglass::stamp(11, 1);
+    memglass::stamp(11, 1);  // repeated stage: first one counts
+    std::this_thread::sleep_for(2ms);
+    memglass::stamp(11, 2);
+
+    EXPECT_EQ(joiner.poll(), 7u);
+    EXPECT_EQ(joiner.pending(), 0u);
+
+    const LatencyReport& r = joiner.report();
+    EXPECT_EQ(r.messages, 2u);
+    EXPECT_EQ(r.incomplete, 0u);
+    EXPECT_EQ(r.missed, 0u);
+    EXPECT_EQ(r.stages[0].count(), 0u);  // nothing before the first stage
+    EXPECT_EQ(r.stages[1].count(), 2u);
+    EXPECT_EQ(r.stages[2].count(), 2u);
+    EXPECT_EQ(r.end_to_end.count(), 2u);
+    EXPECT_GE(r.stages[2].max(), 1'500'000u);
+
+    ASSERT_EQ(r.worst.size(), 2u);
+    EXPECT_EQ(r.worst[0].message_id, 11u);
+    EXPECT_EQ(r.worst[1].message_id, 10u);
+    ASSERT_EQ(r.worst[0].stages.size(), 3u);
+    EXPECT_EQ(r.worst[0].stages[0], (std::pair<uint32_t, uint64_t>{0, 0}));
+    EXPECT_EQ(r.worst[0].stages[2].first, 2u);
+    EXPECT_EQ(r.worst[0].stages[2].second, r.worst[0].total_ns);
+    EXPECT_GT(r.worst[0].start_ns, 0u);
+
+    joiner.reset();
+    EXPECT_EQ(joiner.report().messages, 0u);
+    EXPECT_EQ(joiner.report().stage_names.size(), 3u);
+}
+
+TEST_F(LatencyTest, KeepsOnlyTheSlowest) {
+    ASSERT_TRUE(memglass::init("test_latency_worst", config()));
+    name_pipeline();
+
+    Observer obs("test_latency_worst");
+    ASSERT_TRUE(obs.connect());
+    JoinOptions opts;
+    opts.worst = 2;
+    StampJoiner joiner(obs, opts);
+    ASSERT_TRUE(joiner.attach());
+
+    for (uint64_t id = 1; id <= 5; ++id) {
+        memglass::stamp(id, 0);
+        if (id == 2 || id == 4) std::this_thread::sleep_for(std::chrono::milliseconds(id));
+        memglass::stamp(id, 2);
+    }
+    joiner.poll();
+
+    const LatencyReport& r = joiner.report();
+    EXPECT_EQ(r.messages, 5u);
+    ASSERT_EQ(r.worst.size(), 2u);
+    EXPECT_GE(r.worst[0].total_ns, r.worst[1].total_ns);
+    // The two that slept, in whichever order the scheduler woke them
+    EXPECT_EQ(r.worst[0].message_id + r.worst[1].message_id, 6u);
+    EXPECT_EQ(r.worst[0].message_id * r.worst[1].message_id, 8u);
+}
+
+TEST_F(LatencyTest, SamplesWholeMessages) {
+    ASSERT_TRUE(memglass::init("test_latency_sample", config(4)));
+    name_pipeline();
+
+    Observer obs("test_latency_sample");
+    ASSERT_TRUE(obs.connect());
+    StampJoiner joiner(obs);
+    ASSERT_TRUE(joiner.attach());
+
+    for (uint64_t id = 0; id < 400; ++id) {
+        for (uint32_t stage = 0; stage < 3; ++stage) memglass::stamp(id, stage);
+    }
+    size_t read = joiner.poll();
+
+    const LatencyReport& r = joiner.report();
+    EXPECT_EQ(read, r.messages * 3);  // every stage of a sampled message
+    EXPECT_EQ(joiner.pending(), 0u);
+    EXPECT_GT(r.messages, 50u);
+    EXPECT_LT(r.messages, 150u);
+}
+
+TEST_F(LatencyTest, DropsIncompleteAfterTimeout) {
+    ASSERT_TRUE(memglass::init("test_latency_timeout", config()));
+    name_pipeline();
+
+    Observer obs("test_latency_timeout");
+    ASSERT_TRUE(obs.connect());
+    JoinOptions opts;
+    opts.timeout = 5ms;
+    StampJoiner joiner(obs, opts);
+    ASSERT_TRUE(joiner.attach());
+
+    memglass::stamp(1, 0);
+    memglass::stamp(1, 1);  // never reaches the gateway
+    joiner.poll();
+    EXPECT_EQ(joiner.pending(), 1u);
+
+    std::this_thread::sleep_for(10ms);
+    joiner.poll();
+    EXPECT_EQ(joiner.pending(), 0u);
+    EXPECT_EQ(joiner.report().incomplete, 1u);
+    EXPECT_EQ(joiner.report().messages, 0u);
+}
+
+TEST_F(LatencyTest, UnnamedStagesCompleteWhenQuiet) {
+    ASSERT_TRUE(memglass::init("test_latency_unnamed", config()));
+
+    Observer obs("test_latency_unnamed");
+    ASSERT_TRUE(obs.connect());
+    JoinOptions opts;
+    opts.timeout = 5ms;
+    StampJoiner joiner(obs, opts);
+    ASSERT_TRUE(joiner.attach());
+
+    memglass::stamp(1, 0);
+    memglass::stamp(1, 3);
+    joiner.poll();
+    EXPECT_EQ(joiner.report().messages, 0u);
+
+    std::this_thread::sleep_for(10ms);
+    joiner.poll();
+    const LatencyReport& r = joiner.report();
+    EXPECT_EQ(r.messages, 1u);
+    ASSERT_EQ(r.stage_names.size(), 4u);
+    EXPECT_EQ(r.stage_names[3], "stage3");
+    EXPECT_EQ(r.stages[3].count(), 1u);
+}
+
+TEST_F(LatencyTest, NotStampedWhilePaused) {
+    ASSERT_TRUE(memglass::init("test_latency_paused", config()));
+    name_pipeline();
+
+    Observer obs("test_latency_paused");
+    ASSERT_TRUE(obs.connect());
+    StampJoiner joiner(obs);
+    ASSERT_TRUE(joiner.attach());
+
+    memglass::set_paused(true);
+    memglass::stamp(1, 0);
+    memglass::stamp(1, 2);
+    memglass::set_paused(false);
+    EXPECT_EQ(joiner.poll(), 0u);
+    EXPECT_EQ(joiner.report().messages, 0u);
+}
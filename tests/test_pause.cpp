@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/events.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/stats.hpp>
+
+#include <chrono>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+class PauseTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::shutdown();
+        memglass::set_paused(false);
+    }
+};
+
+TEST_F(PauseTest, ObserverPausesAndResumesProducer) {
+    ASSERT_TRUE(memglass::init("test_pause"));
+
+    ObserverOptions opts;
+    opts.writable = true;
+    Observer ctl("test_pause", opts);
+    ASSERT_TRUE(ctl.connect());
+    Observer obs("test_pause");
+    ASSERT_TRUE(obs.connect());
+    EventListener events(obs);
+    ASSERT_TRUE(events.attach());
+
+    // Read-only observers can see the switch but not flip it
+    EXPECT_FALSE(obs.set_paused(true));
+    EXPECT_FALSE(obs.paused());
+
+    Ewma ewma;
+    ASSERT_TRUE(ctl.set_paused(true));
+    EXPECT_TRUE(memglass::paused());
+    EXPECT_TRUE(obs.paused());
+
+    memglass::cycle_end();
+    ewma.update(5);
+    Event e;
+    EXPECT_FALSE(events.next(e, 0ns));
+    EXPECT_EQ(ewma.count, 0u);
+
+    ASSERT_TRUE(ctl.set_paused(false));
+    EXPECT_FALSE(memglass::paused());
+    memglass::cycle_end();
+    ewma.update(5);
+    ASSERT_TRUE(events.next(e, 0ns));
+    EXPECT_EQ(e.kind, EventKind::CycleEnd);
+    EXPECT_EQ(ewma.count, 1u);
+}
+
+TEST_F(PauseTest, StateSurvivesInitAndShutdown) {
+    memglass::set_paused(true);
+    ASSERT_TRUE(memglass::init("test_pause_carry"));
+
+    Observer obs("test_pause_carry");
+    ASSERT_TRUE(obs.connect());
+    EXPECT_TRUE(obs.paused());
+
+    memglass::set_paused(false);
+    EXPECT_FALSE(obs.paused());
+    memglass::set_paused(true);
+
+    memglass::shutdown();
+    EXPECT_TRUE(memglass::paused());
+}
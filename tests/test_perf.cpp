@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/perf.hpp>
+#include <memglass/registry.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+struct Worker {
+    ScopeStats decode;
+    int64_t packets;
+};
+
+class PerfTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        memglass::shutdown();
+        memglass::set_paused(false);
+        registry::clear();
+    }
+};
+
+// Something with instructions and branches to count
+static uint64_t work(uint64_t n) {
+    uint64_t x = 0;
+    for (uint64_t i = 0; i < n; ++i) x += (i * 2654435761u) % 7 == 0 ? i : 1;
+    return x;
+}
+
+TEST_F(PerfTest, SampleReflectsCounterAvailability) {
+    PerfSample a = perf_sample();
+    volatile uint64_t sink = work(100000);
+    (void)sink;
+    PerfSample b = perf_sample();
+
+    EXPECT_GT(b.ns, a.ns);
+    EXPECT_EQ(a.counters, perf_counters_available());
+    if (a.counters && b.counters) {
+        EXPECT_GT(b.instructions, a.instructions);
+        EXPECT_GT(b.cycles, a.cycles);
+    }
+}
+
+TEST_F(PerfTest, ScopeTimerAccumulates) {
+    ScopeStats stats;
+    for (int i = 0; i < 3; ++i) {
+        ScopeTimer t(stats);
+        std::this_thread::sleep_for(1ms);
+    }
+
+    EXPECT_EQ(stats.calls, 3u);
+    EXPECT_GE(stats.total_ns, 3'000'000u);
+    EXPECT_DOUBLE_EQ(stats.ns_per_call, static_cast<double>(stats.total_ns) / 3);
+    if (perf_counters_available()) {
+        EXPECT_EQ(stats.counters, 1u);
+        EXPECT_GT(stats.instructions, 0u);
+        EXPECT_GT(stats.ipc, 0.0);
+    } else {
+        // Timing only
+        EXPECT_EQ(stats.counters, 0u);
+        EXPECT_EQ(stats.cycles, 0u);
+        EXPECT_EQ(stats.ipc, 0.0);
+    }
+}
+
+TEST_F(PerfTest, NotTimedWhilePaused) {
+    ScopeStats stats;
+    memglass::set_paused(true);
+    {
+        ScopeTimer t(stats);
+    }
+    EXPECT_EQ(stats.calls, 0u);
+    memglass::set_paused(false);
+    {
+        ScopeTimer t(stats);
+    }
+    EXPECT_EQ(stats.calls, 1u);
+}
+
+TEST_F(PerfTest, ObserversReadPerCallFigures) {
+    TypeDescriptor desc;
+    desc.name = "Worker";
+    desc.size = sizeof(Worker);
+    desc.alignment = alignof(Worker);
+    desc.fields = {
+        {"packets", offsetof(Worker, packets), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+    };
+    ScopeStats::describe(desc, "decode", offsetof(Worker, decode));
+    registry::register_type_for<Worker>(desc);
+
+    ASSERT_TRUE(memglass::init("test_perf"));
+    auto* w = memglass::create<Worker>("worker");
+    ASSERT_NE(w, nullptr);
+    for (int i = 0; i < 4; ++i) {
+        ScopeTimer t(w->decode);
+        volatile uint64_t sink = work(1000);
+        (void)sink;
+    }
+
+    Observer obs("test_perf");
+    ASSERT_TRUE(obs.connect());
+    auto view = obs.find("worker");
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view["decode.calls"].as<uint64_t>(), 4u);
+    EXPECT_GT(view["decode.ns_per_call"].as<double>(), 0.0);
+    EXPECT_EQ(view["decode.counters"].as<uint32_t>(), perf_counters_available() ? 1u : 0u);
+    EXPECT_NE(view["decode.ipc"].info(), nullptr);
+    EXPECT_NE(view["decode.llc_misses_per_call"].info(), nullptr);
+    EXPECT_NE(view["decode.branch_misses_per_call"].info(), nullptr);
+}
@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+#include <memglass/mgdf.hpp>
+#include <memglass/query.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace memglass;
+
+namespace {
+
+constexpr uint64_t BASE_NS = 1700000000000000000ull;  // 2023-11-14T22:13:20Z
+constexpr uint64_t MS = 1'000'000;
+
+FieldValue make_int(int64_t v) {
+    FieldValue fv;
+    fv.type = PrimitiveType::Int64;
+    fv.data.i64 = v;
+    return fv;
+}
+
+FieldValue make_double(double v) {
+    FieldValue fv;
+    fv.type = PrimitiveType::Float64;
+    fv.data.f64 = v;
+    return fv;
+}
+
+// One diff every 100ms: AAPL.bid = 100 + i, MSFT.bid = 500 - i, AAPL.last = i / 2
+SnapshotDiff tick(uint64_t i) {
+    SnapshotDiff diff;
+    diff.timestamp_ns = BASE_NS + i * 100 * MS;
+    diff.old_sequence = i;
+    diff.new_sequence = i + 1;
+    diff.field_changes.push_back({"AAPL", "bid", make_int(99 + i), make_int(100 + i)});
+    diff.field_changes.push_back({"AAPL", "last", make_double(0), make_double(i / 2.0)});
+    diff.field_changes.push_back({"MSFT", "bid", make_int(501 - i), make_int(500 - i)});
+    return diff;
+}
+
+} // anonymous namespace
+
+class QueryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "/tmp/memglass_test_query_" + std::to_string(getpid());
+    }
+
+    void TearDown() override {
+        ::unlink(path_.c_str());
+        ::unlink((path_ + ".rollup").c_str());
+    }
+
+    // Record n ticks with small blocks so queries span many of them
+    void record(uint64_t n, bool finish = true) {
+        mgdf::BlockWriter writer(512, 1'000'000'000ull);
+        std::string out;
+        writer.write_header(out);
+        for (uint64_t i = 0; i < n; ++i) {
+            writer.write_diff(out, tick(i));
+        }
+        if (finish) {
+            writer.write_end(out);
+        } else {
+            writer.finish_block(out);
+        }
+        std::ofstream(path_, std::ios::binary) << out;
+    }
+
+    // Compact `from` into path_.rollup
+    query::CompactStats compact(const std::string& from, uint64_t interval_ns) {
+        mgdf::MappedFile file;
+        std::string error;
+        EXPECT_TRUE(file.open(from, &error)) << error;
+        std::ostringstream out;
+        query::CompactStats stats;
+        EXPECT_TRUE(query::compact(file, interval_ns, out, &stats, &error)) << error;
+        std::ofstream(path_ + ".rollup", std::ios::binary) << out.str();
+        return stats;
+    }
+
+    query::QueryResult run(const query::Query& q, const std::string& path = {}) {
+        mgdf::MappedFile file;
+        std::string error;
+        EXPECT_TRUE(file.open(path.empty() ? path_ : path, &error)) << error;
+        query::QueryResult result;
+        EXPECT_TRUE(query::run_query(file, q, result, &error)) << error;
+        return result;
+    }
+
+    const query::Series* find(const query::QueryResult& r, const std::string& label,
+                              const std::string& field) {
+        for (const auto& s : r.series) {
+            if (s.label == label && s.field == field) return &s;
+        }
+        return nullptr;
+    }
+
+    std::string path_;
+};
+
+TEST_F(QueryTest, IndexedFile) {
+    record(200);
+
+    mgdf::MappedFile file;
+    ASSERT_TRUE(file.open(path_));
+    EXPECT_EQ(file.version(), mgdf::VERSION_2);
+    EXPECT_TRUE(file.has_index());
+    ASSERT_GT(file.blocks().size(), 1u);
+
+    uint32_t records = 0;
+    uint64_t prev_last = 0;
+    for (const auto& b : file.blocks()) {
+        EXPECT_LE(b.first_ts, b.last_ts);
+        EXPECT_GE(b.first_ts, prev_last);
+        prev_last = b.last_ts;
+        records += b.record_count;
+    }
+    EXPECT_EQ(records, 200u);
+}
+
+TEST_F(QueryTest, ScansFileWithoutIndex) {
+    record(200, false);
+
+    mgdf::MappedFile file;
+    ASSERT_TRUE(file.open(path_));
+    EXPECT_FALSE(file.has_index());
+    EXPECT_GT(file.blocks().size(), 1u);
+
+    query::QueryResult result;
+    ASSERT_TRUE(query::run_query(file, {}, result));
+    EXPECT_EQ(result.stats.records, 200u);
+}
+
+TEST_F(QueryTest, RawValuesAreAbsolute) {
+    record(200);
+
+    query::Query q;
+    q.labels = {"MSFT"};
+    q.threads = 4;
+    auto result = run(q);
+
+    ASSERT_EQ(result.series.size(), 1u);
+    const auto& s = result.series[0];
+    EXPECT_EQ(s.field, "bid");
+    EXPECT_TRUE(s.integer);
+    ASSERT_EQ(s.size(), 200u);
+    for (uint64_t i = 0; i < 200; ++i) {
+        EXPECT_EQ(s.timestamps[i], BASE_NS + i * 100 * MS);
+        EXPECT_EQ(s.ints[i], static_cast<int64_t>(500 - i));
+    }
+}
+
+TEST_F(QueryTest, TimeRangePrunesBlocks) {
+    record(200);
+
+    query::Query q;
+    q.fields = {"last"};
+    q.start_ns = BASE_NS + 5000 * MS;
+    q.end_ns = BASE_NS + 6000 * MS;
+    auto result = run(q);
+
+    ASSERT_EQ(result.series.size(), 1u);
+    const auto& s = result.series[0];
+    EXPECT_FALSE(s.integer);
+    ASSERT_EQ(s.size(), 10u);
+    EXPECT_EQ(s.timestamps.front(), q.start_ns);
+    EXPECT_DOUBLE_EQ(s.doubles.front(), 25.0);
+    EXPECT_LT(result.stats.blocks_in_range, result.stats.blocks_total);
+}
+
+TEST_F(QueryTest, ResampleAggregations) {
+    record(200);
+
+    query::Query q;
+    q.labels = {"AAPL"};
+    q.fields = {"bid"};
+    q.interval_ns = 1000 * MS;
+    q.threads = 3;
+
+    q.aggregation = query::Aggregation::Last;
+    auto last = run(q);
+    ASSERT_EQ(last.series.size(), 1u);
+    ASSERT_EQ(last.series[0].size(), 20u);
+    EXPECT_EQ(last.series[0].timestamps[0], BASE_NS);
+    EXPECT_EQ(last.series[0].ints[0], 109);
+    EXPECT_EQ(last.series[0].ints[19], 299);
+
+    q.aggregation = query::Aggregation::Min;
+    EXPECT_EQ(run(q).series[0].ints[1], 110);
+
+    q.aggregation = query::Aggregation::Max;
+    EXPECT_EQ(run(q).series[0].ints[1], 119);
+
+    q.aggregation = query::Aggregation::Count;
+    EXPECT_EQ(run(q).series[0].ints[5], 10);
+
+    q.aggregation = query::Aggregation::Mean;
+    auto mean = run(q);
+    EXPECT_FALSE(mean.series[0].integer);
+    EXPECT_DOUBLE_EQ(mean.series[0].doubles[0], 104.5);
+}
+
+TEST_F(QueryTest, FillCarriesLastValue) {
+    record(30);  // covers [BASE, BASE + 3s)
+
+    query::Query q;
+    q.labels = {"MSFT"};
+    q.interval_ns = 1000 * MS;
+    q.end_ns = BASE_NS + 6000 * MS;
+    q.fill = true;
+    auto result = run(q);
+
+    ASSERT_EQ(result.series.size(), 1u);
+    const auto& s = result.series[0];
+    ASSERT_EQ(s.size(), 6u);
+    EXPECT_EQ(s.ints[2], 471);
+    EXPECT_EQ(s.ints[5], 471);
+    EXPECT_EQ(s.timestamps[5], BASE_NS + 5000 * MS);
+}
+
+TEST_F(QueryTest, MissingLabelMatchesNothing) {
+    record(50);
+
+    query::Query q;
+    q.labels = {"GOOG"};
+    auto result = run(q);
+    EXPECT_TRUE(result.series.empty());
+    EXPECT_EQ(result.stats.blocks_decoded, 0u);
+}
+
+TEST_F(QueryTest, ReaderDecodesBlocks) {
+    record(50);
+
+    std::ifstream in(path_, std::ios::binary);
+    mgdf::Reader reader(in);
+    ASSERT_TRUE(reader.read_header());
+    EXPECT_EQ(reader.version(), mgdf::VERSION_2);
+
+    uint64_t count = 0;
+    while (auto diff = reader.read_diff()) {
+        auto expected = tick(count);
+        EXPECT_EQ(diff->timestamp_ns, expected.timestamp_ns);
+        EXPECT_EQ(diff->old_sequence, expected.old_sequence);
+        EXPECT_EQ(diff->new_sequence, expected.new_sequence);
+        ASSERT_EQ(diff->field_changes.size(), 3u);
+        EXPECT_EQ(diff->field_changes[2].new_value.data.i64, expected.field_changes[2].new_value.data.i64);
+        count++;
+    }
+    EXPECT_EQ(count, 50u);
+}
+
+TEST(QueryParse, Duration) {
+    uint64_t ns = 0;
+    ASSERT_TRUE(query::parse_duration("100ms", ns));
+    EXPECT_EQ(ns, 100 * MS);
+    ASSERT_TRUE(query::parse_duration("1.5s", ns));
+    EXPECT_EQ(ns, 1500 * MS);
+    ASSERT_TRUE(query::parse_duration("5m", ns));
+    EXPECT_EQ(ns, 300'000 * MS);
+    ASSERT_TRUE(query::parse_duration("250", ns));
+    EXPECT_EQ(ns, 250u);
+    EXPECT_FALSE(query::parse_duration("fast", ns));
+    EXPECT_FALSE(query::parse_duration("3 weeks", ns));
+}
+
+TEST(QueryParse, Time) {
+    uint64_t ns = 0;
+    ASSERT_TRUE(query::parse_time("1700000000000000000", 0, ns));
+    EXPECT_EQ(ns, BASE_NS);
+
+    ASSERT_TRUE(query::parse_time("2023-11-14T22:13:20", 0, ns));
+    EXPECT_EQ(ns, BASE_NS);
+
+    ASSERT_TRUE(query::parse_time("22:13:20.5", BASE_NS, ns));
+    EXPECT_EQ(ns, BASE_NS + 500 * MS);
+
+    ASSERT_TRUE(query::parse_time("09:30", BASE_NS, ns));
+    EXPECT_EQ(ns % 86'400'000'000'000ull, (9 * 60 + 30) * 60'000 * MS);
+
+    EXPECT_FALSE(query::parse_time("25:00", BASE_NS, ns));
+    EXPECT_FALSE(query::parse_time("noon", BASE_NS, ns));
+}
+
+TEST_F(QueryTest, FirstAndSum) {
+    record(200);
+
+    query::Query q;
+    q.labels = {"AAPL"};
+    q.fields = {"bid"};
+    q.interval_ns = 1000 * MS;
+
+    q.aggregation = query::Aggregation::First;
+    auto first = run(q);
+    EXPECT_TRUE(first.series[0].integer);
+    EXPECT_EQ(first.series[0].ints[1], 110);
+
+    q.aggregation = query::Aggregation::Sum;
+    auto sum = run(q);
+    EXPECT_FALSE(sum.series[0].integer);
+    EXPECT_DOUBLE_EQ(sum.series[0].doubles[0], 1045.0);
+}
+
+TEST_F(QueryTest, RollupMatchesRawResample) {
+    record(200);
+    auto stats = compact(path_, 1000 * MS);
+    EXPECT_EQ(stats.records, 200u);
+    EXPECT_EQ(stats.rollups, 60u);  // 20 buckets x 3 series
+
+    mgdf::MappedFile rollup;
+    ASSERT_TRUE(rollup.open(path_ + ".rollup"));
+    EXPECT_TRUE(rollup.is_rollup());
+    EXPECT_EQ(rollup.size(), stats.bytes);
+
+    mgdf::MappedFile raw_file;
+    ASSERT_TRUE(raw_file.open(path_));
+    EXPECT_LT(rollup.size(), raw_file.size());
+
+    const query::Aggregation aggs[] = {
+        query::Aggregation::Last, query::Aggregation::First, query::Aggregation::Min,
+        query::Aggregation::Max, query::Aggregation::Mean, query::Aggregation::Sum,
+        query::Aggregation::Count};
+
+    query::Query q;
+    q.interval_ns = 5000 * MS;
+    q.threads = 2;
+    for (auto agg : aggs) {
+        q.aggregation = agg;
+        auto raw = run(q);
+        auto rolled = run(q, path_ + ".rollup");
+        ASSERT_EQ(raw.series.size(), rolled.series.size());
+        for (size_t k = 0; k < raw.series.size(); ++k) {
+            const auto& a = raw.series[k];
+            const auto& b = rolled.series[k];
+            EXPECT_EQ(a.label, b.label);
+            EXPECT_EQ(a.field, b.field);
+            EXPECT_EQ(a.integer, b.integer);
+            EXPECT_EQ(a.timestamps, b.timestamps);
+            EXPECT_EQ(a.ints, b.ints);
+            ASSERT_EQ(a.doubles.size(), b.doubles.size());
+            for (size_t i = 0; i < a.doubles.size(); ++i) {
+                EXPECT_DOUBLE_EQ(a.doubles[i], b.doubles[i]);
+            }
+        }
+    }
+}
+
+TEST_F(QueryTest, RollupNativeResolution) {
+    record(200);
+    compact(path_, 1000 * MS);
+
+    query::Query q;
+    q.labels = {"MSFT"};
+    auto native = run(q, path_ + ".rollup");
+    ASSERT_EQ(native.series.size(), 1u);
+    ASSERT_EQ(native.series[0].size(), 20u);
+    EXPECT_EQ(native.series[0].timestamps[1], BASE_NS + 1000 * MS);
+    EXPECT_EQ(native.series[0].ints[1], 481);
+
+    // Finer than, or not a multiple of, the stored resolution
+    mgdf::MappedFile file;
+    ASSERT_TRUE(file.open(path_ + ".rollup"));
+    query::QueryResult result;
+    std::string error;
+    q.interval_ns = 1500 * MS;
+    EXPECT_FALSE(query::run_query(file, q, result, &error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST_F(QueryTest, CompactRollupToCoarser) {
+    record(600);
+    compact(path_, 1000 * MS);
+    std::string fine = path_ + ".1s";
+    ASSERT_EQ(::rename((path_ + ".rollup").c_str(), fine.c_str()), 0);
+    auto stats = compact(fine, 10'000 * MS);
+    ::unlink(fine.c_str());
+    EXPECT_EQ(stats.records, 180u);  // 60 buckets x 3 series
+    EXPECT_EQ(stats.rollups, 18u);
+
+    query::Query q;
+    q.labels = {"AAPL"};
+    q.fields = {"bid"};
+    q.interval_ns = 10'000 * MS;
+    q.aggregation = query::Aggregation::Mean;
+    auto raw = run(q);
+    auto rolled = run(q, path_ + ".rollup");
+    ASSERT_EQ(rolled.series.size(), 1u);
+    EXPECT_EQ(raw.series[0].timestamps, rolled.series[0].timestamps);
+    EXPECT_EQ(raw.series[0].doubles, rolled.series[0].doubles);
+
+    // Rollups cannot be split into a finer or misaligned resolution
+    mgdf::MappedFile file;
+    ASSERT_TRUE(file.open(path_ + ".rollup"));
+    std::ostringstream out;
+    std::string error;
+    EXPECT_FALSE(query::compact(file, 15'000 * MS, out, nullptr, &error));
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/mgdf.hpp>
+#include <memglass/recorder.hpp>
+#include <memglass/registry.hpp>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace memglass;
+using namespace std::chrono_literals;
+
+struct Counter {
+    int64_t value;
+    double rate;
+};
+
+class RecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        TypeDescriptor desc;
+        desc.name = "Counter";
+        desc.size = sizeof(Counter);
+        desc.alignment = alignof(Counter);
+        desc.fields = {
+            {"value", offsetof(Counter, value), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"rate", offsetof(Counter, rate), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<Counter>(desc);
+        path_ = "/tmp/memglass_test_recorder_" + std::to_string(getpid()) + ".mgd";
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        memglass::set_paused(false);
+        registry::clear();
+        std::remove(path_.c_str());
+    }
+
+    RecorderOptions options(bool dirty_tracking) const {
+        RecorderOptions opts;
+        opts.output = {SinkFormat::Binary, path_};
+        opts.interval = 5ms;
+        opts.dirty_tracking = dirty_tracking;
+        return opts;
+    }
+
+    // Values of counter.value in the recording, in order
+    std::vector<int64_t> recorded_values() const {
+        std::ifstream in(path_, std::ios::binary);
+        mgdf::Reader reader(in);
+        EXPECT_TRUE(reader.read_header());
+        std::vector<int64_t> values;
+        while (auto diff = reader.read_diff()) {
+            for (const auto& c : diff->field_changes) {
+                if (c.object_label == "counter" && c.field_name == "value") {
+                    values.push_back(c.new_value.as_int64());
+                }
+            }
+        }
+        return values;
+    }
+
+    // Wait for the recorder to finish a pass that started after this call
+    static void wait_for_pass(const Recorder& recorder) {
+        uint64_t seen = recorder.stats().captures;
+        while (recorder.stats().captures < seen + 2) std::this_thread::sleep_for(1ms);
+    }
+
+    std::string path_;
+};
+
+TEST_F(RecorderTest, NeedsASession) {
+    Recorder recorder(options(false));
+    std::string error;
+    EXPECT_FALSE(recorder.start(&error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(recorder.running());
+}
+
+TEST_F(RecorderTest, RecordsChangesFromProducerMemory) {
+    for (bool dirty : {false, true}) {
+        SCOPED_TRACE(dirty ? "dirty tracking" : "full scans");
+        memglass::shutdown();
+        ASSERT_TRUE(memglass::init("test_recorder"));
+        auto* counter = memglass::create<Counter>("counter");
+        ASSERT_NE(counter, nullptr);
+
+        Recorder recorder(options(dirty));
+        ASSERT_TRUE(recorder.start());
+        EXPECT_TRUE(recorder.running());
+
+        for (int64_t v = 1; v <= 3; ++v) {
+            counter->value = v;
+            wait_for_pass(recorder);
+        }
+        recorder.stop();
+        EXPECT_FALSE(recorder.running());
+
+        EXPECT_EQ(recorded_values(), (std::vector<int64_t>{1, 2, 3}));
+        auto st = recorder.stats();
+        EXPECT_GE(st.diffs, 3u);
+        EXPECT_GE(st.changes, 3u);
+        EXPECT_GT(st.bytes_read, 0u);
+        EXPECT_EQ(st.dropped, 0u);
+    }
+}
+
+TEST_F(RecorderTest, SkipsPassesWhilePaused) {
+    ASSERT_TRUE(memglass::init("test_recorder_paused"));
+    auto* counter = memglass::create<Counter>("counter");
+    ASSERT_NE(counter, nullptr);
+
+    Recorder recorder(options(false));
+    ASSERT_TRUE(recorder.start());
+    memglass::set_paused(true);
+    std::this_thread::sleep_for(10ms);  // let a pass in flight finish
+    uint64_t captures = recorder.stats().captures;
+    counter->value = 7;
+    std::this_thread::sleep_for(30ms);
+    EXPECT_EQ(recorder.stats().captures, captures);
+
+    memglass::set_paused(false);
+    wait_for_pass(recorder);
+    recorder.stop();
+    EXPECT_EQ(recorded_values(), (std::vector<int64_t>{7}));
+}
+
+TEST_F(RecorderTest, ReadCapStretchesInterval) {
+    ASSERT_TRUE(memglass::init("test_recorder_cap"));
+    ASSERT_NE(memglass::create<Counter>("counter"), nullptr);
+
+    // 16 bytes per full scan at 320 B/s: one pass per 50ms instead of 5ms
+    RecorderOptions opts = options(false);
+    opts.max_read_bytes_per_sec = 320;
+    Recorder recorder(opts);
+    ASSERT_TRUE(recorder.start());
+    std::this_thread::sleep_for(120ms);
+    recorder.stop();
+
+    auto st = recorder.stats();
+    EXPECT_GE(st.captures, 1u);
+    EXPECT_LE(st.captures, 4u);
+    EXPECT_GT(st.throttled_ns, 0u);
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+
+using namespace memglass;
+using namespace std::string_view_literals;
+
+struct Quote {
+    int64_t bid;
+    int64_t ask;
+    Guarded<double> mid;
+};
+
+struct Fill {
+    uint64_t qty;
+};
+
+struct Desk {
+    int64_t pnl;
+    Quote quote;
+};
+
+struct Ladder {
+    Quote best;
+    Quote levels[2];
+};
+
+class SchemaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        registry::clear();
+        register_quote();
+    }
+
+    void TearDown() override {
+        memglass::shutdown();
+        registry::clear();
+    }
+
+    static void register_quote() {
+        TypeDescriptor desc;
+        desc.name = "Quote";
+        desc.size = sizeof(Quote);
+        desc.alignment = alignof(Quote);
+        desc.fields = {
+            {"bid", offsetof(Quote, bid), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"ask", offsetof(Quote, ask), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"mid", offsetof(Quote, mid), sizeof(double), PrimitiveType::Float64, 0, 0, Atomicity::Seqlock, false},
+        };
+        registry::register_type_for<Quote>(desc);
+    }
+
+    static void register_fill() {
+        TypeDescriptor desc;
+        desc.name = "Fill";
+        desc.size = sizeof(Fill);
+        desc.alignment = alignof(Fill);
+        desc.fields = {
+            {"qty", offsetof(Fill, qty), sizeof(uint64_t), PrimitiveType::UInt64, 0, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<Fill>(desc);
+    }
+
+    // Desk and Ladder embed the Quote registered by SetUp()
+    static void register_nested() {
+        uint32_t quote = registry::get_type_id("Quote");
+
+        TypeDescriptor desk;
+        desk.name = "Desk";
+        desk.size = sizeof(Desk);
+        desk.alignment = alignof(Desk);
+        desk.fields = {
+            {"pnl", offsetof(Desk, pnl), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+            {"quote", offsetof(Desk, quote), sizeof(Quote), PrimitiveType::Unknown, quote, 0, Atomicity::None, false},
+        };
+        registry::register_type_for<Desk>(desk);
+
+        TypeDescriptor ladder;
+        ladder.name = "Ladder";
+        ladder.size = sizeof(Ladder);
+        ladder.alignment = alignof(Ladder);
+        ladder.fields = {
+            {"best", offsetof(Ladder, best), sizeof(Quote), PrimitiveType::Unknown, quote, 0, Atomicity::None, true},
+            {"levels", offsetof(Ladder, levels), sizeof(Quote) * 2, PrimitiveType::Unknown, quote, 2, Atomicity::None, false},
+        };
+        registry::register_type_for<Ladder>(ladder);
+    }
+
+    // Start a producer session holding one Quote
+    static void start(const char* session, int64_t bid) {
+        ASSERT_TRUE(memglass::init(session));
+        auto* q = memglass::create<Quote>("quote");
+        ASSERT_NE(q, nullptr);
+        q->bid = bid;
+    }
+};
+
+TEST_F(SchemaTest, IdenticalSessionsShareSchema) {
+    ObserverOptions options;
+    options.schema_cache = std::make_shared<SchemaCache>();
+
+    // Observers keep their mappings after the producer shuts down
+    start("test_schema_a", 1);
+    Observer a("test_schema_a", options);
+    ASSERT_TRUE(a.connect());
+    memglass::shutdown();
+
+    start("test_schema_b", 2);
+    Observer b("test_schema_b", options);
+    ASSERT_TRUE(b.connect());
+
+    ASSERT_NE(a.schema(), nullptr);
+    EXPECT_EQ(a.schema(), b.schema());
+    EXPECT_EQ(options.schema_cache->misses(), 1u);
+    EXPECT_EQ(options.schema_cache->hits(), 1u);
+    EXPECT_EQ(options.schema_cache->size(), 1u);
+
+    // Shared types, per-session data
+    EXPECT_EQ(a.find("quote")["bid"].as<int64_t>(), 1);
+    EXPECT_EQ(b.find("quote")["bid"].as<int64_t>(), 2);
+}
+
+TEST_F(SchemaTest, DifferentTypesGetOwnSchema) {
+    ObserverOptions options;
+    options.schema_cache = std::make_shared<SchemaCache>();
+
+    start("test_schema_a", 1);
+    Observer a("test_schema_a", options);
+    ASSERT_TRUE(a.connect());
+    memglass::shutdown();
+
+    register_fill();
+    start("test_schema_b", 2);
+    Observer b("test_schema_b", options);
+    ASSERT_TRUE(b.connect());
+
+    EXPECT_NE(a.schema()->fingerprint, b.schema()->fingerprint);
+    EXPECT_EQ(a.types().size(), 1u);
+    EXPECT_EQ(b.types().size(), 2u);
+    EXPECT_EQ(options.schema_cache->size(), 2u);
+
+    // Expired schemas are not kept alive by the cache
+    a.disconnect();
+    EXPECT_EQ(options.schema_cache->size(), 1u);
+}
+
+TEST_F(SchemaTest, CompiledFieldLookup) {
+    start("test_schema_a", 7);
+    Observer obs("test_schema_a");
+    ASSERT_TRUE(obs.connect());
+
+    const ObservedType* type = obs.types().data();
+    ASSERT_NE(type, nullptr);
+    ASSERT_TRUE(type->find_field("ask"));
+    EXPECT_EQ(type->find_field("ask").offset(), offsetof(Quote, ask));
+    EXPECT_FALSE(type->find_field("missing"));
+
+    // Only the Guarded<double> needs validating in a bulk copy
+    ASSERT_EQ(type->guarded_fields.size(), 1u);
+    EXPECT_STREQ(type->guarded_fields[0].entry->name, "mid");
+}
+
+TEST_F(SchemaTest, NestedTypesAreShared) {
+    register_nested();
+    ASSERT_TRUE(memglass::init("test_schema_nested"));
+    auto* desk = memglass::create<Desk>("desk");
+    auto* ladder = memglass::create<Ladder>("ladder");
+    ASSERT_NE(desk, nullptr);
+    ASSERT_NE(ladder, nullptr);
+    desk->quote.ask = 101;
+    ladder->levels[1].bid = 99;
+
+    // Quote's fields are published once, not once per embedding
+    const TelemetryHeader* header = memglass::detail::get_context()->header();
+    EXPECT_EQ(header->field_count.load(), 7u);
+
+    Observer obs("test_schema_nested");
+    ASSERT_TRUE(obs.connect());
+    const ObservedType* quote = obs.get_type(registry::get_type_id("Quote"));
+    const ObservedType* desk_type = obs.get_type(registry::get_type_id("Desk"));
+    const ObservedType* ladder_type = obs.get_type(registry::get_type_id("Ladder"));
+    ASSERT_NE(quote, nullptr);
+    ASSERT_NE(desk_type, nullptr);
+    ASSERT_NE(ladder_type, nullptr);
+
+    // Parents keep the published field and point at the one Quote
+    ASSERT_EQ(desk_type->fields.size(), 2u);
+    EXPECT_EQ(desk_type->fields[1].type_id, quote->type_id);
+    EXPECT_TRUE(desk_type->fields[1].flags & static_cast<uint32_t>(FieldFlags::IsNested));
+    EXPECT_EQ(desk_type->nested_types[0], nullptr);
+    EXPECT_EQ(desk_type->nested_types[1], quote);
+    ASSERT_EQ(ladder_type->fields.size(), 2u);
+    EXPECT_EQ(ladder_type->nested_types[0], quote);
+    EXPECT_EQ(ladder_type->nested_types[1], quote);
+
+    // Paths resolve to Quote's own entries, rebased into the parent
+    FieldRef ask = desk_type->find_field("quote.ask");
+    ASSERT_TRUE(ask);
+    EXPECT_EQ(ask.entry, &quote->fields[1]);
+    EXPECT_EQ(ask.offset(), offsetof(Desk, quote) + offsetof(Quote, ask));
+    FieldRef bid = ladder_type->find_field("levels[1].bid");
+    ASSERT_TRUE(bid);
+    EXPECT_EQ(bid.entry, &quote->fields[0]);
+    EXPECT_EQ(bid.offset(), offsetof(Ladder, levels) + sizeof(Quote) + offsetof(Quote, bid));
+    EXPECT_TRUE(ladder_type->find_field("best.mid"));
+    EXPECT_FALSE(ladder_type->find_field("levels[2].bid"));
+    EXPECT_FALSE(ladder_type->find_field("levels.bid"));
+    EXPECT_FALSE(ladder_type->find_field("best[0].bid"));
+    EXPECT_FALSE(desk_type->find_field("quote.missing"));
+
+    ASSERT_EQ(desk_type->guarded_fields.size(), 1u);
+    EXPECT_EQ(desk_type->guarded_fields[0].entry, &quote->fields[2]);
+    EXPECT_EQ(desk_type->guarded_fields[0].offset(), offsetof(Desk, quote) + offsetof(Quote, mid));
+    EXPECT_EQ(ladder_type->guarded_fields.size(), 3u);
+
+    // Leaves are enumerated on demand, array elements one by one
+    std::vector<std::string> leaves;
+    ladder_type->for_each_leaf([&](std::string_view path, const FieldRef& field) {
+        leaves.emplace_back(path);
+        EXPECT_EQ(ladder_type->find_field(path).offset(), field.offset());
+    });
+    std::vector<std::string> expected = {
+        "best.bid", "best.ask", "best.mid", "levels[0].bid", "levels[0].ask", "levels[0].mid",
+        "levels[1].bid", "levels[1].ask", "levels[1].mid",
+    };
+    EXPECT_EQ(leaves, expected);
+
+    auto desk_view = obs.find("desk");
+    auto ladder_view = obs.find("ladder");
+    ASSERT_TRUE(desk_view);
+    ASSERT_TRUE(ladder_view);
+    EXPECT_EQ(desk_view["quote.ask"].as<int64_t>(), 101);
+    EXPECT_EQ(desk_view["quote"]["ask"sv].as<int64_t>(), 101);
+    EXPECT_EQ(ladder_view["levels[1].bid"].as<int64_t>(), 99);
+    EXPECT_EQ(ladder_view["levels"][size_t{1}]["bid"sv].as<int64_t>(), 99);
+}
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <memglass/detail/seqlock.hpp>
 #include <thread>
+#include <vector>
 
 using namespace memglass;
 
@@ -168,6 +169,50 @@ TEST_F(LockedTest, ConcurrentAccess) {
     EXPECT_EQ(result, num_threads * increments_per_thread);
 }
 
+TEST_F(LockedTest, UnlockedReadsAreNeverTorn) {
+    Locked<TestData> locked;
+    std::atomic<bool> stop{false};
+    std::atomic<int> inconsistencies{0};
+    std::atomic<int> reads{0};
+    std::atomic<int> started{0};
+
+    // Readers never take the lock, like a read-only observer
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            bool first = true;
+            while (!stop.load(std::memory_order_relaxed)) {
+                TestData result = locked.read_unlocked();
+                if (result.a != result.b || static_cast<int64_t>(result.a) != result.c ||
+                    static_cast<double>(result.c) != result.d) {
+                    inconsistencies++;
+                }
+                reads++;
+                if (first) {
+                    started++;
+                    first = false;
+                }
+            }
+        });
+    }
+
+    // Don't let the writer finish before the readers get scheduled, and keep
+    // it writing until they have read a fair amount while it runs
+    while (started.load() < 4) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 100000 || reads.load(std::memory_order_relaxed) < 40000; ++i) {
+        locked.write(TestData{i, i, static_cast<int64_t>(i), static_cast<double>(i)});
+    }
+    stop = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(inconsistencies, 0) << "Found " << inconsistencies << " torn reads!";
+}
+
 TEST_F(LockedTest, ConcurrentReadersWriters) {
     Locked<TestData> locked;
     std::atomic<bool> stop{false};
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <memglass/sink.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace memglass;
+
+namespace {
+
+FieldValue make_int(int64_t v) {
+    FieldValue fv;
+    fv.type = PrimitiveType::Int64;
+    fv.data.i64 = v;
+    return fv;
+}
+
+FieldValue make_double(double v) {
+    FieldValue fv;
+    fv.type = PrimitiveType::Float64;
+    fv.data.f64 = v;
+    return fv;
+}
+
+SnapshotDiff sample_diff() {
+    SnapshotDiff diff;
+    diff.timestamp_ns = 1700000000000000000ull;
+    diff.old_sequence = 4;
+    diff.new_sequence = 5;
+    diff.added_objects.push_back("order_1");
+    diff.field_changes.push_back({"AAPL", "bid_price", make_int(15000), make_int(15025)});
+    diff.field_changes.push_back({"AAPL", "last", make_double(1.5), make_double(2.25)});
+    diff.field_changes.push_back({"MSFT", "bid_price", make_int(40000), make_int(39990)});
+    return diff;
+}
+
+} // anonymous namespace
+
+class SinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = "/tmp/memglass_test_sink_" + std::to_string(getpid());
+    }
+
+    void TearDown() override {
+        ::unlink(path_.c_str());
+    }
+
+    std::unique_ptr<DiffSink> open_sink(SinkFormat format) {
+        std::string error;
+        auto sink = make_sink({format, path_}, "trading", &error);
+        EXPECT_NE(sink, nullptr) << error;
+        return sink;
+    }
+
+    std::string contents() const {
+        std::ifstream in(path_, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    std::string path_;
+};
+
+TEST_F(SinkTest, ParseSpec) {
+    SinkSpec spec;
+    ASSERT_TRUE(parse_sink_spec("influx:unix:/run/telegraf.sock", spec));
+    EXPECT_EQ(spec.format, SinkFormat::LineProtocol);
+    EXPECT_EQ(spec.target, "unix:/run/telegraf.sock");
+
+    ASSERT_TRUE(parse_sink_spec("csv", spec));
+    EXPECT_EQ(spec.format, SinkFormat::Csv);
+    EXPECT_EQ(spec.target, "-");
+
+    ASSERT_TRUE(parse_sink_spec("rollup-1m:day.1m.mgd", spec));
+    EXPECT_EQ(spec.format, SinkFormat::Rollup);
+    EXPECT_EQ(spec.rollup_interval_ns, 60'000'000'000ull);
+    EXPECT_EQ(spec.target, "day.1m.mgd");
+
+    EXPECT_FALSE(parse_sink_spec("xml:out.xml", spec));
+    EXPECT_FALSE(parse_sink_spec("csv:", spec));
+    EXPECT_FALSE(parse_sink_spec("rollup-0s:out.mgd", spec));
+}
+
+TEST_F(SinkTest, TextFormat) {
+    auto sink = open_sink(SinkFormat::Text);
+    sink->write(sample_diff());
+    sink->close();
+
+    EXPECT_EQ(contents(),
+              "@1700000000000000000 seq:4->5 +objs:[order_1]\n"
+              "  AAPL.bid_price: 15000 -> 15025\n"
+              "  AAPL.last: 1.5 -> 2.25\n"
+              "  MSFT.bid_price: 40000 -> 39990\n");
+}
+
+TEST_F(SinkTest, CsvColumnOrder) {
+    auto sink = open_sink(SinkFormat::Csv);
+    sink->write(sample_diff());
+    sink->write(sample_diff());
+    sink->close();
+
+    std::istringstream lines(contents());
+    std::string line;
+    std::getline(lines, line);
+    EXPECT_EQ(line, "timestamp_ns,sequence,event,object,field,type,old,new");
+    std::getline(lines, line);
+    EXPECT_EQ(line, "1700000000000000000,5,added,order_1,,,,");
+    std::getline(lines, line);
+    EXPECT_EQ(line, "1700000000000000000,5,change,AAPL,bid_price,int64,15000,15025");
+
+    // Header is written once per stream
+    size_t headers = 0;
+    std::istringstream all(contents());
+    while (std::getline(all, line)) {
+        if (line.rfind("timestamp_ns", 0) == 0) ++headers;
+    }
+    EXPECT_EQ(headers, 1u);
+}
+
+TEST_F(SinkTest, LineProtocolGroupsByObject) {
+    auto sink = open_sink(SinkFormat::LineProtocol);
+    sink->write(sample_diff());
+    sink->close();
+
+    EXPECT_EQ(contents(),
+              "memglass_events,session=trading,object=order_1 event=\"added\" 1700000000000000000\n"
+              "memglass,session=trading,object=AAPL bid_price=15025i,last=2.25 1700000000000000000\n"
+              "memglass,session=trading,object=MSFT bid_price=39990i 1700000000000000000\n");
+}
+
+TEST_F(SinkTest, NdjsonOneRecordPerChange) {
+    auto sink = open_sink(SinkFormat::Ndjson);
+    sink->write(sample_diff());
+    sink->close();
+
+    std::istringstream lines(contents());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(lines, line)) {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_EQ(line.back(), '}');
+        ++count;
+    }
+    EXPECT_EQ(count, 4u);
+    EXPECT_NE(contents().find("\"obj\":\"MSFT\",\"field\":\"bid_price\",\"type\":\"int64\","
+                              "\"old\":40000,\"new\":39990"), std::string::npos);
+}
+
+TEST(JsonEscape, QuotesBackslashesAndControls) {
+    std::string out;
+    append_json_escaped(out, "a\"b\\c\nd\x01");
+    EXPECT_EQ(out, "a\\\"b\\\\c\\nd\\u0001");
+}
+
+TEST(CsvField, QuotesOnlyWhenNeeded) {
+    std::string out;
+    append_csv_field(out, "AAPL");
+    out += ',';
+    append_csv_field(out, "a,\"b\"");
+    EXPECT_EQ(out, "AAPL,\"a,\"\"b\"\"\"");
+}
+
+TEST_F(SinkTest, MgdfRoundTrip) {
+    auto sink = open_sink(SinkFormat::Binary);
+    auto diff = sample_diff();
+    sink->write(diff);
+    diff.timestamp_ns += 1000;
+    sink->write(diff);
+    sink->close();
+
+    std::ifstream in(path_, std::ios::binary);
+    mgdf::Reader reader(in);
+    ASSERT_TRUE(reader.read_header());
+
+    auto first = reader.read_diff();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->timestamp_ns, 1700000000000000000ull);
+    EXPECT_EQ(first->new_sequence, 5u);
+    ASSERT_EQ(first->added_objects.size(), 1u);
+    ASSERT_EQ(first->field_changes.size(), 3u);
+    EXPECT_EQ(first->field_changes[1].new_value.data.f64, 2.25);
+
+    auto second = reader.read_diff();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->timestamp_ns, 1700000000000000000ull + 1000);
+
+    EXPECT_FALSE(reader.read_diff().has_value());
+}
+
+TEST_F(SinkTest, AsyncFanOutSharesDiff) {
+    std::string path2 = path_ + "_b";
+
+    std::string error;
+    AsyncSink a(make_sink({SinkFormat::Csv, path_}, "trading", &error));
+    AsyncSink b(make_sink({SinkFormat::Ndjson, path2}, "trading", &error));
+
+    auto diff = std::make_shared<const SnapshotDiff>(sample_diff());
+    for (int i = 0; i < 100; ++i) {
+        a.submit(diff);
+        b.submit(diff);
+    }
+    a.close();
+    b.close();
+
+    EXPECT_EQ(a.dropped(), 0u);
+    EXPECT_EQ(b.dropped(), 0u);
+
+    std::istringstream lines(contents());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(lines, line)) ++count;
+    EXPECT_EQ(count, 1u + 100u * 4u);
+
+    std::ifstream in(path2);
+    count = 0;
+    while (std::getline(in, line)) ++count;
+    EXPECT_EQ(count, 100u * 4u);
+    ::unlink(path2.c_str());
+}
+
+TEST_F(SinkTest, AsyncDropsWhenQueueFull) {
+    AsyncSink sink(make_sink({SinkFormat::Text, path_}, "trading"), 1);
+    auto diff = std::make_shared<const SnapshotDiff>(sample_diff());
+    for (int i = 0; i < 10000; ++i) {
+        sink.submit(diff);
+    }
+    sink.close();
+
+    // Every diff is either written (4 lines each) or counted as dropped
+    std::istringstream lines(contents());
+    std::string line;
+    uint64_t count = 0;
+    while (std::getline(lines, line)) ++count;
+    EXPECT_EQ(count, (10000u - sink.dropped()) * 4u);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <memglass/memglass.hpp>
+#include <memglass/observer.hpp>
+#include <memglass/registry.hpp>
+#include <memglass/stats.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+using namespace memglass;
+
+namespace {
+
+constexpr uint64_t MS = 1'000'000;
+constexpr uint64_t T0 = 1'700'000'000'000'000'000ull;  // a bucket boundary
+
+} // anonymous namespace
+
+TEST(StatsTest, EwmaHalfLife) {
+    Ewma e;
+    e.set_half_life(1);
+    e.update(0);
+    EXPECT_EQ(e.value, 0);
+    e.update(1);
+    EXPECT_DOUBLE_EQ(e.value, 0.5);
+    e.update(1);
+    EXPECT_DOUBLE_EQ(e.value, 0.75);
+    EXPECT_EQ(e.count, 3u);
+
+    // The first sample seeds the average
+    Ewma f;
+    f.update(42);
+    EXPECT_EQ(f.value, 42);
+}
+
+TEST(StatsTest, TimeEwmaWeighsByDuration) {
+    TimeEwma e;
+    e.half_life_ns = 1000 * MS;
+    e.update(0, T0);
+    e.update(1, T0 + 1000 * MS);
+    EXPECT_DOUBLE_EQ(e.value, 0.0);  // the level was 0 for that second
+
+    e.tick(T0 + 2000 * MS);
+    EXPECT_DOUBLE_EQ(e.value, 0.5);
+    e.tick(T0 + 3000 * MS);
+    EXPECT_DOUBLE_EQ(e.value, 0.75);
+
+    // Samples at the same instant only replace the level
+    e.update(5, T0 + 3000 * MS);
+    EXPECT_DOUBLE_EQ(e.value, 0.75);
+    EXPECT_EQ(e.count, 3u);
+}
+
+TEST(StatsTest, WindowStatsSlidesByBucket) {
+    WindowStats<4> w;
+    w.set_bucket_ns(100 * MS);
+    EXPECT_EQ(w.window_ns, 400 * MS);
+    EXPECT_TRUE(std::isnan(w.mean));
+
+    w.update(10, T0);
+    w.update(20, T0 + 50 * MS);
+    w.update(-5, T0 + 150 * MS);
+    w.update(7, T0 + 350 * MS);
+    EXPECT_EQ(w.count, 4u);
+    EXPECT_DOUBLE_EQ(w.sum, 32);
+    EXPECT_DOUBLE_EQ(w.mean, 8);
+    EXPECT_EQ(w.min, -5);
+    EXPECT_EQ(w.max, 20);
+
+    // The first bucket (10, 20) leaves the window whole
+    w.update(1, T0 + 400 * MS);
+    EXPECT_EQ(w.count, 3u);
+    EXPECT_DOUBLE_EQ(w.mean, 1);
+    EXPECT_EQ(w.min, -5);
+    EXPECT_EQ(w.max, 7);
+
+    // Samples from the past land in the current bucket
+    w.update(3, T0 + 10 * MS);
+    EXPECT_EQ(w.count, 4u);
+
+    // Idle: tick drains the window
+    w.tick(T0 + 600 * MS);
+    EXPECT_EQ(w.count, 3u);  // 7, then 1 and 3
+    EXPECT_EQ(w.min, 1);
+    w.tick(T0 + 10'000 * MS);
+    EXPECT_EQ(w.count, 0u);
+    EXPECT_TRUE(std::isnan(w.mean));
+    EXPECT_TRUE(std::isnan(w.min));
+}
+
+TEST(StatsTest, RateMeter) {
+    RateMeter<10> r;
+    r.set_bucket_ns(100 * MS);
+
+    // 1000 events per second for two seconds
+    for (uint64_t t = 0; t < 2000; ++t) {
+        r.add(1, T0 + t * MS);
+    }
+    EXPECT_EQ(r.total, 2000u);
+    EXPECT_NEAR(r.rate, 1000, 10);
+
+    // Younger than the window: divides by the time since the first add
+    RateMeter<10> young;
+    young.set_bucket_ns(100 * MS);
+    for (uint64_t t = 0; t <= 200; ++t) {
+        young.add(1, T0 + t * MS);
+    }
+    EXPECT_NEAR(young.rate, 1000, 10);
+
+    // Idle for a whole window
+    r.tick(T0 + 5000 * MS);
+    EXPECT_EQ(r.rate, 0);
+    EXPECT_EQ(r.total, 2000u);
+}
+
+struct Engine {
+    int64_t pnl;
+    Ewma latency;
+    WindowStats<10> spread;
+    RateMeter<10> orders;
+};
+
+TEST(StatsTest, ObservedAsFlatFields) {
+    registry::clear();
+    TypeDescriptor desc;
+    desc.name = "Engine";
+    desc.size = sizeof(Engine);
+    desc.alignment = alignof(Engine);
+    desc.fields = {
+        {"pnl", offsetof(Engine, pnl), sizeof(int64_t), PrimitiveType::Int64, 0, 0, Atomicity::None, false},
+    };
+    Ewma::describe(desc, "latency", offsetof(Engine, latency));
+    WindowStats<10>::describe(desc, "spread", offsetof(Engine, spread));
+    RateMeter<10>::describe(desc, "orders", offsetof(Engine, orders));
+    registry::register_type_for<Engine>(desc);
+
+    ASSERT_TRUE(memglass::init("test_stats"));
+    Engine* engine = memglass::create<Engine>("engine");
+    ASSERT_NE(engine, nullptr);
+    engine->latency.update(250);
+    engine->spread.update(2, T0);
+    engine->spread.update(4, T0 + MS);
+    engine->orders.add(3, T0);
+
+    Observer obs("test_stats");
+    ASSERT_TRUE(obs.connect());
+    auto view = obs.find("engine");
+    ASSERT_TRUE(view);
+    EXPECT_EQ(view["latency.value"].as<double>(), 250);
+    EXPECT_EQ(view["latency.count"].as<uint64_t>(), 1u);
+    EXPECT_EQ(view["latency.half_life"].as<double>(), 16);
+    EXPECT_EQ(view["spread.count"].as<uint64_t>(), 2u);
+    EXPECT_EQ(view["spread.mean"].as<double>(), 3);
+    EXPECT_EQ(view["spread.max"].as<double>(), 4);
+    EXPECT_EQ(view["spread.window_ns"].as<uint64_t>(), 1000 * MS);
+    EXPECT_EQ(view["orders.total"].as<uint64_t>(), 3u);
+    EXPECT_EQ(view["spread.max"].info()->atomicity, Atomicity::Atomic);
+
+    memglass::shutdown();
+    registry::clear();
+}
@@ -1,692 +1,73 @@
 // memglass-diff: Snapshot diff tool for memglass sessions
 // Takes periodic snapshots and outputs diffs (changed fields only)
-// Supports both text/JSON and compact binary output formats
+// Diffs fan out to one or more sinks (text, JSON, CSV, line protocol, NDJSON, binary)
+// Compare mode reports fields that differ between two live sessions
+// CDC mode records every logged store of tracked fields instead of sampling
 
 #include <memglass/observer.hpp>
+#include <memglass/bulk.hpp>
+#include <memglass/cdc.hpp>
+#include <memglass/compare.hpp>
+#include <memglass/diff.hpp>
+#include <memglass/dirty.hpp>
+#include <memglass/events.hpp>
+#include <memglass/mgdf.hpp>
+#include <memglass/sink.hpp>
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <csignal>
 #include <chrono>
-#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
-#include <optional>
 #include <cstdint>
 
+using memglass::Snapshot;
+using memglass::SnapshotDiff;
+using memglass::SinkSpec;
+
 static volatile bool g_running = true;
 
 void signal_handler(int) {
     g_running = false;
 }
 
-// ============================================================================
-// Value storage for comparison
-// ============================================================================
-
-// Union-like storage for field values
-struct FieldValue {
-    memglass::PrimitiveType type = memglass::PrimitiveType::Unknown;
-    memglass::Atomicity atomicity = memglass::Atomicity::None;
-
-    union {
-        bool b;
-        int8_t i8;
-        uint8_t u8;
-        int16_t i16;
-        uint16_t u16;
-        int32_t i32;
-        uint32_t u32;
-        int64_t i64;
-        uint64_t u64;
-        float f32;
-        double f64;
-        char c;
-    } data;
-
-    bool operator==(const FieldValue& other) const {
-        if (type != other.type) return false;
-        switch (type) {
-            case memglass::PrimitiveType::Bool: return data.b == other.data.b;
-            case memglass::PrimitiveType::Int8: return data.i8 == other.data.i8;
-            case memglass::PrimitiveType::UInt8: return data.u8 == other.data.u8;
-            case memglass::PrimitiveType::Int16: return data.i16 == other.data.i16;
-            case memglass::PrimitiveType::UInt16: return data.u16 == other.data.u16;
-            case memglass::PrimitiveType::Int32: return data.i32 == other.data.i32;
-            case memglass::PrimitiveType::UInt32: return data.u32 == other.data.u32;
-            case memglass::PrimitiveType::Int64: return data.i64 == other.data.i64;
-            case memglass::PrimitiveType::UInt64: return data.u64 == other.data.u64;
-            case memglass::PrimitiveType::Float32: return data.f32 == other.data.f32;
-            case memglass::PrimitiveType::Float64: return data.f64 == other.data.f64;
-            case memglass::PrimitiveType::Char: return data.c == other.data.c;
-            default: return true;
-        }
-    }
-
-    bool operator!=(const FieldValue& other) const { return !(*this == other); }
-
-    // For delta encoding in binary format
-    int64_t as_int64() const {
-        switch (type) {
-            case memglass::PrimitiveType::Bool: return data.b ? 1 : 0;
-            case memglass::PrimitiveType::Int8: return data.i8;
-            case memglass::PrimitiveType::UInt8: return data.u8;
-            case memglass::PrimitiveType::Int16: return data.i16;
-            case memglass::PrimitiveType::UInt16: return data.u16;
-            case memglass::PrimitiveType::Int32: return data.i32;
-            case memglass::PrimitiveType::UInt32: return data.u32;
-            case memglass::PrimitiveType::Int64: return data.i64;
-            case memglass::PrimitiveType::UInt64: return static_cast<int64_t>(data.u64);
-            case memglass::PrimitiveType::Char: return data.c;
-            default: return 0;
-        }
-    }
-
-    std::string to_string() const {
-        switch (type) {
-            case memglass::PrimitiveType::Bool: return data.b ? "true" : "false";
-            case memglass::PrimitiveType::Int8: return std::to_string(data.i8);
-            case memglass::PrimitiveType::UInt8: return std::to_string(data.u8);
-            case memglass::PrimitiveType::Int16: return std::to_string(data.i16);
-            case memglass::PrimitiveType::UInt16: return std::to_string(data.u16);
-            case memglass::PrimitiveType::Int32: return std::to_string(data.i32);
-            case memglass::PrimitiveType::UInt32: return std::to_string(data.u32);
-            case memglass::PrimitiveType::Int64: return std::to_string(data.i64);
-            case memglass::PrimitiveType::UInt64: return std::to_string(data.u64);
-            case memglass::PrimitiveType::Float32: return fmt::format("{:.6g}", data.f32);
-            case memglass::PrimitiveType::Float64: return fmt::format("{:.6g}", data.f64);
-            case memglass::PrimitiveType::Char: return fmt::format("'{}'", data.c);
-            default: return "?";
-        }
-    }
-
-    std::string to_json() const {
-        switch (type) {
-            case memglass::PrimitiveType::Bool: return data.b ? "true" : "false";
-            case memglass::PrimitiveType::Int8: return std::to_string(data.i8);
-            case memglass::PrimitiveType::UInt8: return std::to_string(data.u8);
-            case memglass::PrimitiveType::Int16: return std::to_string(data.i16);
-            case memglass::PrimitiveType::UInt16: return std::to_string(data.u16);
-            case memglass::PrimitiveType::Int32: return std::to_string(data.i32);
-            case memglass::PrimitiveType::UInt32: return std::to_string(data.u32);
-            case memglass::PrimitiveType::Int64: return std::to_string(data.i64);
-            case memglass::PrimitiveType::UInt64: return std::to_string(data.u64);
-            case memglass::PrimitiveType::Float32: return fmt::format("{:.6g}", data.f32);
-            case memglass::PrimitiveType::Float64: return fmt::format("{:.6g}", data.f64);
-            case memglass::PrimitiveType::Char: return fmt::format("\"{}\"", data.c);
-            default: return "null";
-        }
-    }
-};
-
-FieldValue read_field_value(const memglass::FieldProxy& field) {
-    FieldValue v;
-    auto* info = field.info();
-    if (!info) return v;
-
-    v.type = static_cast<memglass::PrimitiveType>(info->type_id);
-    v.atomicity = info->atomicity;
-
-    switch (v.type) {
-        case memglass::PrimitiveType::Bool: v.data.b = field.as<bool>(); break;
-        case memglass::PrimitiveType::Int8: v.data.i8 = field.as<int8_t>(); break;
-        case memglass::PrimitiveType::UInt8: v.data.u8 = field.as<uint8_t>(); break;
-        case memglass::PrimitiveType::Int16: v.data.i16 = field.as<int16_t>(); break;
-        case memglass::PrimitiveType::UInt16: v.data.u16 = field.as<uint16_t>(); break;
-        case memglass::PrimitiveType::Int32: v.data.i32 = field.as<int32_t>(); break;
-        case memglass::PrimitiveType::UInt32: v.data.u32 = field.as<uint32_t>(); break;
-        case memglass::PrimitiveType::Int64: v.data.i64 = field.as<int64_t>(); break;
-        case memglass::PrimitiveType::UInt64: v.data.u64 = field.as<uint64_t>(); break;
-        case memglass::PrimitiveType::Float32: v.data.f32 = field.as<float>(); break;
-        case memglass::PrimitiveType::Float64: v.data.f64 = field.as<double>(); break;
-        case memglass::PrimitiveType::Char: v.data.c = field.as<char>(); break;
-        default: break;
-    }
-    return v;
-}
-
-// ============================================================================
-// Snapshot storage
-// ============================================================================
-
-struct ObjectSnapshot {
-    std::string label;
-    std::string type_name;
-    std::map<std::string, FieldValue> fields;  // field_name -> value
-};
-
-struct Snapshot {
-    uint64_t timestamp_ns;  // nanoseconds since epoch
-    uint64_t sequence;
-    uint64_t pid;
-    std::map<std::string, ObjectSnapshot> objects;  // label -> snapshot
-};
-
-Snapshot take_snapshot(memglass::Observer& obs) {
-    Snapshot snap;
-    snap.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()
-    ).count();
-    snap.sequence = obs.sequence();
-    snap.pid = obs.producer_pid();
-
-    obs.refresh();
-
-    const auto& types = obs.types();
-    for (const auto& obj : obs.objects()) {
-        ObjectSnapshot os;
-        os.label = obj.label;
-        os.type_name = obj.type_name;
-
-        // Find type info
-        const memglass::ObservedType* type_info = nullptr;
-        for (const auto& t : types) {
-            if (t.name == obj.type_name) {
-                type_info = &t;
-                break;
-            }
-        }
-
-        if (type_info) {
-            auto view = obs.get(obj);
-            if (view) {
-                for (const auto& field : type_info->fields) {
-                    auto fv = view[field.name];
-                    if (fv) {
-                        os.fields[field.name] = read_field_value(fv);
-                    }
-                }
-            }
-        }
-
-        snap.objects[obj.label] = std::move(os);
-    }
-
-    return snap;
-}
-
-// ============================================================================
-// Diff computation
-// ============================================================================
-
-struct FieldChange {
-    std::string object_label;
-    std::string field_name;
-    FieldValue old_value;
-    FieldValue new_value;
-};
-
-struct SnapshotDiff {
-    uint64_t timestamp_ns;
-    uint64_t old_sequence;
-    uint64_t new_sequence;
-    std::vector<std::string> added_objects;
-    std::vector<std::string> removed_objects;
-    std::vector<FieldChange> field_changes;
-
-    bool empty() const {
-        return added_objects.empty() && removed_objects.empty() && field_changes.empty();
-    }
-};
-
-SnapshotDiff compute_diff(const Snapshot& old_snap, const Snapshot& new_snap) {
-    SnapshotDiff diff;
-    diff.timestamp_ns = new_snap.timestamp_ns;
-    diff.old_sequence = old_snap.sequence;
-    diff.new_sequence = new_snap.sequence;
-
-    // Find added and removed objects
-    for (const auto& [label, obj] : new_snap.objects) {
-        if (old_snap.objects.find(label) == old_snap.objects.end()) {
-            diff.added_objects.push_back(label);
-        }
-    }
-    for (const auto& [label, obj] : old_snap.objects) {
-        if (new_snap.objects.find(label) == new_snap.objects.end()) {
-            diff.removed_objects.push_back(label);
-        }
-    }
-
-    // Find field changes in existing objects
-    for (const auto& [label, new_obj] : new_snap.objects) {
-        auto old_it = old_snap.objects.find(label);
-        if (old_it == old_snap.objects.end()) continue;  // new object, skip
-
-        const auto& old_obj = old_it->second;
-
-        for (const auto& [field_name, new_value] : new_obj.fields) {
-            auto old_field_it = old_obj.fields.find(field_name);
-            if (old_field_it == old_obj.fields.end()) {
-                // New field (shouldn't happen normally)
-                FieldChange change;
-                change.object_label = label;
-                change.field_name = field_name;
-                change.new_value = new_value;
-                diff.field_changes.push_back(change);
-            } else if (old_field_it->second != new_value) {
-                // Changed field
-                FieldChange change;
-                change.object_label = label;
-                change.field_name = field_name;
-                change.old_value = old_field_it->second;
-                change.new_value = new_value;
-                diff.field_changes.push_back(change);
-            }
-        }
-    }
-
-    return diff;
-}
-
-// ============================================================================
-// Text/JSON output format
-// ============================================================================
-
-std::string json_escape(const std::string& s) {
-    std::string result;
-    result.reserve(s.size() + 10);
-    for (char c : s) {
-        switch (c) {
-            case '"': result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c; break;
-        }
-    }
-    return result;
-}
-
-void write_diff_json(std::ostream& out, const SnapshotDiff& diff, bool pretty = false) {
-    const char* nl = pretty ? "\n" : "";
-    const char* sp = pretty ? "  " : "";
-
-    out << "{" << nl;
-    out << sp << "\"timestamp_ns\":" << diff.timestamp_ns << "," << nl;
-    out << sp << "\"old_sequence\":" << diff.old_sequence << "," << nl;
-    out << sp << "\"new_sequence\":" << diff.new_sequence << "," << nl;
-
-    // Added objects
-    out << sp << "\"added\":[";
-    for (size_t i = 0; i < diff.added_objects.size(); ++i) {
-        if (i > 0) out << ",";
-        out << "\"" << json_escape(diff.added_objects[i]) << "\"";
-    }
-    out << "]," << nl;
-
-    // Removed objects
-    out << sp << "\"removed\":[";
-    for (size_t i = 0; i < diff.removed_objects.size(); ++i) {
-        if (i > 0) out << ",";
-        out << "\"" << json_escape(diff.removed_objects[i]) << "\"";
-    }
-    out << "]," << nl;
-
-    // Field changes
-    out << sp << "\"changes\":[";
-    for (size_t i = 0; i < diff.field_changes.size(); ++i) {
-        if (i > 0) out << ",";
-        const auto& c = diff.field_changes[i];
-        out << nl << sp << sp << "{";
-        out << "\"obj\":\"" << json_escape(c.object_label) << "\",";
-        out << "\"field\":\"" << json_escape(c.field_name) << "\",";
-        out << "\"old\":" << c.old_value.to_json() << ",";
-        out << "\"new\":" << c.new_value.to_json();
-        out << "}";
-    }
-    out << nl << sp << "]" << nl;
-    out << "}" << nl;
-}
-
-void write_diff_text(std::ostream& out, const SnapshotDiff& diff) {
-    // Compact human-readable format
-    out << "@" << diff.timestamp_ns << " seq:" << diff.old_sequence << "->" << diff.new_sequence;
-
-    if (!diff.added_objects.empty()) {
-        out << " +objs:[";
-        for (size_t i = 0; i < diff.added_objects.size(); ++i) {
-            if (i > 0) out << ",";
-            out << diff.added_objects[i];
-        }
-        out << "]";
-    }
-
-    if (!diff.removed_objects.empty()) {
-        out << " -objs:[";
-        for (size_t i = 0; i < diff.removed_objects.size(); ++i) {
-            if (i > 0) out << ",";
-            out << diff.removed_objects[i];
-        }
-        out << "]";
-    }
-
-    out << "\n";
-
-    for (const auto& c : diff.field_changes) {
-        out << "  " << c.object_label << "." << c.field_name
-            << ": " << c.old_value.to_string() << " -> " << c.new_value.to_string() << "\n";
-    }
-}
-
-// ============================================================================
-// Binary output format
-// ============================================================================
-
-// Binary format:
-// Header (per file):
-//   Magic: "MGDF" (4 bytes)
-//   Version: uint8 (1)
-//   Flags: uint8 (0 = normal, 1 = with string table)
-//   Reserved: 2 bytes
-//
-// Per diff record:
-//   Record type: uint8 (1 = diff, 0 = end)
-//   Timestamp delta: varint (ns since last record or file start)
-//   Sequence: varint
-//   Num added objects: varint
-//   Num removed objects: varint
-//   Num field changes: varint
-//   For each added/removed: string_id (varint)
-//   For each change:
-//     object_id: varint (index into object list)
-//     field_id: varint (index into field list for that type)
-//     value_delta: varint (for integers) or raw bytes (for floats)
-
-class BinaryWriter {
-public:
-    explicit BinaryWriter(std::ostream& out) : out_(out) {}
-
-    void write_header() {
-        out_.write("MGDF", 4);  // Magic
-        write_u8(1);            // Version
-        write_u8(0);            // Flags
-        write_u8(0);            // Reserved
-        write_u8(0);            // Reserved
-    }
-
-    void write_diff(const SnapshotDiff& diff, uint64_t last_timestamp) {
-        write_u8(1);  // Record type: diff
-
-        // Timestamp delta (can be negative if clock skew, but usually positive)
-        int64_t ts_delta = static_cast<int64_t>(diff.timestamp_ns - last_timestamp);
-        write_varint_signed(ts_delta);
-
-        write_varint(diff.new_sequence);
-        write_varint(diff.added_objects.size());
-        write_varint(diff.removed_objects.size());
-        write_varint(diff.field_changes.size());
-
-        // Added objects (write full strings for now)
-        for (const auto& obj : diff.added_objects) {
-            write_string(obj);
-        }
-
-        // Removed objects
-        for (const auto& obj : diff.removed_objects) {
-            write_string(obj);
-        }
-
-        // Field changes
-        for (const auto& c : diff.field_changes) {
-            write_string(c.object_label);
-            write_string(c.field_name);
-            write_u8(static_cast<uint8_t>(c.new_value.type));
-
-            // For integer types, write delta; for others, write raw value
-            if (is_integer_type(c.new_value.type)) {
-                int64_t delta = c.new_value.as_int64() - c.old_value.as_int64();
-                write_varint_signed(delta);
-            } else {
-                write_raw_value(c.new_value);
-            }
-        }
-    }
-
-    void write_end() {
-        write_u8(0);  // Record type: end
-    }
-
-private:
-    std::ostream& out_;
-
-    void write_u8(uint8_t v) {
-        out_.put(static_cast<char>(v));
-    }
-
-    void write_varint(uint64_t v) {
-        // Standard LEB128 encoding
-        while (v >= 0x80) {
-            out_.put(static_cast<char>((v & 0x7F) | 0x80));
-            v >>= 7;
-        }
-        out_.put(static_cast<char>(v));
-    }
-
-    void write_varint_signed(int64_t v) {
-        // ZigZag encoding then varint
-        uint64_t encoded = (static_cast<uint64_t>(v) << 1) ^ (v >> 63);
-        write_varint(encoded);
-    }
-
-    void write_string(const std::string& s) {
-        write_varint(s.size());
-        out_.write(s.data(), s.size());
-    }
-
-    bool is_integer_type(memglass::PrimitiveType t) {
-        switch (t) {
-            case memglass::PrimitiveType::Bool:
-            case memglass::PrimitiveType::Int8:
-            case memglass::PrimitiveType::UInt8:
-            case memglass::PrimitiveType::Int16:
-            case memglass::PrimitiveType::UInt16:
-            case memglass::PrimitiveType::Int32:
-            case memglass::PrimitiveType::UInt32:
-            case memglass::PrimitiveType::Int64:
-            case memglass::PrimitiveType::UInt64:
-            case memglass::PrimitiveType::Char:
-                return true;
-            default:
-                return false;
-        }
-    }
-
-    void write_raw_value(const FieldValue& v) {
-        switch (v.type) {
-            case memglass::PrimitiveType::Float32:
-                out_.write(reinterpret_cast<const char*>(&v.data.f32), sizeof(float));
-                break;
-            case memglass::PrimitiveType::Float64:
-                out_.write(reinterpret_cast<const char*>(&v.data.f64), sizeof(double));
-                break;
-            default:
-                // For integers, this shouldn't be called
-                write_varint_signed(v.as_int64());
-                break;
-        }
-    }
-};
-
-// ============================================================================
-// Binary reader (for decoding)
-// ============================================================================
-
-class BinaryReader {
-public:
-    explicit BinaryReader(std::istream& in) : in_(in) {}
-
-    bool read_header() {
-        char magic[4];
-        in_.read(magic, 4);
-        if (std::memcmp(magic, "MGDF", 4) != 0) {
-            return false;
-        }
-
-        version_ = read_u8();
-        flags_ = read_u8();
-        read_u8();  // Reserved
-        read_u8();  // Reserved
-
-        return version_ == 1;
-    }
-
-    std::optional<SnapshotDiff> read_diff(uint64_t& last_timestamp) {
-        uint8_t record_type = read_u8();
-        if (record_type == 0 || in_.eof()) {
-            return std::nullopt;
-        }
-
-        SnapshotDiff diff;
-
-        int64_t ts_delta = read_varint_signed();
-        diff.timestamp_ns = last_timestamp + ts_delta;
-        last_timestamp = diff.timestamp_ns;
-
-        diff.new_sequence = read_varint();
-        size_t num_added = read_varint();
-        size_t num_removed = read_varint();
-        size_t num_changes = read_varint();
-
-        for (size_t i = 0; i < num_added; ++i) {
-            diff.added_objects.push_back(read_string());
-        }
-
-        for (size_t i = 0; i < num_removed; ++i) {
-            diff.removed_objects.push_back(read_string());
-        }
-
-        for (size_t i = 0; i < num_changes; ++i) {
-            FieldChange c;
-            c.object_label = read_string();
-            c.field_name = read_string();
-            c.new_value.type = static_cast<memglass::PrimitiveType>(read_u8());
-
-            if (is_integer_type(c.new_value.type)) {
-                int64_t delta = read_varint_signed();
-                // We only have the new value (delta from old)
-                // For display, we'll just show the delta
-                set_int_value(c.new_value, delta);
-            } else {
-                read_raw_value(c.new_value);
-            }
-
-            diff.field_changes.push_back(c);
-        }
-
-        return diff;
-    }
-
-private:
-    std::istream& in_;
-    uint8_t version_ = 0;
-    uint8_t flags_ = 0;
-
-    uint8_t read_u8() {
-        return static_cast<uint8_t>(in_.get());
-    }
-
-    uint64_t read_varint() {
-        uint64_t result = 0;
-        int shift = 0;
-        while (true) {
-            uint8_t b = read_u8();
-            result |= static_cast<uint64_t>(b & 0x7F) << shift;
-            if ((b & 0x80) == 0) break;
-            shift += 7;
-        }
-        return result;
-    }
-
-    int64_t read_varint_signed() {
-        uint64_t encoded = read_varint();
-        return static_cast<int64_t>((encoded >> 1) ^ -(encoded & 1));
-    }
-
-    std::string read_string() {
-        size_t len = read_varint();
-        std::string s(len, '\0');
-        in_.read(&s[0], len);
-        return s;
-    }
-
-    bool is_integer_type(memglass::PrimitiveType t) {
-        switch (t) {
-            case memglass::PrimitiveType::Bool:
-            case memglass::PrimitiveType::Int8:
-            case memglass::PrimitiveType::UInt8:
-            case memglass::PrimitiveType::Int16:
-            case memglass::PrimitiveType::UInt16:
-            case memglass::PrimitiveType::Int32:
-            case memglass::PrimitiveType::UInt32:
-            case memglass::PrimitiveType::Int64:
-            case memglass::PrimitiveType::UInt64:
-            case memglass::PrimitiveType::Char:
-                return true;
-            default:
-                return false;
-        }
-    }
-
-    void set_int_value(FieldValue& v, int64_t val) {
-        switch (v.type) {
-            case memglass::PrimitiveType::Bool: v.data.b = val != 0; break;
-            case memglass::PrimitiveType::Int8: v.data.i8 = static_cast<int8_t>(val); break;
-            case memglass::PrimitiveType::UInt8: v.data.u8 = static_cast<uint8_t>(val); break;
-            case memglass::PrimitiveType::Int16: v.data.i16 = static_cast<int16_t>(val); break;
-            case memglass::PrimitiveType::UInt16: v.data.u16 = static_cast<uint16_t>(val); break;
-            case memglass::PrimitiveType::Int32: v.data.i32 = static_cast<int32_t>(val); break;
-            case memglass::PrimitiveType::UInt32: v.data.u32 = static_cast<uint32_t>(val); break;
-            case memglass::PrimitiveType::Int64: v.data.i64 = val; break;
-            case memglass::PrimitiveType::UInt64: v.data.u64 = static_cast<uint64_t>(val); break;
-            case memglass::PrimitiveType::Char: v.data.c = static_cast<char>(val); break;
-            default: break;
-        }
-    }
-
-    void read_raw_value(FieldValue& v) {
-        switch (v.type) {
-            case memglass::PrimitiveType::Float32:
-                in_.read(reinterpret_cast<char*>(&v.data.f32), sizeof(float));
-                break;
-            case memglass::PrimitiveType::Float64:
-                in_.read(reinterpret_cast<char*>(&v.data.f64), sizeof(double));
-                break;
-            default:
-                set_int_value(v, read_varint_signed());
-                break;
-        }
-    }
-};
-
 // ============================================================================
 // Command-line interface
 // ============================================================================
 
-enum class OutputFormat {
-    Text,
-    Json,
-    JsonPretty,
-    Binary
-};
-
 struct Options {
     std::string session_name;
-    std::string output_file;
-    OutputFormat format = OutputFormat::Text;
+    SinkSpec output;               // -f/-o
+    std::vector<SinkSpec> sinks;  // additional --sink outputs
     uint64_t interval_ms = 1000;
+    bool interval_set = false;
+    bool on_cycle = false;         // capture after each cycle_end()
+    std::string on_mark;           // capture after each mark(name)
+    bool cdc = false;              // drain the change-data-capture log
+    size_t queue_depth = 4096;
     bool skip_empty = true;
+    bool dirty_tracking = false;
+    uint32_t full_scan = 16;       // -d: every n-th tick re-reads everything
+    bool bulk_copy = false;
+    memglass::RegionMapping mapping = memglass::RegionMapping::Populate;
     bool decode_mode = false;
     std::string decode_file;
+    std::string compare_session;   // --compare: session B
+    memglass::CompareOptions compare;
     bool help = false;
 };
 
 void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " [OPTIONS] <session_name>\n"
               << "       " << prog << " --decode <binary_file>\n"
+              << "       " << prog << " --compare <session_b> [OPTIONS] <session_a>\n"
               << "\n"
               << "Snapshot diff tool for memglass sessions.\n"
               << "Takes periodic snapshots and outputs changes (diffs).\n"
@@ -695,19 +76,50 @@ void print_usage(const char* prog) {
               << "  -h, --help              Show this help message\n"
               << "  -i, --interval <ms>     Snapshot interval in milliseconds (default: 1000)\n"
               << "  -o, --output <file>     Write to file instead of stdout\n"
-              << "  -f, --format <fmt>      Output format: text, json, json-pretty, binary\n"
+              << "  -f, --format <fmt>      Output format: text, json, json-pretty, binary,\n"
+              << "                          csv, influx, ndjson, rollup-<dur>\n"
+              << "  -s, --sink <fmt>:<dst>  Add another output (repeatable); dst is a file,\n"
+              << "                          '-' for stdout or unix:<path> for a socket\n"
+              << "  -q, --queue <n>         Per-sink queue depth in diffs (default: 4096)\n"
               << "  -a, --all               Include empty diffs (no changes)\n"
+              << "  -d, --dirty             Only re-read objects on pages the producer wrote\n"
+              << "                          (Linux soft-dirty; falls back to full scans)\n"
+              << "  --full-scan <n>         With -d, re-read everything every n ticks to catch\n"
+              << "                          writes that raced the tracker (default: 16; 0: never)\n"
+              << "  -b, --bulk              Copy objects into a private buffer in one burst per\n"
+              << "                          tick, then decode from the copy\n"
+              << "  -m, --map <mode>        Region mapping: eager, populate (default), lazy\n"
+              << "  --on-cycle              Capture at the next cycle_end() instead of on a\n"
+              << "                          timer; with -i, at most once per interval\n"
+              << "  --on-mark <name>        Capture at the next mark(name), like --on-cycle\n"
+              << "  --cdc                   Record every change of tracked fields from the\n"
+              << "                          producer's CDC log; -i sets the drain period\n"
+              << "                          (default: 10)\n"
               << "  --decode <file>         Decode a binary diff file to text\n"
+              << "  --compare <session>     Report fields that differ from another session\n"
+              << "                          (objects by label, fields by name); text or json\n"
+              << "  -t, --tolerance <tol>   Compare: [<label.field|field>=]<abs> or\n"
+              << "                          <name>=ignore (repeatable; default exact)\n"
               << "\n"
               << "Output Formats:\n"
               << "  text        Compact human-readable format (default)\n"
               << "  json        One JSON object per line (JSONL)\n"
               << "  json-pretty Pretty-printed JSON\n"
               << "  binary      Compact binary with varint/delta encoding\n"
+              << "  csv         timestamp_ns,sequence,event,object,field,type,old,new\n"
+              << "  influx      InfluxDB line protocol\n"
+              << "  ndjson      One JSON record per change\n"
+              << "  rollup-<d>  Per-field first/last/min/max/count/sum every <d>\n"
+              << "              (e.g. rollup-1s); read with memglass-query\n"
               << "\n"
               << "Examples:\n"
               << "  " << prog << " trading                    # Text output to stdout\n"
               << "  " << prog << " -i 100 -f binary -o diff.mgd trading\n"
+              << "  " << prog << " -f binary -o day.mgd -s influx:unix:/run/telegraf.sock trading\n"
+              << "  " << prog << " -f binary -o day.mgd -s rollup-1m:day.1m.mgd trading\n"
+              << "  " << prog << " --on-mark md_burst trading  # Capture after each burst\n"
+              << "  " << prog << " --cdc -f binary -o fills.mgd trading  # Every tracked store\n"
+              << "  " << prog << " -i 10 --compare shadow -t 1e-6 -t ts=ignore trading\n"
               << "  " << prog << " --decode diff.mgd          # Decode binary to text\n";
 }
 
@@ -728,6 +140,7 @@ Options parse_args(int argc, char* argv[]) {
                 return opts;
             }
             opts.interval_ms = std::stoull(argv[++i]);
+            opts.interval_set = true;
         }
         else if (arg == "-o" || arg == "--output") {
             if (i + 1 >= argc) {
@@ -735,7 +148,7 @@ Options parse_args(int argc, char* argv[]) {
                 opts.help = true;
                 return opts;
             }
-            opts.output_file = argv[++i];
+            opts.output.target = argv[++i];
         }
         else if (arg == "-f" || arg == "--format") {
             if (i + 1 >= argc) {
@@ -744,19 +157,97 @@ Options parse_args(int argc, char* argv[]) {
                 return opts;
             }
             std::string fmt = argv[++i];
-            if (fmt == "text") opts.format = OutputFormat::Text;
-            else if (fmt == "json") opts.format = OutputFormat::Json;
-            else if (fmt == "json-pretty") opts.format = OutputFormat::JsonPretty;
-            else if (fmt == "binary") opts.format = OutputFormat::Binary;
-            else {
+            if (!memglass::parse_sink_format(fmt, opts.output)) {
                 std::cerr << "Error: unknown format '" << fmt << "'\n";
                 opts.help = true;
                 return opts;
             }
         }
+        else if (arg == "-s" || arg == "--sink") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires <format>:<target>\n";
+                opts.help = true;
+                return opts;
+            }
+            SinkSpec spec;
+            if (!memglass::parse_sink_spec(argv[++i], spec)) {
+                std::cerr << "Error: invalid sink '" << argv[i] << "'\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.sinks.push_back(std::move(spec));
+        }
+        else if (arg == "-q" || arg == "--queue") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a value\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.queue_depth = std::max<size_t>(1, std::stoull(argv[++i]));
+        }
         else if (arg == "-a" || arg == "--all") {
             opts.skip_empty = false;
         }
+        else if (arg == "-d" || arg == "--dirty") {
+            opts.dirty_tracking = true;
+        }
+        else if (arg == "--full-scan") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a count\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.full_scan = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "-b" || arg == "--bulk") {
+            opts.bulk_copy = true;
+        }
+        else if (arg == "-m" || arg == "--map") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a mode\n";
+                opts.help = true;
+                return opts;
+            }
+            std::string mode = argv[++i];
+            if (mode == "eager") opts.mapping = memglass::RegionMapping::Eager;
+            else if (mode == "populate") opts.mapping = memglass::RegionMapping::Populate;
+            else if (mode == "lazy") opts.mapping = memglass::RegionMapping::Lazy;
+            else {
+                std::cerr << "Error: unknown mapping mode '" << mode << "'\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if (arg == "--on-cycle") {
+            opts.on_cycle = true;
+        }
+        else if (arg == "--cdc") {
+            opts.cdc = true;
+        }
+        else if (arg == "--on-mark") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --on-mark requires a name\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.on_mark = argv[++i];
+        }
+        else if (arg == "--compare") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --compare requires a session name\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.compare_session = argv[++i];
+        }
+        else if (arg == "-t" || arg == "--tolerance") {
+            if (i + 1 >= argc || !memglass::parse_tolerance(argv[i + 1], opts.compare)) {
+                std::cerr << "Error: " << arg << " requires [<name>=]<tolerance|ignore>\n";
+                opts.help = true;
+                return opts;
+            }
+            ++i;
+        }
         else if (arg == "--decode") {
             if (i + 1 >= argc) {
                 std::cerr << "Error: --decode requires a filename\n";
@@ -786,22 +277,106 @@ int decode_binary_file(const std::string& filename) {
         return 1;
     }
 
-    BinaryReader reader(in);
+    memglass::mgdf::Reader reader(in);
     if (!reader.read_header()) {
         std::cerr << "Error: invalid binary diff file\n";
         return 1;
     }
+    if (reader.flags() & memglass::mgdf::FLAG_ROLLUP) {
+        std::cerr << "Error: '" << filename << "' is a rollup file; read it with memglass-query\n";
+        return 1;
+    }
 
-    uint64_t last_timestamp = 0;
-    while (auto diff = reader.read_diff(last_timestamp)) {
-        write_diff_text(std::cout, *diff);
+    auto out = std::make_unique<memglass::SinkOutput>();
+    out->open("-");
+    memglass::TextSink text(std::move(out));
+    while (auto diff = reader.read_diff()) {
+        text.write(*diff);
     }
+    text.flush();
 
     return 0;
 }
 
+void close_sinks(std::vector<std::unique_ptr<memglass::DiffSink>>& sinks,
+                 uint64_t diff_count, uint64_t change_count) {
+    for (auto& sink : sinks) {
+        sink->close();
+    }
+
+    std::cerr << "\nRecorded " << diff_count << " diffs with " << change_count << " total changes\n";
+    for (const auto& sink : sinks) {
+        if (sink->dropped() > 0) {
+            std::cerr << "Sink '" << sink->name() << "' dropped " << sink->dropped() << " diffs\n";
+        }
+    }
+}
+
+// Drain the producer's CDC rings instead of sampling: one diff per logged
+// timestamp, nothing in between lost unless the producer's rings overflow
+int run_cdc(const Options& opts, memglass::Observer& obs,
+            std::vector<std::unique_ptr<memglass::DiffSink>>& sinks) {
+    memglass::CdcReader reader(obs);
+    if (!reader.attach()) {
+        std::cerr << "Producer logs no changes (cdc_ring_capacity is 0 or an older build)\n";
+        return 1;
+    }
+
+    auto interval = std::chrono::milliseconds(opts.interval_set ? opts.interval_ms : 10);
+    std::cerr << "Draining change log every " << interval.count() << "ms. Press Ctrl+C to stop.\n";
+
+    std::vector<SnapshotDiff> diffs;
+    uint64_t diff_count = 0;
+    uint64_t change_count = 0;
+    bool last = false;
+    while (!last) {
+        std::this_thread::sleep_for(interval);
+        last = !g_running;  // one final drain after Ctrl+C
+
+        diffs.clear();
+        reader.drain(diffs);
+        for (auto& d : diffs) {
+            change_count += d.field_changes.size();
+            auto diff = std::make_shared<const SnapshotDiff>(std::move(d));
+            for (auto& sink : sinks) {
+                sink->submit(diff);
+            }
+            diff_count++;
+        }
+    }
+
+    close_sinks(sinks, diff_count, change_count);
+
+    const auto& st = reader.stats();
+    std::cerr << st.records << " records, " << st.dropped << " dropped by the producer, "
+              << st.unresolved << " unresolved\n";
+    return 0;
+}
+
 int run_diff(const Options& opts) {
-    memglass::Observer obs(opts.session_name);
+    // Primary output (-f/-o) followed by any --sink outputs
+    std::vector<SinkSpec> specs;
+    specs.push_back(opts.output);
+    specs.insert(specs.end(), opts.sinks.begin(), opts.sinks.end());
+
+    // Each sink encodes and writes on its own thread so a slow consumer
+    // only drops its own diffs instead of stalling the capture loop
+    std::vector<std::unique_ptr<memglass::DiffSink>> sinks;
+    for (const auto& spec : specs) {
+        std::string error;
+        auto sink = memglass::make_sink(spec, opts.session_name, &error);
+        if (!sink) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        sinks.push_back(std::make_unique<memglass::AsyncSink>(std::move(sink), opts.queue_depth));
+    }
+
+    // Every tick reads every region, so prefault by default to keep page
+    // faults out of the sampling loop
+    memglass::ObserverOptions obs_opts;
+    obs_opts.regions = opts.mapping;
+    memglass::Observer obs(opts.session_name, obs_opts);
 
     std::cerr << "Connecting to session '" << opts.session_name << "'...\n";
 
@@ -811,76 +386,217 @@ int run_diff(const Options& opts) {
     }
 
     std::cerr << "Connected to PID: " << obs.producer_pid() << "\n";
-    std::cerr << "Taking snapshots every " << opts.interval_ms << "ms. Press Ctrl+C to stop.\n";
-
-    // Output stream
-    std::ofstream file_out;
-    std::ostream* out = &std::cout;
-    if (!opts.output_file.empty()) {
-        auto mode = (opts.format == OutputFormat::Binary)
-            ? (std::ios::out | std::ios::binary)
-            : std::ios::out;
-        file_out.open(opts.output_file, mode);
-        if (!file_out) {
-            std::cerr << "Error: cannot open output file '" << opts.output_file << "'\n";
+
+    if (opts.cdc) {
+        return run_cdc(opts, obs, sinks);
+    }
+
+    // Event-driven capture: snapshot right after the producer finishes a
+    // cycle or raises a mark, and not at all while it is idle
+    bool on_event = opts.on_cycle || !opts.on_mark.empty();
+    memglass::EventListener events(obs);
+    if (on_event) {
+        if (!events.attach()) {
+            std::cerr << "Producer publishes no events (event_ring_capacity is 0 or an older build)\n";
             return 1;
         }
-        out = &file_out;
+        std::cerr << "Taking snapshots at each "
+                  << (opts.on_cycle ? std::string("cycle end") : "mark '" + opts.on_mark + "'")
+                  << ". Press Ctrl+C to stop.\n";
+    } else {
+        std::cerr << "Taking snapshots every " << opts.interval_ms << "ms. Press Ctrl+C to stop.\n";
     }
 
-    // Binary writer (if needed)
-    std::unique_ptr<BinaryWriter> bin_writer;
-    if (opts.format == OutputFormat::Binary) {
-        bin_writer = std::make_unique<BinaryWriter>(*out);
-        bin_writer->write_header();
+    // Clear soft-dirty bits before the baseline read so nothing is missed
+    memglass::DirtyTracker tracker(obs);
+    bool use_tracker = false;
+    if (opts.dirty_tracking) {
+        use_tracker = tracker.attach();
+        tracker.set_full_scan_interval(opts.full_scan);
+        if (!use_tracker) {
+            std::cerr << "Soft-dirty tracking unavailable for PID " << obs.producer_pid()
+                      << "; using full scans\n";
+        }
     }
 
+    // Bulk mode reads producer memory in one burst per tick; decoding and
+    // diffing then only touch the private copy
+    memglass::BulkCopy bulk(obs);
+    auto snapshot = [&] {
+        return opts.bulk_copy ? memglass::take_snapshot(obs, bulk) : memglass::take_snapshot(obs);
+    };
+
     // Take initial snapshot
-    Snapshot prev_snap = take_snapshot(obs);
-    uint64_t last_timestamp = prev_snap.timestamp_ns;
+    Snapshot prev_snap = snapshot();
     uint64_t diff_count = 0;
     uint64_t change_count = 0;
 
     auto interval = std::chrono::milliseconds(opts.interval_ms);
 
+    auto wait_for_capture = [&] {
+        if (!on_event) {
+            std::this_thread::sleep_for(interval);
+            return;
+        }
+        if (opts.interval_set) std::this_thread::sleep_for(interval);
+
+        // Events raised while we were capturing are stale; wait for a fresh one
+        events.skip_to_head();
+        memglass::EventKind kind = opts.on_cycle ? memglass::EventKind::CycleEnd
+                                                 : memglass::EventKind::Mark;
+        memglass::Event event;
+        while (g_running &&
+               !events.wait_for(kind, opts.on_mark, event, std::chrono::milliseconds(100))) {
+        }
+    };
+
     while (g_running) {
-        std::this_thread::sleep_for(interval);
+        wait_for_capture();
         if (!g_running) break;
 
-        Snapshot new_snap = take_snapshot(obs);
-        SnapshotDiff diff = compute_diff(prev_snap, new_snap);
-
-        if (!diff.empty() || !opts.skip_empty) {
-            switch (opts.format) {
-                case OutputFormat::Text:
-                    write_diff_text(*out, diff);
-                    break;
-                case OutputFormat::Json:
-                    write_diff_json(*out, diff, false);
-                    break;
-                case OutputFormat::JsonPretty:
-                    write_diff_json(*out, diff, true);
-                    break;
-                case OutputFormat::Binary:
-                    bin_writer->write_diff(diff, last_timestamp);
-                    break;
+        std::shared_ptr<const SnapshotDiff> diff;
+        if (use_tracker) {
+            tracker.collect();
+            diff = std::make_shared<const SnapshotDiff>(opts.bulk_copy
+                ? memglass::update_snapshot(obs, prev_snap, tracker, bulk)
+                : memglass::update_snapshot(obs, prev_snap, tracker));
+        } else {
+            Snapshot new_snap = snapshot();
+            diff = std::make_shared<const SnapshotDiff>(memglass::compute_diff(prev_snap, new_snap));
+            prev_snap = std::move(new_snap);
+        }
+
+        if (!diff->empty() || !opts.skip_empty) {
+            for (auto& sink : sinks) {
+                sink->submit(diff);
             }
-
-            out->flush();
             diff_count++;
-            change_count += diff.field_changes.size();
+            change_count += diff->field_changes.size();
         }
+    }
 
-        last_timestamp = new_snap.timestamp_ns;
-        prev_snap = std::move(new_snap);
+    close_sinks(sinks, diff_count, change_count);
+    return 0;
+}
+
+void append_divergence(std::string& out, bool json, std::string_view event,
+                       const memglass::CompareResult& r, const memglass::Divergence& d) {
+    if (json) {
+        fmt::format_to(std::back_inserter(out), "{{\"ts\":{},\"event\":\"{}\",\"obj\":\"",
+                       r.timestamp_ns, event);
+        memglass::append_json_escaped(out, d.label);
+        out += "\",\"field\":\"";
+        memglass::append_json_escaped(out, d.field);
+        fmt::format_to(std::back_inserter(out), "\",\"a\":{},\"b\":{},\"since\":{}}}\n",
+                       d.a.to_json(), d.b.to_json(), d.since_ns);
+    } else {
+        fmt::format_to(std::back_inserter(out), "@{} {} {}.{}: {} vs {}", r.timestamp_ns, event,
+                       d.label, d.field, d.a.to_string(), d.b.to_string());
+        if (event == "converged") {
+            fmt::format_to(std::back_inserter(out), " (after {:.3f} ms)",
+                           (r.timestamp_ns - d.since_ns) / 1e6);
+        }
+        out += '\n';
     }
+}
 
-    if (opts.format == OutputFormat::Binary && bin_writer) {
-        bin_writer->write_end();
+int run_compare(const Options& opts) {
+    using memglass::SinkFormat;
+    if (opts.output.format != SinkFormat::Text && opts.output.format != SinkFormat::Json) {
+        std::cerr << "Error: --compare writes text or json\n";
+        return 1;
     }
+    bool json = opts.output.format == SinkFormat::Json;
 
-    std::cerr << "\nRecorded " << diff_count << " diffs with " << change_count << " total changes\n";
+    memglass::SinkOutput out;
+    std::string error;
+    if (!out.open(opts.output.target, &error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    memglass::ObserverOptions obs_opts;
+    obs_opts.regions = opts.mapping;
+    memglass::Observer obs_a(opts.session_name, obs_opts);
+    memglass::Observer obs_b(opts.compare_session, obs_opts);
+    for (auto* obs : {&obs_a, &obs_b}) {
+        if (!obs->connect()) {
+            std::cerr << "Failed to connect to '" << obs->session_name()
+                      << "'. Is the producer running?\n";
+            return 1;
+        }
+    }
+
+    memglass::SessionComparator comparator(obs_a, obs_b, opts.compare);
+    comparator.rebuild();
+    const auto& st = comparator.stats();
+    std::cerr << fmt::format("Comparing '{}' (PID {}) with '{}' (PID {}): {} objects, {} fields "
+                             "in {} spans ({} decoded every pass)\n",
+                             opts.session_name, obs_a.producer_pid(), opts.compare_session,
+                             obs_b.producer_pid(), st.objects, st.fields, st.spans, st.slow_fields);
+    if (!comparator.only_in_a().empty() || !comparator.only_in_b().empty()) {
+        std::cerr << fmt::format("Unpaired objects: {} only in '{}', {} only in '{}'\n",
+                                 comparator.only_in_a().size(), opts.session_name,
+                                 comparator.only_in_b().size(), opts.compare_session);
+    }
+    for (const auto& name : comparator.unmatched_fields()) {
+        std::cerr << "Field on one side only: " << name << "\n";
+    }
 
+    // Same pacing as diff mode, driven by session A's events
+    bool on_event = opts.on_cycle || !opts.on_mark.empty();
+    memglass::EventListener events(obs_a);
+    if (on_event && !events.attach()) {
+        std::cerr << "Producer publishes no events (event_ring_capacity is 0 or an older build)\n";
+        return 1;
+    }
+    auto interval = std::chrono::milliseconds(opts.interval_ms);
+    memglass::EventKind kind = opts.on_cycle ? memglass::EventKind::CycleEnd
+                                             : memglass::EventKind::Mark;
+
+    std::string buffer;
+    uint64_t divergences = 0;
+    auto busy = std::chrono::steady_clock::duration::zero();
+
+    while (g_running) {
+        if (!on_event || opts.interval_set) std::this_thread::sleep_for(interval);
+        if (on_event) {
+            events.skip_to_head();
+            memglass::Event event;
+            while (g_running &&
+                   !events.wait_for(kind, opts.on_mark, event, std::chrono::milliseconds(100))) {
+            }
+        }
+        if (!g_running) break;
+
+        auto start = std::chrono::steady_clock::now();
+        const auto& r = comparator.compare();
+        busy += std::chrono::steady_clock::now() - start;
+
+        // Transitions only, unless -a asks for every open divergence per pass
+        for (const auto& d : r.diverged) {
+            if (d.since_ns == r.timestamp_ns) {
+                append_divergence(buffer, json, "diverged", r, d);
+                divergences++;
+            } else if (!opts.skip_empty) {
+                append_divergence(buffer, json, "differs", r, d);
+            }
+        }
+        for (const auto& d : r.converged) {
+            append_divergence(buffer, json, "converged", r, d);
+        }
+        if (!buffer.empty()) {
+            out.write(buffer);
+            buffer.clear();
+        }
+    }
+
+    std::cerr << fmt::format("\n{} passes, {} divergences, {:.1f} us per pass, {} rebuilds\n",
+                             st.compares, divergences,
+                             st.compares ? std::chrono::duration<double, std::micro>(busy).count() /
+                                               static_cast<double>(st.compares)
+                                         : 0.0,
+                             st.rebuilds);
     return 0;
 }
 
@@ -905,5 +621,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (!opts.compare_session.empty()) {
+        return run_compare(opts);
+    }
+
     return run_diff(opts);
 }
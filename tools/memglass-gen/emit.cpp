@@ -0,0 +1,284 @@
+#include "emit.hpp"
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string_view>
+
+namespace memglass::gen {
+
+FieldMeta parse_annotations(const std::string& text) {
+    FieldMeta meta;
+
+    // Parse @readonly
+    if (text.find("@readonly") != std::string::npos) {
+        meta.readonly = true;
+    }
+
+    // Parse @atomic
+    if (text.find("@atomic") != std::string::npos) {
+        meta.atomicity = FieldMeta::Atomicity::Atomic;
+    }
+
+    // Parse @seqlock
+    if (text.find("@seqlock") != std::string::npos) {
+        meta.atomicity = FieldMeta::Atomicity::Seqlock;
+    }
+
+    // Parse @locked
+    if (text.find("@locked") != std::string::npos) {
+        meta.atomicity = FieldMeta::Atomicity::Locked;
+    }
+
+    // Parse @range(min, max)
+    std::regex range_re(R"(@range\s*\(\s*([^,]+)\s*,\s*([^)]+)\s*\))");
+    std::smatch match;
+    if (std::regex_search(text, match, range_re)) {
+        meta.has_range = true;
+        meta.range_min = std::stod(match[1]);
+        meta.range_max = std::stod(match[2]);
+    }
+
+    // Parse @min(val)
+    std::regex min_re(R"(@min\s*\(\s*([^)]+)\s*\))");
+    if (std::regex_search(text, match, min_re)) {
+        meta.has_range = true;
+        meta.range_min = std::stod(match[1]);
+    }
+
+    // Parse @max(val)
+    std::regex max_re(R"(@max\s*\(\s*([^)]+)\s*\))");
+    if (std::regex_search(text, match, max_re)) {
+        meta.has_range = true;
+        meta.range_max = std::stod(match[1]);
+    }
+
+    // Parse @step(val)
+    std::regex step_re(R"(@step\s*\(\s*([^)]+)\s*\))");
+    if (std::regex_search(text, match, step_re)) {
+        meta.step = std::stod(match[1]);
+    }
+
+    // Parse @regex("pattern")
+    std::regex regex_re(R"--(@regex\s*\(\s*"([^"]+)"\s*\))--");
+    if (std::regex_search(text, match, regex_re)) {
+        meta.regex_pattern = match[1];
+    }
+
+    // Parse @format("fmt")
+    std::regex format_re(R"--(@format\s*\(\s*"([^"]+)"\s*\))--");
+    if (std::regex_search(text, match, format_re)) {
+        meta.format = match[1];
+    }
+
+    // Parse @unit("str")
+    std::regex unit_re(R"--(@unit\s*\(\s*"([^"]+)"\s*\))--");
+    if (std::regex_search(text, match, unit_re)) {
+        meta.unit = match[1];
+    }
+
+    // Parse @enum(NAME=val, ...)
+    std::regex enum_re(R"(@enum\s*\(([^)]+)\))");
+    if (std::regex_search(text, match, enum_re)) {
+        std::string enum_list = match[1];
+        std::regex item_re(R"((\w+)\s*=\s*(-?\d+))");
+        std::sregex_iterator it(enum_list.begin(), enum_list.end(), item_re);
+        std::sregex_iterator end;
+        while (it != end) {
+            meta.enum_values.emplace_back((*it)[1], std::stoll((*it)[2]));
+            ++it;
+        }
+    }
+
+    // Parse @flags(NAME=bit, ...)
+    std::regex flags_re(R"(@flags\s*\(([^)]+)\))");
+    if (std::regex_search(text, match, flags_re)) {
+        std::string flags_list = match[1];
+        std::regex item_re(R"((\w+)\s*=\s*(\d+))");
+        std::sregex_iterator it(flags_list.begin(), flags_list.end(), item_re);
+        std::sregex_iterator end;
+        while (it != end) {
+            meta.flags.emplace_back((*it)[1], std::stoull((*it)[2]));
+            ++it;
+        }
+    }
+
+    return meta;
+}
+
+std::string stats_type_of(const std::string& spelling) {
+    for (const char* stats : {"memglass::Ewma", "memglass::TimeEwma",
+                              "memglass::WindowStats<", "memglass::RateMeter<",
+                              "memglass::Book<", "memglass::ScopeStats"}) {
+        std::string_view prefix(stats);
+        if (spelling.compare(0, prefix.size(), prefix) == 0 &&
+            (prefix.back() == '<' || spelling.size() == prefix.size())) {
+            return spelling;
+        }
+    }
+    return {};
+}
+
+std::string tracked_type_of(const std::string& spelling) {
+    std::string_view prefix("memglass::Tracked<");
+    if (spelling.size() > prefix.size() + 1 && spelling.compare(0, prefix.size(), prefix) == 0 &&
+        spelling.back() == '>') {
+        return spelling.substr(prefix.size(), spelling.size() - prefix.size() - 1);
+    }
+    return {};
+}
+
+namespace {
+
+void emit_includes(std::ostringstream& out, const std::vector<TypeInfo>& types) {
+    out << "#include <memglass/memglass.hpp>\n";
+    out << "#include <memglass/registry.hpp>\n";
+    // Header declaring each stats type: books, scope timers, the rest
+    auto header_of = [](const std::string& stats_type) {
+        if (stats_type.rfind("memglass::Book<", 0) == 0) return "book.hpp";
+        if (stats_type == "memglass::ScopeStats") return "perf.hpp";
+        return "stats.hpp";
+    };
+    auto uses = [&types, &header_of](std::string_view header) {
+        return std::any_of(types.begin(), types.end(), [&](const TypeInfo& type) {
+            return std::any_of(type.fields.begin(), type.fields.end(), [&](const FieldInfo& field) {
+                return !field.stats_type.empty() && header_of(field.stats_type) == header;
+            });
+        });
+    };
+    for (const char* header : {"book.hpp", "perf.hpp", "stats.hpp"}) {
+        if (uses(header)) out << "#include <memglass/" << header << ">\n";
+    }
+    bool tracked = std::any_of(types.begin(), types.end(), [](const TypeInfo& type) {
+        return std::any_of(type.fields.begin(), type.fields.end(),
+                           [](const FieldInfo& field) { return field.tracked; });
+    });
+    if (tracked) out << "#include <memglass/cdc.hpp>\n";
+    out << "#include <array>\n";
+    out << "#include <cstddef>\n\n";
+}
+
+// register_<Type>() for each type, then register_all_types(); linkage is
+// "inline " in headers
+void emit_registrations(std::ostringstream& out, const std::vector<TypeInfo>& types,
+                        std::string_view linkage) {
+    // Nested structs of generated types are registered once, as their own
+    // type, and referenced by id from every type embedding them
+    std::set<std::string> generated;
+    for (const auto& type : types) generated.insert(type.name);
+    auto nested_type = [&generated](const FieldInfo& field) -> std::string {
+        bool known = field.is_nested && field.stats_type.empty() && generated.count(field.nested_type_name);
+        return known ? field.nested_type_name : std::string();
+    };
+    bool any_nested = std::any_of(types.begin(), types.end(), [&](const TypeInfo& type) {
+        return std::any_of(type.fields.begin(), type.fields.end(),
+                           [&](const FieldInfo& field) { return !nested_type(field).empty(); });
+    });
+    if (any_nested) {
+        for (const auto& type : types) {
+            out << fmt::format("{}uint32_t register_{}();\n", linkage, type.name);
+        }
+        out << "\n";
+    }
+
+    // Generate TypeDescriptor specializations
+    for (const auto& type : types) {
+        out << fmt::format("// Type: {}\n", type.name);
+        out << fmt::format("{}uint32_t register_{}() {{\n", linkage, type.name);
+        out << "    memglass::TypeDescriptor desc;\n";
+        out << fmt::format("    desc.name = \"{}\";\n", type.name);
+        out << fmt::format("    desc.size = {};\n", type.size);
+        out << fmt::format("    desc.alignment = {};\n", type.alignment);
+        out << "    desc.fields = {\n";
+
+        for (const auto& field : type.fields) {
+            if (!field.stats_type.empty()) continue;
+            out << "        {";
+            out << fmt::format("\"{}\", ", field.name);
+            out << fmt::format("{}, ", field.offset);
+            out << fmt::format("{}, ", field.size);
+
+            // Primitive type
+            if (field.type_name == "bool") out << "memglass::PrimitiveType::Bool, ";
+            else if (field.type_name == "int8_t" || field.type_name == "signed char") out << "memglass::PrimitiveType::Int8, ";
+            else if (field.type_name == "uint8_t" || field.type_name == "unsigned char") out << "memglass::PrimitiveType::UInt8, ";
+            else if (field.type_name == "int16_t" || field.type_name == "short") out << "memglass::PrimitiveType::Int16, ";
+            else if (field.type_name == "uint16_t" || field.type_name == "unsigned short") out << "memglass::PrimitiveType::UInt16, ";
+            else if (field.type_name == "int32_t" || field.type_name == "int") out << "memglass::PrimitiveType::Int32, ";
+            else if (field.type_name == "uint32_t" || field.type_name == "unsigned int") out << "memglass::PrimitiveType::UInt32, ";
+            else if (field.type_name == "int64_t" || field.type_name == "long" || field.type_name == "long long") out << "memglass::PrimitiveType::Int64, ";
+            else if (field.type_name == "uint64_t" || field.type_name == "unsigned long" || field.type_name == "unsigned long long") out << "memglass::PrimitiveType::UInt64, ";
+            else if (field.type_name == "float") out << "memglass::PrimitiveType::Float32, ";
+            else if (field.type_name == "double") out << "memglass::PrimitiveType::Float64, ";
+            else if (field.type_name == "char") out << "memglass::PrimitiveType::Char, ";
+            else out << "memglass::PrimitiveType::Unknown, ";
+
+            // user_type_id: 0 leaves other structs opaque
+            std::string nested = nested_type(field);
+            out << (nested.empty() ? std::string("0") : fmt::format("register_{}()", nested)) << ", ";
+            out << fmt::format("{}, ", field.array_size);
+
+            // Atomicity
+            switch (field.meta.atomicity) {
+                case FieldMeta::Atomicity::Atomic: out << "memglass::Atomicity::Atomic, "; break;
+                case FieldMeta::Atomicity::Seqlock: out << "memglass::Atomicity::Seqlock, "; break;
+                case FieldMeta::Atomicity::Locked: out << "memglass::Atomicity::Locked, "; break;
+                default: out << "memglass::Atomicity::None, "; break;
+            }
+
+            out << (field.meta.readonly ? "true" : "false");
+            out << "},\n";
+        }
+
+        out << "    };\n";
+        for (const auto& field : type.fields) {
+            if (field.stats_type.empty()) continue;
+            out << fmt::format("    {}::describe(desc, \"{}\", {});\n",
+                               field.stats_type, field.name, field.offset);
+        }
+        out << fmt::format("    return memglass::registry::register_type_for<{}>(desc);\n", type.name);
+        out << "}\n\n";
+    }
+
+    // Generate register_all_types function
+    out << fmt::format("{}void register_all_types() {{\n", linkage);
+    for (const auto& type : types) {
+        out << fmt::format("    register_{}();\n", type.name);
+    }
+    out << "}\n\n";
+}
+
+} // anonymous namespace
+
+std::string generate_header(const std::vector<TypeInfo>& types) {
+    std::ostringstream out;
+
+    out << "// Generated by memglass-gen - DO NOT EDIT\n";
+    out << "#pragma once\n\n";
+    emit_includes(out, types);
+    out << "namespace memglass::generated {\n\n";
+    emit_registrations(out, types, "inline ");
+    out << "} // namespace memglass::generated\n";
+
+    return out.str();
+}
+
+std::string generate_source(const std::vector<TypeInfo>& types,
+                            const std::vector<std::string>& includes) {
+    std::ostringstream out;
+
+    out << "// Generated by memglass-gen - DO NOT EDIT\n";
+    emit_includes(out, types);
+    for (const auto& include : includes) {
+        out << fmt::format("#include \"{}\"\n", include);
+    }
+    out << "\nnamespace memglass::generated {\n\n";
+    emit_registrations(out, types, "");
+    out << "} // namespace memglass::generated\n";
+
+    return out.str();
+}
+
+} // namespace memglass::gen
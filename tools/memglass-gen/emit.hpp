@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Type model and code emission shared by the libclang front end
+// (memglass-gen) and the Clang plugin
+
+namespace memglass::gen {
+
+// Field metadata parsed from comments
+struct FieldMeta {
+    bool readonly = false;
+    bool has_range = false;
+    double range_min = 0;
+    double range_max = 0;
+    double step = 0;
+    std::string regex_pattern;
+    std::string format;
+    std::string unit;
+    std::string desc;
+    std::vector<std::pair<std::string, int64_t>> enum_values;
+    std::vector<std::pair<std::string, uint64_t>> flags;
+
+    // Atomicity
+    enum class Atomicity { None, Atomic, Seqlock, Locked };
+    Atomicity atomicity = Atomicity::None;
+};
+
+// Field information
+struct FieldInfo {
+    std::string name;
+    std::string type_name;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    bool is_array = false;
+    uint32_t array_size = 0;
+    bool is_nested = false;
+    std::string nested_type_name;
+    std::string stats_type;  // memglass::Ewma, memglass::Book<N> etc.; registered with its describe()
+    bool tracked = false;    // memglass::Tracked<T>, registered as its T
+    FieldMeta meta;
+};
+
+// Type information
+struct TypeInfo {
+    std::string name;
+    std::string qualified_name;
+    std::string file;  // header declaring the type (plugin only)
+    uint32_t size = 0;
+    uint32_t alignment = 0;
+    std::vector<FieldInfo> fields;
+};
+
+// Parse @atomic, @range(...) etc. out of a field's comment text
+FieldMeta parse_annotations(const std::string& comment);
+
+// The type's canonical spelling if it describes its own fields (rolling
+// statistics and books), else empty
+std::string stats_type_of(const std::string& canonical_spelling);
+
+// T of a memglass::Tracked<T> canonical spelling, else empty
+std::string tracked_type_of(const std::string& canonical_spelling);
+
+// Header with inline registration functions
+std::string generate_header(const std::vector<TypeInfo>& types);
+
+// Translation unit defining the same functions out of line, for a build
+// to compile once and link; includes the given headers for the types
+std::string generate_source(const std::vector<TypeInfo>& types,
+                            const std::vector<std::string>& includes);
+
+} // namespace memglass::gen
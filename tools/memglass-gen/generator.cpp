@@ -1,9 +1,6 @@
 #include "generator.hpp"
 
-#include <fmt/format.h>
-#include <regex>
 #include <iostream>
-#include <sstream>
 #include <cstring>
 
 namespace memglass::gen {
@@ -231,6 +228,19 @@ FieldInfo Generator::extract_field_info(CXCursor cursor, CXCursor parent) {
             info.nested_type_name = clang_getCString(nested_name);
             clang_disposeString(nested_name);
         }
+
+        // Rolling statistics and books describe their own fields
+        CXString canonical_spelling = clang_getTypeSpelling(canonical);
+        info.stats_type = stats_type_of(clang_getCString(canonical_spelling));
+
+        // Tracked<T> has T's layout; register it as a plain T field
+        std::string tracked = tracked_type_of(clang_getCString(canonical_spelling));
+        if (!tracked.empty()) {
+            info.tracked = true;
+            info.is_nested = false;
+            info.type_name = tracked;
+        }
+        clang_disposeString(canonical_spelling);
     }
 
     // Parse comment metadata
@@ -240,187 +250,22 @@ FieldInfo Generator::extract_field_info(CXCursor cursor, CXCursor parent) {
 }
 
 FieldMeta Generator::parse_comment(CXCursor cursor) {
-    FieldMeta meta;
-
     CXString raw_comment = clang_Cursor_getRawCommentText(cursor);
     const char* comment = clang_getCString(raw_comment);
 
     if (!comment) {
         clang_disposeString(raw_comment);
-        return meta;
+        return FieldMeta{};
     }
 
     std::string text(comment);
     clang_disposeString(raw_comment);
 
-    // Parse @readonly
-    if (text.find("@readonly") != std::string::npos) {
-        meta.readonly = true;
-    }
-
-    // Parse @atomic
-    if (text.find("@atomic") != std::string::npos) {
-        meta.atomicity = FieldMeta::Atomicity::Atomic;
-    }
-
-    // Parse @seqlock
-    if (text.find("@seqlock") != std::string::npos) {
-        meta.atomicity = FieldMeta::Atomicity::Seqlock;
-    }
-
-    // Parse @locked
-    if (text.find("@locked") != std::string::npos) {
-        meta.atomicity = FieldMeta::Atomicity::Locked;
-    }
-
-    // Parse @range(min, max)
-    std::regex range_re(R"(@range\s*\(\s*([^,]+)\s*,\s*([^)]+)\s*\))");
-    std::smatch match;
-    if (std::regex_search(text, match, range_re)) {
-        meta.has_range = true;
-        meta.range_min = std::stod(match[1]);
-        meta.range_max = std::stod(match[2]);
-    }
-
-    // Parse @min(val)
-    std::regex min_re(R"(@min\s*\(\s*([^)]+)\s*\))");
-    if (std::regex_search(text, match, min_re)) {
-        meta.has_range = true;
-        meta.range_min = std::stod(match[1]);
-    }
-
-    // Parse @max(val)
-    std::regex max_re(R"(@max\s*\(\s*([^)]+)\s*\))");
-    if (std::regex_search(text, match, max_re)) {
-        meta.has_range = true;
-        meta.range_max = std::stod(match[1]);
-    }
-
-    // Parse @step(val)
-    std::regex step_re(R"(@step\s*\(\s*([^)]+)\s*\))");
-    if (std::regex_search(text, match, step_re)) {
-        meta.step = std::stod(match[1]);
-    }
-
-    // Parse @regex("pattern")
-    std::regex regex_re(R"--(@regex\s*\(\s*"([^"]+)"\s*\))--");
-    if (std::regex_search(text, match, regex_re)) {
-        meta.regex_pattern = match[1];
-    }
-
-    // Parse @format("fmt")
-    std::regex format_re(R"--(@format\s*\(\s*"([^"]+)"\s*\))--");
-    if (std::regex_search(text, match, format_re)) {
-        meta.format = match[1];
-    }
-
-    // Parse @unit("str")
-    std::regex unit_re(R"--(@unit\s*\(\s*"([^"]+)"\s*\))--");
-    if (std::regex_search(text, match, unit_re)) {
-        meta.unit = match[1];
-    }
-
-    // Parse @enum(NAME=val, ...)
-    std::regex enum_re(R"(@enum\s*\(([^)]+)\))");
-    if (std::regex_search(text, match, enum_re)) {
-        std::string enum_list = match[1];
-        std::regex item_re(R"((\w+)\s*=\s*(-?\d+))");
-        std::sregex_iterator it(enum_list.begin(), enum_list.end(), item_re);
-        std::sregex_iterator end;
-        while (it != end) {
-            meta.enum_values.emplace_back((*it)[1], std::stoll((*it)[2]));
-            ++it;
-        }
-    }
-
-    // Parse @flags(NAME=bit, ...)
-    std::regex flags_re(R"(@flags\s*\(([^)]+)\))");
-    if (std::regex_search(text, match, flags_re)) {
-        std::string flags_list = match[1];
-        std::regex item_re(R"((\w+)\s*=\s*(\d+))");
-        std::sregex_iterator it(flags_list.begin(), flags_list.end(), item_re);
-        std::sregex_iterator end;
-        while (it != end) {
-            meta.flags.emplace_back((*it)[1], std::stoull((*it)[2]));
-            ++it;
-        }
-    }
-
-    return meta;
+    return parse_annotations(text);
 }
 
 std::string Generator::generate_header() const {
-    std::ostringstream out;
-
-    out << "// Generated by memglass-gen - DO NOT EDIT\n";
-    out << "#pragma once\n\n";
-    out << "#include <memglass/memglass.hpp>\n";
-    out << "#include <memglass/registry.hpp>\n";
-    out << "#include <array>\n";
-    out << "#include <cstddef>\n\n";
-    out << "namespace memglass::generated {\n\n";
-
-    // Generate TypeDescriptor specializations
-    for (const auto& type : types_) {
-        out << fmt::format("// Type: {}\n", type.name);
-        out << fmt::format("inline uint32_t register_{}() {{\n", type.name);
-        out << "    memglass::TypeDescriptor desc;\n";
-        out << fmt::format("    desc.name = \"{}\";\n", type.name);
-        out << fmt::format("    desc.size = {};\n", type.size);
-        out << fmt::format("    desc.alignment = {};\n", type.alignment);
-        out << "    desc.fields = {\n";
-
-        for (const auto& field : type.fields) {
-            out << "        {";
-            out << fmt::format("\"{}\", ", field.name);
-            out << fmt::format("{}, ", field.offset);
-            out << fmt::format("{}, ", field.size);
-
-            // Primitive type
-            if (field.type_name == "bool") out << "memglass::PrimitiveType::Bool, ";
-            else if (field.type_name == "int8_t" || field.type_name == "signed char") out << "memglass::PrimitiveType::Int8, ";
-            else if (field.type_name == "uint8_t" || field.type_name == "unsigned char") out << "memglass::PrimitiveType::UInt8, ";
-            else if (field.type_name == "int16_t" || field.type_name == "short") out << "memglass::PrimitiveType::Int16, ";
-            else if (field.type_name == "uint16_t" || field.type_name == "unsigned short") out << "memglass::PrimitiveType::UInt16, ";
-            else if (field.type_name == "int32_t" || field.type_name == "int") out << "memglass::PrimitiveType::Int32, ";
-            else if (field.type_name == "uint32_t" || field.type_name == "unsigned int") out << "memglass::PrimitiveType::UInt32, ";
-            else if (field.type_name == "int64_t" || field.type_name == "long" || field.type_name == "long long") out << "memglass::PrimitiveType::Int64, ";
-            else if (field.type_name == "uint64_t" || field.type_name == "unsigned long" || field.type_name == "unsigned long long") out << "memglass::PrimitiveType::UInt64, ";
-            else if (field.type_name == "float") out << "memglass::PrimitiveType::Float32, ";
-            else if (field.type_name == "double") out << "memglass::PrimitiveType::Float64, ";
-            else if (field.type_name == "char") out << "memglass::PrimitiveType::Char, ";
-            else out << "memglass::PrimitiveType::Unknown, ";
-
-            out << "0, ";  // user_type_id (TODO: resolve nested types)
-            out << fmt::format("{}, ", field.array_size);
-
-            // Atomicity
-            switch (field.meta.atomicity) {
-                case FieldMeta::Atomicity::Atomic: out << "memglass::Atomicity::Atomic, "; break;
-                case FieldMeta::Atomicity::Seqlock: out << "memglass::Atomicity::Seqlock, "; break;
-                case FieldMeta::Atomicity::Locked: out << "memglass::Atomicity::Locked, "; break;
-                default: out << "memglass::Atomicity::None, "; break;
-            }
-
-            out << (field.meta.readonly ? "true" : "false");
-            out << "},\n";
-        }
-
-        out << "    };\n";
-        out << fmt::format("    return memglass::registry::register_type_for<{}>(desc);\n", type.name);
-        out << "}\n\n";
-    }
-
-    // Generate register_all_types function
-    out << "inline void register_all_types() {\n";
-    for (const auto& type : types_) {
-        out << fmt::format("    register_{}();\n", type.name);
-    }
-    out << "}\n\n";
-
-    out << "} // namespace memglass::generated\n";
-
-    return out.str();
+    return gen::generate_header(types_);
 }
 
 } // namespace memglass::gen
@@ -0,0 +1,282 @@
+// memglass-gen as a Clang plugin: runs inside the real compile of one
+// designated translation unit, so types are read from the compiler's own
+// AST and record layouts instead of a second libclang parse with its own
+// include flags.
+//
+//   clang++ -fplugin=memglass-gen-plugin.so \
+//       -fplugin-arg-memglass-gen-header=types_generated.hpp -c types.cpp
+//
+// Arguments (each as -fplugin-arg-memglass-gen-<arg>):
+//   header=<file>   write the header memglass-gen would generate
+//   source=<file>   write a source file defining the same functions out of
+//                   line, to compile and link instead of the header
+//
+// The plugin runs after the main action, so the compile still produces its
+// object file. Outputs are only rewritten when their contents change.
+
+#include "emit.hpp"
+
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Attr.h>
+#include <clang/AST/RawCommentList.h>
+#include <clang/AST/RecordLayout.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendPluginRegistry.h>
+#include <clang/Sema/ParsedAttr.h>
+#include <clang/Sema/Sema.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace memglass::gen {
+
+namespace {
+
+constexpr const char* OBSERVE = "memglass::observe";
+
+// Accept [[memglass::observe]] on structs and classes and keep it in the
+// AST as an annotation, instead of Clang dropping it as unknown
+struct ObserveAttrInfo : clang::ParsedAttrInfo {
+    ObserveAttrInfo() {
+        static constexpr Spelling spellings[] = {
+            {clang::ParsedAttr::AS_CXX11, "memglass::observe"},
+        };
+        Spellings = spellings;
+    }
+
+    bool diagAppertainsToDecl(clang::Sema& sema, const clang::ParsedAttr& attr,
+                              const clang::Decl* decl) const override {
+        if (llvm::isa<clang::CXXRecordDecl>(decl)) return true;
+        auto& diags = sema.getDiagnostics();
+        diags.Report(attr.getLoc(), diags.getCustomDiagID(
+            clang::DiagnosticsEngine::Warning, "'memglass::observe' only applies to structs and classes"));
+        return false;
+    }
+
+    AttrHandling handleDeclAttribute(clang::Sema& sema, clang::Decl* decl,
+                                     const clang::ParsedAttr& attr) const override {
+        decl->addAttr(clang::AnnotateAttr::Create(sema.Context, OBSERVE, nullptr, 0, attr.getRange()));
+        return AttributeApplied;
+    }
+};
+
+bool is_observed(const clang::Decl* decl) {
+    for (const auto* attr : decl->specific_attrs<clang::AnnotateAttr>()) {
+        if (attr->getAnnotation() == OBSERVE) return true;
+    }
+    return false;
+}
+
+// Collects observed types with the layout the compiler chose
+class ObserveVisitor : public clang::RecursiveASTVisitor<ObserveVisitor> {
+public:
+    explicit ObserveVisitor(clang::ASTContext& ctx)
+        : ctx_(ctx)
+        , policy_(ctx.getLangOpts())
+    {
+        policy_.SuppressTagKeyword = true;
+    }
+
+    bool VisitCXXRecordDecl(clang::CXXRecordDecl* record) {
+        if (!record->isThisDeclarationADefinition() || record->isDependentType() ||
+            record->isInvalidDecl() || !is_observed(record)) {
+            return true;
+        }
+        if (seen_.insert(record->getCanonicalDecl()).second) {
+            types_.push_back(extract(record));
+        }
+        return true;
+    }
+
+    const std::vector<TypeInfo>& types() const { return types_; }
+
+private:
+    TypeInfo extract(const clang::CXXRecordDecl* record) {
+        const clang::ASTRecordLayout& layout = ctx_.getASTRecordLayout(record);
+        const clang::SourceManager& sm = ctx_.getSourceManager();
+
+        TypeInfo info;
+        info.name = record->getNameAsString();
+        info.qualified_name = record->getQualifiedNameAsString();
+        info.file = sm.getFilename(sm.getFileLoc(record->getLocation())).str();
+        info.size = static_cast<uint32_t>(layout.getSize().getQuantity());
+        info.alignment = static_cast<uint32_t>(layout.getAlignment().getQuantity());
+
+        for (const clang::FieldDecl* decl : record->fields()) {
+            FieldInfo field;
+            field.name = decl->getNameAsString();
+            field.offset = static_cast<uint32_t>(
+                ctx_.toCharUnitsFromBits(layout.getFieldOffset(decl->getFieldIndex())).getQuantity());
+
+            clang::QualType type = decl->getType();
+            field.size = static_cast<uint32_t>(ctx_.getTypeSizeInChars(type).getQuantity());
+
+            clang::QualType canonical = type.getCanonicalType();
+            if (const auto* nested = canonical->getAsCXXRecordDecl()) {
+                field.is_nested = nested->isStruct();
+                field.nested_type_name = nested->getNameAsString();
+                // Rolling statistics and books describe their own fields
+                field.stats_type = stats_type_of(canonical.getAsString(policy_));
+                // Tracked<T> has T's layout; register it as a plain T field
+                field.tracked = !tracked_type_of(canonical.getAsString(policy_)).empty();
+            }
+
+            if (const auto* array = ctx_.getAsConstantArrayType(type)) {
+                field.is_array = true;
+                field.array_size = static_cast<uint32_t>(array->getSize().getZExtValue());
+                type = array->getElementType();
+            }
+            field.type_name = type_name(type);
+            if (field.tracked) {
+                field.is_nested = false;
+                field.type_name = tracked_type_of(canonical.getUnqualifiedType().getAsString(policy_));
+            }
+
+            if (const clang::RawComment* comment = ctx_.getRawCommentForDeclNoCache(decl)) {
+                field.meta = parse_annotations(comment->getRawText(sm).str());
+            }
+
+            info.fields.push_back(std::move(field));
+        }
+        return info;
+    }
+
+    // Builtins by their canonical spelling ("long" for int64_t), which
+    // does not depend on how the header spelled the typedef
+    std::string type_name(clang::QualType type) const {
+        clang::QualType canonical = type.getCanonicalType().getUnqualifiedType();
+        if (canonical->isBuiltinType()) return canonical.getAsString(policy_);
+        return type.getUnqualifiedType().getAsString(policy_);
+    }
+
+    clang::ASTContext& ctx_;
+    clang::PrintingPolicy policy_;
+    std::set<const clang::Decl*> seen_;
+    std::vector<TypeInfo> types_;
+};
+
+struct Outputs {
+    std::string header;
+    std::string source;
+};
+
+class GenerateConsumer : public clang::ASTConsumer {
+public:
+    GenerateConsumer(clang::CompilerInstance& ci, Outputs outputs)
+        : ci_(ci)
+        , outputs_(std::move(outputs))
+    {
+    }
+
+    void HandleTranslationUnit(clang::ASTContext& ctx) override {
+        if (ci_.getDiagnostics().hasErrorOccurred()) return;
+
+        ObserveVisitor visitor(ctx);
+        visitor.TraverseDecl(ctx.getTranslationUnitDecl());
+        const auto& types = visitor.types();
+
+        if (!outputs_.header.empty()) {
+            write(outputs_.header, generate_header(types));
+        }
+        if (!outputs_.source.empty()) {
+            // The generated source includes the headers declaring the types;
+            // types declared in the designated file itself can't be reached
+            const clang::SourceManager& sm = ctx.getSourceManager();
+            std::string main_file = sm.getFilename(sm.getLocForStartOfFile(sm.getMainFileID())).str();
+            std::vector<TypeInfo> reachable;
+            std::vector<std::string> includes;
+            for (const auto& type : types) {
+                if (type.file == main_file) {
+                    report(clang::DiagnosticsEngine::Warning,
+                           "'" + type.name + "' is declared in the designated file; move it to a "
+                           "header to register it from source=");
+                    continue;
+                }
+                reachable.push_back(type);
+                if (std::find(includes.begin(), includes.end(), type.file) == includes.end()) {
+                    includes.push_back(type.file);
+                }
+            }
+            write(outputs_.source, generate_source(reachable, includes));
+        }
+    }
+
+private:
+    void report(clang::DiagnosticsEngine::Level level, const std::string& message) {
+        auto& diags = ci_.getDiagnostics();
+        diags.Report(diags.getCustomDiagID(level, "memglass-gen: %0")) << message;
+    }
+
+    // Leave unchanged outputs alone so dependents don't rebuild
+    void write(const std::string& path, const std::string& content) {
+        std::ifstream in(path, std::ios::binary);
+        if (in) {
+            std::string existing((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (existing == content) return;
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out || !(out << content)) {
+            report(clang::DiagnosticsEngine::Error, "cannot write " + path);
+        }
+    }
+
+    clang::CompilerInstance& ci_;
+    Outputs outputs_;
+};
+
+class GenerateAction : public clang::PluginASTAction {
+protected:
+    std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& ci,
+                                                          llvm::StringRef) override {
+        // Annotations live in ordinary comments (// @atomic), which Clang
+        // only keeps with -fparse-all-comments
+        ci.getLangOpts().CommentOpts.ParseAllComments = true;
+        return std::make_unique<GenerateConsumer>(ci, outputs_);
+    }
+
+    bool ParseArgs(const clang::CompilerInstance& ci, const std::vector<std::string>& args) override {
+        auto& diags = ci.getDiagnostics();
+        for (const auto& arg : args) {
+            llvm::StringRef a(arg);
+            if (a.consume_front("header=")) {
+                outputs_.header = a.str();
+            } else if (a.consume_front("source=")) {
+                outputs_.source = a.str();
+            } else {
+                diags.Report(diags.getCustomDiagID(clang::DiagnosticsEngine::Error,
+                                                   "memglass-gen: unknown plugin argument '%0'"))
+                    << arg;
+                return false;
+            }
+        }
+        if (outputs_.header.empty() && outputs_.source.empty()) {
+            diags.Report(diags.getCustomDiagID(clang::DiagnosticsEngine::Error,
+                                               "memglass-gen: needs header=<file> or source=<file>"));
+            return false;
+        }
+        return true;
+    }
+
+    ActionType getActionType() override { return AddAfterMainAction; }
+
+private:
+    Outputs outputs_;
+};
+
+} // anonymous namespace
+
+} // namespace memglass::gen
+
+static clang::ParsedAttrInfoRegistry::Add<memglass::gen::ObserveAttrInfo>
+    register_observe_attr("memglass-observe", "[[memglass::observe]] on observed types");
+
+static clang::FrontendPluginRegistry::Add<memglass::gen::GenerateAction>
+    register_generate_action("memglass-gen", "generate memglass type registration");
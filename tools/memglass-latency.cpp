@@ -0,0 +1,275 @@
+// memglass-latency: Per-message latency attribution for memglass sessions
+// Joins the producer's stamp(message_id, stage) calls per message and
+// prints per-stage and end-to-end latency percentiles every interval,
+// with the slowest messages broken down stage by stage
+
+#include <memglass/latency.hpp>
+#include <memglass/observer.hpp>
+
+#include <fmt/format.h>
+#include <csignal>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+using memglass::JoinOptions;
+using memglass::LatencyHistogram;
+using memglass::LatencyReport;
+using memglass::StampJoiner;
+
+static volatile bool g_running = true;
+
+void signal_handler(int) {
+    g_running = false;
+}
+
+// ============================================================================
+// Command-line interface
+// ============================================================================
+
+struct Options {
+    std::string session_name;
+    std::chrono::milliseconds interval{1000};
+    std::chrono::milliseconds poll{10};
+    JoinOptions join;
+    uint64_t count = 0;        // reports to print; 0 until Ctrl+C
+    bool cumulative = false;   // keep accumulating instead of one window per report
+    bool json = false;
+    bool help = false;
+};
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [OPTIONS] <session_name>\n"
+              << "\n"
+              << "Per-stage and end-to-end latency of messages stamped with memglass::stamp().\n"
+              << "\n"
+              << "Options:\n"
+              << "  -h, --help              Show this help message\n"
+              << "  -i, --interval <ms>     Report interval in milliseconds (default: 1000)\n"
+              << "  -n, --worst <n>         Slowest messages to break down (default: 10)\n"
+              << "  --final <stage>         Stage number that completes a message\n"
+              << "                          (default: highest stage named by the producer)\n"
+              << "  --timeout <ms>          Drop messages idle this long (default: 1000)\n"
+              << "  -c, --count <n>         Exit after n reports\n"
+              << "  --cumulative            Report totals since start, not per interval\n"
+              << "  --json                  One JSON object per report (NDJSON)\n"
+              << "\n"
+              << "The producer needs Config::stamp_ring_capacity > 0. Each stage row is the\n"
+              << "time from a message's previous stamped stage to that stage.\n"
+              << "\n"
+              << "Examples:\n"
+              << "  " << prog << " trading_engine\n"
+              << "  " << prog << " -i 5000 -n 3 trading_engine\n"
+              << "  " << prog << " --json -c 60 trading_engine > latency.ndjson\n";
+}
+
+bool need_value(int i, int argc, const std::string& arg, Options& opts) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << arg << " requires a value\n";
+        opts.help = true;
+        return false;
+    }
+    return true;
+}
+
+Options parse_args(int argc, char* argv[]) {
+    Options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            opts.help = true;
+            return opts;
+        }
+        else if (arg == "-i" || arg == "--interval") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.interval = std::chrono::milliseconds(std::stoul(argv[++i]));
+        }
+        else if (arg == "-n" || arg == "--worst") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.join.worst = std::stoul(argv[++i]);
+        }
+        else if (arg == "--final") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.join.final_stage = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--timeout") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.join.timeout = std::chrono::milliseconds(std::stoul(argv[++i]));
+        }
+        else if (arg == "-c" || arg == "--count") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.count = std::stoull(argv[++i]);
+        }
+        else if (arg == "--cumulative") {
+            opts.cumulative = true;
+        }
+        else if (arg == "--json") {
+            opts.json = true;
+        }
+        else if (arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            opts.help = true;
+            return opts;
+        }
+        else {
+            opts.session_name = arg;
+        }
+    }
+
+    return opts;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+std::string format_ns(uint64_t ns) {
+    if (ns < 10'000) return fmt::format("{}ns", ns);
+    if (ns < 10'000'000) return fmt::format("{:.1f}us", ns / 1e3);
+    if (ns < 10'000'000'000ull) return fmt::format("{:.1f}ms", ns / 1e6);
+    return fmt::format("{:.1f}s", ns / 1e9);
+}
+
+void print_row(const std::string& name, const LatencyHistogram& h) {
+    std::cout << fmt::format("{:<24} {:>10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n", name, h.count(),
+                             format_ns(static_cast<uint64_t>(h.mean())), format_ns(h.percentile(0.5)),
+                             format_ns(h.percentile(0.9)), format_ns(h.percentile(0.99)),
+                             format_ns(h.percentile(0.999)), format_ns(h.max()));
+}
+
+void print_text(const LatencyReport& r) {
+    std::cout << fmt::format("{} messages, {} incomplete, {} stamps missed\n", r.messages, r.incomplete,
+                             r.missed);
+    std::cout << fmt::format("{:<24} {:>10} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "STAGE", "COUNT", "MEAN",
+                             "P50", "P90", "P99", "P99.9", "MAX");
+    for (size_t i = 0; i < r.stages.size(); ++i) {
+        if (r.stages[i].count()) print_row(r.stage_names[i], r.stages[i]);
+    }
+    print_row("end to end", r.end_to_end);
+
+    if (!r.worst.empty()) {
+        std::cout << "\nSlowest messages:\n";
+        for (const auto& m : r.worst) {
+            std::string line = fmt::format("  {:>20} {:>9} ", m.message_id, format_ns(m.total_ns));
+            uint64_t prev = 0;
+            for (const auto& [stage, at] : m.stages) {
+                const std::string& name = stage < r.stage_names.size() ? r.stage_names[stage] : "?";
+                line += fmt::format(" {} +{}", name, format_ns(at - prev));
+                prev = at;
+            }
+            std::cout << line << "\n";
+        }
+    }
+    std::cout << "\n" << std::flush;
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+            continue;
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string json_histogram(const LatencyHistogram& h) {
+    return fmt::format("\"count\":{},\"mean\":{:.1f},\"min\":{},\"p50\":{},\"p90\":{},\"p99\":{},"
+                       "\"p999\":{},\"max\":{}",
+                       h.count(), h.mean(), h.min(), h.percentile(0.5), h.percentile(0.9),
+                       h.percentile(0.99), h.percentile(0.999), h.max());
+}
+
+void print_json(const LatencyReport& r, uint64_t time_ns) {
+    std::string out = fmt::format("{{\"time_ns\":{},\"messages\":{},\"incomplete\":{},\"missed\":{},\"stages\":[",
+                                  time_ns, r.messages, r.incomplete, r.missed);
+    bool first = true;
+    for (size_t i = 0; i < r.stages.size(); ++i) {
+        if (!r.stages[i].count()) continue;
+        if (!first) out += ",";
+        first = false;
+        out += fmt::format("{{\"stage\":{},{}}}", json_string(r.stage_names[i]), json_histogram(r.stages[i]));
+    }
+    out += fmt::format("],\"end_to_end\":{{{}}},\"worst\":[", json_histogram(r.end_to_end));
+    for (size_t w = 0; w < r.worst.size(); ++w) {
+        const auto& m = r.worst[w];
+        if (w) out += ",";
+        out += fmt::format("{{\"message_id\":{},\"start_ns\":{},\"total_ns\":{},\"stages\":[", m.message_id,
+                           m.start_ns, m.total_ns);
+        for (size_t s = 0; s < m.stages.size(); ++s) {
+            const auto& [stage, at] = m.stages[s];
+            std::string name = stage < r.stage_names.size() ? r.stage_names[stage] : std::to_string(stage);
+            if (s) out += ",";
+            out += fmt::format("{{\"stage\":{},\"at_ns\":{}}}", json_string(name), at);
+        }
+        out += "]}";
+    }
+    out += "]}";
+    std::cout << out << "\n" << std::flush;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    Options opts = parse_args(argc, argv);
+
+    if (opts.help) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (opts.session_name.empty()) {
+        std::cerr << "Error: session name required\n\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    memglass::Observer obs(opts.session_name);
+
+    std::cerr << "Connecting to session '" << opts.session_name << "'...\n";
+
+    if (!obs.connect()) {
+        std::cerr << "Failed to connect. Is the producer running?\n";
+        return 1;
+    }
+
+    std::cerr << "Connected to PID: " << obs.producer_pid() << "\n";
+
+    StampJoiner joiner(obs, opts.join);
+    if (!joiner.attach()) {
+        std::cerr << "Session has no stamps ring (set Config::stamp_ring_capacity)\n";
+        return 1;
+    }
+
+    uint64_t reports = 0;
+    auto next = std::chrono::steady_clock::now() + opts.interval;
+    while (g_running) {
+        std::this_thread::sleep_for(opts.poll);
+        joiner.poll();
+
+        if (std::chrono::steady_clock::now() < next) continue;
+        next += opts.interval;
+
+        if (opts.json) {
+            print_json(joiner.report(), memglass::TscClock::wall_now());
+        } else {
+            print_text(joiner.report());
+        }
+        if (!opts.cumulative) joiner.reset();
+        if (opts.count && ++reports >= opts.count) break;
+    }
+
+    return 0;
+}
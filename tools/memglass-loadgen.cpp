@@ -0,0 +1,549 @@
+// memglass-loadgen: synthetic producer for load-testing the observer tools
+// Registers N generated types of M fields (mixed atomicity), creates K
+// objects and updates them from T threads at a fixed rate, with optional
+// create/destroy churn, and reports its own write throughput
+
+#include <memglass/memglass.hpp>
+#include <memglass/registry.hpp>
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using memglass::Atomicity;
+using memglass::PrimitiveType;
+
+static std::atomic<bool> g_running{true};
+
+void signal_handler(int) {
+    g_running = false;
+}
+
+// ============================================================================
+// Command-line interface
+// ============================================================================
+
+enum class Distribution {
+    Uniform,
+    Zipf
+};
+
+struct Options {
+    std::string session_name = "loadgen";
+    uint32_t types = 10;
+    uint32_t fields = 16;
+    size_t objects = 10000;
+    unsigned threads = 1;
+    double rate = 100000;          // field writes per second, 0 = unthrottled
+    double churn = 0;              // destroy + create pairs per second
+    Distribution distribution = Distribution::Uniform;
+    double zipf_s = 1.0;
+    double weights[4] = {1, 1, 1, 1};  // none, atomic, seqlock, locked
+    double duration_s = 0;         // 0 = until interrupted
+    double report_s = 1;
+    uint64_t seed = 1;
+    bool help = false;
+};
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [OPTIONS] [session_name]\n"
+              << "\n"
+              << "Synthetic memglass producer for load-testing observers and tools.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -h, --help              Show this help message\n"
+              << "  -n, --objects <k>       Live objects (default: 10000)\n"
+              << "  -t, --types <n>         Generated types (default: 10)\n"
+              << "  -f, --fields <m>        Fields per type (default: 16)\n"
+              << "  -j, --threads <t>       Writer threads; each owns a slice of the\n"
+              << "                          objects (default: 1)\n"
+              << "  -r, --rate <n>          Field writes per second across all threads,\n"
+              << "                          0 for as fast as possible (default: 100000)\n"
+              << "  -c, --churn <n>         Objects destroyed and re-created per second\n"
+              << "                          (default: 0)\n"
+              << "  -D, --dist <d>          Object choice: uniform (default), zipf[:s]\n"
+              << "  -A, --atomicity <mix>   Field atomicity weights, e.g.\n"
+              << "                          none=4,atomic=2,seqlock=1,locked=1\n"
+              << "                          (default: equal)\n"
+              << "  -d, --duration <s>      Stop after s seconds (default: until Ctrl+C)\n"
+              << "  --report <s>            Throughput report interval (default: 1)\n"
+              << "  --seed <n>              Layout and workload seed (default: 1)\n"
+              << "\n"
+              << "Types are named Load<i>, objects obj<k>; the session defaults to 'loadgen'.\n"
+              << "\n"
+              << "Examples:\n"
+              << "  " << prog << " -n 1000000 -j 4 -r 0 big\n"
+              << "  " << prog << " -n 50000 -r 1e6 -c 1000 -D zipf:1.2 -A none=1,seqlock=1\n";
+}
+
+bool parse_atomicity_mix(std::string_view spec, double (&weights)[4]) {
+    static constexpr std::string_view names[4] = {"none", "atomic", "seqlock", "locked"};
+    double parsed[4] = {0, 0, 0, 0};
+    while (!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+
+        size_t eq = item.find('=');
+        if (eq == std::string_view::npos) return false;
+        auto it = std::find(std::begin(names), std::end(names), item.substr(0, eq));
+        if (it == std::end(names)) return false;
+
+        std::string value(item.substr(eq + 1));
+        char* end = nullptr;
+        double w = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !(w >= 0)) return false;
+        parsed[it - std::begin(names)] = w;
+    }
+    if (parsed[0] + parsed[1] + parsed[2] + parsed[3] <= 0) return false;
+    std::copy(std::begin(parsed), std::end(parsed), weights);
+    return true;
+}
+
+bool parse_number(const char* text, double& out) {
+    char* end = nullptr;
+    out = std::strtod(text, &end);
+    return *text != '\0' && *end == '\0' && out >= 0;
+}
+
+Options parse_args(int argc, char* argv[]) {
+    Options opts;
+
+    auto value = [&](int& i, std::string_view arg, double& out) {
+        if (i + 1 >= argc || !parse_number(argv[i + 1], out)) {
+            std::cerr << "Error: " << arg << " requires a non-negative number\n";
+            opts.help = true;
+            return false;
+        }
+        ++i;
+        return true;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        double v = 0;
+
+        if (arg == "-h" || arg == "--help") {
+            opts.help = true;
+            return opts;
+        }
+        else if (arg == "-n" || arg == "--objects") {
+            if (!value(i, arg, v) || v < 1) { opts.help = true; return opts; }
+            opts.objects = static_cast<size_t>(v);
+        }
+        else if (arg == "-t" || arg == "--types") {
+            if (!value(i, arg, v) || v < 1) { opts.help = true; return opts; }
+            opts.types = static_cast<uint32_t>(v);
+        }
+        else if (arg == "-f" || arg == "--fields") {
+            if (!value(i, arg, v) || v < 1) { opts.help = true; return opts; }
+            opts.fields = static_cast<uint32_t>(v);
+        }
+        else if (arg == "-j" || arg == "--threads") {
+            if (!value(i, arg, v) || v < 1) { opts.help = true; return opts; }
+            opts.threads = static_cast<unsigned>(v);
+        }
+        else if (arg == "-r" || arg == "--rate") {
+            if (!value(i, arg, opts.rate)) return opts;
+        }
+        else if (arg == "-c" || arg == "--churn") {
+            if (!value(i, arg, opts.churn)) return opts;
+        }
+        else if (arg == "-d" || arg == "--duration") {
+            if (!value(i, arg, opts.duration_s)) return opts;
+        }
+        else if (arg == "--report") {
+            if (!value(i, arg, opts.report_s) || opts.report_s <= 0) { opts.help = true; return opts; }
+        }
+        else if (arg == "--seed") {
+            if (!value(i, arg, v)) return opts;
+            opts.seed = static_cast<uint64_t>(v);
+        }
+        else if (arg == "-D" || arg == "--dist") {
+            std::string_view d = i + 1 < argc ? std::string_view(argv[++i]) : std::string_view{};
+            if (d == "uniform") {
+                opts.distribution = Distribution::Uniform;
+            } else if (d == "zipf" || d.substr(0, 5) == "zipf:") {
+                opts.distribution = Distribution::Zipf;
+                if (d.size() > 5 && (!parse_number(std::string(d.substr(5)).c_str(), opts.zipf_s) ||
+                                     opts.zipf_s <= 0)) {
+                    std::cerr << "Error: invalid zipf exponent in '" << d << "'\n";
+                    opts.help = true;
+                    return opts;
+                }
+            } else {
+                std::cerr << "Error: " << arg << " requires uniform or zipf[:s]\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if (arg == "-A" || arg == "--atomicity") {
+            if (i + 1 >= argc || !parse_atomicity_mix(argv[i + 1], opts.weights)) {
+                std::cerr << "Error: " << arg << " requires <mode>=<weight>[,...]\n";
+                opts.help = true;
+                return opts;
+            }
+            ++i;
+        }
+        else if (arg[0] == '-') {
+            std::cerr << "Error: unknown option '" << arg << "'\n";
+            opts.help = true;
+            return opts;
+        }
+        else {
+            opts.session_name = arg;
+        }
+    }
+
+    return opts;
+}
+
+// ============================================================================
+// Generated types
+// ============================================================================
+
+struct FieldSlot {
+    uint32_t offset;
+    PrimitiveType type;
+    Atomicity atomicity;
+};
+
+struct Shape {
+    uint32_t type_id = 0;
+    uint32_t size = 0;
+    uint32_t alignment = 1;
+    std::vector<FieldSlot> fields;
+};
+
+// Field value types cycle through these
+constexpr PrimitiveType FIELD_TYPES[] = {
+    PrimitiveType::Int64, PrimitiveType::Float64, PrimitiveType::Int32,
+    PrimitiveType::UInt64, PrimitiveType::Float32, PrimitiveType::UInt32,
+};
+
+struct FieldLayout {
+    uint32_t value_size;
+    uint32_t size;       // of the wrapper the atomicity uses
+    uint32_t alignment;
+};
+
+template<typename T>
+FieldLayout wrapper_layout(Atomicity atomicity) {
+    switch (atomicity) {
+        case Atomicity::Atomic:
+            return {sizeof(T), sizeof(std::atomic<T>), alignof(std::atomic<T>)};
+        case Atomicity::Seqlock:
+            return {sizeof(T), sizeof(memglass::Guarded<T>), alignof(memglass::Guarded<T>)};
+        case Atomicity::Locked:
+            return {sizeof(T), sizeof(memglass::Locked<T>), alignof(memglass::Locked<T>)};
+        default:
+            return {sizeof(T), sizeof(T), alignof(T)};
+    }
+}
+
+FieldLayout field_layout(PrimitiveType type, Atomicity atomicity) {
+    switch (type) {
+        case PrimitiveType::Int32: return wrapper_layout<int32_t>(atomicity);
+        case PrimitiveType::UInt32: return wrapper_layout<uint32_t>(atomicity);
+        case PrimitiveType::UInt64: return wrapper_layout<uint64_t>(atomicity);
+        case PrimitiveType::Float32: return wrapper_layout<float>(atomicity);
+        case PrimitiveType::Float64: return wrapper_layout<double>(atomicity);
+        default: return wrapper_layout<int64_t>(atomicity);
+    }
+}
+
+// Register the generated types. The registry keeps string_views, so the
+// names live in `names` for the life of the process.
+std::vector<Shape> register_shapes(const Options& opts, std::deque<std::string>& names) {
+    static constexpr Atomicity modes[4] = {
+        Atomicity::None, Atomicity::Atomic, Atomicity::Seqlock, Atomicity::Locked};
+
+    std::mt19937_64 rng(opts.seed);
+    std::discrete_distribution<int> pick_mode(std::begin(opts.weights), std::end(opts.weights));
+
+    std::vector<Shape> shapes(opts.types);
+    for (uint32_t t = 0; t < opts.types; ++t) {
+        Shape& shape = shapes[t];
+        memglass::TypeDescriptor desc;
+        desc.name = names.emplace_back(fmt::format("Load{}", t));
+
+        uint32_t offset = 0;
+        for (uint32_t f = 0; f < opts.fields; ++f) {
+            PrimitiveType type = FIELD_TYPES[(t + f) % std::size(FIELD_TYPES)];
+            Atomicity atomicity = modes[pick_mode(rng)];
+
+            FieldLayout layout = field_layout(type, atomicity);
+            offset = (offset + layout.alignment - 1) / layout.alignment * layout.alignment;
+            shape.alignment = std::max(shape.alignment, layout.alignment);
+
+            desc.fields.push_back({names.emplace_back(fmt::format("f{}", f)), offset,
+                                   layout.value_size, type, 0, 0, atomicity, false});
+            shape.fields.push_back({offset, type, atomicity});
+            offset += layout.size;
+        }
+        shape.size = (offset + shape.alignment - 1) / shape.alignment * shape.alignment;
+        desc.size = shape.size;
+        desc.alignment = shape.alignment;
+        shape.type_id = memglass::registry::register_type(desc);
+    }
+    return shapes;
+}
+
+// Write through the same protocol the observer reads with
+template<typename T>
+void write_as(char* p, Atomicity atomicity, T value) {
+    switch (atomicity) {
+        case Atomicity::Atomic:
+            reinterpret_cast<std::atomic<T>*>(p)->store(value, std::memory_order_release);
+            break;
+        case Atomicity::Seqlock:
+            reinterpret_cast<memglass::Guarded<T>*>(p)->write(value);
+            break;
+        case Atomicity::Locked:
+            reinterpret_cast<memglass::Locked<T>*>(p)->write(value);
+            break;
+        default:
+            *reinterpret_cast<T*>(p) = value;
+            break;
+    }
+}
+
+void write_field(char* object, const FieldSlot& field, uint64_t n) {
+    char* p = object + field.offset;
+    switch (field.type) {
+        case PrimitiveType::Int32: write_as<int32_t>(p, field.atomicity, static_cast<int32_t>(n)); break;
+        case PrimitiveType::UInt32: write_as<uint32_t>(p, field.atomicity, static_cast<uint32_t>(n)); break;
+        case PrimitiveType::UInt64: write_as<uint64_t>(p, field.atomicity, n); break;
+        case PrimitiveType::Float32: write_as<float>(p, field.atomicity, n * 0.25f); break;
+        case PrimitiveType::Float64: write_as<double>(p, field.atomicity, n * 0.25); break;
+        default: write_as<int64_t>(p, field.atomicity, static_cast<int64_t>(n)); break;
+    }
+}
+
+// ============================================================================
+// Objects and writers
+// ============================================================================
+
+// One live object. Churn destroys it and registers the same memory again,
+// so sustained churn does not grow the regions.
+struct Slot {
+    char* data = nullptr;
+    uint64_t region_id = 0;
+    uint64_t offset = 0;
+    const Shape* shape = nullptr;
+    memglass::ObjectHandle handle;
+    std::string label;
+};
+
+bool create_slots(const Options& opts, const std::vector<Shape>& shapes, std::vector<Slot>& slots) {
+    auto* ctx = memglass::detail::get_context();
+    slots.resize(opts.objects);
+    for (size_t k = 0; k < slots.size(); ++k) {
+        Slot& slot = slots[k];
+        slot.shape = &shapes[k % shapes.size()];
+        slot.label = fmt::format("obj{}", k);
+
+        void* p = ctx->regions().allocate(slot.shape->size, slot.shape->alignment,
+                                          &slot.region_id, &slot.offset);
+        if (!p) return false;
+        slot.data = static_cast<char*>(p);
+        std::memset(slot.data, 0, slot.shape->size);
+
+        slot.handle = ctx->objects().register_object(slot.region_id, slot.offset,
+                                                     slot.shape->type_id, slot.label);
+        if (!slot.handle) return false;
+    }
+    return true;
+}
+
+struct alignas(64) WriterStats {
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> churned{0};
+    std::atomic<uint64_t> busy_ns{0};  // time spent writing, excluding sleeps
+};
+
+// Owns slots [begin, end); nothing else writes them, as Guarded<T> requires
+void run_writer(const Options& opts, std::vector<Slot>& slots, size_t begin, size_t end,
+                unsigned index, WriterStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    auto* ctx = memglass::detail::get_context();
+    size_t count = end - begin;
+    if (count == 0) return;
+
+    std::mt19937_64 rng(opts.seed * 1000003 + index);
+    std::uniform_int_distribution<size_t> uniform(0, count - 1);
+
+    // Rank r is chosen with probability proportional to 1 / (r + 1)^s
+    std::vector<double> zipf_cdf;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (opts.distribution == Distribution::Zipf) {
+        zipf_cdf.resize(count);
+        double total = 0;
+        for (size_t r = 0; r < count; ++r) {
+            total += 1.0 / std::pow(static_cast<double>(r + 1), opts.zipf_s);
+            zipf_cdf[r] = total;
+        }
+        for (double& c : zipf_cdf) c /= total;
+    }
+    auto pick = [&]() -> size_t {
+        if (zipf_cdf.empty()) return begin + uniform(rng);
+        size_t r = std::lower_bound(zipf_cdf.begin(), zipf_cdf.end(), unit(rng)) - zipf_cdf.begin();
+        return begin + std::min(r, count - 1);
+    };
+
+    // Writes go out in batches; the schedule, not the sleep, sets the rate
+    constexpr uint64_t BATCH = 256;
+    double rate = opts.rate / opts.threads;
+    double churn = opts.churn / opts.threads;
+    auto start = Clock::now();
+    uint64_t writes = 0;
+    uint64_t churned = 0;
+    Clock::duration busy{};
+
+    while (g_running) {
+        auto batch_start = Clock::now();
+        for (uint64_t i = 0; i < BATCH; ++i) {
+            Slot& slot = slots[pick()];
+            const auto& fields = slot.shape->fields;
+            write_field(slot.data, fields[writes % fields.size()], writes);
+            ++writes;
+        }
+        auto now = Clock::now();
+        busy += now - batch_start;
+        stats.writes.store(writes, std::memory_order_relaxed);
+        stats.busy_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+                            std::memory_order_relaxed);
+
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        while (churn > 0 && churned < elapsed * churn) {
+            Slot& slot = slots[begin + uniform(rng)];
+            ctx->objects().destroy_object(slot.handle);
+            std::memset(slot.data, 0, slot.shape->size);
+            slot.handle = ctx->objects().register_object(slot.region_id, slot.offset,
+                                                         slot.shape->type_id, slot.label);
+            ++churned;
+        }
+        stats.churned.store(churned, std::memory_order_relaxed);
+
+        if (rate > 0) {
+            auto due = start + std::chrono::duration_cast<Clock::duration>(
+                                   std::chrono::duration<double>(writes / rate));
+            std::this_thread::sleep_until(due);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    Options opts = parse_args(argc, argv);
+    if (opts.help) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    opts.threads = static_cast<unsigned>(std::min<size_t>(opts.threads, opts.objects));
+
+    std::deque<std::string> names;
+    std::vector<Shape> shapes = register_shapes(opts, names);
+
+    memglass::Config config;
+    config.max_types = opts.types + 16;
+    config.max_fields = opts.types * opts.fields + 256;
+    config.max_objects = static_cast<uint32_t>(std::max<size_t>(opts.objects, 4096));
+    if (!memglass::init(opts.session_name, config)) {
+        std::cerr << "Error: failed to create session '" << opts.session_name << "'\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto setup_start = Clock::now();
+    std::vector<Slot> slots;
+    if (!create_slots(opts, shapes, slots)) {
+        std::cerr << "Error: out of shared memory after " << slots.size() << " objects\n";
+        memglass::shutdown();
+        return 1;
+    }
+    size_t bytes = 0;
+    for (const auto& shape : shapes) bytes += shape.size;
+    std::cerr << fmt::format(
+        "Session '{}': {} objects of {} types x {} fields (~{:.1f} MB), created in {:.3f} s\n",
+        opts.session_name, opts.objects, opts.types, opts.fields,
+        static_cast<double>(bytes) / shapes.size() * opts.objects / (1024 * 1024),
+        std::chrono::duration<double>(Clock::now() - setup_start).count());
+    std::cerr << fmt::format("{} threads, target {} writes/s, {} churn/s. Ctrl+C to stop.\n",
+                             opts.threads,
+                             opts.rate > 0 ? fmt::format("{:.0f}", opts.rate) : "unthrottled",
+                             opts.churn);
+
+    std::vector<WriterStats> stats(opts.threads);
+    std::vector<std::thread> writers;
+    for (unsigned t = 0; t < opts.threads; ++t) {
+        size_t begin = slots.size() * t / opts.threads;
+        size_t end = slots.size() * (t + 1) / opts.threads;
+        writers.emplace_back(run_writer, std::cref(opts), std::ref(slots), begin, end, t,
+                             std::ref(stats[t]));
+    }
+
+    auto totals = [&]() {
+        std::pair<uint64_t, uint64_t> sum{0, 0};
+        for (const auto& s : stats) {
+            sum.first += s.writes.load(std::memory_order_relaxed);
+            sum.second += s.churned.load(std::memory_order_relaxed);
+        }
+        return sum;
+    };
+
+    auto start = Clock::now();
+    auto last = start;
+    auto last_totals = totals();
+    auto next_report = start + std::chrono::duration_cast<Clock::duration>(
+                                   std::chrono::duration<double>(opts.report_s));
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        auto now = Clock::now();
+        if (opts.duration_s > 0 && now - start >= std::chrono::duration<double>(opts.duration_s)) {
+            g_running = false;
+        }
+        if (now < next_report && g_running) continue;
+
+        auto current = totals();
+        double dt = std::chrono::duration<double>(now - last).count();
+        if (dt > 0) {
+            std::cerr << fmt::format("{:.1f}s: {:.0f} writes/s, {:.0f} churn/s\n",
+                                     std::chrono::duration<double>(now - start).count(),
+                                     (current.first - last_totals.first) / dt,
+                                     (current.second - last_totals.second) / dt);
+        }
+        last = now;
+        last_totals = current;
+        next_report += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(opts.report_s));
+    }
+
+    for (auto& w : writers) w.join();
+
+    auto final_totals = totals();
+    uint64_t busy_ns = 0;
+    for (const auto& s : stats) busy_ns += s.busy_ns.load(std::memory_order_relaxed);
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cerr << fmt::format("\n{} writes, {} churned in {:.2f} s: {:.0f} writes/s, {:.1f} ns per write\n",
+                             final_totals.first, final_totals.second, elapsed,
+                             final_totals.first / elapsed,
+                             final_totals.first ? static_cast<double>(busy_ns) / final_totals.first : 0.0);
+
+    memglass::shutdown();
+    return 0;
+}
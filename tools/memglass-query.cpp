@@ -0,0 +1,385 @@
+// memglass-query: Time-series queries over MGDF recordings
+// Seeks by the block index, decodes matching blocks in parallel and
+// resamples object fields into columns (CSV or JSON); compacts raw
+// recordings into rollup files
+
+#include <memglass/mgdf.hpp>
+#include <memglass/query.hpp>
+#include <memglass/sink.hpp>
+
+#include <fmt/format.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+using memglass::query::Query;
+using memglass::query::QueryResult;
+using memglass::query::Series;
+
+// ============================================================================
+// Command-line interface
+// ============================================================================
+
+enum class OutputFormat { Csv, Json };
+
+struct Options {
+    std::string file;
+    Query query;
+    std::string from;  // parsed once the file is open (time of day needs a date)
+    std::string to;
+    OutputFormat output = OutputFormat::Csv;
+    bool stats = false;
+    bool list_blocks = false;
+    std::vector<std::string> compact;  // rollup resolutions, as given
+    std::string into;                  // compaction output for a single resolution
+    bool help = false;
+};
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [OPTIONS] <recording.mgd>\n"
+              << "       " << prog << " --compact <dur>[,<dur>...] [--into <file>] <recording.mgd>\n"
+              << "\n"
+              << "Query object fields from a binary memglass-diff recording or rollup file.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -h, --help              Show this help message\n"
+              << "  -l, --label <label>     Object label to select (repeatable; default all)\n"
+              << "  -f, --field <name>      Field name to select (repeatable; default all)\n"
+              << "  --from <time>           Range start (inclusive)\n"
+              << "  --to <time>             Range end (exclusive)\n"
+              << "  -r, --resample <dur>    Bucket width, e.g. 100ms, 1s, 5m\n"
+              << "  -a, --agg <fn>          Bucket aggregation: last (default), first, min,\n"
+              << "                          max, mean, sum, count\n"
+              << "  --fill                  Repeat the last value in empty buckets\n"
+              << "  -o, --output <fmt>      Output format: csv (default), json\n"
+              << "  -j, --threads <n>       Decoder threads (default: one per core)\n"
+              << "  --stats                 Print block pruning statistics to stderr\n"
+              << "  --blocks                List the block index and exit\n"
+              << "  --compact <dur>[,...]   Write a rollup file per resolution, named\n"
+              << "                          <recording>.<dur>.mgd, and exit\n"
+              << "  --into <file>           Compaction output (single resolution only)\n"
+              << "\n"
+              << "Rollup files answer -r at multiples of their resolution; without -r they\n"
+              << "return one bucket per rollup interval.\n"
+              << "\n"
+              << "Times are nanoseconds since the epoch, YYYY-MM-DDTHH:MM[:SS[.frac]] (UTC),\n"
+              << "or HH:MM[:SS[.frac]] on the UTC date the recording starts.\n"
+              << "\n"
+              << "Examples:\n"
+              << "  " << prog << " -l orderbook -f bid_price -r 1s --from 09:30 --to 16:00 day.mgd\n"
+              << "  " << prog << " -l risk -r 1m -a max -o json day.mgd\n"
+              << "  " << prog << " --compact 1s,1m day.mgd   # day.1s.mgd, day.1m.mgd\n"
+              << "  " << prog << " -l risk -r 1h -a max day.1m.mgd\n";
+}
+
+bool need_value(int i, int argc, const std::string& arg, Options& opts) {
+    if (i + 1 >= argc) {
+        std::cerr << "Error: " << arg << " requires a value\n";
+        opts.help = true;
+        return false;
+    }
+    return true;
+}
+
+Options parse_args(int argc, char* argv[]) {
+    Options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            opts.help = true;
+            return opts;
+        }
+        else if (arg == "-l" || arg == "--label") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.query.labels.push_back(argv[++i]);
+        }
+        else if (arg == "-f" || arg == "--field") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.query.fields.push_back(argv[++i]);
+        }
+        else if (arg == "--from") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.from = argv[++i];
+        }
+        else if (arg == "--to") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.to = argv[++i];
+        }
+        else if (arg == "-r" || arg == "--resample") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            if (!memglass::query::parse_duration(argv[++i], opts.query.interval_ns) ||
+                opts.query.interval_ns == 0) {
+                std::cerr << "Error: invalid duration '" << argv[i] << "'\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if (arg == "-a" || arg == "--agg") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            if (!memglass::query::parse_aggregation(argv[++i], opts.query.aggregation)) {
+                std::cerr << "Error: unknown aggregation '" << argv[i] << "'\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if (arg == "--fill") {
+            opts.query.fill = true;
+        }
+        else if (arg == "-o" || arg == "--output") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            std::string fmt = argv[++i];
+            if (fmt == "csv") {
+                opts.output = OutputFormat::Csv;
+            } else if (fmt == "json") {
+                opts.output = OutputFormat::Json;
+            } else {
+                std::cerr << "Error: unknown output format '" << fmt << "'\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if (arg == "-j" || arg == "--threads") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.query.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--stats") {
+            opts.stats = true;
+        }
+        else if (arg == "--blocks") {
+            opts.list_blocks = true;
+        }
+        else if (arg == "--compact") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            std::string_view list = argv[++i];
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                std::string_view item = list.substr(0, comma);
+                uint64_t ns;
+                if (!memglass::query::parse_duration(item, ns) || ns == 0) {
+                    std::cerr << "Error: invalid duration '" << item << "'\n";
+                    opts.help = true;
+                    return opts;
+                }
+                opts.compact.emplace_back(item);
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+        }
+        else if (arg == "--into") {
+            if (!need_value(i, argc, arg, opts)) return opts;
+            opts.into = argv[++i];
+        }
+        else if (arg[0] == '-') {
+            std::cerr << "Error: unknown option '" << arg << "'\n";
+            opts.help = true;
+            return opts;
+        }
+        else {
+            opts.file = arg;
+        }
+    }
+
+    if (opts.file.empty()) {
+        std::cerr << "Error: recording file required\n";
+        opts.help = true;
+    }
+    if (!opts.into.empty() && opts.compact.size() != 1) {
+        std::cerr << "Error: --into needs exactly one --compact resolution\n";
+        opts.help = true;
+    }
+
+    return opts;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+std::string format_value(const Series& s, size_t i) {
+    if (s.integer) {
+        return fmt::format("{}", s.ints[i]);
+    }
+    return fmt::format("{}", s.doubles[i]);
+}
+
+// Raw changes: one row per change
+void write_csv_long(const QueryResult& result) {
+    std::cout << "timestamp_ns,object,field,value\n";
+    for (const auto& s : result.series) {
+        std::string names;
+        memglass::append_csv_field(names, s.label);
+        names += ',';
+        memglass::append_csv_field(names, s.field);
+        for (size_t i = 0; i < s.size(); ++i) {
+            std::cout << fmt::format("{},{},{}\n", s.timestamps[i], names, format_value(s, i));
+        }
+    }
+}
+
+// Resampled: one row per bucket, one column per label.field
+void write_csv_wide(const QueryResult& result) {
+    std::string header = "timestamp_ns";
+    for (const auto& s : result.series) {
+        header += ',';
+        memglass::append_csv_field(header, s.label + "." + s.field);
+    }
+    std::cout << header << '\n';
+
+    // Merge the (sorted) bucket timestamps of all series
+    std::vector<size_t> pos(result.series.size(), 0);
+    while (true) {
+        uint64_t ts = UINT64_MAX;
+        for (size_t k = 0; k < result.series.size(); ++k) {
+            const auto& s = result.series[k];
+            if (pos[k] < s.size()) ts = std::min(ts, s.timestamps[pos[k]]);
+        }
+        if (ts == UINT64_MAX) break;
+
+        std::cout << ts;
+        for (size_t k = 0; k < result.series.size(); ++k) {
+            const auto& s = result.series[k];
+            std::cout << ',';
+            if (pos[k] < s.size() && s.timestamps[pos[k]] == ts) {
+                std::cout << format_value(s, pos[k]++);
+            }
+        }
+        std::cout << '\n';
+    }
+}
+
+void write_json(const QueryResult& result) {
+    std::cout << "{\"series\":[";
+    for (size_t k = 0; k < result.series.size(); ++k) {
+        const auto& s = result.series[k];
+        if (k > 0) std::cout << ',';
+        std::string names = "{\"object\":\"";
+        memglass::append_json_escaped(names, s.label);
+        names += "\",\"field\":\"";
+        memglass::append_json_escaped(names, s.field);
+        std::cout << names << "\",\"timestamps\":[";
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (i > 0) std::cout << ',';
+            std::cout << s.timestamps[i];
+        }
+        std::cout << "],\"values\":[";
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (i > 0) std::cout << ',';
+            std::cout << format_value(s, i);
+        }
+        std::cout << "]}";
+    }
+    std::cout << "]}\n";
+}
+
+void list_blocks(const memglass::mgdf::MappedFile& file) {
+    std::cout << fmt::format("{} blocks ({}{})\n", file.blocks().size(),
+                             file.has_index() ? "indexed" : "scanned, no index",
+                             file.is_rollup() ? ", rollup" : "");
+    std::cout << "offset,size,records,first_ts,last_ts\n";
+    for (const auto& b : file.blocks()) {
+        std::cout << fmt::format("{},{},{},{},{}\n", b.offset, b.size, b.record_count,
+                                 b.first_ts, b.last_ts);
+    }
+}
+
+// day.mgd -> day.1m.mgd
+std::string rollup_path(const std::string& recording, const std::string& resolution) {
+    std::string stem = recording;
+    if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".mgd") == 0) {
+        stem.resize(stem.size() - 4);
+    }
+    return fmt::format("{}.{}.mgd", stem, resolution);
+}
+
+int compact(const memglass::mgdf::MappedFile& file, const Options& opts) {
+    for (const auto& resolution : opts.compact) {
+        uint64_t interval = 0;
+        memglass::query::parse_duration(resolution, interval);
+        std::string path = opts.into.empty() ? rollup_path(opts.file, resolution) : opts.into;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: cannot create '" << path << "'\n";
+            return 1;
+        }
+
+        memglass::query::CompactStats st;
+        std::string error;
+        if (!memglass::query::compact(file, interval, out, &st, &error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        std::cerr << fmt::format("{}: {} records -> {} rollups, {} -> {} bytes\n", path,
+                                 st.records, st.rollups, file.size(), st.bytes);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options opts = parse_args(argc, argv);
+
+    if (opts.help) {
+        print_usage(argv[0]);
+        return opts.file.empty() ? 1 : 0;
+    }
+
+    memglass::mgdf::MappedFile file;
+    std::string error;
+    if (!file.open(opts.file, &error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    if (opts.list_blocks) {
+        list_blocks(file);
+        return 0;
+    }
+
+    if (!opts.compact.empty()) {
+        return compact(file, opts);
+    }
+
+    uint64_t reference = file.blocks().empty() ? 0 : file.blocks().front().first_ts;
+    if (!opts.from.empty() &&
+        !memglass::query::parse_time(opts.from, reference, opts.query.start_ns)) {
+        std::cerr << "Error: invalid time '" << opts.from << "'\n";
+        return 1;
+    }
+    if (!opts.to.empty() &&
+        !memglass::query::parse_time(opts.to, reference, opts.query.end_ns)) {
+        std::cerr << "Error: invalid time '" << opts.to << "'\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    QueryResult result;
+    if (!memglass::query::run_query(file, opts.query, result, &error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if (opts.output == OutputFormat::Json) {
+        write_json(result);
+    } else if (opts.query.interval_ns != 0 || file.is_rollup()) {
+        write_csv_wide(result);
+    } else {
+        write_csv_long(result);
+    }
+
+    if (opts.stats) {
+        const auto& st = result.stats;
+        std::cerr << fmt::format("blocks: {} total, {} in range, {} decoded; "
+                                 "{} records, {} points, {} series in {:.3f} ms\n",
+                                 st.blocks_total, st.blocks_in_range, st.blocks_decoded,
+                                 st.records, st.points, result.series.size(),
+                                 std::chrono::duration<double, std::milli>(elapsed).count());
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 // Tree-based browser with expandable/collapsible hierarchy
 // Supports nested structs via field name prefixes (e.g., "quote.bid_price")
 // Optional web server mode for browser-based viewing
+#include <memglass/heartbeat.hpp>
+#include <memglass/ladder.hpp>
 #include <memglass/observer.hpp>
 
 #include <fmt/format.h>
@@ -20,10 +22,17 @@
 #include <set>
 #include <algorithm>
 
+#include <memglass/query.hpp>
+
 #ifdef MEMGLASS_WEB_ENABLED
+#include <memglass/compare.hpp>
 #include <httplib.h>
 #include <atomic>
 #include <cmath>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #endif
 
 static volatile bool g_running = true;
@@ -79,7 +88,8 @@ std::string atomicity_str(memglass::Atomicity a) {
 // Tree browser class
 class TreeBrowser {
 public:
-    TreeBrowser(memglass::Observer& obs) : obs_(obs) {}
+    TreeBrowser(memglass::Observer& obs, memglass::StallDetector* stalls = nullptr)
+        : obs_(obs), stalls_(stalls) {}
 
     void run() {
         // Set terminal to raw mode for single keypress detection
@@ -151,13 +161,14 @@ public:
 
 private:
     // Line types in the display
-    enum class LineType { Object, FieldGroup, Field };
+    enum class LineType { Object, FieldGroup, Field, Ladder };
 
     struct DisplayLine {
         LineType type;
         size_t object_index;
         std::string field_group;     // For FieldGroup lines (e.g., "quote", "position")
-        size_t field_index;          // For Field lines
+        std::string field_path;      // For Field lines (e.g., "quote.bid_price")
+        size_t field_index;          // Row for Ladder lines (0 = heading)
         int indent;
         std::string display_name;
     };
@@ -166,7 +177,7 @@ private:
     struct FieldGroupInfo {
         std::string group_name;      // e.g., "quote" or "" for ungrouped
         std::string field_name;      // e.g., "bid_price"
-        size_t original_index;       // Index in type's fields vector
+        std::string path;            // e.g., "quote.bid_price"
     };
 
     void refresh_objects() {
@@ -179,12 +190,11 @@ private:
 
         if (!type) return groups;
 
-        for (size_t i = 0; i < type->fields.size(); ++i) {
-            const auto& field = type->fields[i];
-            std::string full_name = field.name;
+        type->for_each_leaf([&](std::string_view path, const memglass::FieldRef&) {
+            std::string full_name(path);
 
             FieldGroupInfo info;
-            info.original_index = i;
+            info.path = full_name;
 
             // Check for dot notation (nested struct)
             size_t dot_pos = full_name.find('.');
@@ -197,7 +207,7 @@ private:
             }
 
             groups[info.group_name].push_back(info);
-        }
+        });
 
         return groups;
     }
@@ -247,7 +257,8 @@ private:
                                 field_line.type = LineType::Field;
                                 field_line.object_index = obj_idx;
                                 field_line.field_group = "";
-                                field_line.field_index = fi.original_index;
+                                field_line.field_path = fi.path;
+                                field_line.field_index = 0;
                                 field_line.indent = 1;
                                 field_line.display_name = fi.field_name;
                                 lines_.push_back(field_line);
@@ -265,13 +276,18 @@ private:
 
                             // If field group is expanded, add its fields
                             std::string expand_key = fmt::format("{}:{}", obj_idx, group_name);
-                            if (expanded_field_groups_.count(expand_key)) {
+                            auto books = memglass::find_books(*type_info);
+                            bool is_book = std::find(books.begin(), books.end(), group_name) != books.end();
+                            if (expanded_field_groups_.count(expand_key) && is_book) {
+                                add_ladder_lines(obj_idx, group_name, expand_key, *type_info);
+                            } else if (expanded_field_groups_.count(expand_key)) {
                                 for (const auto& fi : fields_in_group) {
                                     DisplayLine field_line;
                                     field_line.type = LineType::Field;
                                     field_line.object_index = obj_idx;
                                     field_line.field_group = group_name;
-                                    field_line.field_index = fi.original_index;
+                                    field_line.field_path = fi.path;
+                                    field_line.field_index = 0;
                                     field_line.indent = 2;
                                     field_line.display_name = fi.field_name;
                                     lines_.push_back(field_line);
@@ -289,6 +305,69 @@ private:
         }
     }
 
+    // One-line digest of a ScopeStats group: time, IPC and misses per call
+    std::string scope_summary(size_t obj_idx, const std::string& group) {
+        const auto& obj = objects_[obj_idx];
+        const memglass::ObservedType* type = obs_.get_type(obj.type_id);
+        if (!type || !type->find_field(group + ".ipc") || !type->find_field(group + ".ns_per_call")) {
+            return {};
+        }
+        auto view = obs_.get(obj);
+        if (!view) return {};
+        std::string out = fmt::format("{:.0f} ns/call", view[group + ".ns_per_call"].as<double>());
+        if (view[group + ".counters"].as<uint32_t>() == 0) return out + "  (timing only)";
+        return out + fmt::format("  IPC {:.2f}  LLC {:.2f}/call  br {:.2f}/call",
+                                 view[group + ".ipc"].as<double>(),
+                                 view[group + ".llc_misses_per_call"].as<double>(),
+                                 view[group + ".branch_misses_per_call"].as<double>());
+    }
+
+    // Books render as a price ladder, best levels on the first row
+    void add_ladder_lines(size_t obj_idx, const std::string& book, const std::string& expand_key,
+                          const memglass::ObservedType& type) {
+        memglass::Ladder& ladder = ladders_[expand_key];
+        ladder = {};
+        memglass::BookReader reader(type, book);
+        auto view = obs_.get(objects_[obj_idx]);
+        if (!view || !reader.read(view.data(), ladder)) {
+            ladder.bids.clear();
+            ladder.asks.clear();
+        }
+
+        size_t rows = std::max(ladder.bids.size(), ladder.asks.size());
+        for (size_t row = 0; row <= rows; ++row) {
+            DisplayLine line;
+            line.type = LineType::Ladder;
+            line.object_index = obj_idx;
+            line.field_group = book;
+            line.field_index = row;
+            line.indent = 2;
+            lines_.push_back(line);
+        }
+    }
+
+    void render_ladder_line(const DisplayLine& line) {
+        const auto& ladder = ladders_[fmt::format("{}:{}", line.object_index, line.field_group)];
+        if (line.field_index == 0) {
+            std::cout << fmt::format("\033[0;37m{:>8} {:>12} {:>12} | {:<12} {:<12} {:<8}\033[0m",
+                                     "orders", "bid qty", "bid", "ask", "ask qty", "orders");
+            return;
+        }
+
+        size_t i = line.field_index - 1;
+        std::string bid = fmt::format("{:>8} {:>12} {:>12}", "", "", "");
+        std::string ask = fmt::format("{:<12} {:<12} {:<8}", "", "", "");
+        if (i < ladder.bids.size()) {
+            const auto& l = ladder.bids[i];
+            bid = fmt::format("{:>8} {:>12} {:>12}", l.orders, l.qty, l.price);
+        }
+        if (i < ladder.asks.size()) {
+            const auto& l = ladder.asks[i];
+            ask = fmt::format("{:<12} {:<12} {:<8}", l.price, l.qty, l.orders);
+        }
+        std::cout << fmt::format("\033[0;32m{}\033[0m | \033[0;31m{}\033[0m", bid, ask);
+    }
+
     void render() {
         build_display_lines();
 
@@ -299,7 +378,8 @@ private:
         int term_width = ws.ws_col;
 
         // Calculate visible range
-        int header_lines = 3;
+        bool threads_line = stalls_ && stalls_->attached();
+        int header_lines = threads_line ? 4 : 3;
         int footer_lines = show_help_ ? 6 : 2;
         int visible_lines = term_height - header_lines - footer_lines;
         if (visible_lines < 1) visible_lines = 1;
@@ -319,7 +399,10 @@ private:
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count() % 100000;
         std::cout << "\033[1;36m=== Memglass Browser ===\033[0m\n";
         std::cout << "PID: " << obs_.producer_pid() << "  Objects: " << objects_.size();
-        std::cout << "  Seq: " << obs_.sequence() << "  t:" << ms << "\n";
+        std::cout << "  Seq: " << obs_.sequence() << "  t:" << ms;
+        if (obs_.paused()) std::cout << "  \033[1;33m[paused]\033[0m";
+        std::cout << "\n";
+        if (threads_line) render_threads();
         std::cout << std::string(std::min(term_width, 80), '-') << "\n";
 
         // Content
@@ -354,6 +437,16 @@ private:
                 std::cout << fmt::format("\033[0;32m{}\033[0m", line.display_name);
                 if (is_selected) std::cout << "\033[7m";
 
+                std::string summary = scope_summary(line.object_index, line.field_group);
+                if (!summary.empty()) {
+                    std::cout << fmt::format("  \033[0;36m{}\033[0m", summary);
+                    if (is_selected) std::cout << "\033[7m";
+                }
+
+            } else if (line.type == LineType::Ladder) {
+                render_ladder_line(line);
+                if (is_selected) std::cout << "\033[7m";
+
             } else {  // Field
                 const auto& obj = objects_[line.object_index];
                 const memglass::ObservedType* type_info = nullptr;
@@ -364,14 +457,14 @@ private:
                     }
                 }
 
-                if (type_info && line.field_index < type_info->fields.size()) {
-                    const auto& field = type_info->fields[line.field_index];
-
+                memglass::FieldRef field = type_info ? type_info->find_field(line.field_path)
+                                                     : memglass::FieldRef{};
+                if (field) {
                     // Get field value
                     auto view = obs_.get(obj);
                     std::string value = "<unavailable>";
                     if (view) {
-                        auto fv = view[field.name];
+                        auto fv = view[line.field_path];
                         if (fv) {
                             value = format_value(fv);
                         }
@@ -384,7 +477,7 @@ private:
                     if (is_selected) std::cout << "\033[7m";
 
                     // Atomicity indicator
-                    std::string atom = atomicity_str(field.atomicity);
+                    std::string atom = atomicity_str(field.entry->atomicity);
                     if (!atom.empty()) {
                         std::cout << fmt::format("\033[0;35m{}\033[0m", atom);
                         if (is_selected) std::cout << "\033[7m";
@@ -420,6 +513,22 @@ private:
         std::cout.flush();
     }
 
+    // Heartbeat line: thread count, then every stalled thread in red
+    void render_threads() {
+        const auto& threads = stalls_->check();
+        std::cout << "Threads: " << threads.size();
+        if (stalls_->stalled() == 0) {
+            std::cout << "  \033[0;32mall beating\033[0m\n";
+            return;
+        }
+        std::cout << "  \033[1;31mSTALLED:";
+        for (const auto& t : threads) {
+            if (!t.stalled) continue;
+            std::cout << fmt::format(" {} ({:.1f} ms)", t.name, t.silent_ns / 1e6);
+        }
+        std::cout << "\033[0m\n";
+    }
+
     void move_up() {
         if (cursor_ > 0) {
             cursor_--;
@@ -459,11 +568,13 @@ private:
     }
 
     memglass::Observer& obs_;
+    memglass::StallDetector* stalls_;
     std::vector<memglass::ObservedObject> objects_;
 
     // Expansion state
     std::set<size_t> expanded_objects_;
     std::set<std::string> expanded_field_groups_;  // "obj_idx:group_name"
+    std::map<std::string, memglass::Ladder> ladders_;  // expanded books, same keys
 
     // Display
     std::vector<DisplayLine> lines_;
@@ -671,6 +782,11 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
             color: #4ade80;
             font-weight: bold;
         }
+        .scope-summary {
+            color: #67e8f9;
+            margin-left: 12px;
+            font-size: 0.9em;
+        }
         .field {
             display: flex;
             align-items: center;
@@ -725,7 +841,27 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
         .status-bar .live {
             color: #4ade80;
         }
+        .header .info span.stalled {
+            color: #f87171;
+            font-weight: bold;
+        }
         .hidden { display: none; }
+        .ladder {
+            border-collapse: collapse;
+            margin: 4px 10px 8px;
+        }
+        .ladder th {
+            color: #888;
+            font-weight: normal;
+            padding: 2px 10px;
+        }
+        .ladder td {
+            padding: 2px 10px;
+            text-align: right;
+        }
+        .ladder td.bid { color: #4ade80; }
+        .ladder td.ask { color: #f87171; text-align: left; }
+        .ladder td.changed { animation: flash 0.3s ease-out; }
     </style>
 </head>
 <body>
@@ -735,6 +871,7 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
             <span>PID: <b id="pid">-</b></span>
             <span>Objects: <b id="obj-count">-</b></span>
             <span>Sequence: <b id="sequence">-</b></span>
+            <span id="threads" class="hidden"></span>
         </div>
         <div class="controls">
             <button onclick="refresh()">Refresh</button>
@@ -767,14 +904,29 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
                 document.getElementById('pid').textContent = data.pid;
                 document.getElementById('obj-count').textContent = data.objects.length;
                 document.getElementById('sequence').textContent = data.sequence;
-                document.getElementById('status').className = 'live';
-                document.getElementById('status').textContent = '● Live';
+                document.getElementById('status').className = data.paused ? '' : 'live';
+                document.getElementById('status').textContent = data.paused ? '● Paused' : '● Live';
+                renderThreads(data.threads);
             } catch (e) {
                 document.getElementById('status').className = '';
                 document.getElementById('status').textContent = '● Disconnected';
             }
         }
 
+        // Heartbeat summary: thread count, or the stalled threads in red
+        function renderThreads(threads) {
+            const el = document.getElementById('threads');
+            if (!threads) {
+                el.className = 'hidden';
+                return;
+            }
+            const stalled = threads.filter(t => t.stalled);
+            el.className = stalled.length ? 'stalled' : '';
+            el.innerHTML = stalled.length
+                ? 'STALLED: ' + stalled.map(t => `${escapeHtml(t.name)} (${(t.silent_ns / 1e6).toFixed(1)} ms)`).join(', ')
+                : `Threads: <b>${threads.length}</b>`;
+        }
+
         function getFieldGroups(fields) {
             const groups = {};
             for (const field of fields) {
@@ -825,8 +977,13 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
                             html += `<div class="field-group-header" onclick="toggleGroup('${groupKey}')">`;
                             html += `<span class="toggle">${isGroupExpanded ? '−' : '+'}</span>`;
                             html += `<span class="field-group-name">${escapeHtml(groupName)}</span>`;
+                            const summary = scopeSummary(fields);
+                            if (summary) html += `<span class="scope-summary">${summary}</span>`;
                             html += `</div>`;
-                            if (isGroupExpanded) {
+                            const book = (obj.books || []).find(b => b.name === groupName);
+                            if (isGroupExpanded && book) {
+                                html += renderLadder(obj.label, book);
+                            } else if (isGroupExpanded) {
                                 html += `<div class="fields">`;
                                 for (const field of fields) {
                                     html += renderField(obj.label, field);
@@ -867,6 +1024,39 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
             return html;
         }
 
+        // ScopeStats groups: time, IPC and misses per call on the header
+        function scopeSummary(fields) {
+            const f = {};
+            for (const field of fields) f[field.displayName] = field.value;
+            if (f.ipc === undefined || f.ns_per_call === undefined) return '';
+            const fixed = (v, d) => Number(v).toFixed(d);
+            let out = `${fixed(f.ns_per_call, 0)} ns/call`;
+            if (!f.counters) return out + ' (timing only)';
+            return out + ` &middot; IPC ${fixed(f.ipc, 2)} &middot; LLC ${fixed(f.llc_misses_per_call, 2)}/call` +
+                   ` &middot; br ${fixed(f.branch_misses_per_call, 2)}/call`;
+        }
+
+        // Order books: bids and asks side by side, best levels first
+        function renderLadder(objLabel, book) {
+            const cell = (side, level) => {
+                if (!level) return `<td></td><td></td><td></td>`;
+                const key = `${objLabel}.${book.name}.${side}@${level[0]}`;
+                const changed = previousValues[key] !== undefined && previousValues[key] !== level[1];
+                previousValues[key] = level[1];
+                const cls = `${side}${changed ? ' changed' : ''}`;
+                const cells = [formatValue(level[2]), formatValue(level[1]), formatValue(level[0])]
+                    .map((v, i) => `<td class="${i === 1 ? cls : side}">${v}</td>`);
+                return (side === 'ask' ? cells.reverse() : cells).join('');
+            };
+            let html = `<table class="ladder"><tr><th>orders</th><th>bid qty</th><th>bid</th>`;
+            html += `<th>ask</th><th>ask qty</th><th>orders</th></tr>`;
+            const rows = Math.max(book.bids.length, book.asks.length);
+            for (let i = 0; i < rows; i++) {
+                html += `<tr>${cell('bid', book.bids[i])}${cell('ask', book.asks[i])}</tr>`;
+            }
+            return html + `</table>`;
+        }
+
         function formatValue(v) {
             if (v === null || v === undefined) return '<null>';
             if (typeof v === 'number') {
@@ -954,11 +1144,128 @@ const char* WEB_UI_HTML = R"html(<!DOCTYPE html>
 </html>
 )html";
 
+// Embedded HTML/JS for the session comparison page (-w with --compare)
+const char* COMPARE_UI_HTML = R"html(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <title>Memglass Compare</title>
+    <style>
+        * { box-sizing: border-box; margin: 0; padding: 0; }
+        body {
+            font-family: 'SF Mono', 'Monaco', 'Inconsolata', 'Fira Code', monospace;
+            background: #1a1a2e;
+            color: #eee;
+            padding: 20px;
+        }
+        h1 { color: #00d9ff; font-size: 24px; margin-bottom: 10px; }
+        h2 { color: #00d9ff; font-size: 16px; margin: 20px 0 8px; }
+        .info { color: #888; font-size: 14px; }
+        .info span { color: #00d9ff; margin-right: 20px; }
+        table { border-collapse: collapse; width: 100%; font-size: 13px; }
+        th, td { text-align: left; padding: 4px 10px; border-bottom: 1px solid #0f3460; }
+        th { color: #888; font-weight: normal; }
+        .a { color: #ffd166; }
+        .b { color: #ef476f; }
+        .ok { color: #06d6a0; }
+        .muted { color: #666; font-size: 13px; }
+    </style>
+</head>
+<body>
+    <h1>Memglass Compare</h1>
+    <div class="info" id="info">Connecting...</div>
+
+    <h2>Diverged</h2>
+    <table>
+        <thead><tr><th>object.field</th><th>A</th><th>B</th><th>for</th></tr></thead>
+        <tbody id="diverged"></tbody>
+    </table>
+
+    <h2>Recent transitions</h2>
+    <table>
+        <thead><tr><th>time</th><th>event</th><th>object.field</th><th>A</th><th>B</th></tr></thead>
+        <tbody id="events"></tbody>
+    </table>
+
+    <h2>Unpaired</h2>
+    <div class="muted" id="unpaired"></div>
+
+    <script>
+        function escapeHtml(text) {
+            const div = document.createElement('div');
+            div.textContent = String(text);
+            return div.innerHTML;
+        }
+
+        function ms(ns) {
+            return (ns / 1e6).toFixed(1) + ' ms';
+        }
+
+        function clock(ns) {
+            return new Date(ns / 1e6).toISOString().substr(11, 12);
+        }
+
+        async function refresh() {
+            let d;
+            try {
+                d = await (await fetch('/api/compare')).json();
+            } catch (e) {
+                document.getElementById('info').textContent = 'Error: ' + e.message;
+                return;
+            }
+
+            const s = d.stats;
+            document.getElementById('info').innerHTML =
+                `A: <span class="a">${escapeHtml(d.a)}</span>` +
+                `B: <span class="b">${escapeHtml(d.b)}</span>` +
+                `Objects: <span>${s.objects}</span>Fields: <span>${s.fields}</span>` +
+                `Spans: <span>${s.spans}</span>Passes: <span>${s.compares}</span>`;
+
+            document.getElementById('diverged').innerHTML = d.diverged.length
+                ? d.diverged.map(x =>
+                    `<tr><td>${escapeHtml(x.obj + '.' + x.field)}</td>` +
+                    `<td class="a">${escapeHtml(x.a)}</td><td class="b">${escapeHtml(x.b)}</td>` +
+                    `<td>${ms(d.ts - x.since)}</td></tr>`).join('')
+                : '<tr><td class="ok" colspan="4">All paired fields within tolerance</td></tr>';
+
+            document.getElementById('events').innerHTML = d.events.slice().reverse().map(x =>
+                `<tr><td>${clock(x.ts)}</td>` +
+                `<td class="${x.event === 'converged' ? 'ok' : 'b'}">${x.event}</td>` +
+                `<td>${escapeHtml(x.obj + '.' + x.field)}</td>` +
+                `<td class="a">${escapeHtml(x.a)}</td><td class="b">${escapeHtml(x.b)}</td></tr>`).join('');
+
+            const unpaired = [];
+            if (d.only_in_a.length) unpaired.push('Only in A: ' + d.only_in_a.join(', '));
+            if (d.only_in_b.length) unpaired.push('Only in B: ' + d.only_in_b.join(', '));
+            if (d.unmatched.length) unpaired.push('One-sided fields: ' + d.unmatched.join(', '));
+            document.getElementById('unpaired').innerHTML =
+                unpaired.length ? unpaired.map(escapeHtml).join('<br>') : 'None';
+        }
+
+        refresh();
+        setInterval(refresh, 500);
+    </script>
+</body>
+</html>
+)html";
+
 class WebServer {
 public:
     WebServer(memglass::Observer& obs, int port)
         : obs_(obs), port_(port), running_(false) {}
 
+    // Report producer thread heartbeats in /api/data and /metrics
+    void watch_threads(memglass::StallDetector& stalls) {
+        stalls_ = &stalls;
+    }
+
+    // Also serve a live comparison of this session (A) against b
+    void compare_with(memglass::Observer& b, memglass::CompareOptions options) {
+        compare_ = std::make_unique<memglass::SessionComparator>(obs_, b, std::move(options));
+        compare_b_ = &b;
+    }
+
     void run() {
         httplib::Server svr;
 
@@ -969,13 +1276,33 @@ public:
 
         // API endpoint: get all data
         svr.Get("/api/data", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard<std::mutex> lock(mutex_);
             obs_.refresh();
             std::string json = build_json();
             res.set_content(json, "application/json");
         });
 
+        // Prometheus text exposition of thread heartbeats
+        svr.Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+            res.set_content(build_metrics(), "text/plain; version=0.0.4");
+        });
+
+        if (compare_) {
+            svr.Get("/compare", [](const httplib::Request&, httplib::Response& res) {
+                res.set_content(COMPARE_UI_HTML, "text/html");
+            });
+
+            // API endpoint: run a comparison pass
+            svr.Get("/api/compare", [this](const httplib::Request&, httplib::Response& res) {
+                res.set_content(build_compare_json(), "application/json");
+            });
+        }
+
         running_ = true;
         std::cerr << "Web server running at http://localhost:" << port_ << "\n";
+        if (compare_) {
+            std::cerr << "Comparison at http://localhost:" << port_ << "/compare\n";
+        }
         std::cerr << "Press Ctrl+C to stop.\n";
 
         // Run server in a way that can be interrupted
@@ -990,6 +1317,20 @@ private:
         // Producer info
         ss << "\"pid\":" << obs_.producer_pid() << ",";
         ss << "\"sequence\":" << obs_.sequence() << ",";
+        ss << "\"paused\":" << (obs_.paused() ? "true" : "false") << ",";
+        if (stalls_ && stalls_->attached()) {
+            ss << "\"threads\":[";
+            const auto& threads = stalls_->check();
+            for (size_t i = 0; i < threads.size(); ++i) {
+                const auto& t = threads[i];
+                if (i > 0) ss << ",";
+                ss << fmt::format("{{\"name\":\"{}\",\"tid\":{},\"count\":{},\"rate\":{:.1f},"
+                                  "\"silent_ns\":{},\"threshold_ns\":{},\"stalled\":{}}}",
+                                  json_escape(t.name), t.tid, t.count, t.rate, t.silent_ns,
+                                  t.threshold_ns, t.stalled ? "true" : "false");
+            }
+            ss << "],";
+        }
 
         // Types
         ss << "\"types\":[";
@@ -1026,20 +1367,57 @@ private:
                 }
             }
 
-            if (type_info && view) {
-                for (size_t j = 0; j < type_info->fields.size(); ++j) {
-                    if (j > 0) ss << ",";
-                    const auto& field = type_info->fields[j];
-                    auto fv = view[field.name];
+            // Book levels go out as ladders instead of one field per slot
+            std::vector<std::string> books;
+            if (type_info) books = memglass::find_books(*type_info);
+            auto is_level_field = [&](std::string_view name) {
+                for (const auto& book : books) {
+                    if (name.starts_with(book + ".bids[") || name.starts_with(book + ".asks[")) return true;
+                }
+                return false;
+            };
 
-                    ss << "{\"name\":\"" << json_escape(field.name) << "\""
-                       << ",\"value\":" << (fv ? format_value_json(fv) : "null")
-                       << ",\"atomicity\":" << atomicity_json(field.atomicity)
+            if (type_info && view) {
+                bool first = true;
+                char* data = static_cast<char*>(const_cast<void*>(view.data()));
+                type_info->for_each_leaf([&](std::string_view name, const memglass::FieldRef& field) {
+                    if (!books.empty() && is_level_field(name)) return;
+                    if (!first) ss << ",";
+                    first = false;
+                    memglass::FieldProxy fv(view, field.entry, data + field.offset());
+
+                    ss << "{\"name\":\"" << json_escape(std::string(name)) << "\""
+                       << ",\"value\":" << format_value_json(fv)
+                       << ",\"atomicity\":" << atomicity_json(field.entry->atomicity)
                        << "}";
+                });
+            }
+            ss << "]";
+
+            if (!books.empty() && view) {
+                ss << ",\"books\":[";
+                for (size_t j = 0; j < books.size(); ++j) {
+                    memglass::Ladder ladder;
+                    if (!memglass::BookReader(*type_info, books[j]).read(view.data(), ladder)) {
+                        ladder.bids.clear();
+                        ladder.asks.clear();
+                    }
+                    if (j > 0) ss << ",";
+                    ss << "{\"name\":\"" << json_escape(books[j]) << "\",\"epoch\":" << ladder.epoch;
+                    for (auto [side, levels] : {std::pair{"bids", &ladder.bids}, std::pair{"asks", &ladder.asks}}) {
+                        ss << ",\"" << side << "\":[";
+                        for (size_t k = 0; k < levels->size(); ++k) {
+                            const auto& l = (*levels)[k];
+                            ss << (k ? "," : "") << fmt::format("[{},{},{}]", l.price, l.qty, l.orders);
+                        }
+                        ss << "]";
+                    }
+                    ss << "}";
                 }
+                ss << "]";
             }
 
-            ss << "]}";
+            ss << "}";
         }
         ss << "]";
 
@@ -1047,13 +1425,402 @@ private:
         return ss.str();
     }
 
+    std::string build_metrics() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string out;
+        if (!stalls_ || !stalls_->attached()) return out;
+
+        const auto& threads = stalls_->check();
+        std::string session = json_escape(obs_.session_name());
+        auto labels = [&](const memglass::ThreadHeartbeat& t) {
+            return fmt::format("session=\"{}\",thread=\"{}\",tid=\"{}\"", session, json_escape(t.name), t.tid);
+        };
+
+        out += "# HELP memglass_thread_iterations_total Event-loop iterations (heartbeats) of a producer thread\n"
+               "# TYPE memglass_thread_iterations_total counter\n";
+        for (const auto& t : threads) {
+            fmt::format_to(std::back_inserter(out), "memglass_thread_iterations_total{{{}}} {}\n", labels(t), t.count);
+        }
+        out += "# HELP memglass_thread_silence_seconds Time since the thread's last heartbeat\n"
+               "# TYPE memglass_thread_silence_seconds gauge\n";
+        for (const auto& t : threads) {
+            fmt::format_to(std::back_inserter(out), "memglass_thread_silence_seconds{{{}}} {:.9f}\n", labels(t),
+                           t.silent_ns / 1e9);
+        }
+        out += "# HELP memglass_thread_stalled 1 if the thread has been silent longer than its threshold\n"
+               "# TYPE memglass_thread_stalled gauge\n";
+        for (const auto& t : threads) {
+            fmt::format_to(std::back_inserter(out), "memglass_thread_stalled{{{}}} {}\n", labels(t),
+                           t.stalled ? 1 : 0);
+        }
+        return out;
+    }
+
+    static void append_string_array(std::string& out, const std::vector<std::string>& items) {
+        out += '[';
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0) out += ',';
+            out += '"';
+            out += json_escape(items[i]);
+            out += '"';
+        }
+        out += ']';
+    }
+
+    static void append_divergence(std::string& out, const memglass::Divergence& d,
+                                  const char* event = nullptr, uint64_t ts = 0) {
+        out += '{';
+        if (event) {
+            fmt::format_to(std::back_inserter(out), "\"ts\":{},\"event\":\"{}\",", ts, event);
+        }
+        fmt::format_to(std::back_inserter(out),
+                       "\"obj\":\"{}\",\"field\":\"{}\",\"a\":\"{}\",\"b\":\"{}\",\"since\":{}}}",
+                       json_escape(std::string(d.label)), json_escape(std::string(d.field)),
+                       json_escape(d.a.to_string()), json_escape(d.b.to_string()), d.since_ns);
+    }
+
+    // One comparison pass; transitions are kept so slow pollers still see
+    // divergences that converged between two requests
+    std::string build_compare_json() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto& r = compare_->compare();
+
+        auto log = [&](const char* event, const memglass::Divergence& d) {
+            std::string entry;
+            append_divergence(entry, d, event, r.timestamp_ns);
+            events_.push_back(std::move(entry));
+            if (events_.size() > MAX_EVENTS) events_.pop_front();
+        };
+        for (const auto& d : r.diverged) {
+            if (d.since_ns == r.timestamp_ns) log("diverged", d);
+        }
+        for (const auto& d : r.converged) {
+            log("converged", d);
+        }
+
+        const auto& st = compare_->stats();
+        std::string out;
+        fmt::format_to(std::back_inserter(out),
+                       "{{\"a\":\"{}\",\"b\":\"{}\",\"ts\":{},"
+                       "\"stats\":{{\"objects\":{},\"fields\":{},\"spans\":{},"
+                       "\"slow_fields\":{},\"compares\":{},\"rebuilds\":{}}},",
+                       json_escape(obs_.session_name()), json_escape(compare_b_->session_name()),
+                       r.timestamp_ns, st.objects, st.fields, st.spans, st.slow_fields,
+                       st.compares, st.rebuilds);
+
+        out += "\"only_in_a\":";
+        append_string_array(out, compare_->only_in_a());
+        out += ",\"only_in_b\":";
+        append_string_array(out, compare_->only_in_b());
+        out += ",\"unmatched\":";
+        append_string_array(out, compare_->unmatched_fields());
+
+        out += ",\"diverged\":[";
+        for (size_t i = 0; i < r.diverged.size(); ++i) {
+            if (i > 0) out += ',';
+            append_divergence(out, r.diverged[i]);
+        }
+        out += "],\"events\":[";
+        for (size_t i = 0; i < events_.size(); ++i) {
+            if (i > 0) out += ',';
+            out += events_[i];
+        }
+        out += "]}";
+        return out;
+    }
+
+    static constexpr size_t MAX_EVENTS = 200;
+
     memglass::Observer& obs_;
     int port_;
+    std::unique_ptr<memglass::SessionComparator> compare_;
+    memglass::Observer* compare_b_ = nullptr;
+    memglass::StallDetector* stalls_ = nullptr;
+    std::mutex mutex_;  // requests run on a thread pool; the comparator refreshes obs_
+    std::deque<std::string> events_;
     std::atomic<bool> running_;
 };
 
 #endif // MEMGLASS_WEB_ENABLED
 
+// ============================================================================
+// One-shot commands: get, ls, check
+// ============================================================================
+
+// Exit codes, so scripts and health checks can branch without parsing
+constexpr int EXIT_OK = 0;          // value printed / condition true
+constexpr int EXIT_FALSE = 1;       // check: condition false
+constexpr int EXIT_USAGE = 2;
+constexpr int EXIT_NO_SESSION = 3;
+constexpr int EXIT_NOT_FOUND = 4;   // no such object or field
+
+// Value for scripts: full float precision, no quoting
+std::string format_plain(const memglass::FieldProxy& field) {
+    switch (static_cast<memglass::PrimitiveType>(field.info()->type_id)) {
+        case memglass::PrimitiveType::Float32:
+            return fmt::format("{}", field.as<float>());
+        case memglass::PrimitiveType::Float64:
+            return fmt::format("{}", field.as<double>());
+        case memglass::PrimitiveType::Char:
+            return std::string(1, field.as<char>());
+        default:
+            return format_value(field);
+    }
+}
+
+bool numeric_value(const memglass::FieldProxy& field, long double& out) {
+    switch (static_cast<memglass::PrimitiveType>(field.info()->type_id)) {
+        case memglass::PrimitiveType::Bool: out = field.as<bool>(); return true;
+        case memglass::PrimitiveType::Int8: out = field.as<int8_t>(); return true;
+        case memglass::PrimitiveType::UInt8: out = field.as<uint8_t>(); return true;
+        case memglass::PrimitiveType::Int16: out = field.as<int16_t>(); return true;
+        case memglass::PrimitiveType::UInt16: out = field.as<uint16_t>(); return true;
+        case memglass::PrimitiveType::Int32: out = field.as<int32_t>(); return true;
+        case memglass::PrimitiveType::UInt32: out = field.as<uint32_t>(); return true;
+        case memglass::PrimitiveType::Int64: out = field.as<int64_t>(); return true;
+        case memglass::PrimitiveType::UInt64: out = field.as<uint64_t>(); return true;
+        case memglass::PrimitiveType::Float32: out = field.as<float>(); return true;
+        case memglass::PrimitiveType::Float64: out = field.as<double>(); return true;
+        case memglass::PrimitiveType::Char: out = field.as<char>(); return true;
+        default: return false;
+    }
+}
+
+// Split "AAPL.position.quantity" into an object and a field path. Labels
+// may contain dots, so the longest existing label wins. Each attempt is
+// one label index lookup.
+bool resolve_path(memglass::Observer& obs, std::string_view path,
+                  memglass::ObjectView& view, std::string_view& field) {
+    size_t end = path.size();
+    while (true) {
+        view = obs.find(path.substr(0, end));
+        if (view) {
+            field = end < path.size() ? path.substr(end + 1) : std::string_view();
+            return true;
+        }
+        if (end == 0) return false;
+        end = path.rfind('.', end - 1);
+        if (end == std::string_view::npos || end == 0) return false;
+    }
+}
+
+void print_field(memglass::Observer& obs, const memglass::FieldProxy& field,
+                 const std::string& name) {
+    const memglass::FieldEntry* info = field.info();
+    bool is_array = info->flags & static_cast<uint32_t>(memglass::FieldFlags::IsArray);
+    bool is_nested = info->type_id >= static_cast<uint32_t>(memglass::PrimitiveType::UserTypeBase);
+    if (is_array && info->array_size > 0 && !is_nested) {
+        for (uint32_t i = 0; i < info->array_size; ++i) {
+            std::cout << name << "[" << i << "]=" << format_plain(field[static_cast<size_t>(i)]) << "\n";
+        }
+        return;
+    }
+    if (!is_nested) {
+        std::cout << name << "=" << format_plain(field) << "\n";
+        return;
+    }
+    const auto* nested = obs.get_type(info->type_id);
+    if (!nested) return;
+    uint32_t count = is_array ? info->array_size : 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        memglass::FieldProxy element = is_array ? field[static_cast<size_t>(i)] : field;
+        std::string prefix = is_array ? name + "[" + std::to_string(i) + "]" : name;
+        for (const auto& f : nested->fields) {
+            print_field(obs, element[std::string_view(f.name)], prefix + "." + f.name);
+        }
+    }
+}
+
+int command_get(memglass::Observer& obs, const std::vector<std::string>& paths) {
+    int status = EXIT_OK;
+    for (const auto& path : paths) {
+        memglass::ObjectView view;
+        std::string_view field_path;
+        if (!resolve_path(obs, path, view, field_path)) {
+            std::cerr << "No such object: " << path << "\n";
+            status = EXIT_NOT_FOUND;
+            continue;
+        }
+
+        // Whole object: one name=value line per primitive field
+        if (field_path.empty()) {
+            if (!view.type()) continue;
+            for (const auto& f : view.type()->fields) {
+                print_field(obs, view[std::string_view(f.name)], f.name);
+            }
+            continue;
+        }
+
+        auto field = view[field_path];
+        if (!field) {
+            std::cerr << "No such field: " << path << "\n";
+            status = EXIT_NOT_FOUND;
+            continue;
+        }
+        if (field.info()->type_id < static_cast<uint32_t>(memglass::PrimitiveType::UserTypeBase) &&
+            !(field.info()->flags & static_cast<uint32_t>(memglass::FieldFlags::IsArray))) {
+            // Single value: print it bare for $(memglass get ...)
+            std::cout << format_plain(field) << "\n";
+        } else {
+            print_field(obs, field, std::string(field_path));
+        }
+    }
+    return status;
+}
+
+int command_ls(memglass::Observer& obs, std::string_view prefix) {
+    auto objects = obs.objects();
+    std::sort(objects.begin(), objects.end(),
+              [](const auto& a, const auto& b) { return a.label < b.label; });
+    for (const auto& obj : objects) {
+        if (obj.label.compare(0, prefix.size(), prefix) != 0) continue;
+        std::cout << obj.label << "\t" << obj.type_name << "\n";
+    }
+    return EXIT_OK;
+}
+
+// "<path> <op> <value>", e.g. "AAPL.position.quantity < 1000"
+int command_check(memglass::Observer& obs, const std::string& expr) {
+    static constexpr std::string_view ops[] = {"==", "!=", "<=", ">=", "<", ">"};
+    size_t pos = std::string::npos;
+    std::string_view op;
+    for (auto candidate : ops) {
+        size_t p = expr.find(candidate);
+        if (p != std::string::npos && p < pos) {
+            pos = p;
+            op = candidate;
+        }
+    }
+    if (pos == std::string::npos) {
+        std::cerr << "Invalid expression (expected <path> <op> <value>): " << expr << "\n";
+        return EXIT_USAGE;
+    }
+
+    auto trim = [](std::string_view s) {
+        while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+        while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
+        return s;
+    };
+    std::string_view path = trim(std::string_view(expr).substr(0, pos));
+    std::string rhs(trim(std::string_view(expr).substr(pos + op.size())));
+
+    long double expected;
+    if (rhs == "true") expected = 1;
+    else if (rhs == "false") expected = 0;
+    else {
+        char* end = nullptr;
+        expected = std::strtold(rhs.c_str(), &end);
+        if (rhs.empty() || *end != '\0') {
+            std::cerr << "Invalid value: " << rhs << "\n";
+            return EXIT_USAGE;
+        }
+    }
+
+    memglass::ObjectView view;
+    std::string_view field_path;
+    if (!resolve_path(obs, path, view, field_path) || field_path.empty()) {
+        std::cerr << "No such field: " << path << "\n";
+        return EXIT_NOT_FOUND;
+    }
+    auto field = view[field_path];
+    long double actual;
+    if (!field || !numeric_value(field, actual)) {
+        std::cerr << "No such primitive field: " << path << "\n";
+        return EXIT_NOT_FOUND;
+    }
+
+    bool result = op == "==" ? actual == expected
+                : op == "!=" ? actual != expected
+                : op == "<=" ? actual <= expected
+                : op == ">=" ? actual >= expected
+                : op == "<" ? actual < expected
+                : actual > expected;
+    return result ? EXIT_OK : EXIT_FALSE;
+}
+
+// Flip the producer's publishing kill switch
+int command_pause(memglass::Observer& obs, bool paused) {
+    if (!obs.set_paused(paused)) {
+        std::cerr << "Producer does not support pausing\n";
+        return EXIT_NOT_FOUND;
+    }
+    return EXIT_OK;
+}
+
+// Heartbeats of the producer's threads; false (exit 1) if any is stalled
+int command_threads(memglass::Observer& obs, const char* threshold) {
+    memglass::StallOptions options;
+    if (threshold) {
+        uint64_t ns;
+        if (!memglass::query::parse_duration(threshold, ns)) {
+            std::cerr << "Invalid threshold: " << threshold << "\n";
+            return EXIT_USAGE;
+        }
+        options.threshold = std::chrono::nanoseconds(ns);
+    }
+
+    memglass::StallDetector detector(obs, options);
+    if (!detector.attach()) {
+        std::cerr << "Producer has no heartbeats (set Config::heartbeat_slots)\n";
+        return EXIT_NOT_FOUND;
+    }
+    for (const auto& t : detector.check()) {
+        std::cout << fmt::format("{}\t{}\t{}\t{:.3f}ms\t{}\n", t.name, t.tid, t.count, t.silent_ns / 1e6,
+                                 t.stalled ? "stalled" : "ok");
+    }
+    return detector.stalled() ? EXIT_FALSE : EXIT_OK;
+}
+
+bool is_command(std::string_view arg) {
+    return arg == "get" || arg == "ls" || arg == "check" || arg == "pause" || arg == "resume" ||
+           arg == "threads";
+}
+
+// memglass <command> <session> [args...]
+int run_command(int argc, char* argv[]) {
+    std::string command = argv[1];
+    bool control = command == "pause" || command == "resume";
+    bool optional_arg = command == "ls" || command == "threads";
+    if (argc < 3 || (!optional_arg && !control && argc < 4)) {
+        std::cerr << "Usage: " << argv[0] << " get <session> <label>[.<field>]...\n"
+                  << "       " << argv[0] << " ls <session> [prefix]\n"
+                  << "       " << argv[0] << " check <session> '<label>.<field> <op> <value>'\n"
+                  << "       " << argv[0] << " pause|resume <session>\n"
+                  << "       " << argv[0] << " threads <session> [threshold]\n";
+        return EXIT_USAGE;
+    }
+
+    // Only the header and the regions of the objects read get mapped
+    memglass::ObserverOptions obs_opts;
+    obs_opts.regions = memglass::RegionMapping::Lazy;
+    obs_opts.writable = control;
+    memglass::Observer obs(argv[2], obs_opts);
+    if (!obs.connect()) {
+        std::cerr << "Cannot connect to session '" << argv[2] << "'\n";
+        return EXIT_NO_SESSION;
+    }
+
+    if (command == "get") {
+        return command_get(obs, std::vector<std::string>(argv + 3, argv + argc));
+    }
+    if (command == "ls") {
+        return command_ls(obs, argc > 3 ? argv[3] : "");
+    }
+    if (control) {
+        return command_pause(obs, command == "pause");
+    }
+    if (command == "threads") {
+        return command_threads(obs, argc > 3 ? argv[3] : nullptr);
+    }
+
+    std::string expr;
+    for (int i = 3; i < argc; ++i) {
+        if (!expr.empty()) expr += ' ';
+        expr += argv[i];
+    }
+    return command_check(obs, expr);
+}
+
 // ============================================================================
 // Command-line parsing
 // ============================================================================
@@ -1062,19 +1829,41 @@ struct Options {
     std::string session_name;
     bool web_mode = false;
     int web_port = 8080;
+#ifdef MEMGLASS_WEB_ENABLED
+    std::string compare_session;
+    memglass::CompareOptions compare;
+#endif
+    memglass::RegionMapping mapping = memglass::RegionMapping::Lazy;
+    memglass::StallOptions stall;
     bool help = false;
 };
 
 void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " [OPTIONS] <session_name>\n"
+              << "       " << prog << " <command> <session_name> [ARGS]\n"
               << "\n"
               << "Interactive observer for memglass sessions.\n"
               << "\n"
               << "Options:\n"
               << "  -h, --help           Show this help message\n"
+              << "  -m, --map <mode>     Region mapping: eager, populate, lazy (default)\n"
+              << "  -s, --stall <dur>    Flag threads without a heartbeat for this long,\n"
+              << "                       e.g. 500us, 20ms (default: 10ms)\n"
 #ifdef MEMGLASS_WEB_ENABLED
               << "  -w, --web [PORT]     Run as web server (default port: 8080)\n"
+              << "  -c, --compare <sess> With -w, serve /compare: live diff against <sess>\n"
+              << "  -t, --tolerance <t>  Compare tolerance: [<label.field|field>=]<abs>\n"
+              << "                       or <name>=ignore (repeatable)\n"
 #endif
+              << "\n"
+              << "Commands (one-shot, for scripts):\n"
+              << "  get <session> <label>[.<field>]...   Print values\n"
+              << "  ls <session> [prefix]                List objects and types\n"
+              << "  check <session> '<label>.<field> <op> <value>'\n"
+              << "                                       Compare (==, !=, <, <=, >, >=)\n"
+              << "  pause|resume <session>               Switch the producer's publishing off/on\n"
+              << "  threads <session> [threshold]        Thread heartbeats; false if any is stalled\n"
+              << "  Exit codes: 0 ok/true, 1 false, 2 usage, 3 no session, 4 not found\n"
               << "\n"
               << "TUI Controls:\n"
               << "  Up/Down, j/k         Navigate\n"
@@ -1107,7 +1896,37 @@ Options parse_args(int argc, char* argv[]) {
                 }
             }
         }
+        else if ((arg == "-c" || arg == "--compare") && i + 1 < argc) {
+            opts.compare_session = argv[++i];
+        }
+        else if ((arg == "-t" || arg == "--tolerance") && i + 1 < argc) {
+            if (!memglass::parse_tolerance(argv[++i], opts.compare)) {
+                std::cerr << "Invalid tolerance: " << argv[i] << "\n";
+                opts.help = true;
+                return opts;
+            }
+        }
 #endif
+        else if ((arg == "-m" || arg == "--map") && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "eager") opts.mapping = memglass::RegionMapping::Eager;
+            else if (mode == "populate") opts.mapping = memglass::RegionMapping::Populate;
+            else if (mode == "lazy") opts.mapping = memglass::RegionMapping::Lazy;
+            else {
+                std::cerr << "Unknown mapping mode: " << mode << "\n";
+                opts.help = true;
+                return opts;
+            }
+        }
+        else if ((arg == "-s" || arg == "--stall") && i + 1 < argc) {
+            uint64_t ns;
+            if (!memglass::query::parse_duration(argv[++i], ns)) {
+                std::cerr << "Invalid duration: " << argv[i] << "\n";
+                opts.help = true;
+                return opts;
+            }
+            opts.stall.threshold = std::chrono::nanoseconds(ns);
+        }
         else if (arg[0] == '-') {
             std::cerr << "Unknown option: " << arg << "\n";
             opts.help = true;
@@ -1122,6 +1941,10 @@ Options parse_args(int argc, char* argv[]) {
 }
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && is_command(argv[1])) {
+        return run_command(argc, argv);
+    }
+
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
@@ -1138,7 +1961,17 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    memglass::Observer obs(opts.session_name);
+#ifdef MEMGLASS_WEB_ENABLED
+    if (!opts.compare_session.empty() && !opts.web_mode) {
+        std::cerr << "Error: --compare requires -w (use memglass-diff --compare in a terminal)\n";
+        return 1;
+    }
+#endif
+
+    // Browsing touches few objects at a time; only map what is viewed
+    memglass::ObserverOptions obs_opts;
+    obs_opts.regions = opts.mapping;
+    memglass::Observer obs(opts.session_name, obs_opts);
 
     std::cerr << "Connecting to session '" << opts.session_name << "'...\n";
 
@@ -1149,16 +1982,30 @@ int main(int argc, char* argv[]) {
 
     std::cerr << "Connected to PID: " << obs.producer_pid() << "\n";
 
+    // Shown only if the producer has heartbeat slots
+    memglass::StallDetector stalls(obs, opts.stall);
+    stalls.attach();
+
 #ifdef MEMGLASS_WEB_ENABLED
     if (opts.web_mode) {
         std::cerr << "Starting web server on port " << opts.web_port << "...\n";
         WebServer server(obs, opts.web_port);
+        server.watch_threads(stalls);
+
+        memglass::Observer obs_b(opts.compare_session, obs_opts);
+        if (!opts.compare_session.empty()) {
+            if (!obs_b.connect()) {
+                std::cerr << "Failed to connect to '" << opts.compare_session << "'.\n";
+                return 1;
+            }
+            server.compare_with(obs_b, opts.compare);
+        }
         server.run();
     } else
 #endif
     {
         std::cerr << "Starting TUI browser...\n";
-        TreeBrowser browser(obs);
+        TreeBrowser browser(obs, &stalls);
         browser.run();
     }
 